@@ -0,0 +1,248 @@
+#pragma once
+
+# include <condition_variable>
+# include <exception>
+# include <optional>
+# include <variant>
+# include "Matrix.hpp"
+# include "IO.hpp"
+# include "ThreadPool.hpp"
+
+/**
+ * Asynchronous evaluation on the global ThreadPool.
+ * submit(fn, deps...) returns at once a Future of fn's result. The task is queued when its dependencies (other
+ * futures) are all ready, and receives their values : chaining submits builds a DAG whose independent branches
+ * overlap on the pool, with no thread ever blocked on an unfinished dependency. An exception thrown by a task is
+ * stored in its future and propagated to every task depending on it.
+ * Waiting on a future runs pending pool tasks meanwhile, as parallel_for does. The task picked up may be any queued
+ * one, including one downstream of the waiter, run on its stack : a task blocking on a future other than its declared
+ * dependencies (already ready when it runs) could wait on itself forever, so wait() throws std::logic_error instead.
+ * The library stays C++17, so there are no coroutines : a coroutine wrapper can await ready() / get() on top of it.
+ */
+
+// Number of submit() tasks running on this thread : more than one when a wait helped with another task
+inline thread_local size_t async_tasks_running = 0;
+
+/**
+ * @brief Result of an asynchronous task, shared by every copy, std::shared_future-like.
+ * @tparam R The result type, void for tasks returning nothing (held as std::monostate).
+ */
+template<typename R>
+class Future {
+	public:
+		using value_type = std::conditional_t<std::is_void_v<R>, std::monostate, R>;
+
+		// Completion state shared by the future copies and the task producing it
+		struct State {
+			std::mutex                         mutex;
+			std::condition_variable            wake;
+			std::atomic<bool>                  done{false};
+			std::optional<value_type>          value;
+			std::exception_ptr                 error;
+			std::vector<std::function<void()>> continuations; // Run once, by the thread completing the state
+
+			// Publishes value or error, then runs the continuations
+			void finish() {
+				std::vector<std::function<void()>> run;
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					done = true;
+					run.swap(continuations);
+				}
+				wake.notify_all();
+				for (auto& f : run)
+					f();
+			}
+
+			// Runs f once the state is done : now if it already is, or from finish()
+			void on_ready(std::function<void()> f) {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (!done) {
+						continuations.push_back(std::move(f));
+						return;
+					}
+				}
+				f();
+			}
+		};
+
+	protected:
+		std::shared_ptr<State> state;
+
+	public:
+		Future() = default;
+
+		/**
+		 * @brief Wraps a state, as submit() does.
+		 */
+		explicit Future(std::shared_ptr<State> state) : state(std::move(state)) {}
+
+		inline bool valid() const { return state != nullptr; }
+		inline bool ready() const { return state && state->done.load(std::memory_order_acquire); }
+		inline const std::shared_ptr<State>& shared_state() const { return state; }
+
+		/**
+		 * @brief Waits until the result is available, running pending pool tasks meanwhile.
+		 * @note Inside a task, only ready futures (its dependencies) can be waited on : a helped task could depend on
+		 *       the waiter, which would then never complete. Pass the futures a task needs as submit() dependencies.
+		 * @throw std::logic_error If the future is empty, or not ready while a task runs on this thread.
+		 */
+		void wait() const {
+			if (!state)
+				throw std::logic_error("Waiting on an empty future.");
+			if (!ready() && async_tasks_running)
+				throw std::logic_error("A task cannot wait on a future that is not one of its dependencies.");
+
+			ThreadPool& pool = ThreadPool::global();
+			while (!ready()) {
+				if (pool.run_one())
+					continue;
+				std::unique_lock<std::mutex> lock(state->mutex); // Nothing to help with : sleep, waking up for new tasks
+				state->wake.wait_for(lock, std::chrono::microseconds(200), [this] { return state->done.load(); });
+			}
+		}
+
+		/**
+		 * @brief Returns the result, waiting for it.
+		 * @return const value_type& The result, shared by every copy of the future.
+		 * @throw The exception thrown by the task, or by one of its dependencies.
+		 */
+		const value_type& get() const {
+			wait();
+			if (state->error)
+				std::rethrow_exception(state->error);
+			return *state->value;
+		}
+};
+
+/**
+ * @brief Returns a future that is already ready with a value, to feed a value into a DAG of tasks.
+ * @param value The value.
+ * @return Future<X> The ready future.
+ */
+template<typename X>
+Future<X> ready_future(X value) {
+	auto state = std::make_shared<typename Future<X>::State>();
+	state->value.emplace(std::move(value));
+	state->done = true;
+	return Future<X>(std::move(state));
+}
+
+# pragma region Utils
+
+template<typename X> struct is_future : std::false_type {};
+template<typename X> struct is_future<Future<X>> : std::true_type {};
+
+// Futures pass through, values become ready futures
+template<typename X>
+auto as_future(X x) {
+	if constexpr (is_future<X>::value)
+		return x;
+	else
+		return ready_future(std::move(x));
+}
+
+# pragma endregion
+
+/**
+ * @brief Runs fn on the global ThreadPool once the dependencies are ready, and returns the future of its result.
+ * @details fn is called as fn(deps.get()...) : with const references to the dependencies' values (std::monostate for
+ *          void ones). If a dependency failed, fn is not called and the future holds the same exception.
+ *          The task is queued by the thread completing its last dependency, or right away without dependencies.
+ * @param fn The task. Copied into the pool, together with the futures it depends on.
+ * @param deps The futures of the values fn needs.
+ * @return Future<R> The future result of fn.
+ * @note Time complexity : O(deps) to schedule
+ */
+template<typename F, typename... D>
+auto submit(F fn, Future<D>... deps) {
+	using R     = std::invoke_result_t<F, const typename Future<D>::value_type&...>;
+	using State = typename Future<R>::State;
+
+	auto state = std::make_shared<State>();
+	auto task  = std::make_shared<ThreadPool::Task>([state, fn = std::move(fn), deps...]() {
+		async_tasks_running++;
+		try {
+			if constexpr (std::is_void_v<R>) {
+				fn(deps.get()...);
+				state->value.emplace();
+			}
+			else
+				state->value.emplace(fn(deps.get()...));
+		} catch (...) {
+			state->error = std::current_exception();
+		}
+		async_tasks_running--;
+		state->finish();
+	});
+
+	if constexpr (sizeof...(D) == 0)
+		ThreadPool::global().push(*task);
+	else {
+		auto remaining = std::make_shared<std::atomic<size_t>>(sizeof...(D));
+		auto ready     = [remaining, task] {
+			if (--*remaining == 0)
+				ThreadPool::global().push(*task);
+		};
+		(deps.shared_state()->on_ready(ready), ...);
+	}
+
+	return Future<R>(std::move(state));
+}
+
+# pragma region Operations
+
+/**
+ * Asynchronous versions of the large operations. Each operand is a value (moved in, copied if it is an lvalue) or the
+ * future of one, so results chain into the next operation without waiting : the service thread only calls get()
+ * on what it needs in the end.
+ */
+
+/**
+ * @brief Computes a.mul_mat(b) on the pool.
+ * @return Future<Matrix<T>> The product.
+ */
+template<typename A, typename B>
+auto async_mul_mat(A a, B b) {
+	return submit([](const auto& x, const auto& y) { return x.mul_mat(y); }, as_future(std::move(a)), as_future(std::move(b)));
+}
+
+/**
+ * @brief Computes a.inverse() on the pool.
+ * @return Future<Matrix<T>> The inverse. Holds std::logic_error if the matrix is singular.
+ */
+template<typename A>
+auto async_inverse(A a) {
+	return submit([](const auto& x) { return x.inverse(); }, as_future(std::move(a)));
+}
+
+/**
+ * @brief Computes a.solve(b) on the pool, for a right-hand side vector or matrix.
+ * @return Future of the solution.
+ */
+template<typename A, typename B>
+auto async_solve(A a, B b) {
+	return submit([](const auto& x, const auto& y) { return x.solve(y); }, as_future(std::move(a)), as_future(std::move(b)));
+}
+
+/**
+ * @brief Reads a binary matrix file (see load()) on the pool.
+ * @details The read occupies one worker : it overlaps the computations running on the others.
+ * @return Future<Matrix<T>> The matrix. Holds std::runtime_error if the file cannot be read.
+ */
+template<typename T>
+Future<Matrix<T>> async_load(std::string path) {
+	return submit([path = std::move(path)] { return load<T>(path); });
+}
+
+/**
+ * @brief Writes a matrix to a binary matrix file (see save()) on the pool, once it is available.
+ * @return Future<void> Ready when the file is written. Holds the error of the write, or of the matrix computation.
+ */
+template<typename M>
+Future<void> async_save(std::string path, M m) {
+	return submit([path = std::move(path)](const auto& x) { save(path, x); }, as_future(std::move(m)));
+}
+
+# pragma endregion
@@ -0,0 +1,417 @@
+#pragma once
+
+# include "Matrix.hpp"
+# include "Fixed.hpp"
+
+/**
+ * @brief Non-owning structure-of-arrays view over a batch of small vectors.
+ * @details Component k of vector i is at `ptr[k * stride + i]` : each component is a contiguous array over the batch,
+ *          so kernels vectorize across the batch dimension. A column-major Matrix<T>(dims, count) has exactly this
+ *          layout, with stride = ld(). The viewed storage must outlive the view.
+ * @tparam T The type of the elements (may be const-qualified for read-only views).
+ */
+template<typename T>
+class SoAView {
+	protected:
+		T*     ptr    = nullptr;
+		size_t n      = 0;   // Number of vectors in the batch
+		size_t d      = 0;   // Number of components of each vector
+		size_t stride = 0;   // Distance between the starts of two components
+
+	public:
+		using value_type = std::remove_const_t<T>;
+
+		SoAView() = default;
+
+		/**
+		 * @brief Views dims arrays of count elements.
+		 * @param ptr The first element of the first component.
+		 * @param count The number of vectors in the batch.
+		 * @param dims The number of components of each vector.
+		 * @param stride The distance between two components, count (packed) by default.
+		 * @throw std::invalid_argument If stride is smaller than count.
+		 */
+		SoAView(T* ptr, size_t count, size_t dims, size_t stride = 0) : ptr(ptr), n(count), d(dims), stride(stride ? stride : count) {
+			if (this->stride < count)
+				throw std::invalid_argument("SoA stride must be at least the batch size.");
+		}
+
+		/**
+		 * @brief Views the columns of a matrix as the components of a batch (count = rows, dims = cols).
+		 * @param m The matrix to view.
+		 */
+		template<typename M, typename = decltype(std::declval<M&>().ptr(), std::declval<M&>().ld())>
+		SoAView(M& m) : SoAView(m.ptr(), m.rows(), m.cols(), m.ld()) {}
+
+		// Allow SoAView<T> -> SoAView<const T>
+		template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+		SoAView(const SoAView<U>& other) : SoAView(other.component(0), other.count(), other.dims(), other.ld()) {}
+
+		# pragma region Utils
+
+		/**
+		 * @brief Returns the number of vectors in the batch.
+		 * @return size_t The batch size.
+		 */
+		inline size_t count() const { return n; }
+
+		/**
+		 * @brief Returns the number of components of each vector.
+		 * @return size_t The vector size.
+		 */
+		inline size_t dims() const { return d; }
+
+		/**
+		 * @brief Returns the distance between the starts of two components.
+		 * @return size_t The leading dimension.
+		 */
+		inline size_t ld() const { return stride; }
+
+		/**
+		 * @brief Returns the contiguous array holding component k of every vector.
+		 * @param k The component index.
+		 * @return T* The first element of the component.
+		 */
+		inline T* component(size_t k) const { return ptr + k * stride; }
+
+		/**
+		 * @brief Returns whether the views share any element.
+		 * @param other The other view.
+		 * @return true If the spans of memory covered by both views intersect.
+		 */
+		template<typename U>
+		bool overlaps(const SoAView<U>& other) const {
+			if (!n || !d || !other.count() || !other.dims())
+				return false;
+
+			const void* a_lo = component(0);
+			const void* a_hi = component(d - 1) + n;
+			const void* b_lo = other.component(0);
+			const void* b_hi = other.component(other.dims() - 1) + other.count();
+			return std::less<const void*>()(a_lo, b_hi) && std::less<const void*>()(b_lo, a_hi);
+		}
+
+		# pragma endregion
+};
+
+/**
+ * Batched kernels. They follow the Matrix<T>::mul_vec convention, out[c] = sum over r of m[c][r] * in[r],
+ * and process the batch in blocks that stay in L1 : for each output component, one fma pass per input component
+ * over the block, which the compiler vectorizes across the batch. Blocks are spread over the thread pool.
+ * Nothing is allocated : the caller provides the output, which must not overlap the inputs.
+ */
+
+// Keeps T deduced from the matrix or the output only, so SoAView<T> arguments convert to SoAView<const T> parameters
+template<typename T> struct no_deduce { using type = T; };
+template<typename T> using no_deduce_t = typename no_deduce<T>::type;
+
+// Vectors per block : 4 input and 4 output components of 256 floats fit in 8 KiB
+inline constexpr size_t BATCH_BLOCK = 256;
+
+# pragma region Kernels
+
+/**
+ * @brief out[c][lo, hi) = sum over r of m(r, c) * in[r][lo, hi), R and C fixed at compile time when not DYNAMIC.
+ */
+template<size_t R, size_t C, typename T>
+inline void transform_block(const T* m, size_t ld, size_t rows, size_t cols, const SoAView<const T>& in, const SoAView<T>& out, size_t lo, size_t hi) {
+	if constexpr (R != DYNAMIC) rows = R;
+	if constexpr (C != DYNAMIC) cols = C;
+
+	# pragma GCC unroll 4
+	for (size_t c = 0; c < cols; c++) {
+		const T* mc = m + c * ld;
+		T*       o  = out.component(c);
+
+		const T  m0 = mc[0];
+		const T* i0 = in.component(0);
+		for (size_t i = lo; i < hi; i++)
+			o[i] = m0 * i0[i];
+
+		# pragma GCC unroll 4
+		for (size_t r = 1; r < rows; r++) {
+			const T  mr = mc[r];
+			const T* ir = in.component(r);
+
+			for (size_t i = lo; i < hi; i++) {
+				if constexpr (IS_ARITHMETIC(T))
+					o[i] = std::fma(mr, ir[i], o[i]);
+				else
+					o[i] += mr * ir[i];
+			}
+		}
+	}
+}
+
+/**
+ * @brief Per-vector matrices : element (r, c) of matrix i is component c * rows + r of mats.
+ */
+template<size_t R, size_t C, typename T>
+inline void transform_each_block(const SoAView<const T>& mats, size_t rows, size_t cols, const SoAView<const T>& in, const SoAView<T>& out, size_t lo, size_t hi) {
+	if constexpr (R != DYNAMIC) rows = R;
+	if constexpr (C != DYNAMIC) cols = C;
+
+	# pragma GCC unroll 4
+	for (size_t c = 0; c < cols; c++) {
+		T*       o  = out.component(c);
+		const T* m0 = mats.component(c * rows);
+		const T* i0 = in.component(0);
+
+		for (size_t i = lo; i < hi; i++)
+			o[i] = m0[i] * i0[i];
+
+		# pragma GCC unroll 4
+		for (size_t r = 1; r < rows; r++) {
+			const T* mr = mats.component(c * rows + r);
+			const T* ir = in.component(r);
+
+			for (size_t i = lo; i < hi; i++) {
+				if constexpr (IS_ARITHMETIC(T))
+					o[i] = std::fma(mr[i], ir[i], o[i]);
+				else
+					o[i] += mr[i] * ir[i];
+			}
+		}
+	}
+}
+
+template<typename T>
+void check_batch(size_t rows, size_t cols, const SoAView<const T>& in, const SoAView<T>& out) {
+	if (in.dims() != rows)
+		throw std::invalid_argument("Input vectors size must match the matrix rows.");
+	if (out.dims() != cols)
+		throw std::invalid_argument("Output vectors size must match the matrix cols.");
+	if (in.count() != out.count())
+		throw std::invalid_argument("Input and output batches must have the same size.");
+	if (out.overlaps(in))
+		throw std::invalid_argument("Output batch must not overlap the input batch.");
+}
+
+template<size_t R, size_t C, typename T>
+void transform_batch(const T* m, size_t ld, size_t rows, size_t cols, const SoAView<const T>& in, const SoAView<T>& out) {
+	check_batch(rows, cols, in, out);
+
+	const size_t blocks = (in.count() + BATCH_BLOCK - 1) / BATCH_BLOCK;
+	parallel_for(0, blocks, 2 * rows * cols * BATCH_BLOCK, [&](size_t lo, size_t hi) {
+		for (size_t b = lo; b < hi; b++)
+			transform_block<R, C>(m, ld, rows, cols, in, out, b * BATCH_BLOCK, std::min(in.count(), (b + 1) * BATCH_BLOCK));
+	});
+}
+
+# pragma endregion
+
+/**
+ * @brief Multiplies one matrix by every vector of a batch : out[i] = m.mul_vec(in[i]).
+ * @details Same result as calling mul_vec per vector, without any allocation or per-vector shape check.
+ * @param m The matrix, applied to every vector.
+ * @param in The input batch, of m.rows() components.
+ * @param out The output batch, of m.cols() components and the same size. Must not overlap the input.
+ * @throw std::invalid_argument If the shapes or batch sizes do not match, or the batches overlap.
+ * @note Time complexity : O(n * m.rows() * m.cols()) with n the batch size
+ * @note Space complexity : O(1)
+ * @note Allowed math functions : fma
+ */
+template<typename T>
+void transform(const Matrix<T>& m, SoAView<const no_deduce_t<T>> in, SoAView<no_deduce_t<T>> out) {
+	if (m.rows() == 4 && m.cols() == 4 && m.ld() == 4) // The common vertex transform, fully unrolled
+		transform_batch<4, 4>(m.ptr(), m.ld(), 4, 4, in, out);
+	else
+		transform_batch<DYNAMIC, DYNAMIC>(m.ptr(), m.ld(), m.rows(), m.cols(), in, out);
+}
+
+/**
+ * @brief Multiplies one fixed-size matrix by every vector of a batch, with the loops unrolled at compile time.
+ * @see transform(const Matrix<T>&, SoAView<const T>, SoAView<T>)
+ */
+template<typename T, size_t R, size_t C, std::enable_if_t<R != DYNAMIC, int> = 0>
+void transform(const Matrix<T, R, C>& m, SoAView<const no_deduce_t<T>> in, SoAView<no_deduce_t<T>> out) {
+	transform_batch<R, C>(m.ptr(), m.ld(), R, C, in, out);
+}
+
+/**
+ * @brief Multiplies every vector of a batch by its own matrix : out[i] = mats[i].mul_vec(in[i]).
+ * @details The matrices are stored as a batch too : element (r, c) of matrix i is component c * rows + r of mats
+ *          (the column-major order of one matrix), so every matrix element is contiguous over the batch.
+ * @param mats The batch of matrices, of in.dims() * out.dims() components.
+ * @param in The input batch.
+ * @param out The output batch, of the same size. Must not overlap the inputs.
+ * @throw std::invalid_argument If the shapes or batch sizes do not match, or the output overlaps an input.
+ * @note Time complexity : O(n * in.dims() * out.dims()) with n the batch size
+ * @note Space complexity : O(1)
+ * @note Allowed math functions : fma
+ */
+template<typename T>
+void transform_each(SoAView<const no_deduce_t<T>> mats, SoAView<const no_deduce_t<T>> in, SoAView<T> out) {
+	const size_t rows = in.dims(), cols = out.dims();
+
+	check_batch(rows, cols, in, out);
+	if (mats.dims() != rows * cols)
+		throw std::invalid_argument("Matrices components must match the input and output vectors sizes.");
+	if (mats.count() != in.count())
+		throw std::invalid_argument("There must be one matrix per vector.");
+	if (out.overlaps(mats))
+		throw std::invalid_argument("Output batch must not overlap the matrices.");
+
+	const size_t blocks = (in.count() + BATCH_BLOCK - 1) / BATCH_BLOCK;
+	parallel_for(0, blocks, 2 * rows * cols * BATCH_BLOCK, [&](size_t lo, size_t hi) {
+		for (size_t b = lo; b < hi; b++) {
+			const size_t first = b * BATCH_BLOCK, last = std::min(in.count(), first + BATCH_BLOCK);
+
+			if (rows == 4 && cols == 4)
+				transform_each_block<4, 4>(mats, rows, cols, in, out, first, last);
+			else
+				transform_each_block<DYNAMIC, DYNAMIC>(mats, rows, cols, in, out, first, last);
+		}
+	});
+}
+
+# pragma region Interpolation
+
+/**
+ * Batched interpolation, for keyframe animation : every vector i of the batch is interpolated with its own factor t[i].
+ * Like the transforms, nothing is allocated and blocks of BATCH_BLOCK vectors are spread over the thread pool.
+ * The output may be one of the inputs (in-place update of the current pose), but must not partially overlap them.
+ */
+
+template<typename T>
+void check_interpolation(const SoAView<const T>& u, const SoAView<const T>& v, const SoAView<T>& out) {
+	if (u.dims() != v.dims() || u.dims() != out.dims())
+		throw std::invalid_argument("Interpolated vectors must all have the same size.");
+	if (u.count() != v.count() || u.count() != out.count())
+		throw std::invalid_argument("Interpolated batches must have the same size.");
+
+	auto aliases = [&](const SoAView<const T>& in) { return in.component(0) == out.component(0) && in.ld() == out.ld(); };
+	if ((out.overlaps(u) && !aliases(u)) || (out.overlaps(v) && !aliases(v)))
+		throw std::invalid_argument("Output batch must be disjoint from the inputs, or one of them.");
+}
+
+/**
+ * @brief out[k][lo, hi) = u[k] + a * (v[k] - u[k]) with a = t[i].
+ */
+template<typename T, typename R>
+inline void lerp_block(const SoAView<const T>& u, const SoAView<const T>& v, const R* t, const SoAView<T>& out, size_t lo, size_t hi) {
+	for (size_t k = 0; k < out.dims(); k++) {
+		const T* uk = u.component(k);
+		const T* vk = v.component(k);
+		T*       ok = out.component(k);
+
+		for (size_t i = lo; i < hi; i++) {
+			if constexpr (IS_ARITHMETIC(T))
+				ok[i] = std::fma(t[i], vk[i] - uk[i], uk[i]);
+			else
+				ok[i] = uk[i] + t[i] * (vk[i] - uk[i]);
+		}
+	}
+}
+
+/**
+ * @brief Linearly interpolates every pair of a batch : out[i] = lerp(u[i], v[i], t[i]).
+ * @details Same semantics as lerp(const Vector<T>&, const Vector<T>&, t) per vector, vectorized across the batch.
+ * @param u The batch of start vectors (t = 0).
+ * @param v The batch of end vectors (t = 1), of the same shape.
+ * @param t The interpolation factors, one per vector (u.count() of them).
+ * @param out The output batch, of the same shape. May be u or v itself.
+ * @throw std::invalid_argument If the shapes do not match, or the output partially overlaps an input.
+ * @note Time complexity : O(n * d) with n the batch size and d the vectors size
+ * @note Space complexity : O(1)
+ * @note Allowed math functions : fma
+ */
+template<typename T>
+void lerp(SoAView<const no_deduce_t<T>> u, SoAView<const no_deduce_t<T>> v, const TO_REAL<T>* t, SoAView<T> out) {
+	check_interpolation(u, v, out);
+
+	const size_t blocks = (u.count() + BATCH_BLOCK - 1) / BATCH_BLOCK;
+	parallel_for(0, blocks, 3 * u.dims() * BATCH_BLOCK, [&](size_t lo, size_t hi) {
+		for (size_t b = lo; b < hi; b++)
+			lerp_block(u, v, t, out, b * BATCH_BLOCK, std::min(u.count(), (b + 1) * BATCH_BLOCK));
+	});
+}
+
+/**
+ * @brief Spherically interpolates every pair of unit vectors of a batch, at constant angular speed.
+ * @details out[i] = (sin((1 - t) w) u[i] + sin(t w) v[i]) / sin(w), with w the angle between u[i] and v[i].
+ *          The dot products, then the weights, are computed for a whole block before the components are blended,
+ *          so every pass runs over contiguous arrays. Pairs closer than about 1e-3 rad (where sin(w) loses its digits)
+ *          fall back to lerp. Antipodal pairs have no unique arc : they are lerped too, and the caller of a quaternion
+ *          batch should negate v[i] when dot(u[i], v[i]) < 0 to take the shortest path.
+ * @param u The batch of start unit vectors (t = 0).
+ * @param v The batch of end unit vectors (t = 1), of the same shape.
+ * @param t The interpolation factors, one per vector.
+ * @param out The output batch, of the same shape. May be u or v itself.
+ * @throw std::invalid_argument If the shapes do not match, or the output partially overlaps an input.
+ * @note Time complexity : O(n * d)
+ * @note Space complexity : O(1)
+ * @note Allowed math functions : fma, acos, sin
+ *
+ * @see https://en.wikipedia.org/wiki/Slerp
+ */
+template<typename T>
+void slerp(SoAView<const no_deduce_t<T>> u, SoAView<const no_deduce_t<T>> v, const no_deduce_t<T>* t, SoAView<T> out) {
+	static_assert(IS_ARITHMETIC(T), "slerp is only defined for real vectors.");
+	check_interpolation(u, v, out);
+
+	const size_t blocks = (u.count() + BATCH_BLOCK - 1) / BATCH_BLOCK;
+	parallel_for(0, blocks, 3 * u.dims() * BATCH_BLOCK + 64, [&](size_t lo, size_t hi) {
+		T wu[BATCH_BLOCK], wv[BATCH_BLOCK];
+
+		for (size_t b = lo; b < hi; b++) {
+			const size_t first = b * BATCH_BLOCK, last = std::min(u.count(), first + BATCH_BLOCK), m = last - first;
+
+			// Cosines of the angles between the pairs
+			std::fill(wu, wu + m, T(0));
+			for (size_t k = 0; k < u.dims(); k++) {
+				const T* uk = u.component(k) + first;
+				const T* vk = v.component(k) + first;
+				for (size_t i = 0; i < m; i++)
+					wu[i] = std::fma(uk[i], vk[i], wu[i]);
+			}
+
+			// Weights of u and v
+			for (size_t i = 0; i < m; i++) {
+				const T c = std::clamp(wu[i], T(-1), T(1));
+				const T a = t[first + i];
+
+				if (std::abs(c) > T(1) - T(5e-7)) { // sin(w)^2 < 1e-6
+					wu[i] = T(1) - a;
+					wv[i] = a;
+					continue;
+				}
+				const T w = std::acos(c), s = std::sin(w);
+				wu[i] = std::sin((T(1) - a) * w) / s;
+				wv[i] = std::sin(a * w) / s;
+			}
+
+			for (size_t k = 0; k < u.dims(); k++) {
+				const T* uk = u.component(k) + first;
+				const T* vk = v.component(k) + first;
+				T*       ok = out.component(k) + first;
+				for (size_t i = 0; i < m; i++)
+					ok[i] = std::fma(wu[i], uk[i], wv[i] * vk[i]);
+			}
+		}
+	});
+}
+
+/**
+ * @brief Blends every pair of 4x4 transforms of a batch : out[i] = (1 - t[i]) a[i] + t[i] b[i], element-wise.
+ * @details The matrices are stored as in transform_each() (element (r, c) of matrix i is component c * 4 + r), so the
+ *          result can be applied directly with transform_each(). The blend is linear, as in linear blend skinning :
+ *          exact for translations and for transforms close to each other, it shrinks rotations that are far apart,
+ *          which should then be interpolated as quaternions with slerp() and converted back.
+ * @param a The batch of start transforms (t = 0), of 16 components.
+ * @param b The batch of end transforms (t = 1).
+ * @param t The blend factors, one per matrix.
+ * @param out The output batch of transforms. May be a or b itself.
+ * @throw std::invalid_argument If the batches are not of 16 components and the same size, or the output partially overlaps an input.
+ * @note Time complexity : O(n)
+ * @note Space complexity : O(1)
+ * @note Allowed math functions : fma
+ */
+template<typename T>
+void blend(SoAView<const no_deduce_t<T>> a, SoAView<const no_deduce_t<T>> b, const TO_REAL<T>* t, SoAView<T> out) {
+	if (a.dims() != 16 || b.dims() != 16 || out.dims() != 16)
+		throw std::invalid_argument("Blended transforms must be batches of 4x4 matrices (16 components).");
+	lerp<T>(a, b, t, out);
+}
+
+# pragma endregion
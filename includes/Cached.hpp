@@ -0,0 +1,261 @@
+#pragma once
+
+# include <mutex>
+# include <optional>
+# include "Vector.hpp"
+# include "Matrix.hpp"
+# include "LU.hpp"
+
+/**
+ * @brief A matrix that memoizes its derived properties until it is modified.
+ * @details determinant(), rank(), inverse(), rref() and the LU factorization are computed on first use, then returned
+ *          in O(1) until a mutation (add, sub, scl, set, assign, non-const operator[] or modify()) drops them all.
+ *          It is opt-in : a plain Matrix<T> never pays for the cache. Typical use is a matrix built once and queried
+ *          every frame, e.g. CachedMatrix<f32> proj(projection(fov, ratio, near, far)).
+ *          The values are the ones of the Matrix<T> methods of the same name, computed on the same elements.
+ *          Const queries may run concurrently, the cache is filled under a lock; mutations must not run concurrently
+ *          with anything else, as for a Matrix<T>.
+ * @tparam T The type of the elements in the matrix.
+ */
+template<typename T>
+class CachedMatrix {
+	protected:
+		Matrix<T> m;
+
+		mutable std::mutex                lock;
+		mutable std::optional<T>          det;
+		mutable std::optional<size_t>     rk;         // Rank for the default tolerance
+		mutable std::optional<Matrix<T>>  inv;
+		mutable std::optional<bool>       invertible; // Known once inverse() ran, so a singular matrix throws in O(1) too
+		mutable std::optional<Echelon<T>> echelon;
+		mutable std::optional<LU<T>>      lu;
+
+		void copy_cache(const CachedMatrix& other) {
+			det        = other.det;
+			rk         = other.rk;
+			inv        = other.inv;
+			invertible = other.invertible;
+			echelon    = other.echelon;
+			lu         = other.lu;
+		}
+
+		void move_cache(CachedMatrix& other) {
+			det        = std::move(other.det);
+			rk         = std::move(other.rk);
+			inv        = std::move(other.inv);
+			invertible = std::move(other.invertible);
+			echelon    = std::move(other.echelon);
+			lu         = std::move(other.lu);
+			other.invalidate(); // A moved-from optional still holds a (moved-from) value
+		}
+
+	public:
+		CachedMatrix() = default;
+
+		/**
+		 * @brief Wraps a matrix, with an empty cache.
+		 * @param m The matrix, moved in to avoid the copy.
+		 */
+		explicit CachedMatrix(Matrix<T> m) : m(std::move(m)) {}
+
+		CachedMatrix(const CachedMatrix& other) {
+			std::lock_guard<std::mutex> guard(other.lock);
+			m = other.m;
+			copy_cache(other);
+		}
+
+		CachedMatrix& operator=(const CachedMatrix& other) {
+			if (this != &other) {
+				std::scoped_lock guard(lock, other.lock);
+				m = other.m;
+				copy_cache(other);
+			}
+			return *this;
+		}
+
+		/**
+		 * @brief Takes the matrix and its cache, leaving other empty with no cached property.
+		 */
+		CachedMatrix(CachedMatrix&& other) noexcept {
+			std::lock_guard<std::mutex> guard(other.lock);
+			m = std::move(other.m);
+			move_cache(other);
+		}
+
+		CachedMatrix& operator=(CachedMatrix&& other) noexcept {
+			if (this != &other) {
+				std::scoped_lock guard(lock, other.lock);
+				m = std::move(other.m);
+				move_cache(other);
+			}
+			return *this;
+		}
+
+		# pragma region Mutations
+
+		/**
+		 * @brief Drops every cached property.
+		 * @note Time complexity : O(1), plus freeing the cached matrices
+		 */
+		void invalidate() {
+			det.reset();
+			rk.reset();
+			inv.reset();
+			invertible.reset();
+			echelon.reset();
+			lu.reset();
+		}
+
+		/**
+		 * @brief Replaces the matrix.
+		 * @param other The new matrix.
+		 */
+		void assign(Matrix<T> other) {
+			m = std::move(other);
+			invalidate();
+		}
+
+		void add(const Matrix<T>& other) { m.add(other); invalidate(); }
+		void sub(const Matrix<T>& other) { m.sub(other); invalidate(); }
+		void scl(const T& scalar) { m.scl(scalar); invalidate(); }
+
+		/**
+		 * @brief Writes one element, dropping the cache : the safe way to change single elements between queries.
+		 * @param col The column index.
+		 * @param row The row index.
+		 * @param value The new value.
+		 */
+		void set(size_t col, size_t row, const T& value) {
+			m[col][row] = value;
+			invalidate();
+		}
+
+		/**
+		 * @brief Returns column index for writing, dropping the cache : the view may be written through.
+		 * @details The cache is dropped when the view is taken, not when it is written : as for modify(), the view must
+		 *          not be written through after the next query, which would cache stale properties. Use set() for that.
+		 * @note Even a read through this overload drops the cache : read through a const reference (or the const
+		 *       overload) to keep it.
+		 */
+		VectorView<T> operator[](size_t index) {
+			invalidate();
+			return m[index];
+		}
+		VectorView<const T> operator[](size_t index) const { return m[index]; }
+
+		/**
+		 * @brief Returns the matrix for arbitrary in-place changes, dropping the cache.
+		 * @details The reference must not be kept to modify the matrix after the next query.
+		 */
+		Matrix<T>& modify() {
+			invalidate();
+			return m;
+		}
+
+		# pragma endregion
+
+		# pragma region Queries
+
+		/**
+		 * @brief Returns the determinant, computed once (see Matrix<T>::determinant()).
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @note Time complexity : O(n^3) the first time, O(1) after
+		 */
+		T determinant() const {
+			std::lock_guard<std::mutex> guard(lock);
+			if (!det)
+				det = m.determinant();
+			return *det;
+		}
+
+		/**
+		 * @brief Returns the rank for the default tolerance, computed once (see Matrix<T>::rank()).
+		 * @note Time complexity : O(m*n*min(m, n)) the first time, O(1) after
+		 */
+		size_t rank() const {
+			std::lock_guard<std::mutex> guard(lock);
+			if (!rk)
+				rk = m.rank();
+			return *rk;
+		}
+
+		/**
+		 * @brief Returns the inverse, computed once (see Matrix<T>::inverse()).
+		 * @return const Matrix<T>& The cached inverse, valid until the next mutation.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @throw std::logic_error If the matrix is singular, every time without recomputing.
+		 * @note Time complexity : O(n^3) the first time, O(1) after
+		 */
+		const Matrix<T>& inverse() const {
+			std::lock_guard<std::mutex> guard(lock);
+			if (!invertible) {
+				try {
+					inv = m.inverse();
+				} catch (const std::logic_error&) {
+					if (!m.is_square()) // std::invalid_argument is a logic_error too : not cached
+						throw;
+					invertible = false;
+					throw;
+				}
+				invertible = true;
+			}
+			if (!*invertible)
+				throw std::logic_error("Matrix is singular and cannot be inverted.");
+			return *inv;
+		}
+
+		/**
+		 * @brief Returns the Reduced Row Echelon Form with default tolerance and partial pivoting, computed once (see Matrix<T>::rref()).
+		 * @return const Echelon<T>& The cached elimination, valid until the next mutation.
+		 * @note Time complexity : O(m*n*min(m, n)) the first time, O(1) after
+		 */
+		const Echelon<T>& rref() const {
+			std::lock_guard<std::mutex> guard(lock);
+			if (!echelon)
+				echelon = m.rref();
+			return *echelon;
+		}
+
+		/**
+		 * @brief Returns the LU factorization, computed once, to solve many systems with the same matrix.
+		 * @return const LU<T>& The cached factors, valid until the next mutation.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @note Time complexity : O(n^3) the first time, O(1) after
+		 */
+		const LU<T>& factorization() const {
+			std::lock_guard<std::mutex> guard(lock);
+			if (!lu)
+				lu.emplace(m);
+			return *lu;
+		}
+
+		/**
+		 * @brief Solves A.mul_vec(x) == b with the cached factorization.
+		 * @throw std::invalid_argument If the matrix is not square or b does not match its size.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n^3) the first time, O(n^2) after
+		 */
+		Vector<T> solve(const Vector<T>& b) const { return factorization().solve(b); }
+
+		# pragma endregion
+
+		# pragma region Utils
+
+		inline const Matrix<T>& matrix() const { return m; }
+		inline operator const Matrix<T>&() const { return m; }
+		inline size_t rows() const { return m.rows(); }
+		inline size_t cols() const { return m.cols(); }
+
+		/**
+		 * @brief Returns whether a property is cached, for tests and diagnostics.
+		 */
+		bool has_cached_determinant() const { std::lock_guard<std::mutex> guard(lock); return det.has_value(); }
+		bool has_cached_inverse() const { std::lock_guard<std::mutex> guard(lock); return invertible.has_value(); }
+
+		# pragma endregion
+};
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const CachedMatrix<T>& m) {
+	return os << m.matrix();
+}
@@ -0,0 +1,559 @@
+#pragma once
+
+# include <string>
+# include "Vector.hpp"
+# include "Matrix.hpp"
+
+# ifdef MATRIX_CUDA
+#  include <cuda_runtime.h>
+#  include <cublas_v2.h>
+# endif
+
+/**
+ * Device-resident matrices and vectors, to chain operations on a GPU without a host round trip per operation.
+ *
+ * Built with MATRIX_CUDA (make CUDA=1), DeviceMatrix<T> and DeviceVector<T> own CUDA device memory (f32 and double)
+ * and every operation is enqueued on the stream of a DeviceContext : uploads and downloads are cudaMemcpyAsync,
+ * GEMM, mul_vec, transpose and the elementwise operations are cuBLAS calls. Nothing waits for the device until
+ * synchronize() or to_host(), so host work and transfers overlap with the kernels. Transfers only run truly
+ * asynchronously from page-locked host memory (cudaHostRegister on the Matrix<T> / Vector<T> buffer).
+ *
+ * Without MATRIX_CUDA, the same types keep their data in a host Matrix<T> / Vector<T> and run the CPU kernels :
+ * code written against them builds and runs everywhere, and DeviceContext::accelerated() tells the two apart.
+ *
+ * Operations follow the Matrix<T> conventions (mul_vec(v)[c] = sum over r of A(r, c) * v[r], mul_mat(B) = A * B).
+ * Every operand of one operation must belong to the same DeviceContext, by default the calling thread's.
+ */
+
+# pragma region Utils
+
+# ifdef MATRIX_CUDA
+
+inline void check_cuda(cudaError_t status, const char* what) {
+	if (status != cudaSuccess)
+		throw std::runtime_error(std::string(what) + ": " + cudaGetErrorString(status));
+}
+
+inline void check_cublas(cublasStatus_t status, const char* what) {
+	if (status != CUBLAS_STATUS_SUCCESS)
+		throw std::runtime_error(std::string(what) + " failed with cuBLAS status " + std::to_string(int(status)));
+}
+
+// cuBLAS entry points of one element type
+template<typename T> struct cublas_traits { static constexpr bool enabled = false; };
+template<> struct cublas_traits<float> {
+	static constexpr bool enabled = true;
+	static constexpr auto gemm = cublasSgemm, gemv = cublasSgemv, geam = cublasSgeam, axpy = cublasSaxpy, scal = cublasSscal;
+};
+template<> struct cublas_traits<double> {
+	static constexpr bool enabled = true;
+	static constexpr auto gemm = cublasDgemm, gemv = cublasDgemv, geam = cublasDgeam, axpy = cublasDaxpy, scal = cublasDscal;
+};
+
+# endif
+
+# pragma endregion
+
+/**
+ * @brief The stream the device operations are enqueued on, and the cuBLAS handle bound to it.
+ * @details Operations on one context run in order ; operations on different contexts may run concurrently.
+ *          A context is not thread-safe : each thread uses its own, see local().
+ */
+class DeviceContext {
+	protected:
+# ifdef MATRIX_CUDA
+		cudaStream_t   stream = nullptr;
+		cublasHandle_t handle = nullptr;
+# endif
+
+	public:
+		/**
+		 * @brief Creates a stream and its cuBLAS handle.
+		 * @throw std::runtime_error If there is no usable CUDA device.
+		 */
+		DeviceContext() {
+# ifdef MATRIX_CUDA
+			check_cuda(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking), "cudaStreamCreate");
+			check_cublas(cublasCreate(&handle), "cublasCreate");
+			check_cublas(cublasSetStream(handle, stream), "cublasSetStream");
+			check_cublas(cublasSetPointerMode(handle, CUBLAS_POINTER_MODE_HOST), "cublasSetPointerMode");
+# endif
+		}
+
+		~DeviceContext() {
+# ifdef MATRIX_CUDA
+			cublasDestroy(handle);
+			cudaStreamDestroy(stream);
+# endif
+		}
+
+		DeviceContext(const DeviceContext&) = delete;
+		DeviceContext& operator=(const DeviceContext&) = delete;
+
+		/**
+		 * @brief Returns the context of the calling thread.
+		 * @return DeviceContext& The thread-local context, created on first use.
+		 */
+		static DeviceContext& local() {
+			static thread_local DeviceContext ctx;
+			return ctx;
+		}
+
+		/**
+		 * @brief Checks whether operations run on a GPU, or on the host fallback.
+		 * @return true If built with MATRIX_CUDA.
+		 */
+		static constexpr bool accelerated() {
+# ifdef MATRIX_CUDA
+			return true;
+# else
+			return false;
+# endif
+		}
+
+		/**
+		 * @brief Waits for every operation enqueued on the context.
+		 * @throw std::runtime_error If one of them failed.
+		 */
+		void synchronize() {
+# ifdef MATRIX_CUDA
+			check_cuda(cudaStreamSynchronize(stream), "cudaStreamSynchronize");
+# endif
+		}
+
+# ifdef MATRIX_CUDA
+		inline cudaStream_t cuda_stream() const { return stream; }
+		inline cublasHandle_t cublas_handle() const { return handle; }
+
+		/**
+		 * @brief Allocates n uninitialized elements in stream order.
+		 */
+		template<typename T>
+		T* allocate(size_t n) {
+			void* ptr = nullptr;
+			if (n)
+				check_cuda(cudaMallocAsync(&ptr, n * sizeof(T), stream), "cudaMallocAsync");
+			return static_cast<T*>(ptr);
+		}
+
+		// Frees in stream order, after the operations already enqueued. Never throws, for the destructors.
+		void release(void* ptr) noexcept {
+			if (ptr)
+				cudaFreeAsync(ptr, stream);
+		}
+# endif
+};
+
+/**
+ * @brief A vector resident on the device (see Device.hpp).
+ * @tparam T The type of the elements, f32 or double with MATRIX_CUDA.
+ */
+template<typename T>
+class DeviceVector {
+	template<typename> friend class DeviceMatrix;
+
+	protected:
+		DeviceContext* ctx = nullptr;
+# ifdef MATRIX_CUDA
+		static_assert(cublas_traits<T>::enabled, "The CUDA backend supports f32 and double elements.");
+
+		T*     dev = nullptr;
+		size_t n   = 0;
+# else
+		Vector<T> host;
+# endif
+
+		void check_context(const DeviceVector<T>& other) const {
+			if (ctx != other.ctx)
+				throw std::invalid_argument("Device operands must belong to the same context.");
+		}
+
+	public:
+		/**
+		 * @brief Allocates a zero vector on the device.
+		 * @param size The number of elements.
+		 * @param ctx The context the vector and its operations belong to.
+		 */
+		explicit DeviceVector(size_t size = 0, DeviceContext& ctx = DeviceContext::local()) : ctx(&ctx)
+# ifdef MATRIX_CUDA
+			, dev(ctx.allocate<T>(size)), n(size) {
+			if (n)
+				check_cuda(cudaMemsetAsync(dev, 0, n * sizeof(T), ctx.cuda_stream()), "cudaMemsetAsync");
+		}
+# else
+			, host(size) {}
+# endif
+
+		/**
+		 * @brief Allocates a vector on the device and enqueues the upload of v.
+		 * @param v The host vector, which must stay alive and unmodified until the context is synchronized.
+		 */
+		explicit DeviceVector(const Vector<T>& v, DeviceContext& ctx = DeviceContext::local()) : DeviceVector(v.size(), ctx) { upload(v); }
+
+		DeviceVector(DeviceVector&& other) noexcept { *this = std::move(other); }
+		DeviceVector& operator=(DeviceVector&& other) noexcept {
+			std::swap(ctx, other.ctx);
+# ifdef MATRIX_CUDA
+			std::swap(dev, other.dev);
+			std::swap(n, other.n);
+# else
+			std::swap(host, other.host);
+# endif
+			return *this;
+		}
+		DeviceVector(const DeviceVector&) = delete;
+		DeviceVector& operator=(const DeviceVector&) = delete;
+
+		~DeviceVector() {
+# ifdef MATRIX_CUDA
+			if (ctx)
+				ctx->release(dev);
+# endif
+		}
+
+		/**
+		 * @brief Enqueues the copy of a host vector of the same size into this one.
+		 * @throw std::invalid_argument If the sizes differ.
+		 */
+		void upload(const Vector<T>& v) {
+			if (v.size() != size())
+				throw std::invalid_argument("Vectors must have the same size");
+# ifdef MATRIX_CUDA
+			check_cuda(cudaMemcpyAsync(dev, v.ptr(), n * sizeof(T), cudaMemcpyHostToDevice, ctx->cuda_stream()), "cudaMemcpyAsync");
+# else
+			host = v;
+# endif
+		}
+
+		/**
+		 * @brief Enqueues the copy of this vector into a host vector, resized if needed.
+		 * @param v The destination, valid once the context is synchronized.
+		 */
+		void download(Vector<T>& v) const {
+			if (v.size() != size())
+				v = Vector<T>(size());
+# ifdef MATRIX_CUDA
+			check_cuda(cudaMemcpyAsync(v.ptr(), dev, n * sizeof(T), cudaMemcpyDeviceToHost, ctx->cuda_stream()), "cudaMemcpyAsync");
+# else
+			v = host;
+# endif
+		}
+
+		/**
+		 * @brief Copies the vector to the host, waiting for the pending operations.
+		 * @return Vector<T> The host copy.
+		 */
+		Vector<T> to_host() const {
+			Vector<T> v(size());
+			download(v);
+			ctx->synchronize();
+			return v;
+		}
+
+		/**
+		 * @brief Adds another device vector, on the device.
+		 * @throw std::invalid_argument If the vectors are not of the same size or context.
+		 */
+		void add(const DeviceVector<T>& other) { axpy(T(1), other); }
+		void sub(const DeviceVector<T>& other) { axpy(T(-1), other); }
+
+		/**
+		 * @brief this += alpha * other, on the device.
+		 * @throw std::invalid_argument If the vectors are not of the same size or context.
+		 */
+		void axpy(const T& alpha, const DeviceVector<T>& other) {
+			check_context(other);
+			if (other.size() != size())
+				throw std::invalid_argument("Vectors must have the same size");
+# ifdef MATRIX_CUDA
+			check_cublas(cublas_traits<T>::axpy(ctx->cublas_handle(), int(n), &alpha, other.dev, 1, dev, 1), "cublas axpy");
+# else
+			Vector<T> scaled = other.host;
+			scaled.scl(alpha);
+			host.add(scaled);
+# endif
+		}
+
+		void scl(const T& scalar) {
+# ifdef MATRIX_CUDA
+			check_cublas(cublas_traits<T>::scal(ctx->cublas_handle(), int(n), &scalar, dev, 1), "cublas scal");
+# else
+			host.scl(scalar);
+# endif
+		}
+
+		# pragma region Utils
+
+		inline size_t size() const {
+# ifdef MATRIX_CUDA
+			return n;
+# else
+			return host.size();
+# endif
+		}
+		inline DeviceContext& context() const { return *ctx; }
+
+		# pragma endregion
+};
+
+/**
+ * @brief A column-major matrix resident on the device (see Device.hpp).
+ * @tparam T The type of the elements, f32 or double with MATRIX_CUDA.
+ */
+template<typename T>
+class DeviceMatrix {
+	protected:
+		DeviceContext* ctx = nullptr;
+# ifdef MATRIX_CUDA
+		static_assert(cublas_traits<T>::enabled, "The CUDA backend supports f32 and double elements.");
+
+		T*     dev = nullptr; // Packed : leading dimension n_rows
+		size_t n_rows = 0;
+		size_t n_cols = 0;
+# else
+		Matrix<T> host;
+# endif
+
+		void check_context(const DeviceContext* other) const {
+			if (ctx != other)
+				throw std::invalid_argument("Device operands must belong to the same context.");
+		}
+
+	public:
+		/**
+		 * @brief Allocates a zero matrix on the device, with the same cols-first order as Matrix<T>(cols, rows).
+		 * @param cols The number of columns.
+		 * @param rows The number of rows.
+		 * @param ctx The context the matrix and its operations belong to.
+		 */
+		explicit DeviceMatrix(size_t cols = 0, size_t rows = 0, DeviceContext& ctx = DeviceContext::local()) : ctx(&ctx)
+# ifdef MATRIX_CUDA
+			, dev(ctx.allocate<T>(cols * rows)), n_rows(rows), n_cols(cols) {
+			if (cols && rows)
+				check_cuda(cudaMemsetAsync(dev, 0, cols * rows * sizeof(T), ctx.cuda_stream()), "cudaMemsetAsync");
+		}
+# else
+			, host(cols, rows) {}
+# endif
+
+		/**
+		 * @brief Allocates a matrix on the device and enqueues the upload of m.
+		 * @param m The host matrix, which must stay alive and unmodified until the context is synchronized.
+		 */
+		explicit DeviceMatrix(const Matrix<T>& m, DeviceContext& ctx = DeviceContext::local()) : DeviceMatrix(m.cols(), m.rows(), ctx) { upload(m); }
+
+		DeviceMatrix(DeviceMatrix&& other) noexcept { *this = std::move(other); }
+		DeviceMatrix& operator=(DeviceMatrix&& other) noexcept {
+			std::swap(ctx, other.ctx);
+# ifdef MATRIX_CUDA
+			std::swap(dev, other.dev);
+			std::swap(n_rows, other.n_rows);
+			std::swap(n_cols, other.n_cols);
+# else
+			std::swap(host, other.host);
+# endif
+			return *this;
+		}
+		DeviceMatrix(const DeviceMatrix&) = delete;
+		DeviceMatrix& operator=(const DeviceMatrix&) = delete;
+
+		~DeviceMatrix() {
+# ifdef MATRIX_CUDA
+			if (ctx)
+				ctx->release(dev);
+# endif
+		}
+
+		/**
+		 * @brief Enqueues the copy of a host matrix of the same shape into this one.
+		 * @details One 2D copy, so host matrices with a padded leading dimension need no staging.
+		 * @throw std::invalid_argument If the shapes differ.
+		 */
+		void upload(const Matrix<T>& m) {
+			if (m.shape() != shape())
+				throw std::invalid_argument("Matrices must have the same shape.");
+# ifdef MATRIX_CUDA
+			if (!m.ptr())
+				return;
+			check_cuda(cudaMemcpy2DAsync(dev, n_rows * sizeof(T), m.ptr(), m.ld() * sizeof(T), n_rows * sizeof(T), n_cols,
+			                             cudaMemcpyHostToDevice, ctx->cuda_stream()), "cudaMemcpy2DAsync");
+# else
+			host = m;
+# endif
+		}
+
+		/**
+		 * @brief Enqueues the copy of this matrix into a host matrix, reshaped if needed.
+		 * @param m The destination, valid once the context is synchronized.
+		 */
+		void download(Matrix<T>& m) const {
+			if (m.shape() != shape())
+				m = Matrix<T>(cols(), rows());
+# ifdef MATRIX_CUDA
+			if (!m.ptr())
+				return;
+			check_cuda(cudaMemcpy2DAsync(m.ptr(), m.ld() * sizeof(T), dev, n_rows * sizeof(T), n_rows * sizeof(T), n_cols,
+			                             cudaMemcpyDeviceToHost, ctx->cuda_stream()), "cudaMemcpy2DAsync");
+# else
+			m = host;
+# endif
+		}
+
+		/**
+		 * @brief Copies the matrix to the host, waiting for the pending operations.
+		 * @return Matrix<T> The host copy.
+		 */
+		Matrix<T> to_host() const {
+			Matrix<T> m(cols(), rows());
+			download(m);
+			ctx->synchronize();
+			return m;
+		}
+
+		/**
+		 * @brief Adds another device matrix, on the device.
+		 * @throw std::invalid_argument If the matrices are not of the same shape or context.
+		 */
+		void add(const DeviceMatrix<T>& other) { axpy(T(1), other); }
+		void sub(const DeviceMatrix<T>& other) { axpy(T(-1), other); }
+
+		/**
+		 * @brief this += alpha * other, on the device.
+		 * @throw std::invalid_argument If the matrices are not of the same shape or context.
+		 */
+		void axpy(const T& alpha, const DeviceMatrix<T>& other) {
+			check_context(other.ctx);
+			if (other.shape() != shape())
+				throw std::invalid_argument("Matrices must have the same shape.");
+# ifdef MATRIX_CUDA
+			check_cublas(cublas_traits<T>::axpy(ctx->cublas_handle(), int(n_rows * n_cols), &alpha, other.dev, 1, dev, 1), "cublas axpy");
+# else
+			Matrix<T> scaled = other.host;
+			scaled.scl(alpha);
+			host.add(scaled);
+# endif
+		}
+
+		void scl(const T& scalar) {
+# ifdef MATRIX_CUDA
+			check_cublas(cublas_traits<T>::scal(ctx->cublas_handle(), int(n_rows * n_cols), &scalar, dev, 1), "cublas scal");
+# else
+			host.scl(scalar);
+# endif
+		}
+
+		/**
+		 * @brief Multiplies the matrix by a device vector, with the Matrix<T>::mul_vec convention (one gemv on A^T).
+		 * @return DeviceVector<T> The result, of cols() elements, on the same context.
+		 * @throw std::invalid_argument If the matrix rows do not match the vector size, or the contexts differ.
+		 */
+		DeviceVector<T> mul_vec(const DeviceVector<T>& v) const {
+			check_context(v.ctx);
+			if (rows() != v.size())
+				throw std::invalid_argument("Matrix rows must match vector size");
+
+			DeviceVector<T> result(cols(), *ctx);
+# ifdef MATRIX_CUDA
+			const T one = T(1), zero = T(0);
+			if (n_rows && n_cols)
+				check_cublas(cublas_traits<T>::gemv(ctx->cublas_handle(), CUBLAS_OP_T, int(n_rows), int(n_cols), &one, dev, int(n_rows),
+				                                    v.dev, 1, &zero, result.dev, 1), "cublas gemv");
+# else
+			result.host = host.mul_vec(v.host);
+# endif
+			return result;
+		}
+
+		/**
+		 * @brief Computes A * B into result, on the device, reusing its storage when it has the right shape.
+		 * @param b The right operand.
+		 * @param result The destination, reshaped to rows() x b.cols() if needed. Must not be an operand.
+		 * @throw std::invalid_argument If the matrix columns do not match B rows, or the contexts differ.
+		 */
+		void mul_mat(const DeviceMatrix<T>& b, DeviceMatrix<T>& result) const {
+			check_context(b.ctx);
+			check_context(result.ctx);
+			if (cols() != b.rows())
+				throw std::invalid_argument("Matrix A columns must match Matrix B rows");
+			if (&result == this || &result == &b)
+				throw std::invalid_argument("The product cannot be written over an operand.");
+			if (result.shape() != std::make_pair(rows(), b.cols()))
+				result = DeviceMatrix<T>(b.cols(), rows(), *ctx);
+# ifdef MATRIX_CUDA
+			const T one = T(1), zero = T(0);
+			if (n_rows && b.n_cols)
+				check_cublas(cublas_traits<T>::gemm(ctx->cublas_handle(), CUBLAS_OP_N, CUBLAS_OP_N, int(n_rows), int(b.n_cols), int(n_cols),
+				                                    &one, dev, int(std::max<size_t>(n_rows, 1)), b.dev, int(std::max<size_t>(b.n_rows, 1)),
+				                                    &zero, result.dev, int(n_rows)), "cublas gemm");
+# else
+			result.host = host.mul_mat(b.host);
+# endif
+		}
+
+		/**
+		 * @brief Computes A * B, on the device.
+		 * @return DeviceMatrix<T> The product, on the same context.
+		 * @throw std::invalid_argument If the matrix columns do not match B rows, or the contexts differ.
+		 */
+		DeviceMatrix<T> mul_mat(const DeviceMatrix<T>& b) const {
+			DeviceMatrix<T> result(b.cols(), rows(), *ctx);
+			mul_mat(b, result);
+			return result;
+		}
+
+		/**
+		 * @brief Transposes the matrix, on the device (one geam).
+		 * @return DeviceMatrix<T> The transpose, on the same context.
+		 */
+		DeviceMatrix<T> transpose() const {
+			DeviceMatrix<T> result(rows(), cols(), *ctx);
+# ifdef MATRIX_CUDA
+			const T one = T(1), zero = T(0);
+			if (n_rows && n_cols)
+				check_cublas(cublas_traits<T>::geam(ctx->cublas_handle(), CUBLAS_OP_T, CUBLAS_OP_N, int(n_cols), int(n_rows),
+				                                    &one, dev, int(n_rows), &zero, result.dev, int(n_cols), result.dev, int(n_cols)), "cublas geam");
+# else
+			result.host = host.transpose();
+# endif
+			return result;
+		}
+
+		# pragma region Utils
+
+		inline size_t rows() const {
+# ifdef MATRIX_CUDA
+			return n_rows;
+# else
+			return host.rows();
+# endif
+		}
+		inline size_t cols() const {
+# ifdef MATRIX_CUDA
+			return n_cols;
+# else
+			return host.cols();
+# endif
+		}
+		inline std::pair<size_t, size_t> shape() const { return { rows(), cols() }; }
+		inline DeviceContext& context() const { return *ctx; }
+
+		# pragma endregion
+};
+
+/**
+ * @brief Multiplies one matrix by every vector of a device-resident batch : out[i] = m.mul_vec(in[i]).
+ * @details Same layout as transform() on SoAView : component k of vector i is element (i, k) of in, so the whole
+ *          batch is one GEMM, out = in * m, and consecutive batches stay on the device.
+ * @param m The matrix, applied to every vector.
+ * @param in The input batch, in.rows() vectors of m.rows() components.
+ * @param out The output batch, reshaped to in.rows() vectors of m.cols() components if needed.
+ * @throw std::invalid_argument If the shapes do not match, or the contexts differ.
+ * @note Time complexity : O(n * m.rows() * m.cols()) with n the batch size
+ * @note Space complexity : O(1) when out has the right shape
+ */
+template<typename T>
+void transform(const DeviceMatrix<T>& m, const DeviceMatrix<T>& in, DeviceMatrix<T>& out) {
+	if (in.cols() != m.rows())
+		throw std::invalid_argument("Input vectors size must match the matrix rows.");
+	in.mul_mat(m, out);
+}
@@ -0,0 +1,750 @@
+#pragma once
+
+# include <climits>
+# include <cstdint>
+# include <cstdlib>
+# include <cstring>
+# include "Vector.hpp"
+# include "Matrix.hpp"
+# include "gemm.hpp"
+
+# ifdef MATRIX_MPI
+#  define OMPI_SKIP_MPICXX 1 // The C API only : the deprecated C++ bindings do not build warning-free
+#  define MPICH_SKIP_MPICXX 1
+#  include <mpi.h>
+# endif
+
+/**
+ * Matrices distributed over the ranks of an MPI job, for the sizes that do not fit in the memory of one node.
+ *
+ * Built with MATRIX_MPI (make MPI=1, which compiles with mpicxx), a ProcessGrid arranges the ranks of a communicator
+ * as a Pr x Pc grid and a DistributedMatrix<T> stores its elements 2D block-cyclic over it, as ScaLAPACK does :
+ * nb x nb block (I, J) lives on the rank at grid position (I mod Pr, J mod Pc), which keeps the work balanced as
+ * the factorizations shrink. Each rank holds its blocks in one local column-major Matrix<T>, multiplied with the
+ * same cache-blocked gemm as Matrix<T>::mul_mat, spread over the node's ThreadPool.
+ *
+ * Without MATRIX_MPI, the grid is a single 1 x 1 rank : the same code builds and runs everywhere, on the local node.
+ *
+ * Every operation is collective : all the ranks of the grid call it, in the same order, with the same shapes.
+ * Operations follow the Matrix<T> conventions (mul_mat(B) = A * B, solve(b) returns x such that A.mul_vec(x) == b).
+ */
+
+# pragma region Utils
+
+# ifdef MATRIX_MPI
+
+inline void check_mpi(int status, const char* what) {
+	if (status != MPI_SUCCESS) {
+		char message[MPI_MAX_ERROR_STRING];
+		int  length = 0;
+		MPI_Error_string(status, message, &length);
+		throw std::runtime_error(std::string(what) + ": " + std::string(message, size_t(length)));
+	}
+}
+
+# endif
+
+// Number of the n global indices, cut in blocks of nb dealt round-robin over count processes, that process p owns
+inline size_t block_cyclic_count(size_t n, size_t nb, size_t p, size_t count) {
+	const size_t blocks = n / nb, extra = n % nb;
+	size_t       result = (blocks / count) * nb;
+
+	if (p < blocks % count)
+		result += nb;
+	else if (p == blocks % count)
+		result += extra;
+	return result;
+}
+
+# pragma endregion
+
+/**
+ * @brief A 2D grid of the ranks of a communicator, with the row and column communicators the collectives run on.
+ * @details Rank r sits at grid row r / Pc and grid column r % Pc. Messages carry raw bytes, split in chunks below
+ *          INT_MAX for the MPI counts, so any trivially copyable element type travels as is.
+ */
+class ProcessGrid {
+	public:
+		// Ranks a collective runs over : every rank, the ranks of the caller's grid row, or of its grid column
+		enum class Scope { World, Row, Column };
+
+	protected:
+		size_t n_rows = 1, n_cols = 1, my_row = 0, my_col = 0;
+
+# ifdef MATRIX_MPI
+		MPI_Comm world = MPI_COMM_NULL, row_comm = MPI_COMM_NULL, col_comm = MPI_COMM_NULL;
+
+		MPI_Comm comm(Scope scope) const {
+			return (scope == Scope::World) ? world : (scope == Scope::Row) ? row_comm : col_comm;
+		}
+
+		static constexpr size_t CHUNK = size_t(1) << 30; // Bytes per MPI call, below INT_MAX
+# endif
+
+	public:
+		/**
+		 * @brief Arranges the ranks of MPI_COMM_WORLD, initializing MPI first if the program did not.
+		 * @param rows The number of grid rows Pr, which must divide the number of ranks, 0 for the most square grid.
+		 * @throw std::invalid_argument If rows does not divide the number of ranks.
+		 * @throw std::runtime_error If an MPI call fails.
+		 */
+		explicit ProcessGrid(size_t rows = 0) {
+# ifdef MATRIX_MPI
+			int initialized = 0;
+			check_mpi(MPI_Initialized(&initialized), "MPI_Initialized");
+			if (!initialized) {
+				check_mpi(MPI_Init(nullptr, nullptr), "MPI_Init");
+				std::atexit([] {
+					int finalized = 0;
+					MPI_Finalized(&finalized);
+					if (!finalized)
+						MPI_Finalize();
+				});
+			}
+
+			int rank = 0, size = 1;
+			check_mpi(MPI_Comm_dup(MPI_COMM_WORLD, &world), "MPI_Comm_dup");
+			check_mpi(MPI_Comm_rank(world, &rank), "MPI_Comm_rank");
+			check_mpi(MPI_Comm_size(world, &size), "MPI_Comm_size");
+
+			if (!rows) { // Largest divisor of the size up to its square root
+				for (rows = 1; (rows + 1) * (rows + 1) <= size_t(size); rows++) {}
+				while (size_t(size) % rows)
+					rows--;
+			} else if (size_t(size) % rows) {
+				MPI_Comm_free(&world);
+				throw std::invalid_argument("Grid rows must divide the number of ranks.");
+			}
+
+			n_rows = rows;
+			n_cols = size_t(size) / rows;
+			my_row = size_t(rank) / n_cols;
+			my_col = size_t(rank) % n_cols;
+			check_mpi(MPI_Comm_split(world, int(my_row), int(my_col), &row_comm), "MPI_Comm_split");
+			check_mpi(MPI_Comm_split(world, int(my_col), int(my_row), &col_comm), "MPI_Comm_split");
+# else
+			if (rows > 1)
+				throw std::invalid_argument("Grid rows must divide the number of ranks.");
+# endif
+		}
+
+		~ProcessGrid() {
+# ifdef MATRIX_MPI
+			int finalized = 0;
+			MPI_Finalized(&finalized);
+			if (!finalized) {
+				MPI_Comm_free(&row_comm);
+				MPI_Comm_free(&col_comm);
+				MPI_Comm_free(&world);
+			}
+# endif
+		}
+
+		ProcessGrid(const ProcessGrid&) = delete;
+		ProcessGrid& operator=(const ProcessGrid&) = delete;
+
+		/**
+		 * @brief Returns the grid of every rank, created on first use.
+		 * @return const ProcessGrid& The most square grid over MPI_COMM_WORLD.
+		 */
+		static const ProcessGrid& world_grid() {
+			static const ProcessGrid grid;
+			return grid;
+		}
+
+		/**
+		 * @brief Checks whether the ranks are MPI processes, or the single local fallback.
+		 * @return true If built with MATRIX_MPI.
+		 */
+		static constexpr bool distributed() {
+# ifdef MATRIX_MPI
+			return true;
+# else
+			return false;
+# endif
+		}
+
+		inline size_t rows() const { return n_rows; }
+		inline size_t cols() const { return n_cols; }
+		inline size_t row() const { return my_row; }
+		inline size_t col() const { return my_col; }
+		inline size_t size() const { return n_rows * n_cols; }
+		inline size_t rank() const { return my_row * n_cols + my_col; }
+		inline size_t rank_of(size_t row, size_t col) const { return row * n_cols + col; }
+
+		# pragma region Collectives
+
+		/**
+		 * @brief Broadcasts bytes from root (a rank of the scope : a grid column for Row, a grid row for Column).
+		 */
+		void bcast([[maybe_unused]] void* data, [[maybe_unused]] size_t bytes, [[maybe_unused]] size_t root, [[maybe_unused]] Scope scope) const {
+# ifdef MATRIX_MPI
+			for (size_t done = 0; done < bytes; done += CHUNK)
+				check_mpi(MPI_Bcast(static_cast<char*>(data) + done, int(std::min(CHUNK, bytes - done)), MPI_BYTE, int(root), comm(scope)), "MPI_Bcast");
+# endif
+		}
+
+		/**
+		 * @brief Gathers bytes from every rank of the scope into out, in rank order (count * bytes).
+		 */
+		void allgather(const void* data, size_t bytes, void* out, [[maybe_unused]] Scope scope) const {
+# ifdef MATRIX_MPI
+			if (bytes > CHUNK)
+				throw std::invalid_argument("Gathered blocks must be below 1 GiB per rank.");
+			check_mpi(MPI_Allgather(data, int(bytes), MPI_BYTE, out, int(bytes), MPI_BYTE, comm(scope)), "MPI_Allgather");
+# else
+			std::memcpy(out, data, bytes);
+# endif
+		}
+
+		/**
+		 * @brief Exchanges bytes with peer, a rank of the scope.
+		 */
+		void exchange([[maybe_unused]] void* data, [[maybe_unused]] size_t bytes, [[maybe_unused]] size_t peer, [[maybe_unused]] Scope scope) const {
+# ifdef MATRIX_MPI
+			for (size_t done = 0; done < bytes; done += CHUNK)
+				check_mpi(MPI_Sendrecv_replace(static_cast<char*>(data) + done, int(std::min(CHUNK, bytes - done)), MPI_BYTE,
+				                               int(peer), 0, int(peer), 0, comm(scope), MPI_STATUS_IGNORE), "MPI_Sendrecv_replace");
+# endif
+		}
+
+		// Point to point over the world communicator, for scatter / gather
+		void send([[maybe_unused]] const void* data, [[maybe_unused]] size_t bytes, [[maybe_unused]] size_t to) const {
+# ifdef MATRIX_MPI
+			for (size_t done = 0; done < bytes; done += CHUNK)
+				check_mpi(MPI_Send(static_cast<const char*>(data) + done, int(std::min(CHUNK, bytes - done)), MPI_BYTE, int(to), 1, world), "MPI_Send");
+# endif
+		}
+
+		void recv([[maybe_unused]] void* data, [[maybe_unused]] size_t bytes, [[maybe_unused]] size_t from) const {
+# ifdef MATRIX_MPI
+			for (size_t done = 0; done < bytes; done += CHUNK)
+				check_mpi(MPI_Recv(static_cast<char*>(data) + done, int(std::min(CHUNK, bytes - done)), MPI_BYTE, int(from), 1, world, MPI_STATUS_IGNORE), "MPI_Recv");
+# endif
+		}
+
+		# pragma endregion
+};
+
+/**
+ * @brief Local multiply-accumulate C += A * B of column-major buffers, with the Matrix<T>::mul_mat kernels.
+ * @note Time complexity : O(m*n*k)
+ */
+template<typename T>
+void local_gemm(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc) {
+	if (!m || !n || !k)
+		return;
+
+	parallel_for(0, n, 2 * m * k, [&](size_t lo, size_t hi) {
+		if constexpr (gemm_traits<T>::enabled)
+			gemm(m, hi - lo, k, a, lda, b + lo * ldb, ldb, c + lo * ldc, ldc);
+		else
+			for (size_t j = lo; j < hi; j++)
+				for (size_t p = 0; p < k; p++) {
+					const T  bpj = b[j * ldb + p];
+					const T* ap  = a + p * lda;
+					T*       cj  = c + j * ldc;
+					for (size_t i = 0; i < m; i++)
+						cj[i] += ap[i] * bpj;
+				}
+	});
+}
+
+template<typename T> class DistributedLU;
+
+/**
+ * @brief Represents a matrix distributed 2D block-cyclic over a ProcessGrid.
+ * @details Global element (r, c) is in block (r / nb, c / nb), on grid position ((r / nb) mod Pr, (c / nb) mod Pc),
+ *          at local row ((r / nb) / Pr) * nb + r % nb and local column ((c / nb) / Pc) * nb + c % nb.
+ * @tparam T The type of the elements, trivially copyable.
+ */
+template<typename T>
+class DistributedMatrix {
+	protected:
+		const ProcessGrid* g;
+		size_t             n_rows, n_cols, nb;
+		Matrix<T>          loc; // This rank's blocks, column-major
+
+		friend class DistributedLU<T>;
+
+		using Scope = ProcessGrid::Scope;
+
+		void check_compatible(const DistributedMatrix& other) const {
+			if (g != other.g || nb != other.nb)
+				throw std::invalid_argument("Distributed matrices must share their grid and block size.");
+		}
+
+		inline T& at_local(size_t lr, size_t lc) { return loc.col_ptr(lc)[lr]; }
+		inline const T& at_local(size_t lr, size_t lc) const { return loc.col_ptr(lc)[lr]; }
+
+	public:
+		/**
+		 * @brief Creates a zero matrix. Collective.
+		 * @param rows, cols The global shape.
+		 * @param grid The ranks to distribute over, all of them by default. Must outlive the matrix.
+		 * @param block The block size nb.
+		 * @throw std::invalid_argument If the block size is 0.
+		 * @note Space complexity : O(rows * cols / P) per rank
+		 */
+		DistributedMatrix(size_t rows, size_t cols, const ProcessGrid& grid = ProcessGrid::world_grid(), size_t block = 64)
+			: g(&grid), n_rows(rows), n_cols(cols), nb(block) {
+			if (!nb)
+				throw std::invalid_argument("Block size must be positive.");
+			loc = Matrix<T>(block_cyclic_count(cols, nb, grid.col(), grid.cols()), block_cyclic_count(rows, nb, grid.row(), grid.rows()));
+		}
+
+		# pragma region Utils
+
+		inline size_t rows() const { return n_rows; }
+		inline size_t cols() const { return n_cols; }
+		inline size_t block_size() const { return nb; }
+		inline const ProcessGrid& grid() const { return *g; }
+		inline bool is_square() const { return n_rows == n_cols; }
+
+		/**
+		 * @brief Returns this rank's blocks, local_rows() x local_cols().
+		 */
+		inline Matrix<T>& local() { return loc; }
+		inline const Matrix<T>& local() const { return loc; }
+		inline size_t local_rows() const { return loc.rows(); }
+		inline size_t local_cols() const { return loc.cols(); }
+
+		// Grid row / column owning a global row / column, and its local index there
+		inline size_t row_owner(size_t r) const { return (r / nb) % g->rows(); }
+		inline size_t col_owner(size_t c) const { return (c / nb) % g->cols(); }
+		inline size_t local_row(size_t r) const { return (r / nb) / g->rows() * nb + r % nb; }
+		inline size_t local_col(size_t c) const { return (c / nb) / g->cols() * nb + c % nb; }
+		inline size_t global_row(size_t lr) const { return ((lr / nb) * g->rows() + g->row()) * nb + lr % nb; }
+		inline size_t global_col(size_t lc) const { return ((lc / nb) * g->cols() + g->col()) * nb + lc % nb; }
+
+		// Number of this rank's rows / columns of global index below r / c : its local rows from local_rows_below(r) are the rows >= r
+		inline size_t local_rows_below(size_t r) const { return block_cyclic_count(r, nb, g->row(), g->rows()); }
+		inline size_t local_cols_below(size_t c) const { return block_cyclic_count(c, nb, g->col(), g->cols()); }
+
+		# pragma endregion
+
+		# pragma region Scatter / gather
+
+		/**
+		 * @brief Distributes a matrix held by one rank. Collective.
+		 * @param m The matrix, only read on root (the other ranks pass any, e.g. an empty one).
+		 * @param root The rank holding m.
+		 * @param grid The ranks to distribute over.
+		 * @param block The block size nb.
+		 * @return DistributedMatrix<T> The distributed copy, on every rank.
+		 * @note Time complexity : O(rows * cols) on root, O(rows * cols / P) elsewhere
+		 */
+		static DistributedMatrix scatter(const Matrix<T>& m, size_t root = 0, const ProcessGrid& grid = ProcessGrid::world_grid(), size_t block = 64) {
+			uint64_t shape[2] = { m.rows(), m.cols() };
+			grid.bcast(shape, sizeof(shape), root, Scope::World);
+
+			DistributedMatrix result(static_cast<size_t>(shape[0]), static_cast<size_t>(shape[1]), grid, block);
+			if (grid.rank() != root) {
+				grid.recv(result.loc.ptr(), result.loc.ld() * result.loc.cols() * sizeof(T), root);
+				return result;
+			}
+
+			for (size_t q = 0; q < grid.size(); q++) { // Packs the blocks of rank q, as its local matrix
+				const size_t pr = q / grid.cols(), pc = q % grid.cols();
+				const size_t lrows = block_cyclic_count(result.n_rows, block, pr, grid.rows());
+				const size_t lcols = block_cyclic_count(result.n_cols, block, pc, grid.cols());
+				Matrix<T>    packed = (q == root) ? Matrix<T>() : Matrix<T>(lcols, lrows);
+				Matrix<T>&   dst = (q == root) ? result.loc : packed;
+
+				for (size_t lc = 0; lc < lcols; lc++) {
+					const T* src = m.col_ptr(((lc / block) * grid.cols() + pc) * block + lc % block);
+					T*       out = dst.col_ptr(lc);
+					for (size_t lr = 0; lr < lrows; lr++)
+						out[lr] = src[((lr / block) * grid.rows() + pr) * block + lr % block];
+				}
+				if (q != root)
+					grid.send(packed.ptr(), packed.ld() * packed.cols() * sizeof(T), q);
+			}
+			return result;
+		}
+
+		/**
+		 * @brief Assembles the whole matrix on one rank. Collective.
+		 * @param root The rank receiving the matrix.
+		 * @return Matrix<T> The matrix on root, an empty matrix on the other ranks.
+		 * @note Time complexity : O(rows * cols) on root
+		 * @note Space complexity : O(rows * cols) on root
+		 */
+		Matrix<T> gather(size_t root = 0) const {
+			if (g->rank() != root) {
+				g->send(loc.ptr(), loc.ld() * loc.cols() * sizeof(T), root);
+				return Matrix<T>();
+			}
+
+			Matrix<T> result(n_cols, n_rows);
+			for (size_t q = 0; q < g->size(); q++) {
+				const size_t pr = q / g->cols(), pc = q % g->cols();
+				const size_t lrows = block_cyclic_count(n_rows, nb, pr, g->rows());
+				const size_t lcols = block_cyclic_count(n_cols, nb, pc, g->cols());
+				Matrix<T>    packed = (q == root) ? Matrix<T>() : Matrix<T>(lcols, lrows);
+				if (q != root)
+					g->recv(packed.ptr(), packed.ld() * packed.cols() * sizeof(T), q);
+				const Matrix<T>& src = (q == root) ? loc : packed;
+
+				for (size_t lc = 0; lc < lcols; lc++) {
+					const T* in  = src.col_ptr(lc);
+					T*       out = result.col_ptr(((lc / nb) * g->cols() + pc) * nb + lc % nb);
+					for (size_t lr = 0; lr < lrows; lr++)
+						out[((lr / nb) * g->rows() + pr) * nb + lr % nb] = in[lr];
+				}
+			}
+			return result;
+		}
+
+		# pragma endregion
+
+		/**
+		 * @brief Computes the matrix product A * B with SUMMA. Collective.
+		 * @details For every block column k of A and block row k of B, the grid column owning the A panel broadcasts it along
+		 *          the grid rows, the grid row owning the B panel along the grid columns, then every rank accumulates the
+		 *          product of its parts of the panels into its C blocks with the local gemm. Each rank sends and receives
+		 *          O(n^2 / sqrt(P)) elements, and the flops are split evenly, with P ranks in a square grid.
+		 * @param other The right operand B, on the same grid with the same block size.
+		 * @return DistributedMatrix<T> The product, distributed like the operands.
+		 * @throw std::invalid_argument If the number of columns of A does not match the rows of B, or the distributions differ.
+		 * @note Time complexity : O(m*n*k / P) per rank
+		 * @note Space complexity : O(nb * (m + n) / sqrt(P)) per rank, for the panels
+		 *
+		 * @see https://www.netlib.org/lapack/lawnspdf/lawn96.pdf
+		 */
+		DistributedMatrix mul_mat(const DistributedMatrix& other) const {
+			check_compatible(other);
+			if (n_cols != other.n_rows)
+				throw std::invalid_argument("Matrix A columns must match matrix B rows.");
+
+			PROFILE_OP("DistributedMatrix::mul_mat", n_rows, n_cols, FLOPS_FMA<T> * double(n_rows) * n_cols * other.n_cols / double(g->size()), 0);
+
+			DistributedMatrix result(n_rows, other.n_cols, *g, nb);
+			const size_t      m = local_rows(), n = other.local_cols();
+			std::vector<T>    a_panel(m * nb), b_panel(nb * n);
+
+			for (size_t k0 = 0; k0 < n_cols; k0 += nb) {
+				const size_t w = std::min(nb, n_cols - k0);
+				const size_t pc = col_owner(k0), pr = other.row_owner(k0);
+
+				if (g->col() == pc)
+					for (size_t j = 0; j < w; j++)
+						std::copy_n(loc.col_ptr(local_col(k0) + j), m, a_panel.data() + j * m);
+				if (g->row() == pr) {
+					const size_t lr = other.local_row(k0);
+					for (size_t j = 0; j < n; j++)
+						std::copy_n(other.loc.col_ptr(j) + lr, w, b_panel.data() + j * w);
+				}
+				g->bcast(a_panel.data(), m * w * sizeof(T), pc, Scope::Row);
+				g->bcast(b_panel.data(), w * n * sizeof(T), pr, Scope::Column);
+
+				local_gemm(m, n, w, a_panel.data(), m, b_panel.data(), w, result.loc.ptr(), result.loc.ld());
+			}
+			return result;
+		}
+
+		/**
+		 * @brief Factorizes the matrix with the distributed LU. Collective.
+		 * @return DistributedLU<T> The factors, to solve several systems or take the determinant.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 */
+		DistributedLU<T> lu() const { return DistributedLU<T>(*this); }
+
+		/**
+		 * @brief Computes the determinant through the distributed LU. Collective.
+		 * @return T The determinant, on every rank.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @note Time complexity : O(n^3 / P) per rank
+		 */
+		T determinant() const { return lu().det(); }
+
+		/**
+		 * @brief Solves the system A.mul_vec(x) == b through the distributed LU. Collective.
+		 * @param b The right-hand side, the same on every rank.
+		 * @return Vector<T> The solution, on every rank.
+		 * @throw std::invalid_argument If the matrix is not square or b does not match its size.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n^3 / P) per rank
+		 */
+		Vector<T> solve(const Vector<T>& b) const { return lu().solve(b); }
+};
+
+/**
+ * @brief LU factorization with partial pivoting (P * A = L * U) of a distributed square matrix.
+ * @details Right-looking and blocked by the distribution block : the grid column owning a block column factorizes
+ *          it (pivot searches reduced over the grid column, row swaps applied to the whole matrix), broadcasts it
+ *          along the grid rows, the grid row owning the block row computes that part of U and broadcasts it along
+ *          the grid columns, and every rank updates its trailing blocks with one local gemm.
+ *          The factors stay distributed; the permutation and the solutions are replicated on every rank.
+ * @tparam T The type of the elements in the matrix.
+ */
+template<typename T>
+class DistributedLU {
+	protected:
+		using Scope = ProcessGrid::Scope;
+		using R     = TO_REAL<T>;
+
+		DistributedMatrix<T> lu;
+		std::vector<size_t>  perm;   // Row i of P * A is row perm[i] of A
+		bool                 odd_swaps = false;
+		bool                 singular = false;
+
+		// Swaps global rows r and s over every local column
+		void swap_rows(size_t r, size_t s) {
+			const ProcessGrid& g = lu.grid();
+			const size_t       owner_r = lu.row_owner(r), owner_s = lu.row_owner(s), cols = lu.local_cols();
+
+			if (owner_r == owner_s) {
+				if (g.row() == owner_r) {
+					const size_t lr = lu.local_row(r), ls = lu.local_row(s);
+					for (size_t lc = 0; lc < cols; lc++)
+						std::swap(lu.at_local(lr, lc), lu.at_local(ls, lc));
+				}
+				return;
+			}
+			if (g.row() != owner_r && g.row() != owner_s)
+				return;
+
+			const size_t   mine = (g.row() == owner_r) ? r : s, peer = (g.row() == owner_r) ? owner_s : owner_r;
+			const size_t   lr = lu.local_row(mine);
+			std::vector<T> row(cols);
+			for (size_t lc = 0; lc < cols; lc++)
+				row[lc] = lu.at_local(lr, lc);
+			g.exchange(row.data(), cols * sizeof(T), peer, Scope::Column);
+			for (size_t lc = 0; lc < cols; lc++)
+				lu.at_local(lr, lc) = row[lc];
+		}
+
+		// Sum over the grid column of w values per rank
+		std::vector<T> column_sum(const std::vector<T>& part) const {
+			const ProcessGrid& g = lu.grid();
+			std::vector<T>     all(part.size() * g.rows()), sum(part.size(), T(0));
+
+			g.allgather(part.data(), part.size() * sizeof(T), all.data(), Scope::Column);
+			for (size_t q = 0; q < g.rows(); q++)
+				for (size_t i = 0; i < part.size(); i++)
+					sum[i] += all[q * part.size() + i];
+			return sum;
+		}
+
+		void factor() {
+			const ProcessGrid& g = lu.grid();
+			const size_t       n = lu.rows(), nb = lu.block_size(), rows = lu.local_rows(), cols = lu.local_cols();
+			std::vector<size_t> pivots(n);
+
+			for (size_t k0 = 0; k0 < n; k0 += nb) {
+				const size_t w = std::min(nb, n - k0), end = k0 + w;
+				const size_t pc = lu.col_owner(k0), pr = lu.row_owner(k0);
+				const bool   in_panel = g.col() == pc;
+
+				// Panel : columns [k0, end), one column at a time
+				for (size_t j = k0; j < end; j++) {
+					struct Candidate { double magnitude; uint64_t row; } best = { -1, 0 };
+					const size_t lc = in_panel ? lu.local_col(j) : 0;
+
+					if (in_panel) {
+						for (size_t lr = lu.local_rows_below(j); lr < rows; lr++) {
+							const double mag = double(magnitude(lu.at_local(lr, lc)));
+							if (mag > best.magnitude)
+								best = { mag, lu.global_row(lr) };
+						}
+						std::vector<Candidate> all(g.rows());
+						g.allgather(&best, sizeof(best), all.data(), Scope::Column);
+						for (const Candidate& c : all) // Ties go to the lowest row, the same on every rank
+							if (c.magnitude > best.magnitude || (c.magnitude == best.magnitude && c.row < best.row))
+								best = c;
+					}
+					g.bcast(&best, sizeof(best), pc, Scope::Row);
+
+					pivots[j] = j;
+					if (!(best.magnitude > 0)) { // Zero column : nothing to eliminate
+						singular = true;
+						continue;
+					}
+					pivots[j] = size_t(best.row);
+					if (pivots[j] != j) {
+						swap_rows(j, pivots[j]);
+						odd_swaps = !odd_swaps;
+					}
+
+					if (!in_panel)
+						continue;
+
+					// Pivot row within the panel, to the grid column, then rank-1 update of the panel below it
+					std::vector<T> pivot_row(end - j);
+					if (g.row() == lu.row_owner(j))
+						for (size_t t = 0; t < end - j; t++)
+							pivot_row[t] = lu.at_local(lu.local_row(j), lc + t);
+					g.bcast(pivot_row.data(), pivot_row.size() * sizeof(T), lu.row_owner(j), Scope::Column);
+
+					const T pivot = pivot_row[0];
+					for (size_t lr = lu.local_rows_below(j + 1); lr < rows; lr++) {
+						const T l = lu.at_local(lr, lc) / pivot;
+						lu.at_local(lr, lc) = l;
+						for (size_t t = 1; t < end - j; t++)
+							lu.at_local(lr, lc + t) -= l * pivot_row[t];
+					}
+				}
+
+				// L panel rows >= k0, along the grid rows
+				const size_t   first = lu.local_rows_below(k0), m = rows - first;
+				std::vector<T> l_panel(m * w);
+				if (in_panel)
+					for (size_t t = 0; t < w; t++)
+						std::copy_n(lu.loc.col_ptr(lu.local_col(k0) + t) + first, m, l_panel.data() + t * m);
+				g.bcast(l_panel.data(), l_panel.size() * sizeof(T), pc, Scope::Row);
+
+				// U12 = L11^-1 A12 on the block row, along the grid columns
+				const size_t   right = lu.local_cols_below(end), n2 = cols - right;
+				std::vector<T> u_panel(w * n2);
+				if (g.row() == pr) {
+					const size_t lr = lu.local_row(k0); // == first : the rows >= k0 start with the block row
+					for (size_t lc = right; lc < cols; lc++) {
+						T* a = lu.loc.col_ptr(lc) + lr;
+						for (size_t i = 0; i < w; i++)
+							for (size_t t = i + 1; t < w; t++)
+								a[t] -= l_panel[i * m + t] * a[i];
+						std::copy_n(a, w, u_panel.data() + (lc - right) * w);
+					}
+				}
+				g.bcast(u_panel.data(), u_panel.size() * sizeof(T), pr, Scope::Column);
+
+				// A22 -= L21 * U12
+				const size_t below = lu.local_rows_below(end);
+				for (T& v : u_panel)
+					v = -v;
+				local_gemm(rows - below, n2, w, l_panel.data() + (below - first), m, u_panel.data(), w, lu.loc.col_ptr(right) + below, lu.loc.ld());
+			}
+
+			perm.resize(n);
+			for (size_t i = 0; i < n; i++)
+				perm[i] = i;
+			for (size_t j = 0; j < n; j++)
+				std::swap(perm[j], perm[pivots[j]]);
+		}
+
+		/**
+		 * @brief Solves with the transposed factor of one triangle, in place on a replicated vector.
+		 * @details Upper : U^T y = x, forward. Lower : L^T z = x, backward, unit diagonal. Block by block, the grid column
+		 *          owning the block column sums its contributions of the known part of x, then the rank owning the
+		 *          diagonal block finishes the block and broadcasts it.
+		 * @note Time complexity : O(n^2 / Pr) per rank
+		 */
+		void solve_transposed(bool upper, std::vector<T>& x) const {
+			const ProcessGrid& g = lu.grid();
+			const size_t       n = lu.rows(), nb = lu.block_size(), rows = lu.local_rows();
+			const size_t       blocks = (n + nb - 1) / nb;
+
+			for (size_t step = 0; step < blocks; step++) {
+				const size_t kb = upper ? step : blocks - 1 - step;
+				const size_t k0 = kb * nb, w = std::min(nb, n - k0);
+				const size_t pc = lu.col_owner(k0), pr = lu.row_owner(k0);
+
+				if (g.col() == pc) {
+					// Known part : rows above the block for U^T, below it for L^T
+					const size_t   lo = upper ? 0 : lu.local_rows_below(k0 + w), hi = upper ? lu.local_rows_below(k0) : rows;
+					std::vector<T> part(w, T(0));
+					for (size_t t = 0; t < w; t++) {
+						const T* col = lu.loc.col_ptr(lu.local_col(k0) + t);
+						T        acc = T(0);
+						for (size_t lr = lo; lr < hi; lr++)
+							acc += col[lr] * x[lu.global_row(lr)];
+						part[t] = acc;
+					}
+					const std::vector<T> sum = column_sum(part);
+
+					if (g.row() == pr) {
+						const size_t lr = lu.local_row(k0);
+						auto         a = [&](size_t i, size_t t) { return lu.at_local(lr + i, lu.local_col(k0) + t); };
+
+						if (upper)
+							for (size_t t = 0; t < w; t++) {
+								T v = x[k0 + t] - sum[t];
+								for (size_t i = 0; i < t; i++)
+									v -= a(i, t) * x[k0 + i];
+								x[k0 + t] = v / a(t, t);
+							}
+						else
+							for (size_t t = w; t-- > 0;) {
+								T v = x[k0 + t] - sum[t];
+								for (size_t i = t + 1; i < w; i++)
+									v -= a(i, t) * x[k0 + i];
+								x[k0 + t] = v;
+							}
+					}
+				}
+				g.bcast(x.data() + k0, w * sizeof(T), g.rank_of(pr, pc), Scope::World);
+			}
+		}
+
+	public:
+		/**
+		 * @brief Factorizes a distributed square matrix. Collective.
+		 * @param a The matrix, moved in to factorize in its storage.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @note Time complexity : O(n^3 / P) per rank, O(n) broadcasts per column of the grid
+		 * @note Space complexity : O(n^2 / P) per rank
+		 */
+		explicit DistributedLU(DistributedMatrix<T> a) : lu(std::move(a)) {
+			if (!lu.is_square())
+				throw std::invalid_argument("LU factorization can only be computed on square matrix.");
+			PROFILE_OP("DistributedLU", lu.rows(), lu.cols(), FLOPS_FMA<T> * double(lu.rows()) * lu.rows() * lu.rows() / 3 / double(lu.grid().size()), 0);
+			factor();
+		}
+
+		inline size_t size() const { return lu.rows(); }
+		inline bool is_singular() const { return singular; }
+		inline const std::vector<size_t>& permutation() const { return perm; }
+		inline const DistributedMatrix<T>& factors() const { return lu; }
+
+		/**
+		 * @brief Computes the determinant from the factors. Collective.
+		 * @return T The determinant, (-1)^swaps * product of the pivots, on every rank.
+		 * @note Time complexity : O(n / P) per rank, plus one gather
+		 */
+		T det() const {
+			if (singular)
+				return T(0);
+
+			const ProcessGrid& g = lu.grid();
+			T                  product = T(1);
+			for (size_t i = 0; i < size(); i++)
+				if (lu.row_owner(i) == g.row() && lu.col_owner(i) == g.col())
+					product *= lu.at_local(lu.local_row(i), lu.local_col(i));
+
+			std::vector<T> all(g.size());
+			g.allgather(&product, sizeof(T), all.data(), Scope::World);
+
+			T result = odd_swaps ? T(-1) : T(1);
+			for (const T& p : all) // Rank order : the same rounding on every rank
+				result *= p;
+			return result;
+		}
+
+		/**
+		 * @brief Solves the system for one right-hand side. Collective.
+		 * @details Same convention as LU<T>::solve : x such that A.mul_vec(x) == b. With A^T = U^T * L^T * P, this is a
+		 *          forward substitution with U^T, then a backward one with L^T.
+		 * @param b The right-hand side, the same on every rank.
+		 * @return Vector<T> The solution x, on every rank.
+		 * @throw std::invalid_argument If b does not match the matrix size.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n^2 / Pr) per rank
+		 * @note Space complexity : O(n)
+		 */
+		Vector<T> solve(const Vector<T>& b) const {
+			if (b.size() != size())
+				throw std::invalid_argument("Right-hand side size must match the matrix size.");
+			if (singular)
+				throw std::logic_error("Matrix is singular.");
+
+			std::vector<T> x(b.ptr(), b.ptr() + b.size());
+			solve_transposed(true, x);
+			solve_transposed(false, x);
+
+			Vector<T> result(size()); // P x = z
+			for (size_t i = 0; i < size(); i++)
+				result[perm[i]] = x[i];
+			return result;
+		}
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+# include "config.hpp"
+
+/**
+ * Expression templates for element-wise Vector / Matrix arithmetic.
+ *
+ * `a * x + b * y - z` builds a small tree of nodes holding pointers to the operands; nothing is computed until the
+ * tree is assigned to a Vector or a Matrix, which then evaluates every element in a single fused loop, without any
+ * intermediate allocation. `s * e + r` nodes are evaluated with an fma for real types.
+ * Nodes are read with e[i] for vectors and e(r, c) for matrices : matrix leaves follow the column stride ld(), so
+ * padded storage evaluates the right elements.
+ *
+ * The nodes reference their leaf operands : an expression must not outlive the vectors / matrices it was built from.
+ */
+
+/**
+ * @brief CRTP base of every expression node.
+ * @tparam E The concrete node type.
+ */
+template<typename E>
+struct Expr {
+	inline const E& self() const { return static_cast<const E&>(*this); }
+};
+
+/**
+ * @brief Leaf node reading a Vector or a Matrix buffer.
+ * @tparam T The type of the elements.
+ * @tparam IsMatrix Whether the leaf is a matrix (element-wise operations never mix vectors and matrices).
+ */
+template<typename T, bool IsMatrix>
+struct ExprLeaf : Expr<ExprLeaf<T, IsMatrix>> {
+	using value_type = T;
+	static constexpr bool is_matrix = IsMatrix;
+
+	const T* ptr;
+	size_t   n_rows, n_cols, ld; // Element (r, c) at ptr[c * ld + r]
+
+	ExprLeaf(const T* ptr, size_t rows, size_t cols, size_t ld) : ptr(ptr), n_rows(rows), n_cols(cols), ld(ld) {}
+
+	inline std::pair<size_t, size_t> shape() const { return { n_rows, n_cols }; }
+	inline size_t size() const { return n_rows * n_cols; }
+	inline const T& operator[](size_t i) const { return ptr[i]; }
+	inline const T& operator()(size_t r, size_t c) const { return ptr[c * ld + r]; }
+};
+
+/**
+ * @brief Node computing a scalar times an expression.
+ */
+template<typename S, typename E>
+struct ExprScale : Expr<ExprScale<S, E>> {
+	using value_type = decltype(std::declval<S>() * std::declval<typename E::value_type>());
+	static constexpr bool is_matrix = E::is_matrix;
+
+	S scalar;
+	E expr;
+
+	ExprScale(const S& scalar, const E& expr) : scalar(scalar), expr(expr) {}
+
+	inline std::pair<size_t, size_t> shape() const { return expr.shape(); }
+	inline size_t size() const { return expr.size(); }
+	inline value_type operator[](size_t i) const { return scalar * expr[i]; }
+	inline value_type operator()(size_t r, size_t c) const { return scalar * expr(r, c); }
+};
+
+template<typename E> struct is_expr_scale : std::false_type {};
+template<typename S, typename E> struct is_expr_scale<ExprScale<S, E>> : std::true_type {};
+
+/**
+ * @brief Node computing the element-wise sum (Sign = 1) or difference (Sign = -1) of two expressions.
+ * @throw std::invalid_argument If the operands do not have the same shape.
+ */
+template<typename L, typename R, int Sign>
+struct ExprAdd : Expr<ExprAdd<L, R, Sign>> {
+	static_assert(L::is_matrix == R::is_matrix, "Cannot mix vectors and matrices in an element-wise expression.");
+
+	using value_type = std::common_type_t<typename L::value_type, typename R::value_type>;
+	static constexpr bool is_matrix = L::is_matrix;
+
+	L lhs;
+	R rhs;
+
+	ExprAdd(const L& lhs, const R& rhs) : lhs(lhs), rhs(rhs) {
+		if (lhs.shape() != rhs.shape())
+			throw std::invalid_argument(is_matrix ? "Matrices must have the same shape." : "Vectors must have the same size");
+	}
+
+	inline std::pair<size_t, size_t> shape() const { return lhs.shape(); }
+	inline size_t size() const { return lhs.size(); }
+
+	inline value_type operator[](size_t i) const { return at([i](const auto& e) { return e[i]; }); }
+	inline value_type operator()(size_t r, size_t c) const { return at([r, c](const auto& e) { return e(r, c); }); }
+
+	// Combines the operands read by get, the same element of both
+	template<typename G>
+	inline value_type at(const G& get) const {
+		if constexpr (IS_ARITHMETIC(value_type) && is_expr_scale<R>::value)
+			return std::fma(value_type(Sign > 0 ? rhs.scalar : -rhs.scalar), get(rhs.expr), get(lhs));
+		else if constexpr (IS_ARITHMETIC(value_type) && is_expr_scale<L>::value)
+			return std::fma(value_type(lhs.scalar), get(lhs.expr), Sign > 0 ? get(rhs) : -get(rhs));
+		else if constexpr (Sign > 0)
+			return get(lhs) + get(rhs);
+		else
+			return get(lhs) - get(rhs);
+	}
+};
+
+# pragma region Operators
+
+template<typename X> struct expr_operand { static constexpr bool value = false; };
+template<typename T> struct expr_operand<Vector<T>> {
+	static constexpr bool value = true;
+	static ExprLeaf<T, false> wrap(const Vector<T>& v) { return ExprLeaf<T, false>(v.ptr(), v.size(), 1, v.size()); }
+};
+template<typename T> struct expr_operand<Matrix<T>> {
+	static constexpr bool value = true;
+	static ExprLeaf<T, true> wrap(const Matrix<T>& m) { return ExprLeaf<T, true>(m.ptr(), m.rows(), m.cols(), m.ld()); }
+};
+
+// True for Vector<T>, Matrix<T> and expression nodes
+# define IS_EXPR_OPERAND(X) (expr_operand<X>::value || std::is_base_of_v<Expr<X>, X>)
+
+template<typename X>
+inline auto as_expr(const X& x) {
+	if constexpr (expr_operand<X>::value)
+		return expr_operand<X>::wrap(x);
+	else
+		return x;
+}
+
+template<typename A, typename B, std::enable_if_t<IS_EXPR_OPERAND(A) && IS_EXPR_OPERAND(B), int> = 0>
+inline auto operator+(const A& a, const B& b) {
+	return ExprAdd<decltype(as_expr(a)), decltype(as_expr(b)), 1>(as_expr(a), as_expr(b));
+}
+
+template<typename A, typename B, std::enable_if_t<IS_EXPR_OPERAND(A) && IS_EXPR_OPERAND(B), int> = 0>
+inline auto operator-(const A& a, const B& b) {
+	return ExprAdd<decltype(as_expr(a)), decltype(as_expr(b)), -1>(as_expr(a), as_expr(b));
+}
+
+template<typename S, typename B, std::enable_if_t<(IS_ARITHMETIC(S) || IS_COMPLEX(S)) && IS_EXPR_OPERAND(B), int> = 0>
+inline auto operator*(const S& scalar, const B& b) {
+	return ExprScale<S, decltype(as_expr(b))>(scalar, as_expr(b));
+}
+
+template<typename A, typename S, std::enable_if_t<IS_EXPR_OPERAND(A) && (IS_ARITHMETIC(S) || IS_COMPLEX(S)), int> = 0>
+inline auto operator*(const A& a, const S& scalar) {
+	return ExprScale<S, decltype(as_expr(a))>(scalar, as_expr(a));
+}
+
+# pragma endregion
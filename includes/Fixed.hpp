@@ -0,0 +1,518 @@
+#pragma once
+
+# include <array>
+# include "Vector.hpp"
+# include "Matrix.hpp"
+# include "Small.hpp"
+
+/**
+ * @brief Represents a mathematical vector of N dimensions, with N known at compile time.
+ * @details Elements live in a std::array : the vector never touches the heap and all loops have
+ *          compile-time trip counts, so they are fully unrolled for small N.
+ *          It converts to and from the dynamic Vector<T>.
+ * @tparam T The type of the elements in the vector.
+ * @tparam N The number of elements.
+ */
+template<typename T, size_t N>
+class Vector {
+	static_assert(N != DYNAMIC, "Use Vector<T> for run-time sized vectors.");
+
+	protected:
+		std::array<T, N> data = {};
+
+	public:
+		constexpr Vector() = default;
+		constexpr Vector(std::initializer_list<T> list) {
+			if (list.size() != N)
+				throw std::invalid_argument("Initializer list size does not match the vector size.");
+
+			size_t i = 0;
+			for (const T& v : list)
+				data[i++] = v;
+		}
+		explicit Vector(const Vector<T>& other) {
+			if (other.size() != N)
+				throw std::invalid_argument("Vector size does not match the fixed size.");
+
+			for (size_t i = 0; i < N; i++)
+				data[i] = other[i];
+		}
+
+		/**
+		 * @brief Adds two vectors.
+		 * @param other The other vector to add.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : None
+		 */
+		constexpr void add(const Vector<T, N>& other) {
+			# pragma GCC unroll 16
+			for (size_t i = 0; i < N; ++i)
+				data[i] += other.data[i];
+		}
+
+		/**
+		 * @brief Substract two vectors.
+		 * @param other The other vector to subtract.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : None
+		 */
+		constexpr void sub(const Vector<T, N>& other) {
+			# pragma GCC unroll 16
+			for (size_t i = 0; i < N; ++i)
+				data[i] -= other.data[i];
+		}
+
+		/**
+		 * @brief Scale the vector by a scalar.
+		 * @param scalar The scalar to scale the vector by.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : None
+		 */
+		constexpr void scl(const T& scalar) {
+			# pragma GCC unroll 16
+			for (size_t i = 0; i < N; ++i)
+				data[i] *= scalar;
+		}
+
+		/**
+		 * @brief Divide the vector by a scalar.
+		 * @param scalar The scalar to divide the vector by.
+		 * @throw std::logic_error If the scalar is zero.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : None
+		 */
+		constexpr void div(const T& scalar) {
+			if (scalar == T(0))
+				throw std::logic_error("Division by zero is not allowed.");
+
+			# pragma GCC unroll 16
+			for (size_t i = 0; i < N; ++i)
+				data[i] /= scalar;
+		}
+
+		/**
+		 * @brief Computes the dot product of two vectors.
+		 * @details Work with both real and complex numbers (the second operand is conjugated).
+		 * @param other The other vector to compute the dot product with.
+		 * @return The dot product result.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : None
+		 */
+		constexpr T dot(const Vector<T, N>& other) const {
+			T result = T(0);
+
+			# pragma GCC unroll 16
+			for (size_t i = 0; i < N; i++) {
+				if constexpr (IS_COMPLEX(T))
+					result += data[i] * std::conj(other.data[i]);
+				else
+					result += data[i] * other.data[i];
+			}
+
+			return result;
+		}
+
+		/**
+		 * @brief Compute the Taxicab norm (L1 norm) of the vector.
+		 * @return The L1 norm of the vector.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : fma, pow
+		 */
+		auto norm_1() const {
+			using R = TO_REAL<T>;
+			R result = R(0);
+
+			for (const T& i : data)
+				result += magnitude(i);
+
+			return result;
+		}
+
+		/**
+		 * @brief Compute the Euclidean norm (L2 norm) of the vector.
+		 * @return The L2 norm of the vector.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : fma, pow
+		 */
+		auto norm() const {
+			using R = TO_REAL<T>;
+			R result = R(0);
+
+			for (const T& i : data) {
+				const R a = magnitude(i);
+				result = std::fma(a, a, result);
+			}
+
+			return std::pow(result, R(0.5)); // = sqrt()
+		}
+
+		/**
+		 * @brief Compute the Infinity norm (L∞ norm) of the vector.
+		 * @return The L∞ norm of the vector.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : fma, pow
+		 */
+		auto norm_inf() const {
+			using R = TO_REAL<T>;
+			R result = R(0);
+
+			for (const T& i : data)
+				result = std::max(result, magnitude(i));
+
+			return result;
+		}
+
+		# pragma region Utils
+
+		/**
+		 * @brief Returns the number of elements in the vector.
+		 * @return size_t The size of the vector.
+		 */
+		static constexpr size_t size() { return N; }
+
+		inline T* ptr() { return data.data(); }
+		inline const T* ptr() const { return data.data(); }
+
+		/**
+		 * @brief Copies the vector into a dynamic Vector<T>.
+		 * @return Vector<T> The dynamic vector.
+		 */
+		operator Vector<T>() const { return Vector<T>(std::vector<T>(data.begin(), data.end())); }
+
+		constexpr T& operator[](size_t index) { return data[index]; }
+		constexpr const T& operator[](size_t index) const { return data[index]; }
+		constexpr bool operator==(const Vector<T, N>& other) const { return data == other.data; }
+
+		# pragma endregion
+};
+
+/**
+ * @brief Represents a mathematical matrix of R x C dimensions, with R and C known at compile time.
+ * @details Elements live in a column-major std::array, with the same layout and the same operation semantics
+ *          as the dynamic Matrix<T> (element at row r / column c is m[c][r]).
+ *          Nothing allocates, and all loops have compile-time trip counts so they are fully unrolled : this is the
+ *          type to use on the 4x4 graphics path. It converts to and from the dynamic Matrix<T>.
+ * @tparam T The type of the elements in the matrix.
+ * @tparam R The number of rows.
+ * @tparam C The number of columns.
+ */
+template<typename T, size_t R, size_t C>
+class Matrix {
+	static_assert(R != DYNAMIC && C != DYNAMIC, "Use Matrix<T> for run-time sized matrices.");
+
+	protected:
+		std::array<T, R * C> data = {};
+
+		constexpr T& at(size_t r, size_t c) { return data[c * R + r]; }
+		constexpr const T& at(size_t r, size_t c) const { return data[c * R + r]; }
+
+	public:
+		constexpr Matrix() = default;
+		constexpr Matrix(const T& value) { // Identity matrix (scaled by value)
+			static_assert(R == C, "Identity matrix must be square.");
+
+			for (size_t i = 0; i < R; i++)
+				at(i, i) = value;
+		}
+		constexpr Matrix(std::initializer_list<Vector<T, C>> rows) {
+			if (rows.size() != R)
+				throw std::invalid_argument("Initializer list size does not match the matrix rows.");
+
+			size_t i = 0;
+			for (const Vector<T, C>& row : rows) {
+				for (size_t j = 0; j < C; j++)
+					at(i, j) = row[j];
+				i++;
+			}
+		}
+		explicit Matrix(const Matrix<T>& other) {
+			if (other.rows() != R || other.cols() != C)
+				throw std::invalid_argument("Matrix shape does not match the fixed shape.");
+
+			for (size_t c = 0; c < C; c++)
+				for (size_t r = 0; r < R; r++)
+					at(r, c) = other[c][r];
+		}
+
+		/**
+		 * @brief Adds two matrices.
+		 * @param other The other matrix to add.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : None
+		 */
+		constexpr void add(const Matrix<T, R, C>& other) {
+			# pragma GCC unroll 16
+			for (size_t i = 0; i < R * C; ++i)
+				data[i] += other.data[i];
+		}
+
+		/**
+		 * @brief Substract two matrices.
+		 * @param other The other matrix to subtract.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : None
+		 */
+		constexpr void sub(const Matrix<T, R, C>& other) {
+			# pragma GCC unroll 16
+			for (size_t i = 0; i < R * C; ++i)
+				data[i] -= other.data[i];
+		}
+
+		/**
+		 * @brief Scale the matrix by a scalar.
+		 * @param scalar The scalar to scale the matrix by.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : None
+		 */
+		constexpr void scl(const T& scalar) {
+			# pragma GCC unroll 16
+			for (size_t i = 0; i < R * C; ++i)
+				data[i] *= scalar;
+		}
+
+		/**
+		 * @brief Multiplies the matrix by a vector.
+		 * @details Same semantics as Matrix<T>::mul_vec : result[c] = sum over r of m[c][r] * other[r].
+		 * @param other The vector to multiply.
+		 * @return Vector<T, C> The resulting vector.
+		 * @note Time complexity : O(m*n) matrix rows * matrix cols
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : None
+		 */
+		constexpr Vector<T, C> mul_vec(const Vector<T, R>& other) const {
+			Vector<T, C> result;
+
+			# pragma GCC unroll 16
+			for (size_t c = 0; c < C; c++) {
+				T acc = T(0);
+
+				# pragma GCC unroll 16
+				for (size_t r = 0; r < R; r++)
+					acc += at(r, c) * other[r];
+				result[c] = acc;
+			}
+
+			return result;
+		}
+
+		/**
+		 * @brief Multiplies the matrix by another matrix.
+		 * @param other The other matrix to multiply.
+		 * @return Matrix<T, R, K> The resulting matrix.
+		 * @note Time complexity : O(m*n*p) matrix A rows * matrix A cols * matrix B cols
+		 * @note Space complexity : O(m*p) matrix A rows * matrix B cols
+		 * @note Allowed math functions : None
+		 */
+		template<size_t K>
+		constexpr Matrix<T, R, K> mul_mat(const Matrix<T, C, K>& other) const {
+			Matrix<T, R, K> result;
+
+			# pragma GCC unroll 16
+			for (size_t c = 0; c < K; c++) {
+				# pragma GCC unroll 16
+				for (size_t k = 0; k < C; k++) {
+					const T b = other[c][k];
+
+					# pragma GCC unroll 16
+					for (size_t r = 0; r < R; r++)
+						result[c][r] += at(r, k) * b;
+				}
+			}
+
+			return result;
+		}
+
+		/**
+		 * @brief Computes the trace of the matrix.
+		 * @return T The trace of the matrix.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : None
+		 */
+		constexpr T trace() const {
+			static_assert(R == C, "Trace can only be computed on square matrix");
+			T result = T(0);
+
+			for (size_t i = 0; i < R; i++)
+				result += at(i, i);
+
+			return result;
+		}
+
+		/**
+		 * @brief Transposes the matrix.
+		 * @return Matrix<T, C, R> The transposed matrix.
+		 * @note Time complexity : O(m*n) matrix rows * matrix cols
+		 * @note Space complexity : O(m*n) matrix rows * matrix cols
+		 * @note Allowed math functions : None
+		 */
+		constexpr Matrix<T, C, R> transpose() const {
+			Matrix<T, C, R> result;
+
+			# pragma GCC unroll 16
+			for (size_t c = 0; c < C; c++)
+				# pragma GCC unroll 16
+				for (size_t r = 0; r < R; r++)
+					result[r][c] = at(r, c);
+
+			return result;
+		}
+
+		/**
+		 * @brief Computes the determinant of the matrix.
+		 * @details Closed-form cofactor expansion up to 4x4, Gaussian elimination with partial pivoting above.
+		 * @return T The determinant of the matrix.
+		 * @note Time complexity : O(1) up to 4x4, O(n^3) otherwise
+		 * @note Space complexity : O(n^2)
+		 * @note Allowed math functions : None
+		 */
+		constexpr T determinant() const {
+			static_assert(R == C, "Determinant can only be computed on square matrix");
+
+			if constexpr (R <= 4)
+				return small_determinant<R>(data); // Data is the packed column-major array of Small.hpp
+			else {
+				std::array<T, R * C> tmp = data;
+				T det = T(1);
+
+				for (size_t i = 0; i < R; i++) {
+					size_t pivot = i;
+					for (size_t j = i + 1; j < R; j++)
+						if (magnitude(tmp[i * R + j]) > magnitude(tmp[i * R + pivot]))
+							pivot = j;
+
+					if (tmp[i * R + pivot] == T(0))
+						return T(0);
+
+					if (pivot != i) {
+						for (size_t k = 0; k < C; k++)
+							std::swap(tmp[k * R + i], tmp[k * R + pivot]);
+						det = -det;
+					}
+
+					det *= tmp[i * R + i];
+					for (size_t j = i + 1; j < R; j++) {
+						const T factor = tmp[i * R + j] / tmp[i * R + i];
+						for (size_t k = i; k < C; k++)
+							tmp[k * R + j] -= factor * tmp[k * R + i];
+					}
+				}
+
+				return det;
+			}
+		}
+
+		/**
+		 * @brief Computes the inverse of the matrix.
+		 * @details Closed-form adjugate / determinant up to 4x4 (affine 4x4 transforms through the cheaper affine inverse),
+		 *          Gauss-Jordan elimination above.
+		 * @return Matrix<T, R, C> The inverse of the matrix.
+		 * @throw std::logic_error If the matrix is singular and cannot be inverted.
+		 * @note Time complexity : O(1) up to 4x4, O(n^3) otherwise
+		 * @note Space complexity : O(n^2)
+		 * @note Allowed math functions : None
+		 */
+		constexpr Matrix<T, R, C> inverse() const {
+			static_assert(R == C, "Inverse can only be computed on square matrix.");
+
+			Matrix<T, R, C> result;
+
+			if constexpr (R <= 4) {
+				if (!small_inverse<R>(data.data(), 1, R, result.data.data(), 1, R))
+					throw std::logic_error("Matrix is singular and cannot be inverted.");
+			}
+			else {
+				std::array<T, R * C> tmp = data;
+				result = Matrix<T, R, C>(T(1));
+				auto& inv = result.data;
+
+				for (size_t i = 0; i < R; i++) {
+					size_t pivot = i;
+					for (size_t j = i + 1; j < R; j++)
+						if (magnitude(tmp[i * R + j]) > magnitude(tmp[i * R + pivot]))
+							pivot = j;
+
+					if (tmp[i * R + pivot] == T(0))
+						throw std::logic_error("Matrix is singular and cannot be inverted.");
+
+					for (size_t k = 0; k < C; k++) {
+						std::swap(tmp[k * R + i], tmp[k * R + pivot]);
+						std::swap(inv[k * R + i], inv[k * R + pivot]);
+					}
+
+					const T scale = T(1) / tmp[i * R + i];
+					for (size_t k = 0; k < C; k++) {
+						tmp[k * R + i] *= scale;
+						inv[k * R + i] *= scale;
+					}
+
+					for (size_t j = 0; j < R; j++) {
+						if (j == i) continue;
+						const T factor = tmp[i * R + j];
+						for (size_t k = 0; k < C; k++) {
+							tmp[k * R + j] -= factor * tmp[k * R + i];
+							inv[k * R + j] -= factor * inv[k * R + i];
+						}
+					}
+				}
+			}
+
+			return result;
+		}
+
+		# pragma region Utils
+
+		static constexpr size_t rows() { return R; }
+		static constexpr size_t cols() { return C; }
+		static constexpr std::pair<size_t, size_t> shape() { return { R, C }; }
+		static constexpr bool is_square() { return R == C; }
+		static constexpr size_t ld() { return R; }
+
+		inline T* ptr() { return data.data(); }
+		inline const T* ptr() const { return data.data(); }
+
+		/**
+		 * @brief Copies the matrix into a dynamic Matrix<T>.
+		 * @return Matrix<T> The dynamic matrix.
+		 */
+		operator Matrix<T>() const { return Matrix<T>(C, R, std::vector<T>(data.begin(), data.end())); }
+
+		constexpr VectorView<T> operator[](size_t index) { return VectorView<T>(data.data() + index * R, R); }
+		constexpr VectorView<const T> operator[](size_t index) const { return VectorView<const T>(data.data() + index * R, R); }
+
+		bool operator==(const Matrix<T, R, C>& other) const {
+			using Real = TO_REAL<T>;
+			const Real eps = Real(1e-5); // Tolerance for floating-point comparison
+
+			for (size_t i = 0; i < R * C; ++i)
+				if (magnitude(data[i] - other.data[i]) > eps)
+					return false;
+
+			return true;
+		}
+
+		# pragma endregion
+
+		template<typename, size_t, size_t> friend class Matrix;
+};
+
+template<typename T, size_t N>
+std::ostream& operator<<(std::ostream& os, const Vector<T, N>& vec) {
+	return os << Vector<T>(vec);
+}
+
+template<typename T, size_t R, size_t C>
+std::ostream& operator<<(std::ostream& os, const Matrix<T, R, C>& mat) {
+	return os << Matrix<T>(mat);
+}
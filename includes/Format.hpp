@@ -0,0 +1,125 @@
+#pragma once
+
+# include <charconv>
+# include <locale>
+# include "config.hpp"
+
+/**
+ * Locale-independent number conversions on raw character ranges, built on std::to_chars / std::from_chars.
+ * They never allocate, so the matrix printers and text parsers can run at memory speed.
+ * Complex numbers use the std::complex stream notation "(re,im)" ; a bare real is read as (re,0).
+ */
+
+# pragma region Utils
+
+/**
+ * @brief Returns the most characters format_value can write for one T at the given precision.
+ * @details A shortest round-trip real is at most 32 characters (sign, 21 digits of a long double, point, exponent) ;
+ *          precision digits take precision + 8 (sign, point and an exponent of up to 6 characters, long double
+ *          included). A complex writes two reals and "(,)".
+ * @param precision The precision given to format_value.
+ * @return size_t The room to reserve for one element.
+ * @note Time complexity : O(1)
+ */
+template<typename T>
+constexpr size_t format_room(int precision = -1) {
+	if constexpr (IS_COMPLEX(T))
+		return 2 * format_room<TO_REAL<T>>(precision) + 3;
+	else if constexpr (std::is_floating_point_v<T>)
+		return precision < 0 ? 32 : size_t(precision) + 8;
+	else
+		return 24; // 64-bit integers and their sign
+}
+
+/**
+ * @brief Writes a number into [first, last).
+ * @param first The start of the output, with format_room<T>(precision) characters up to last to never throw.
+ * @param last The end of the output.
+ * @param v The value to write.
+ * @param precision The significant digits for floating values (printf %g style, as iostreams),
+ *        or -1 for the shortest representation that reads back to the same value.
+ * @return char* The character past the last written one.
+ * @throw std::length_error If the value does not fit in [first, last), which is left partially written.
+ * @note Time complexity : O(1)
+ * @note Space complexity : O(1)
+ */
+template<typename T>
+char* format_value(char* first, char* last, const T& v, int precision = -1) {
+	const auto put = [&](char ch) {
+		if (first == last)
+			throw std::length_error("Formatted value does not fit the output buffer.");
+		*first++ = ch;
+	};
+
+	if constexpr (IS_COMPLEX(T)) {
+		put('(');
+		first = format_value(first, last, v.real(), precision);
+		put(',');
+		first = format_value(first, last, v.imag(), precision);
+		put(')');
+		return first;
+	} else {
+		std::to_chars_result res;
+		if constexpr (std::is_floating_point_v<T>)
+			res = precision < 0 ? std::to_chars(first, last, v)
+			                    : std::to_chars(first, last, v, std::chars_format::general, precision ? precision : 1);
+		else {
+			static_assert(std::is_integral_v<T>, "Cannot format the given type.");
+			res = std::to_chars(first, last, v);
+		}
+		if (res.ec != std::errc())
+			throw std::length_error("Formatted value does not fit the output buffer.");
+		return res.ptr;
+	}
+}
+
+/**
+ * @brief Reads a number at the start of [first, last).
+ * @details Accepts an optional leading '+', which std::from_chars does not.
+ * @param first The start of the input, with no leading whitespace.
+ * @param last The end of the input.
+ * @param v The value read.
+ * @return const char* The character past the number, or nullptr if there is no valid number there.
+ * @note Time complexity : O(length of the number)
+ * @note Space complexity : O(1)
+ */
+template<typename T>
+const char* parse_value(const char* first, const char* last, T& v) {
+	if constexpr (IS_COMPLEX(T)) {
+		using R = TO_REAL<T>;
+		R re = 0, im = 0;
+
+		if (first == last || *first != '(') {
+			first = parse_value(first, last, re);
+			v = T(re, R(0));
+			return first;
+		}
+		first = parse_value(first + 1, last, re);
+		if (!first || first == last || *first != ',')
+			return nullptr;
+		first = parse_value(first + 1, last, im);
+		if (!first || first == last || *first != ')')
+			return nullptr;
+		v = T(re, im);
+		return first + 1;
+	} else {
+		static_assert(std::is_arithmetic_v<T>, "Cannot parse the given type.");
+
+		if (first != last && *first == '+' && ++first != last && *first == '-')
+			return nullptr;
+		const auto [ptr, ec] = std::from_chars(first, last, v);
+		return ec == std::errc() ? ptr : nullptr;
+	}
+}
+
+/**
+ * @brief Checks whether format_value with os.precision() prints exactly what `os << v` would.
+ * @details True for the default stream state : no width, no fixed / scientific / showpos flags, classic locale.
+ * @param os The stream to check.
+ * @return true If the to_chars formatter can replace the stream insertion.
+ */
+inline bool formats_like_stream(const std::ostream& os) {
+	return os.flags() == (std::ios::skipws | std::ios::dec) && os.width() == 0 && os.getloc() == std::locale::classic();
+}
+
+# pragma endregion
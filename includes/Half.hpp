@@ -0,0 +1,198 @@
+#pragma once
+
+# include <cstdint>
+# include <cstring>
+# include <type_traits>
+# include <limits>
+
+# if defined(__F16C__)
+#  include <immintrin.h>
+# endif
+
+/**
+ * 16-bit floating storage types, for bandwidth-bound workloads : half the bytes of f32 per element.
+ * - f16 : IEEE 754 binary16, 5 exponent and 10 mantissa bits (3 decimal digits, up to 65504) ;
+ * - bf16 : bfloat16, the top half of an f32 (same range as f32, 2 decimal digits).
+ *
+ * They only store : every arithmetic operation converts to float, and a value converted back is rounded to nearest
+ * even. Vector / Matrix reductions on them (dot, norms, mul_vec, mul_mat) accumulate in f32, see IS_REDUCED.
+ * The conversions use the F16C instructions when the compiler targets them (-march=native on x86), a portable
+ * bit-exact version otherwise.
+ */
+
+# pragma region Utils
+
+inline uint32_t float_bits(float f) {
+	uint32_t u;
+	std::memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+inline float bits_float(uint32_t u) {
+	float f;
+	std::memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+# pragma endregion
+
+/**
+ * @brief IEEE 754 half-precision storage type.
+ */
+struct f16 {
+	uint16_t bits = 0;
+
+	f16() = default;
+	f16(float v) : bits(encode(v)) {}
+	operator float() const { return decode(bits); }
+
+	static f16 from_bits(uint16_t b) {
+		f16 h;
+		h.bits = b;
+		return h;
+	}
+
+	f16& operator+=(float v) { return *this = float(*this) + v; }
+	f16& operator-=(float v) { return *this = float(*this) - v; }
+	f16& operator*=(float v) { return *this = float(*this) * v; }
+	f16& operator/=(float v) { return *this = float(*this) / v; }
+
+	/**
+	 * @brief Rounds a float to the nearest half, ties to even. Overflows give infinity, NaN stays NaN.
+	 * @note Time complexity : O(1)
+	 */
+	static uint16_t encode(float v) {
+# if defined(__F16C__)
+		return uint16_t(_cvtss_sh(v, _MM_FROUND_TO_NEAREST_INT));
+# else
+		uint32_t       x    = float_bits(v);
+		const uint32_t sign = (x >> 16) & 0x8000u;
+		x &= 0x7fffffffu;
+
+		if (x >= 0x47800000u)       // |v| >= 65536 (f32 exponent 143), Inf or NaN
+			return uint16_t(sign | (x > 0x7f800000u ? 0x7e00u : 0x7c00u));
+		if (x < 0x38800000u) {      // Below 2^-14 : subnormal half, rounded by the f32 adder
+			const float magic = bits_float(126u << 23); // 0.5, whose ulp is the half subnormal step
+			return uint16_t(sign | (float_bits(bits_float(x) + magic) - float_bits(magic)));
+		}
+
+		const uint32_t odd = (x >> 13) & 1u;
+		x += 0xc8000fffu + odd;     // Rebias the exponent (-112 << 23) and round to nearest even
+		return uint16_t(sign | (x >> 13));
+# endif
+	}
+
+	/**
+	 * @brief Widens a half to the float of the same value.
+	 * @note Time complexity : O(1)
+	 */
+	static float decode(uint16_t h) {
+# if defined(__F16C__)
+		return _cvtsh_ss(h);
+# else
+		const uint32_t sign = uint32_t(h & 0x8000u) << 16;
+		const uint32_t exp  = (h >> 10) & 0x1fu;
+		const uint32_t mant = h & 0x3ffu;
+
+		if (exp == 0x1fu)           // Inf or NaN
+			return bits_float(sign | 0x7f800000u | (mant << 13));
+		if (exp == 0) {             // Zero or subnormal : mant * 2^-24
+			const float f = float(mant) * bits_float(103u << 23);
+			return bits_float(sign | float_bits(f));
+		}
+		return bits_float(sign | ((exp + 112u) << 23) | (mant << 13));
+# endif
+	}
+};
+
+/**
+ * @brief bfloat16 storage type : the sign, exponent and top 7 mantissa bits of an f32.
+ */
+struct bf16 {
+	uint16_t bits = 0;
+
+	bf16() = default;
+	bf16(float v) : bits(encode(v)) {}
+	operator float() const { return decode(bits); }
+
+	static bf16 from_bits(uint16_t b) {
+		bf16 h;
+		h.bits = b;
+		return h;
+	}
+
+	bf16& operator+=(float v) { return *this = float(*this) + v; }
+	bf16& operator-=(float v) { return *this = float(*this) - v; }
+	bf16& operator*=(float v) { return *this = float(*this) * v; }
+	bf16& operator/=(float v) { return *this = float(*this) / v; }
+
+	// Rounds to nearest even, and keeps NaN a (quiet) NaN instead of rounding it to infinity
+	static uint16_t encode(float v) {
+		const uint32_t x = float_bits(v);
+		if ((x & 0x7fffffffu) > 0x7f800000u)
+			return uint16_t((x >> 16) | 0x40u);
+		return uint16_t((x + 0x7fffu + ((x >> 16) & 1u)) >> 16);
+	}
+
+	static float decode(uint16_t h) { return bits_float(uint32_t(h) << 16); }
+};
+
+/**
+ * @brief Widens n reduced-precision elements to f32.
+ * @details 8 elements per instruction with F16C, a loop the compiler vectorizes for bf16.
+ * @note Time complexity : O(n)
+ * @note Space complexity : O(1)
+ */
+template<typename T>
+inline void to_f32(const T* src, float* dst, size_t n) {
+	size_t i = 0;
+# if defined(__F16C__) && defined(__AVX__)
+	if constexpr (std::is_same_v<T, f16>)
+		for (; i + 8 <= n; i += 8)
+			_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+# endif
+	for (; i < n; i++)
+		dst[i] = T::decode(src[i].bits);
+}
+
+/**
+ * @brief Rounds n f32 elements to a reduced-precision type.
+ * @note Time complexity : O(n)
+ * @note Space complexity : O(1)
+ */
+template<typename T>
+inline void from_f32(const float* src, T* dst, size_t n) {
+	size_t i = 0;
+# if defined(__F16C__) && defined(__AVX__)
+	if constexpr (std::is_same_v<T, f16>)
+		for (; i + 8 <= n; i += 8)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+# endif
+	for (; i < n; i++)
+		dst[i].bits = T::encode(src[i]);
+}
+
+// Limits, through float : epsilon and the range of the 16-bit formats
+template<>
+struct std::numeric_limits<f16> {
+	static constexpr bool is_specialized = true;
+	static constexpr int  digits = 11;
+	static f16 epsilon() { return f16::from_bits(0x1400); } // 2^-10
+	static f16 min() { return f16::from_bits(0x0400); }     // 2^-14
+	static f16 max() { return f16::from_bits(0x7bff); }     // 65504
+	static f16 lowest() { return f16::from_bits(0xfbff); }
+	static f16 infinity() { return f16::from_bits(0x7c00); }
+	static f16 quiet_NaN() { return f16::from_bits(0x7e00); }
+};
+
+template<>
+struct std::numeric_limits<bf16> {
+	static constexpr bool is_specialized = true;
+	static constexpr int  digits = 8;
+	static bf16 epsilon() { return bf16::from_bits(0x3c00); } // 2^-7
+	static bf16 min() { return bf16::from_bits(0x0080); }
+	static bf16 max() { return bf16::from_bits(0x7f7f); }
+	static bf16 lowest() { return bf16::from_bits(0xff7f); }
+	static bf16 infinity() { return bf16::from_bits(0x7f80); }
+	static bf16 quiet_NaN() { return bf16::from_bits(0x7fc0); }
+};
@@ -0,0 +1,569 @@
+#pragma once
+
+# include <cerrno>
+# include <cstdint>
+# include <cstdio>
+# include <cstring>
+# include <fstream>
+# include <stdexcept>
+# include <string>
+# include <string_view>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# include "Matrix.hpp"
+# include "Format.hpp"
+
+/**
+ * Binary matrix files : a 64 byte header followed by the elements, in native byte order.
+ *
+ *   offset  size  field
+ *        0     8  magic "MATRIXB\0"
+ *        8     4  byte order mark 0x01020304, read back as another value on a foreign-endian host
+ *       12     2  version (MATRIX_FILE_VERSION)
+ *       14     2  element type (MatrixFileType)
+ *       16     4  element size in bytes
+ *       20     4  layout : 0 column-major, 1 row-major
+ *       24     8  rows
+ *       32     8  cols
+ *       40     8  payload offset, a multiple of 64 so the payload is SIMD-aligned once mapped
+ *       48    16  reserved, zero
+ *
+ * The payload is packed (leading dimension = rows for column-major, cols for row-major), so a mapped file is a
+ * MatrixView with no copy. The writers below always produce column-major files ; row-major files (e.g. written
+ * from C-ordered arrays) are read back as a transposed-stride view.
+ */
+
+inline constexpr uint16_t MATRIX_FILE_VERSION = 1;
+inline constexpr size_t   MATRIX_FILE_ALIGN   = 64;
+
+enum class MatrixFileType : uint16_t { F32 = 1, F64 = 2, C32 = 3, C64 = 4, I32 = 5, I64 = 6 };
+enum class MatrixFileLayout : uint32_t { ColumnMajor = 0, RowMajor = 1 };
+
+struct MatrixFileHeader {
+	char     magic[8]   = { 'M', 'A', 'T', 'R', 'I', 'X', 'B', '\0' };
+	uint32_t bom        = 0x01020304;
+	uint16_t version    = MATRIX_FILE_VERSION;
+	uint16_t type       = 0;
+	uint32_t elem_size  = 0;
+	uint32_t layout     = uint32_t(MatrixFileLayout::ColumnMajor);
+	uint64_t rows       = 0;
+	uint64_t cols       = 0;
+	uint64_t offset     = MATRIX_FILE_ALIGN;
+	uint64_t reserved[2] = { 0, 0 };
+};
+static_assert(sizeof(MatrixFileHeader) == MATRIX_FILE_ALIGN, "The header must fill exactly the first aligned block.");
+
+// Element type tag of T, only defined for the types the format can store
+template<typename T> struct matrix_file_type;
+template<> struct matrix_file_type<float>                { static constexpr MatrixFileType value = MatrixFileType::F32; };
+template<> struct matrix_file_type<double>               { static constexpr MatrixFileType value = MatrixFileType::F64; };
+template<> struct matrix_file_type<std::complex<float>>  { static constexpr MatrixFileType value = MatrixFileType::C32; };
+template<> struct matrix_file_type<std::complex<double>> { static constexpr MatrixFileType value = MatrixFileType::C64; };
+template<> struct matrix_file_type<int32_t>              { static constexpr MatrixFileType value = MatrixFileType::I32; };
+template<> struct matrix_file_type<int64_t>              { static constexpr MatrixFileType value = MatrixFileType::I64; };
+
+# pragma region Utils
+
+[[noreturn]] inline void throw_io_error(const std::string& what, const std::string& path) {
+	throw std::runtime_error(what + " '" + path + "' : " + std::strerror(errno));
+}
+
+/**
+ * @brief Checks that a header describes a file of T elements that fits in file_size bytes.
+ * @param h The header read from the file.
+ * @param file_size The size of the whole file in bytes.
+ * @throw std::invalid_argument If the file is not a matrix file, is foreign-endian, of another version or element
+ *        type, or is truncated.
+ */
+template<typename T>
+void check_header(const MatrixFileHeader& h, uint64_t file_size) {
+	if (std::memcmp(h.magic, MatrixFileHeader().magic, sizeof(h.magic)) != 0)
+		throw std::invalid_argument("Not a matrix file.");
+	if (h.bom != MatrixFileHeader().bom)
+		throw std::invalid_argument("Matrix file was written with another byte order.");
+	if (h.version != MATRIX_FILE_VERSION)
+		throw std::invalid_argument("Unsupported matrix file version.");
+	if (h.type != uint16_t(matrix_file_type<T>::value) || h.elem_size != sizeof(T))
+		throw std::invalid_argument("Matrix file element type does not match.");
+	if (h.layout > uint32_t(MatrixFileLayout::RowMajor))
+		throw std::invalid_argument("Unknown matrix file layout.");
+	if (h.offset < sizeof(MatrixFileHeader) || h.offset % MATRIX_FILE_ALIGN)
+		throw std::invalid_argument("Matrix file payload is misaligned.");
+	if (h.cols && h.rows > (file_size - std::min(file_size, h.offset)) / sizeof(T) / h.cols)
+		throw std::invalid_argument("Matrix file is truncated.");
+}
+
+# pragma endregion
+
+/**
+ * @brief Read-only (T const) or read-write memory mapping of a matrix file.
+ * @details The elements are never copied : view() points straight into the page cache, and pages are only read
+ *          from disk when touched, so opening a 10k x 10k file is O(1). A read-write mapping (T not const) is shared :
+ *          writes through the view land in the file. Movable, not copyable ; the mapping is released on destruction,
+ *          which invalidates every view taken from it.
+ * @tparam T The element type, const-qualified for a read-only mapping, e.g. MappedMatrix<const f32>.
+ */
+template<typename T>
+class MappedMatrix {
+	protected:
+		using U = std::remove_const_t<T>;
+
+		void*            base   = nullptr;
+		size_t           length = 0;
+		MatrixFileHeader header;
+
+		void release() {
+			if (base)
+				munmap(base, length);
+			base   = nullptr;
+			length = 0;
+		}
+
+	public:
+		MappedMatrix() = default;
+
+		/**
+		 * @brief Maps a matrix file.
+		 * @param path The file to map.
+		 * @throw std::runtime_error If the file cannot be opened or mapped.
+		 * @throw std::invalid_argument If the file is not a valid matrix file of T elements.
+		 * @note Time complexity : O(1)
+		 * @note Space complexity : O(1), the pages are loaded on demand
+		 */
+		explicit MappedMatrix(const std::string& path) {
+			constexpr bool writable = !std::is_const_v<T>;
+
+			const int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+			if (fd < 0)
+				throw_io_error("Cannot open matrix file", path);
+
+			struct stat st;
+			if (fstat(fd, &st) < 0) {
+				const int error = errno;
+				::close(fd);
+				errno = error;
+				throw_io_error("Cannot stat matrix file", path);
+			}
+			if (size_t(st.st_size) < sizeof(MatrixFileHeader)) {
+				::close(fd);
+				throw std::invalid_argument("Not a matrix file.");
+			}
+
+			length = size_t(st.st_size);
+			base   = mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd); // The mapping keeps its own reference to the file
+			if (base == MAP_FAILED) {
+				base = nullptr;
+				throw_io_error("Cannot map matrix file", path);
+			}
+
+			std::memcpy(&header, base, sizeof(header));
+			try {
+				check_header<U>(header, length);
+			} catch (...) {
+				release();
+				throw;
+			}
+		}
+
+		MappedMatrix(const MappedMatrix&) = delete;
+		MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+		MappedMatrix(MappedMatrix&& other) noexcept
+			: base(std::exchange(other.base, nullptr)), length(std::exchange(other.length, 0)), header(other.header) {}
+
+		MappedMatrix& operator=(MappedMatrix&& other) noexcept {
+			if (this != &other) {
+				release();
+				base   = std::exchange(other.base, nullptr);
+				length = std::exchange(other.length, 0);
+				header = other.header;
+			}
+			return *this;
+		}
+
+		~MappedMatrix() { release(); }
+
+		# pragma region Utils
+
+		inline size_t rows() const { return base ? size_t(header.rows) : 0; }
+		inline size_t cols() const { return base ? size_t(header.cols) : 0; }
+		inline std::pair<size_t, size_t> shape() const { return { rows(), cols() }; }
+		inline bool is_open() const { return base != nullptr; }
+
+		/**
+		 * @brief Views the mapped elements, with the strides of the file layout.
+		 * @return MatrixView<T> The view, valid as long as this mapping.
+		 * @note Time complexity : O(1)
+		 */
+		MatrixView<T> view() const {
+			if (!base)
+				return MatrixView<T>();
+
+			T* data = reinterpret_cast<T*>(static_cast<char*>(base) + header.offset);
+			if (header.layout == uint32_t(MatrixFileLayout::RowMajor))
+				return MatrixView<T>(data, rows(), cols(), cols(), 1);
+			return MatrixView<T>(data, rows(), cols());
+		}
+
+		/**
+		 * @brief Hints the kernel about the upcoming access pattern, e.g. MADV_SEQUENTIAL before a full scan.
+		 * @param advice One of the madvise advices.
+		 */
+		void advise(int advice) const {
+			if (base)
+				madvise(base, length, advice);
+		}
+
+		# pragma endregion
+};
+
+/**
+ * @brief Writes a matrix file column by column, without ever holding the whole matrix in memory.
+ * @details The number of rows is fixed up front, columns are appended one at a time or by blocks, and the header
+ *          gets the final number of columns on close(). Matrices larger than RAM can be produced block by block
+ *          and mapped back with MappedMatrix. The destructor closes the file but swallows errors : call close()
+ *          to get them.
+ * @tparam T The element type.
+ */
+template<typename T>
+class MatrixWriter {
+	protected:
+		std::FILE*       file = nullptr;
+		std::string      path;
+		MatrixFileHeader header;
+
+		void write_bytes(const void* bytes, size_t size) {
+			if (std::fwrite(bytes, 1, size, file) != size)
+				throw_io_error("Cannot write matrix file", path);
+		}
+
+	public:
+		/**
+		 * @brief Creates (or truncates) a matrix file.
+		 * @param path The file to write.
+		 * @param rows The size of every column.
+		 * @throw std::runtime_error If the file cannot be created.
+		 */
+		MatrixWriter(const std::string& path, size_t rows) : path(path) {
+			header.type      = uint16_t(matrix_file_type<T>::value);
+			header.elem_size = sizeof(T);
+			header.rows      = rows;
+
+			file = std::fopen(path.c_str(), "wb");
+			if (!file)
+				throw_io_error("Cannot create matrix file", path);
+			std::setvbuf(file, nullptr, _IOFBF, size_t(1) << 20);
+
+			try {
+				write_bytes(&header, sizeof(header)); // Rewritten with the final shape on close
+			} catch (...) {
+				std::fclose(file);
+				file = nullptr;
+				throw;
+			}
+		}
+
+		MatrixWriter(const MatrixWriter&) = delete;
+		MatrixWriter& operator=(const MatrixWriter&) = delete;
+
+		~MatrixWriter() {
+			try {
+				close();
+			} catch (...) {}
+		}
+
+		/**
+		 * @brief Appends one column.
+		 * @param column The column, of rows() elements.
+		 * @throw std::invalid_argument If the column size does not match.
+		 * @throw std::logic_error If the writer is closed.
+		 * @throw std::runtime_error If the write fails.
+		 */
+		void append(const VectorView<const T>& column) {
+			if (!file)
+				throw std::logic_error("Matrix writer is closed.");
+			if (column.size() != header.rows)
+				throw std::invalid_argument("Column size must match the matrix rows.");
+
+			if (column.stride() == 1)
+				write_bytes(column.data(), column.size() * sizeof(T));
+			else
+				for (const T& value : column)
+					write_bytes(&value, sizeof(T));
+			header.cols++;
+		}
+
+		/**
+		 * @brief Appends every column of a block.
+		 * @param block The columns, of rows() elements each.
+		 * @throw std::invalid_argument If the block rows do not match.
+		 * @note Time complexity : O(block.rows() * block.cols())
+		 * @note Space complexity : O(1)
+		 */
+		void append(const MatrixView<const T>& block) {
+			if (block.rows() != header.rows)
+				throw std::invalid_argument("Block rows must match the matrix rows.");
+			for (size_t c = 0; c < block.cols(); c++)
+				append(block[c]);
+		}
+
+		/**
+		 * @brief Writes the final header and closes the file. Does nothing if already closed.
+		 * @throw std::runtime_error If the file cannot be flushed.
+		 */
+		void close() {
+			if (!file)
+				return;
+
+			std::FILE* f = std::exchange(file, nullptr);
+			const bool ok = std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, f) == 1;
+			if (std::fclose(f) != 0 || !ok)
+				throw_io_error("Cannot write matrix file", path);
+		}
+
+		# pragma region Utils
+
+		inline size_t rows() const { return size_t(header.rows); }
+		inline size_t cols() const { return size_t(header.cols); }
+
+		# pragma endregion
+};
+
+/**
+ * @brief Writes a matrix (or any view of one) to a binary matrix file.
+ * @param path The file to write.
+ * @param m The matrix to write, stored column-major in the file.
+ * @throw std::runtime_error If the file cannot be written.
+ * @note Time complexity : O(m.rows() * m.cols())
+ * @note Space complexity : O(1)
+ */
+template<typename T>
+void save(const std::string& path, const MatrixView<T>& m) {
+	MatrixWriter<std::remove_const_t<T>> writer(path, m.rows());
+	writer.append(m);
+	writer.close();
+}
+
+template<typename T>
+void save(const std::string& path, const Matrix<T>& m) { save(path, m.view()); }
+
+/**
+ * @brief Reads a binary matrix file into an owning matrix.
+ * @details Use MappedMatrix instead to work on the file without reading it all.
+ * @param path The file to read.
+ * @return Matrix<T> The matrix.
+ * @throw std::runtime_error If the file cannot be read.
+ * @throw std::invalid_argument If the file is not a valid matrix file of T elements.
+ * @note Time complexity : O(rows * cols)
+ * @note Space complexity : O(rows * cols)
+ */
+template<typename T>
+Matrix<T> load(const std::string& path) {
+	MappedMatrix<const T> mapped(path);
+	mapped.advise(MADV_SEQUENTIAL);
+	return Matrix<T>(mapped.view());
+}
+
+/**
+ * Text matrix files : one row per line, values separated by commas and / or blanks, as display_linux reads its
+ * `proj` file. Numbers go through from_chars / to_chars, so they do not depend on the locale, and write_text uses
+ * the shortest representation that reads back to the same value.
+ */
+
+# pragma region Utils
+
+// A non-blank line of a text matrix, with its 1-based number for error messages
+struct TextLine {
+	const char* begin;
+	const char* end;
+	size_t      number;
+};
+
+inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+/**
+ * @brief Parses the values of one line.
+ * @param line The line to parse.
+ * @param out Where value c goes (out[c * stride]), or nullptr to only count the values.
+ * @param stride The distance between two written values.
+ * @param expected The number of values the line must hold, 0 for any.
+ * @return size_t The number of values on the line.
+ * @throw std::invalid_argument If a value is malformed or the count differs from expected.
+ */
+template<typename T>
+size_t parse_line(const TextLine& line, T* out, size_t stride, size_t expected) {
+	const char* p = line.begin;
+	size_t      n = 0;
+
+	while (true) {
+		while (p < line.end && is_blank(*p))
+			p++;
+		if (p == line.end)
+			break;
+
+		T value;
+		const char* next = parse_value(p, line.end, value);
+		if (!next || (next < line.end && !is_blank(*next) && *next != ','))
+			throw std::invalid_argument("Invalid value at line " + std::to_string(line.number) + ", column " + std::to_string(p - line.begin + 1) + ".");
+		if (expected && n == expected)
+			break; // One value too many
+		if (out)
+			out[n * stride] = value;
+		n++;
+
+		p = next;
+		while (p < line.end && is_blank(*p))
+			p++;
+		if (p < line.end && *p == ',')
+			p++;
+	}
+
+	if (expected && (n != expected || p != line.end))
+		throw std::invalid_argument("Line " + std::to_string(line.number) + " does not have " + std::to_string(expected) + " values.");
+	return n;
+}
+
+# pragma endregion
+
+/**
+ * @brief Parses a text matrix.
+ * @details The line boundaries are found first (memchr), then the rows are parsed straight into the matrix,
+ *          spread over the thread pool for large inputs (see tuning.execution). Blank lines are ignored.
+ * @param text The text, e.g. "1, 0\n0, 1\n".
+ * @return Matrix<T> The matrix, with one row per non-blank line.
+ * @throw std::invalid_argument If a value is malformed or the lines do not all have the same number of values.
+ * @note Time complexity : O(text.size())
+ * @note Space complexity : O(rows) besides the result
+ */
+template<typename T>
+Matrix<T> parse_text(std::string_view text) {
+	std::vector<TextLine> lines;
+	const char* p   = text.data();
+	const char* end = p + text.size();
+
+	for (size_t number = 1; p < end; number++) {
+		const char* eol = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+		if (!eol)
+			eol = end;
+		if (std::find_if_not(p, eol, is_blank) != eol)
+			lines.push_back({ p, eol, number });
+		p = eol + 1;
+	}
+	if (lines.empty())
+		return Matrix<T>();
+
+	const size_t cols = parse_line<T>(lines[0], nullptr, 0, 0);
+	Matrix<T>    result(cols, lines.size());
+	T*           data = result.ptr();
+	const size_t ld   = result.ld();
+
+	parallel_for(0, lines.size(), text.size() / lines.size() + 1, [&](size_t lo, size_t hi) {
+		for (size_t r = lo; r < hi; r++)
+			parse_line(lines[r], data + r, ld, cols);
+	});
+	return result;
+}
+
+/**
+ * @brief Writes a matrix as text, one row per line in the `proj` format ("1, 0\n0, 1\n").
+ * @details Values are formatted with to_chars into a local buffer that goes to the stream in large writes ; a
+ *          precision too large for it gets a heap buffer holding one element.
+ * @param os The stream to write to.
+ * @param m The matrix (or any view of one) to write.
+ * @param precision The significant digits, or -1 (default) for the shortest round-trip representation.
+ * @note Time complexity : O(m.rows() * m.cols())
+ * @note Space complexity : O(1)
+ */
+template<typename T>
+void write_text(std::ostream& os, const MatrixView<T>& m, int precision = -1) {
+	char              local[1 << 16];
+	std::vector<char> heap;
+	const size_t      need = format_room<std::remove_const_t<T>>(precision) + 2; // One element and ", "
+	char*             buffer = local;
+	size_t            size = sizeof(local);
+
+	if (need > size) {
+		heap.resize(need);
+		buffer = heap.data();
+		size   = need;
+	}
+
+	char* out = buffer;
+	for (size_t r = 0; r < m.rows(); r++) {
+		for (size_t c = 0; c < m.cols(); c++) {
+			if (out + need > buffer + size) {
+				os.write(buffer, out - buffer);
+				out = buffer;
+			}
+			out = format_value(out, buffer + size, m[c][r], precision);
+			if (c + 1 < m.cols()) {
+				*out++ = ',';
+				*out++ = ' ';
+			}
+		}
+		if (out == buffer + size) {
+			os.write(buffer, out - buffer);
+			out = buffer;
+		}
+		*out++ = '\n';
+	}
+	os.write(buffer, out - buffer);
+}
+
+template<typename T>
+void write_text(std::ostream& os, const Matrix<T>& m, int precision = -1) { write_text(os, m.view(), precision); }
+
+/**
+ * @brief Writes a matrix to a text file.
+ * @see write_text
+ * @throw std::runtime_error If the file cannot be written.
+ */
+template<typename M>
+void save_text(const std::string& path, const M& m, int precision = -1) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+		throw_io_error("Cannot create matrix file", path);
+	write_text(file, m, precision);
+	file.close();
+	if (!file)
+		throw_io_error("Cannot write matrix file", path);
+}
+
+/**
+ * @brief Reads a text matrix file, e.g. display_linux/proj.
+ * @details The file is read in 1 MiB chunks into one buffer, then parsed in parallel with parse_text.
+ * @param path The file to read.
+ * @return Matrix<T> The matrix.
+ * @throw std::runtime_error If the file cannot be read.
+ * @throw std::invalid_argument If the text is not a valid matrix.
+ * @note Time complexity : O(file size)
+ * @note Space complexity : O(file size)
+ */
+template<typename T>
+Matrix<T> load_text(const std::string& path) {
+	std::FILE* file = std::fopen(path.c_str(), "rb");
+	if (!file)
+		throw_io_error("Cannot open matrix file", path);
+
+	constexpr size_t chunk = size_t(1) << 20;
+	std::string      text;
+	struct stat      st;
+	if (fstat(fileno(file), &st) == 0 && st.st_size > 0)
+		text.reserve(size_t(st.st_size) + chunk);
+
+	for (size_t n = chunk; n == chunk;) {
+		const size_t size = text.size();
+		text.resize(size + chunk);
+		n = std::fread(text.data() + size, 1, chunk, file);
+		text.resize(size + n);
+	}
+
+	const bool failed = std::ferror(file);
+	std::fclose(file);
+	if (failed)
+		throw_io_error("Cannot read matrix file", path);
+	return parse_text<T>(text);
+}
@@ -0,0 +1,426 @@
+#pragma once
+
+# include "Vector.hpp"
+# include "Matrix.hpp"
+
+/**
+ * @brief Estimates the 1-norm of the inverse of a matrix, using only solves with it (Hager, refined by Higham).
+ * @details This is the estimator behind LAPACK's xLACON : a few steps of a gradient ascent of ||A^-1 x||_1 over the
+ *          unit ball, followed by one extra test vector that catches the cases the ascent misses. The result is a
+ *          lower bound, in practice almost always within a factor 3 of the exact norm.
+ * @tparam T The type of the elements in the matrix.
+ * @param n The size of the matrix.
+ * @param solve Callable replacing its Vector<T>& argument x by A^-1 * x.
+ * @param solve_t Callable replacing its Vector<T>& argument x by A^-T * x.
+ * @return TO_REAL<T> The estimate of ||A^-1||_1.
+ * @note Time complexity : O(n^2) at most 6 pairs of solves
+ * @note Space complexity : O(n)
+ * @note Allowed math functions : fma, pow
+ *
+ * @see https://doi.org/10.1145/50063.214386
+ */
+template<typename T, typename F, typename G>
+TO_REAL<T> inverse_norm1(size_t n, const F& solve, const G& solve_t) {
+	using R = TO_REAL<T>;
+
+	if (n == 0)
+		return R(0);
+
+	auto conj = [](const T& v) -> T {
+		if constexpr (IS_COMPLEX(T))
+			return T(v.real(), -v.imag());
+		else
+			return v;
+	};
+	auto norm1 = [&](const Vector<T>& v) {
+		R sum = R(0);
+		for (size_t i = 0; i < n; i++)
+			sum += magnitude(v[i]);
+		return sum;
+	};
+
+	Vector<T> x(n), z(n);
+	for (size_t i = 0; i < n; i++)
+		x[i] = T(R(1) / R(n));
+
+	R      estimate = R(0);
+	size_t last = n;
+
+	for (size_t iter = 0; iter < 5; iter++) {
+		Vector<T> y = x;
+		solve(y);
+
+		const R norm = norm1(y);
+		if (iter > 0 && norm <= estimate)
+			break;
+		estimate = norm;
+
+		// z = A^-H * sign(y), the gradient of ||A^-1 x||_1 at x
+		for (size_t i = 0; i < n; i++) {
+			const R a = magnitude(y[i]);
+			z[i] = (a == R(0)) ? T(1) : conj(y[i] / T(a));
+		}
+		solve_t(z);
+
+		size_t j = 0;
+		for (size_t i = 1; i < n; i++)
+			if (magnitude(z[i]) > magnitude(z[j]))
+				j = i;
+
+		if (last < n && magnitude(z[j]) <= magnitude(z[last])) // No better vertex of the unit ball
+			break;
+		last = j;
+
+		for (size_t i = 0; i < n; i++)
+			x[i] = T(i == j ? 1 : 0);
+	}
+
+	// Alternating test vector
+	for (size_t i = 0; i < n; i++)
+		x[i] = T(R(i % 2 ? -1 : 1) * (R(1) + R(i) / R(n > 1 ? n - 1 : 1)));
+	solve(x);
+
+	return std::max(estimate, R(2) * norm1(x) / R(3 * n));
+}
+
+/**
+ * @brief LU factorization with partial pivoting (P * A = L * U) of a square matrix.
+ * @details The elimination is done once, at construction; the factors then answer det(), solve() and inverse()
+ *          in O(n^2) per right-hand side. L (unit diagonal, not stored) and U share one column-major buffer,
+ *          like LAPACK's getrf, and the trailing updates are split over columns on the thread pool.
+ *          A zero pivot does not throw : the matrix is flagged singular, det() returns 0 and solving throws.
+ * @tparam T The type of the elements in the matrix.
+ *
+ * @see https://en.wikipedia.org/wiki/LU_decomposition
+ */
+template<typename T>
+class LU {
+	protected:
+		Matrix<T>           lu;        // L below the diagonal, U on and above it
+		std::vector<size_t> perm;      // Row i of P * A is row perm[i] of A
+		TO_REAL<T>          anorm = 0; // 1-norm of A, for rcond()
+		bool                odd_swaps = false;
+		bool                singular = false;
+
+		void check_solvable(size_t rhs_size) const {
+			if (rhs_size != size())
+				throw std::invalid_argument("Right-hand side size must match the matrix size.");
+			if (singular)
+				throw std::logic_error("Matrix is singular and cannot be inverted.");
+		}
+
+		void substitute(T* x) const { substitute(lu.view(), x); }
+		void substitute_t(T* x) const { substitute_t(lu.view(), x); }
+
+	public:
+		/**
+		 * @brief Factorizes a square matrix.
+		 * @param a The matrix to factorize, moved in to factorize in its storage (LU(std::move(m))).
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @note Time complexity : O(n^3)
+		 * @note Space complexity : O(n^2), O(n) when the matrix is moved in
+		 * @note Allowed math functions : None
+		 */
+		LU(Matrix<T> a) : lu(std::move(a)), perm(lu.rows()) {
+			if (!lu.is_square())
+				throw std::invalid_argument("LU factorization can only be computed on square matrix.");
+
+			const size_t n = size();
+			for (size_t c = 0; c < n; c++) {
+				TO_REAL<T> sum = 0;
+				for (size_t r = 0; r < n; r++)
+					sum += magnitude(lu[c][r]);
+				anorm = std::max(anorm, sum);
+			}
+
+			singular = !factor(lu.view(), perm.data(), odd_swaps);
+		}
+
+		# pragma region Kernels
+
+		/**
+		 * @brief Factorizes a square column-major matrix in place, without allocating : the kernel behind LU<T>,
+		 *        also run by determinant() and inverse() on workspace storage.
+		 * @param a The matrix, replaced by its packed factors. Must be column-major (a.is_column_major()).
+		 * @param perm Receives the row permutation, a.rows() entries.
+		 * @param odd_swaps Receives whether an odd number of rows were swapped.
+		 * @return true If every pivot is nonzero, false if the matrix is singular.
+		 * @note Time complexity : O(n^3)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : fma
+		 */
+		static bool factor(const MatrixView<T>& a, size_t* perm, bool& odd_swaps) {
+			const size_t n = a.rows();
+			bool regular = true;
+
+			odd_swaps = false;
+			for (size_t i = 0; i < n; i++)
+				perm[i] = i;
+
+			for (size_t j = 0; j < n; j++) {
+				T* col = a[j].data();
+
+				// Partial pivoting : largest magnitude in the column
+				size_t p = j;
+				for (size_t i = j + 1; i < n; i++)
+					if (magnitude(col[i]) > magnitude(col[p]))
+						p = i;
+
+				if (col[p] == T(0)) {
+					regular = false;
+					continue;
+				}
+
+				if (p != j) {
+					for (size_t k = 0; k < n; k++)
+						std::swap(a[k][j], a[k][p]);
+					std::swap(perm[j], perm[p]);
+					odd_swaps = !odd_swaps;
+				}
+
+				// Multipliers, then rank-1 update of the trailing columns
+				const T pivot = col[j];
+				for (size_t i = j + 1; i < n; i++)
+					col[i] /= pivot;
+
+				parallel_for(j + 1, n, 2 * (n - j), [&](size_t lo, size_t hi) {
+					for (size_t k = lo; k < hi; k++) {
+						T*      dst = a[k].data();
+						const T ujk = dst[j];
+
+						for (size_t i = j + 1; i < n; i++) {
+							if constexpr (IS_ARITHMETIC(T))
+								dst[i] = std::fma(-col[i], ujk, dst[i]);
+							else
+								dst[i] -= col[i] * ujk;
+						}
+					}
+				});
+			}
+
+			return regular;
+		}
+
+		/**
+		 * @brief Solves L * U * x = pb in place (pb already permuted), column-oriented.
+		 * @param lu The packed factors.
+		 * @param x The permuted right-hand side, replaced by the solution.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(1)
+		 */
+		static void substitute(const MatrixView<const T>& lu, T* x) {
+			const size_t n = lu.rows();
+
+			for (size_t k = 0; k < n; k++) { // L y = Pb, L has a unit diagonal
+				const T* l = lu[k].data();
+				for (size_t i = k + 1; i < n; i++)
+					x[i] -= l[i] * x[k];
+			}
+			for (size_t k = n; k-- > 0;) {   // U x = y
+				const T* u = lu[k].data();
+				x[k] /= u[k];
+				for (size_t i = 0; i < k; i++)
+					x[i] -= u[i] * x[k];
+			}
+		}
+
+		/**
+		 * @brief Solves U^T * L^T * z = b in place, z being P * x, row-oriented.
+		 * @param lu The packed factors.
+		 * @param x The right-hand side, replaced by z.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(1)
+		 */
+		static void substitute_t(const MatrixView<const T>& lu, T* x) {
+			const size_t n = lu.rows();
+
+			for (size_t k = 0; k < n; k++) { // U^T y = b, column k of U is row k of U^T
+				const T* u = lu[k].data();
+				T acc = x[k];
+				for (size_t i = 0; i < k; i++)
+					acc -= u[i] * x[i];
+				x[k] = acc / u[k];
+			}
+			for (size_t k = n; k-- > 0;) {   // L^T z = y
+				const T* l = lu[k].data();
+				T acc = x[k];
+				for (size_t i = k + 1; i < n; i++)
+					acc -= l[i] * x[i];
+				x[k] = acc;
+			}
+		}
+
+		/**
+		 * @brief Writes the inverse of a factorized matrix, one identity column per tile of the thread pool.
+		 * @param lu The packed factors.
+		 * @param perm The row permutation.
+		 * @param x The output, of the same size as lu. Must be column-major and not overlap lu.
+		 * @note Time complexity : O(n^3)
+		 * @note Space complexity : O(1)
+		 */
+		static void invert(const MatrixView<const T>& lu, const size_t* perm, const MatrixView<T>& x) {
+			const size_t n = lu.rows();
+
+			parallel_for(0, n, 2 * n * n, [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++) {
+					T* dst = x[c].data();
+					for (size_t i = 0; i < n; i++)
+						dst[i] = (perm[i] == c) ? T(1) : T(0);
+					substitute(lu, dst);
+				}
+			});
+		}
+
+		# pragma endregion
+
+		/**
+		 * @brief Returns the size of the factorized matrix.
+		 * @return size_t The number of rows (and columns).
+		 */
+		inline size_t size() const { return lu.rows(); }
+
+		/**
+		 * @brief Checks whether a zero pivot was met.
+		 * @return true If the matrix is singular.
+		 */
+		inline bool is_singular() const { return singular; }
+
+		/**
+		 * @brief Returns the packed factors : L below the diagonal (unit diagonal implied), U on and above it.
+		 * @return const Matrix<T>& The factors.
+		 */
+		inline const Matrix<T>& factors() const { return lu; }
+
+		/**
+		 * @brief Returns the row permutation : row i of P * A is row permutation()[i] of A.
+		 * @return const std::vector<size_t>& The permutation.
+		 */
+		inline const std::vector<size_t>& permutation() const { return perm; }
+
+		/**
+		 * @brief Computes the determinant from the factors.
+		 * @return T The determinant, (-1)^swaps * product of the pivots.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 */
+		T det() const {
+			if (singular)
+				return T(0);
+
+			T result = odd_swaps ? T(-1) : T(1);
+			for (size_t i = 0; i < size(); i++)
+				result *= lu[i][i];
+
+			return result;
+		}
+
+		/**
+		 * @brief Solves the system for one right-hand side.
+		 * @details Same convention as Matrix<T>::mul_vec : returns x such that A.mul_vec(x) == b,
+		 *          i.e. the result of A.inverse().mul_vec(b), without forming the inverse.
+		 *          With A^T = U^T * L^T * P, this is a forward substitution with U^T, then a backward one with L^T.
+		 * @param b The right-hand side.
+		 * @return Vector<T> The solution x.
+		 * @throw std::invalid_argument If b does not match the matrix size.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : None
+		 */
+		Vector<T> solve(const Vector<T>& b) const {
+			check_solvable(b.size());
+
+			const size_t n = size();
+			Vector<T> y(b);
+			substitute_t(y.ptr());
+
+			Vector<T> x(n);
+			for (size_t i = 0; i < n; i++)
+				x[perm[i]] = y[i];
+
+			return x;
+		}
+
+		/**
+		 * @brief Solves the system for several right-hand sides.
+		 * @details Same convention as Matrix<T>::mul_mat : returns X such that A.mul_mat(X) == B,
+		 *          i.e. the result of A.inverse().mul_mat(B). Columns of B are solved in parallel.
+		 * @param b The right-hand sides, one per column.
+		 * @return Matrix<T> The solutions, one per column.
+		 * @throw std::invalid_argument If B rows do not match the matrix size.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n^2 * k) with k the number of columns of B
+		 * @note Space complexity : O(n * k)
+		 * @note Allowed math functions : None
+		 */
+		Matrix<T> solve(const Matrix<T>& b) const {
+			check_solvable(b.rows());
+
+			const size_t n = size();
+			Matrix<T> x(b.cols(), n);
+
+			parallel_for(0, b.cols(), 2 * n * n, [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++) {
+					T* dst = x.col_ptr(c);
+					for (size_t i = 0; i < n; i++)
+						dst[i] = b[c][perm[i]];
+					substitute(dst);
+				}
+			});
+
+			return x;
+		}
+
+		/**
+		 * @brief Computes the inverse of the factorized matrix.
+		 * @details Solves A * X = I, one column per identity column, in parallel.
+		 * @return Matrix<T> The inverse.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n^3)
+		 * @note Space complexity : O(n^2)
+		 * @note Allowed math functions : None
+		 */
+		Matrix<T> inverse() const {
+			check_solvable(size());
+
+			Matrix<T> x(size(), size());
+			invert(lu.view(), perm.data(), x.view());
+			return x;
+		}
+
+		/**
+		 * @brief Estimates the reciprocal condition number of the matrix in the 1-norm.
+		 * @details 1 / (||A||_1 * ||A^-1||_1), with ||A^-1||_1 estimated from the factors (see inverse_norm1).
+		 *          Close to 1 for a well-conditioned matrix; about 1e-7 (f32) or 1e-16 (double) means the solutions
+		 *          have no correct digit left.
+		 * @return TO_REAL<T> The estimate, 0 if the matrix is singular.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : fma, pow
+		 */
+		TO_REAL<T> rcond() const {
+			using R = TO_REAL<T>;
+
+			if (singular || anorm == R(0))
+				return R(0);
+
+			const size_t n = size();
+			const R inv = inverse_norm1<T>(n,
+				[&](Vector<T>& x) { // A^-1 x : permute, then L U
+					Vector<T> p(n);
+					for (size_t i = 0; i < n; i++)
+						p[i] = x[perm[i]];
+					substitute(p.ptr());
+					x = p;
+				},
+				[&](Vector<T>& x) { // A^-T x : U^T L^T, then permute back
+					substitute_t(x.ptr());
+					Vector<T> p(n);
+					for (size_t i = 0; i < n; i++)
+						p[perm[i]] = x[i];
+					x = p;
+				});
+
+			return R(1) / (anorm * inv);
+		}
+};
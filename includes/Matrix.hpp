@@ -1,45 +1,131 @@
 #pragma once
 
+# include <limits>
 # include "config.hpp"
+# include "simd.hpp"
+# include "View.hpp"
+# include "Format.hpp"
+# include "Workspace.hpp"
+# include "Small.hpp"
+# include "gemm.hpp"
+# include "Expr.hpp"
+# include "ThreadPool.hpp"
+
+/**
+ * @brief Pivot search of the row reductions (see Matrix<T>::rref()).
+ * @details Partial takes the largest magnitude of the pivot column, Complete the largest of the whole trailing block.
+ */
+enum class Pivoting { Partial, Complete };
+
+/**
+ * @brief Result of Matrix<T>::rref() : the reduced form and what the elimination found on the way.
+ * @tparam T The type of the elements in the matrix.
+ */
+template<typename T>
+struct Echelon {
+	Matrix<T>           reduced;       // Reduced Row Echelon Form of A, of A * Q with complete pivoting
+	std::vector<size_t> pivots;        // Column of the pivot of each nonzero row, rank entries
+	std::vector<size_t> rows;          // Row i of the elimination is row rows[i] of A (P)
+	std::vector<size_t> cols;          // Column j of reduced is column cols[j] of A (Q), the identity with partial pivoting
+	size_t              rank = 0;
+	TO_REAL<T>          tolerance = 0; // Magnitude under which entries were taken as zero
+};
 
 /**
  * @brief Represents a mathematical matrix of m x n dimensions.
  * @tparam T The type of the elements in the matrix.
- * @note The matrix is stored in column-major order.
+ * @note The matrix is stored in column-major order, in a single contiguous buffer.
+ *       Column c starts at offset c * ld(), so the buffer can be handed as-is to BLAS-like code.
+ * @note This is the run-time sized matrix, see Fixed.hpp for Matrix<T, R, C>.
+ * @note Large operations split their work over column tiles on the global ThreadPool (see tuning.execution).
  */
 template<typename T>
-class Matrix {
+class Matrix<T, DYNAMIC, DYNAMIC> {
 	protected:
-		std::vector<Vector<T>> data;
+		std::vector<T> data;   // Column-major elements
+		size_t n_rows = 0;
+		size_t n_cols = 0;
+		size_t stride = 0;     // Leading dimension : distance between the start of two columns
+
+		// Side of the blocks of the transposes : 1 KB column runs keep the prefetchers streaming, a staged block stays in L2
+		static constexpr size_t TRANSPOSE_BLOCK = std::max<size_t>(16, 1024 / sizeof(T));
 
 		/**
-		 * @brief Computes the absolute value of a number.
-		 * @details Works for both real and complex numbers.
-		 * @param v The value to compute the absolute value for.
-		 * @return The absolute value of v, as a real number.
-		 * @throw std::invalid_argument If the type T is neither arithmetic nor complex.
-		 * @note Time complexity : O(1)
-		 * @note Space complexity : O(1)
-		 * @note Allowed math functions : fma, pow
+		 * @brief Transposes the column-major rows x cols block src into the cols x rows block dst.
+		 * @details float and double go through the in-register tiles of the SIMD kernels, other types element by element.
 		 */
-		inline auto abs(const T& v) const {
-			using R = TO_REAL<T>;
-			
-			if constexpr (IS_ARITHMETIC(T))
-				return (v < R(0)) ? -v : v;
-			else if constexpr (IS_COMPLEX(T))
-				return std::pow(std::fma(v.real(), v.real(), v.imag() * v.imag()), R(0.5)); // sqrt(real² + imag²)
+		static void transpose_block(const T* src, size_t lds, T* dst, size_t ldd, size_t rows, size_t cols) {
+			if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
+				simd<T>().transpose(src, lds, dst, ldd, rows, cols);
 			else
-				throw std::invalid_argument("Cannot compute abs with the given type.");
+				for (size_t c = 0; c < cols; c++)
+					for (size_t r = 0; r < rows; r++)
+						dst[r * ldd + c] = src[c * lds + r];
+		}
+
+		/**
+		 * @brief Transposes a rectangular matrix over its own storage by following the cycles of the permutation.
+		 * @details Element i = c * m + r moves to r * n + c. Each cycle is walked once from its first element, carrying
+		 *          one value, and a bit per element marks the ones already in place. A padded storage (ld() > rows())
+		 *          does not permute this way and is transposed out of place instead.
+		 * @note Time complexity : O(m*n)
+		 * @note Space complexity : O(m*n) bits from the workspace
+		 */
+		void transpose_cycles() {
+			if (ld() != rows()) {
+				*this = std::as_const(*this).transpose();
+				return;
+			}
+
+			const size_t     m = rows(), n = cols(), count = m * n;
+			Workspace&       ws = Workspace::local();
+			Workspace::Scope scope(ws);
+			uint64_t*        done = ws.alloc<uint64_t>((count + 63) / 64);
+			T*               a = data.data();
+
+			std::fill(done, done + (count + 63) / 64, uint64_t(0));
+			for (size_t start = 1; start + 1 < count; start++) { // The first and last elements never move
+				if ((done[start >> 6] >> (start & 63)) & 1)
+					continue;
+
+				T      carry = a[start];
+				size_t i = start;
+				do {
+					const size_t j = (i % m) * n + i / m;
+					std::swap(carry, a[j]);
+					done[j >> 6] |= uint64_t(1) << (j & 63);
+					i = j;
+				} while (i != start);
+			}
+
+			std::swap(n_rows, n_cols);
+			stride = n_rows;
 		}
 
 	public:
 		Matrix() = default;
-		Matrix(const T& value) { // Identity matrix
-			data = {{ value, 0, 0, 0 },
-					{ 0, value, 0, 0 },
-					{ 0, 0, value, 0 },
-					{ 0, 0, 0, value }};
+		Matrix(const Matrix<T>&) = default;
+		Matrix<T>& operator=(const Matrix<T>&) = default;
+
+		/**
+		 * @brief Takes over the buffer of another matrix.
+		 * @details The source is left as an empty 0 x 0 matrix, instead of keeping a shape that no longer has storage.
+		 * @param other The matrix to move from.
+		 */
+		Matrix(Matrix<T>&& other) noexcept
+			: data(std::move(other.data)), n_rows(std::exchange(other.n_rows, 0)), n_cols(std::exchange(other.n_cols, 0)), stride(std::exchange(other.stride, 0)) {}
+
+		Matrix<T>& operator=(Matrix<T>&& other) noexcept {
+			data   = std::move(other.data);
+			n_rows = std::exchange(other.n_rows, 0);
+			n_cols = std::exchange(other.n_cols, 0);
+			stride = std::exchange(other.stride, 0);
+			return *this;
+		}
+
+		Matrix(const T& value) : Matrix(4, 4) { // Identity matrix
+			for (size_t i = 0; i < 4; i++)
+				(*this)[i][i] = value;
 		}
 		Matrix(std::initializer_list<Vector<T>> rows) {
 			if (!rows.size()) return;
@@ -47,7 +133,7 @@ class Matrix {
 			size_t c = rows.begin()->size(); // Columns size
 			size_t r = rows.size();          // Rows size
 
-			data.assign(c, Vector<T>(r));
+			*this = Matrix<T>(c, r);
 
 			size_t i = 0;
 			for (const Vector<T>& row : rows) {
@@ -55,13 +141,87 @@ class Matrix {
 					throw std::invalid_argument("All rows must have the same size.");
 
 				for (size_t j = 0; j < c; j++)
-					data[j][i] = row[j];
+					(*this)[j][i] = row[j];
 					
 				i++;
 			}
 		}
-		Matrix(std::vector<Vector<T>> other) : data(other) {}
-		Matrix(const size_t& cols, const size_t& rows) : data(cols, Vector<T>(rows)) {}
+		Matrix(const std::vector<Vector<T>>& columns) {
+			if (columns.empty()) return;
+
+			*this = Matrix<T>(columns.size(), columns[0].size());
+
+			for (size_t c = 0; c < cols(); c++) {
+				if (columns[c].size() != rows())
+					throw std::invalid_argument("All columns must have the same size.");
+
+				for (size_t r = 0; r < rows(); r++)
+					(*this)[c][r] = columns[c][r];
+			}
+		}
+		Matrix(const size_t& cols, const size_t& rows) : data(cols * rows), n_rows(rows), n_cols(cols), stride(rows) { PROFILE_ALLOC(cols * rows * sizeof(T)); }
+
+		/**
+		 * @brief Builds a matrix by taking ownership of a column-major buffer.
+		 * @param cols The number of columns.
+		 * @param rows The number of rows.
+		 * @param buffer The column-major elements, with a leading dimension equal to rows.
+		 * @throw std::invalid_argument If the buffer size does not match cols * rows.
+		 */
+		Matrix(const size_t& cols, const size_t& rows, std::vector<T> buffer) : data(std::move(buffer)), n_rows(rows), n_cols(cols), stride(rows) {
+			if (data.size() != cols * rows)
+				throw std::invalid_argument("Buffer size does not match the matrix shape.");
+		}
+
+		/**
+		 * @brief Copies the elements of a view (block, transposed view, external buffer...) into a new matrix.
+		 * @param view The view to materialize.
+		 */
+		explicit Matrix(const MatrixView<const T>& view) : Matrix(view.cols(), view.rows()) {
+			MatrixView<T>(*this).assign(view);
+		}
+
+		/**
+		 * @brief Evaluates an element-wise expression (see Expr.hpp) in a single pass, column by column.
+		 * @param expr The expression to evaluate, e.g. 2 * A + B.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(n)
+		 */
+		template<typename E>
+		Matrix(const Expr<E>& expr) : Matrix(expr.self().shape().second, expr.self().shape().first) {
+			static_assert(E::is_matrix, "Cannot assign a vector expression to a matrix.");
+
+			assign_expr(expr.self());
+		}
+
+		/**
+		 * @brief Evaluates an element-wise expression (see Expr.hpp) into this matrix.
+		 * @details The matrix may appear in the expression itself (A = A + B) : each element only reads its own index.
+		 * @param expr The expression to evaluate.
+		 * @return Matrix<T>& This matrix.
+		 */
+		template<typename E>
+		Matrix<T>& operator=(const Expr<E>& expr) {
+			static_assert(E::is_matrix, "Cannot assign a vector expression to a matrix.");
+
+			const E& e = expr.self();
+			if (shape() != e.shape()) {
+				*this = Matrix<T>(e.shape().second, e.shape().first);
+			}
+			assign_expr(e);
+
+			return *this;
+		}
+
+		// Writes every element of e, both sides through their column stride
+		template<typename E>
+		void assign_expr(const E& e) {
+			for (size_t c = 0; c < cols(); ++c) {
+				T* dst = col_ptr(c);
+				for (size_t r = 0; r < rows(); ++r)
+					dst[r] = T(e(r, c));
+			}
+		}
 
 		/**
 		 * @brief Adds two matrices.
@@ -71,12 +231,36 @@ class Matrix {
 		 * @note Space complexity : O(1)
 		 * @note Allowed math functions : None
 		 */
-		void add(const Matrix<T>& other) {
+		void add(const Matrix<T>& other) { add(MatrixView<const T>(other)); }
+		void add(const MatrixView<T>& other) { add(MatrixView<const T>(other)); }
+
+		/**
+		 * @brief Adds a view (block, transposed view, external buffer...) to the matrix.
+		 * @param other The view, which must not overlap this matrix.
+		 * @throw std::invalid_argument If the shapes differ.
+		 */
+		void add(const MatrixView<const T>& other) {
+			PROFILE_OP("Matrix::add", rows(), cols(), FLOPS_ADD<T> * double(rows()) * cols(), 3. * sizeof(T) * double(rows()) * cols());
+
 			if (shape() != other.shape())
 				throw std::invalid_argument("Matrices must have the same shape.");
 
-			for (size_t i = 0; i < cols(); ++i)
-				data[i].add(other[i]); // Reuse Vector's add method
+			parallel_for(0, cols(), rows(), [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; ++c) {
+					T*                  dst = col_ptr(c);
+					VectorView<const T> src = other[c];
+
+					if (src.stride() == 1) {
+						const T* s = src.data();
+						for (size_t r = 0; r < rows(); ++r)
+							dst[r] += s[r];
+					}
+					else {
+						for (size_t r = 0; r < rows(); ++r)
+							dst[r] += src[r];
+					}
+				}
+			});
 		}
 
 		/**
@@ -87,12 +271,36 @@ class Matrix {
 		 * @note Space complexity : O(1)
 		 * @note Allowed math functions : None
 		 */
-		void sub(const Matrix<T>& other) {
+		void sub(const Matrix<T>& other) { sub(MatrixView<const T>(other)); }
+		void sub(const MatrixView<T>& other) { sub(MatrixView<const T>(other)); }
+
+		/**
+		 * @brief Subtracts a view (block, transposed view, external buffer...) from the matrix.
+		 * @param other The view, which must not overlap this matrix.
+		 * @throw std::invalid_argument If the shapes differ.
+		 */
+		void sub(const MatrixView<const T>& other) {
+			PROFILE_OP("Matrix::sub", rows(), cols(), FLOPS_ADD<T> * double(rows()) * cols(), 3. * sizeof(T) * double(rows()) * cols());
+
 			if (shape() != other.shape())
 				throw std::invalid_argument("Matrices must have the same shape.");
 
-			for (size_t i = 0; i < cols(); ++i)
-				data[i].sub(other[i]); // Reuse Vector's sub method
+			parallel_for(0, cols(), rows(), [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; ++c) {
+					T*                  dst = col_ptr(c);
+					VectorView<const T> src = other[c];
+
+					if (src.stride() == 1) {
+						const T* s = src.data();
+						for (size_t r = 0; r < rows(); ++r)
+							dst[r] -= s[r];
+					}
+					else {
+						for (size_t r = 0; r < rows(); ++r)
+							dst[r] -= src[r];
+					}
+				}
+			});
 		}
 
 		/**
@@ -103,12 +311,21 @@ class Matrix {
 		 * @note Allowed math functions : None
 		 */
 		void scl(const T& scalar) {
-			for (Vector<T>& col : data)
-				col.scl(scalar); // Reuse Vector's scl method
+			PROFILE_OP("Matrix::scl", rows(), cols(), FLOPS_ADD<T> * double(rows()) * cols(), 2. * sizeof(T) * double(rows()) * cols());
+
+			parallel_for(0, cols(), rows(), [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; ++c) {
+					T* dst = col_ptr(c);
+
+					for (size_t r = 0; r < rows(); ++r)
+						dst[r] *= scalar;
+				}
+			});
 		}
 
 		/**
 		 * @brief Multiplies the matrix by a vector.
+		 * @details f16 and bf16 matrices accumulate each element of the result in f32, and round it once.
 		 * @param other The vector to multiply.
 		 * @return Vector<T> The resulting vector.
 		 * @throw std::invalid_argument If the matrix rows do not match the vector size.
@@ -116,27 +333,64 @@ class Matrix {
 		 * @note Space complexity : O(n)
 		 * @note Allowed math functions : fma
 		 */
-		Vector<T> mul_vec(const Vector<T>& other) const {
+		Vector<T> mul_vec(const Vector<T>& other) const { return mul_vec(VectorView<const T>(other.ptr(), other.size())); }
+		Vector<T> mul_vec(const VectorView<T>& other) const { return mul_vec(VectorView<const T>(other)); }
+
+		/**
+		 * @brief Multiplies the matrix by a view, e.g. a matrix row, without materializing it.
+		 * @param other The vector view to multiply.
+		 * @return Vector<T> The resulting vector.
+		 * @throw std::invalid_argument If the matrix rows do not match the view size.
+		 */
+		Vector<T> mul_vec(const VectorView<const T>& other) const {
+			PROFILE_OP("Matrix::mul_vec", rows(), cols(), FLOPS_FMA<T> * double(rows()) * cols(), sizeof(T) * (double(rows()) * cols() + rows() + cols()));
+
 			if (rows() != other.size())
 				throw std::invalid_argument("Matrix rows must match vector size");
 
 			Vector<T> result(cols());
+			const T*     v   = other.data();
+			const size_t inc = other.stride();
 
-			for (size_t c = 0; c < cols(); c++) {
-				for (size_t r = 0; r < rows(); r++) {
-					if constexpr (IS_ARITHMETIC(T))
-						result[c] = std::fma(data[c][r], other[r], result[c]);
-					else
-						result[c] += data[c][r] * other[r];
-				}
+			if constexpr (IS_REDUCED(T)) { // Vector widened once, columns by blocks, each dot product accumulated in f32
+				Workspace&       ws = Workspace::local();
+				Workspace::Scope scope(ws);
+				float*           x = ws.alloc<float>(rows());
+
+				for (size_t r = 0; r < rows(); r++)
+					x[r] = v[r * inc];
+
+				parallel_for(0, cols(), 2 * rows(), [&](size_t lo, size_t hi) {
+					for (size_t c = lo; c < hi; c++)
+						result[c] = T(reduced_dot(col_ptr(c), x, rows()));
+				});
+				return result;
 			}
 
+			parallel_for(0, cols(), 2 * rows(), [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++) {
+					const T* col = col_ptr(c);
+					T        acc = T(0);
+
+					for (size_t r = 0; r < rows(); r++) {
+						if constexpr (IS_ARITHMETIC(T))
+							acc = std::fma(col[r], v[r * inc], acc);
+						else
+							acc += col[r] * v[r * inc];
+					}
+					result[c] = acc;
+				}
+			});
+
 			return result;
 		}
 
 		/**
 		 * @brief Multiplies the matrix by another matrix.
 		 * @details The multiplication is performed using the standard matrix multiplication algorithm.
+		 *          The loops are ordered so that the innermost one walks down contiguous columns of both A and the result.
+		 *          For f32, double and c32 matrices larger than tuning.gemm_threshold, the cache-blocked GEMM kernel is used instead.
+		 *          f16 and bf16 matrices are widened to f32 in the workspace and always go through the f32 GEMM kernel.
 		 * @param other The other matrix to multiply.
 		 * @return Matrix<T> The resulting matrix.
 		 * @throw std::invalid_argument If the matrix columns do not match the other matrix rows.
@@ -147,22 +401,87 @@ class Matrix {
 		 * @see https://en.wikipedia.org/wiki/Matrix_multiplication_algorithm
 		 * @see https://matrix.reshish.com/matrix-multiplication/
 		 */
-		Matrix<T> mul_mat(const Matrix<T>& other) {
+		Matrix<T> mul_mat(const Matrix<T>& other) const { return mul_mat(MatrixView<const T>(other)); }
+		Matrix<T> mul_mat(const MatrixView<T>& other) const { return mul_mat(MatrixView<const T>(other)); }
+
+		/**
+		 * @brief Multiplies the matrix by a view (block, transposed view, external buffer...) without materializing it.
+		 * @details The GEMM kernel packs its operands anyway, so any strides cost the same : A.mul_mat(B.transpose_view()) is A * B^T.
+		 * @param other The view to multiply.
+		 * @return Matrix<T> The resulting matrix.
+		 * @throw std::invalid_argument If the matrix columns do not match the view rows.
+		 */
+		Matrix<T> mul_mat(const MatrixView<const T>& other) const {
+			PROFILE_OP("Matrix::mul_mat", rows(), cols(), FLOPS_FMA<T> * double(rows()) * cols() * other.cols(), sizeof(T) * (double(rows()) * cols() + double(other.rows()) * other.cols() + double(rows()) * other.cols()));
+
 			if (cols() != other.rows())
 				throw std::invalid_argument("Matrix A columns must match Matrix B rows");
 
-			Matrix<T> result(rows(), other.cols());
+			Matrix<T> result(other.cols(), rows());
+
+			if constexpr (IS_REDUCED(T)) {
+				// Operands widened to f32 once (O(m*n + n*p) against O(m*n*p) flops), f32 GEMM, each result rounded once
+				if (!rows() || !cols() || !other.cols())
+					return result;
+
+				Workspace&       ws = Workspace::local();
+				Workspace::Scope scope(ws);
+				const size_t     m = rows(), k = cols(), n = other.cols();
+				float*           a = ws.alloc<float>(m * k);
+				float*           b = ws.alloc<float>(k * n);
+				float*           c = ws.alloc<float>(m * n);
+
+				for (size_t j = 0; j < k; j++)
+					to_f32(col_ptr(j), a + j * m, m);
+				for (size_t j = 0; j < n; j++) {
+					if (other.is_column_major())
+						to_f32(other[j].data(), b + j * k, k);
+					else
+						for (size_t i = 0; i < k; i++)
+							b[j * k + i] = other[j][i];
+				}
+				std::fill(c, c + m * n, 0.f);
+
+				parallel_for(0, n, 2 * m * k, [&](size_t lo, size_t hi) {
+					gemm(m, hi - lo, k, a, m, b + lo * k, k, c + lo * m, m);
+				});
+				for (size_t j = 0; j < n; j++)
+					from_f32(c + j * m, result.col_ptr(j), m);
+				return result;
+			}
+
+			if constexpr (gemm_traits<T>::enabled) {
+				ensure_tuning_loaded();
+				const size_t t = tuning.gemm_threshold;
+
+				if (rows() >= t && cols() >= t && other.cols() >= t) {
+					const size_t rsb = other.row_stride(), csb = other.col_stride();
+
+					// Each tile multiplies A by a block of columns of B
+					parallel_for(0, other.cols(), 2 * rows() * cols(), [&](size_t lo, size_t hi) {
+						gemm(rows(), hi - lo, cols(), ptr(), size_t(1), ld(), other[lo].data(), rsb, csb, result.col_ptr(lo), result.ld());
+					});
+					return result;
+				}
+			}
+
+			parallel_for(0, other.cols(), 2 * rows() * cols(), [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++) {
+					T* dst = result.col_ptr(c);
 
-			for (size_t c = 0; c < other.cols(); c++) {
-				for (size_t r = 0; r < rows(); r++) {
 					for (size_t k = 0; k < cols(); k++) {
-						if constexpr (IS_ARITHMETIC(T))
-							result[c][r] = std::fma(data[k][r], other[c][k], result[c][r]);
-						else
-							result[c][r] += data[k][r] * other[c][k];
+						const T* a = col_ptr(k);
+						const T  b = other[c][k];
+
+						for (size_t r = 0; r < rows(); r++) {
+							if constexpr (IS_ARITHMETIC(T))
+								dst[r] = std::fma(a[r], b, dst[r]);
+							else
+								dst[r] += a[r] * b;
+						}
 					}
 				}
-			}
+			});
 
 			return result;
 		}
@@ -177,13 +496,15 @@ class Matrix {
 		 * @note Allowed math functions : None
 		 */
 		T trace() const {
+			PROFILE_OP("Matrix::trace", rows(), cols(), FLOPS_ADD<T> * rows(), sizeof(T) * rows());
+
 			if (!is_square())
 				throw std::invalid_argument("Trace can only be computed on square matrix");
 
 			T result = T(0);
 
 			for (size_t i = 0; i < cols(); i++)
-				result += data[i][i];
+				result += (*this)[i][i];
 
 			return result;
 		}
@@ -191,19 +512,118 @@ class Matrix {
 		/**
 		 * @brief Transposes the matrix.
 		 * @details The transpose of a matrix is obtained by swapping its rows with its columns.
+		 *          The matrix is walked by square blocks of TRANSPOSE_BLOCK, each transposed by in-register tiles for float
+		 *          and double (see SimdKernels<T>::transpose) into a buffer in L2, then copied to the result one full
+		 *          column run at a time : both sides stream whole cache lines and pages, instead of one strided store per
+		 *          element (about 3x fewer memory stalls at 4096 x 4096, close to a plain copy for f32).
 		 * @return Matrix<T> The transposed matrix.
 		 * @note Time complexity : O(m*n) matrix rows * matrix cols
 		 * @note Space complexity : O(m*n) matrix rows * matrix cols
 		 * @note Allowed math functions : None
 		 */
-		Matrix<T> transpose() {
-			Matrix<T> result(rows(), cols());
+		Matrix<T> transpose() const & {
+			Matrix<T> result;
+			transpose(result);
+			return result;
+		}
 
-			for (size_t c = 0; c < cols(); c++)
-				for (size_t r = 0; r < rows(); r++)
-					result[r][c] = data[c][r];
+		/**
+		 * @brief Transposes the matrix into a preallocated result.
+		 * @details Same as transpose(), but reuses the storage of result when it already has the transposed shape :
+		 *          transposing large matrices repeatedly then costs no allocation and no page faults.
+		 * @param result Receives the transpose. m.transpose(m) goes through transpose_inplace().
+		 * @note Time complexity : O(m*n) matrix rows * matrix cols
+		 * @note Space complexity : O(1) when result has the right shape
+		 * @note Allowed math functions : None
+		 */
+		void transpose(Matrix<T>& result) const {
+			if (&result == this) { // The blocks would overwrite the elements they still have to read
+				result.transpose_inplace();
+				return;
+			}
 
-			return result;
+			PROFILE_OP("Matrix::transpose", rows(), cols(), 0, 2. * sizeof(T) * double(rows()) * cols());
+
+			const size_t b = TRANSPOSE_BLOCK;
+			if (result.rows() != cols() || result.cols() != rows())
+				result = Matrix<T>(rows(), cols());
+
+			parallel_for(0, (rows() + b - 1) / b, b * cols(), [&](size_t lo, size_t hi) {
+				Workspace&       ws = Workspace::local();
+				Workspace::Scope scope(ws);
+				T*               tmp = ws.alloc<T>(b * b);
+
+				for (size_t r = lo * b; r < std::min(hi * b, rows()); r += b)
+					for (size_t c = 0; c < cols(); c += b) {
+						const size_t nr = std::min(b, rows() - r), nc = std::min(b, cols() - c);
+
+						transpose_block(col_ptr(c) + r, ld(), tmp, nc, nr, nc);
+						for (size_t k = 0; k < nr; k++)
+							std::copy(tmp + k * nc, tmp + (k + 1) * nc, result.col_ptr(r + k) + c);
+					}
+			});
+		}
+
+		/**
+		 * @brief Transposes a temporary matrix, reusing its storage (e.g. std::move(m).transpose()).
+		 * @details Only square matrices are transposed in their storage : for rectangular ones a second buffer is
+		 *          an order of magnitude faster than following the cycles of transpose_inplace().
+		 * @return Matrix<T> The transposed matrix.
+		 * @note Time complexity : O(m*n) matrix rows * matrix cols
+		 * @note Space complexity : O(1) for square matrices, O(m*n) otherwise
+		 * @note Allowed math functions : None
+		 */
+		Matrix<T> transpose() && {
+			if (!is_square())
+				return std::as_const(*this).transpose();
+
+			transpose_inplace();
+			return std::move(*this);
+		}
+
+		/**
+		 * @brief Transposes the matrix in place.
+		 * @details Square matrices swap pairs of blocks across the diagonal, each block column c owning the pairs (c, r >= c) :
+		 *          one block goes through a workspace buffer, the other is transposed straight into its place.
+		 *          Rectangular ones follow the cycles of the permutation (r, c) -> (c, r) of their storage, with one bit per
+		 *          element to mark the moved ones : no second buffer, but one cache miss per element.
+		 * @note Time complexity : O(m*n) matrix rows * matrix cols
+		 * @note Space complexity : O(1) for square matrices, O(m*n) bits otherwise
+		 * @note Allowed math functions : None
+		 *
+		 * @see https://en.wikipedia.org/wiki/In-place_matrix_transposition
+		 */
+		void transpose_inplace() {
+			PROFILE_OP("Matrix::transpose_inplace", rows(), cols(), 0, 2. * sizeof(T) * double(rows()) * cols());
+
+			if (!is_square()) {
+				transpose_cycles();
+				return;
+			}
+
+			const size_t n = rows(), b = TRANSPOSE_BLOCK, blocks = (n + b - 1) / b;
+
+			parallel_for(0, blocks, b * n, [&](size_t lo, size_t hi) {
+				Workspace&       ws = Workspace::local();
+				Workspace::Scope scope(ws);
+				T*               tmp = ws.alloc<T>(b * b);
+
+				for (size_t i = lo; i < hi; i++) {
+					const size_t c0 = i * b, nc = std::min(b, n - c0);
+
+					for (size_t j = i; j < blocks; j++) {
+						const size_t r0 = j * b, nr = std::min(b, n - r0);
+						T*           x = col_ptr(c0) + r0; // Below the diagonal, nr x nc
+						T*           y = col_ptr(r0) + c0; // Its mirror, nc x nr (x itself on the diagonal)
+
+						transpose_block(x, ld(), tmp, nc, nr, nc);
+						if (j != i)
+							transpose_block(y, ld(), x, ld(), nc, nr);
+						for (size_t k = 0; k < nr; k++)
+							std::copy(tmp + k * nc, tmp + (k + 1) * nc, y + k * ld());
+					}
+				}
+			});
 		}
 
 		/**
@@ -211,127 +631,227 @@ class Matrix {
 		 * @details The REF of a matrix is a form where all nonzero rows are above any rows of all zeros,
 		 *          and the leading coefficient (the first nonzero number from the left, also called the pivot) of a nonzero row is always strictly to the right of
 		 *          the leading coefficient of the previous row. Additionally, all entries in a column below a leading coefficient are zeros.
+		 *          The result is the reduced form (pivots are 1, alone in their column), computed with partial pivoting (see rref()).
 		 * @return Matrix<T> The Row Echelon Form of the matrix.
 		 * @note Time complexity : O(m*n*min(m, n)) matrix rows * matrix cols * min(matrix rows, matrix cols)
 		 * @note Space complexity : O(m*n) matrix rows * matrix cols
 		 * @note Allowed math functions : None
 		 */
-		Matrix<T> row_echelon() const {
-			Matrix<T> result(*this);
-			size_t lead = 0; // Index of current leading column
-			
-			for (size_t r = 0; r < rows(); r++) {
-				if (lead >= cols())
-					break;
-
-				// Find the pivot row
-				size_t i = r;
-				while (result[lead][i] == T(0)) {
-					if (++i == rows()) {
-						i = r;
-						lead++;
-						if (lead == cols())
-							return result;
-					}
-				}
-				
-				// Swap the current row with the pivot row
-				if (i != r) {
-					for (size_t k = 0; k < cols(); k++)
-						std::swap(result[k][r], result[k][i - 1]);
-				}
+		Matrix<T> row_echelon() const & {
+			return Matrix<T>(*this).row_echelon();
+		}
 
-				// Normalize the pivot row
-				T pivot = result[lead][r];
-				if (pivot != T(0)) {
-					for (size_t k = 0; k < cols(); k++)
-						result[k][r] /= pivot;
-				}
+		/**
+		 * @brief Converts a temporary matrix to its Row Echelon Form, reusing its storage (e.g. std::move(m).row_echelon()).
+		 * @param ws The workspace the permutations and row multipliers are taken from.
+		 * @return Matrix<T> The Row Echelon Form of the matrix.
+		 * @note Time complexity : O(m*n*min(m, n)) matrix rows * matrix cols * min(matrix rows, matrix cols)
+		 * @note Space complexity : O(m + n) from the workspace
+		 * @note Allowed math functions : None
+		 */
+		Matrix<T> row_echelon(Workspace& ws = Workspace::local()) && {
+			PROFILE_OP("Matrix::row_echelon", rows(), cols(), FLOPS_FMA<T> * double(rows()) * cols() * std::min(rows(), cols()), 2. * sizeof(T) * double(rows()) * cols());
 
-				// Eliminate all rows below the pivot
-				for (size_t j = r + 1; j < rows(); j++) {
-					T factor = result[lead][j];
-					for (size_t k = 0; k < cols(); k++)
-						result[k][j] -= factor * result[k][r];
-				}
+			Workspace::Scope scope(ws);
 
-				lead++;
-			}
+			echelon(view(), echelon_tolerance(view()), Pivoting::Partial,
+			        ws.alloc<size_t>(rows()), ws.alloc<size_t>(cols()), ws.alloc<size_t>(std::min(rows(), cols())), ws.alloc<T>(rows()));
+			return std::move(*this);
+		}
 
-			// Eliminate above (back substitution)
-			for (ssize_t r = rows() - 1; r >= 0; r--) {
-				// Find pivot column in row r
-				size_t pivot_col = 0;
+		/**
+		 * @brief Computes the Reduced Row Echelon Form along with the pivots, the rank and the permutations, in one pass.
+		 * @details Gauss-Jordan elimination : each pivot is the largest remaining magnitude of its column (Partial), or of
+		 *          the whole trailing block (Complete, which also swaps columns and is the most reliable rank-revealing
+		 *          choice). Entries whose magnitude is at most the tolerance count as zero and are set to exactly zero,
+		 *          so nearly dependent rows of float data give zero rows instead of noise.
+		 * @param tolerance The magnitude under which an entry is zero, or a negative value for the default
+		 *        max(m, n) * epsilon * ||A||_inf (as MATLAB's rref and rank).
+		 * @param pivoting Pivoting::Partial (default) or Pivoting::Complete.
+		 * @param ws The workspace the row multipliers are taken from.
+		 * @return Echelon<T> The reduced form (of A * Q with complete pivoting), pivot columns, permutations and rank.
+		 * @note Time complexity : O(m*n*min(m, n)) matrix rows * matrix cols * min(matrix rows, matrix cols)
+		 * @note Space complexity : O(m*n) matrix rows * matrix cols
+		 * @note Allowed math functions : None
+		 *
+		 * @see https://en.wikipedia.org/wiki/Gaussian_elimination#Pivoting
+		 */
+		Echelon<T> rref(TO_REAL<T> tolerance = -1, Pivoting pivoting = Pivoting::Partial, Workspace& ws = Workspace::local()) const {
+			PROFILE_OP("Matrix::rref", rows(), cols(), FLOPS_FMA<T> * double(rows()) * cols() * std::min(rows(), cols()), 2. * sizeof(T) * double(rows()) * cols());
 
-				while (pivot_col < cols() && result[pivot_col][r] == T(0))
-					++pivot_col;
+			Workspace::Scope scope(ws);
+			Echelon<T>       result;
 
-				if (pivot_col == cols())
-					continue;
+			result.reduced   = *this;
+			result.tolerance = (tolerance < TO_REAL<T>(0)) ? echelon_tolerance(view()) : tolerance;
+			result.rows.resize(rows());
+			result.cols.resize(cols());
+			result.pivots.resize(std::min(rows(), cols()));
 
-				// Eliminate above
-				for (ssize_t i = r - 1; i >= 0; --i) {
-					T factor = result[pivot_col][i];
+			result.rank = echelon(result.reduced.view(), result.tolerance, pivoting,
+			                      result.rows.data(), result.cols.data(), result.pivots.data(), ws.alloc<T>(rows()));
+			result.pivots.resize(result.rank);
+			return result;
+		}
 
-					for (size_t k = 0; k < cols(); ++k)
-						result[k][i] -= factor * result[k][r];
+		/**
+		 * @brief Default tolerance of rref() and rank() : max(m, n) * epsilon * ||A||_inf.
+		 * @param a The matrix.
+		 * @return TO_REAL<T> The tolerance, 0 for integer types.
+		 * @note Time complexity : O(m*n)
+		 * @note Space complexity : O(m)
+		 */
+		static TO_REAL<T> echelon_tolerance(const MatrixView<const T>& a) {
+			using R = TO_REAL<T>;
+
+			std::vector<R> sums(a.rows(), R(0));
+			for (size_t c = 0; c < a.cols(); c++)
+				for (size_t r = 0; r < a.rows(); r++)
+					sums[r] += magnitude(a[c][r]);
+
+			const R norm = sums.empty() ? R(0) : *std::max_element(sums.begin(), sums.end());
+			return R(std::max(a.rows(), a.cols())) * std::numeric_limits<R>::epsilon() * norm;
+		}
+
+		/**
+		 * @brief Reduces a column-major matrix to its Reduced Row Echelon Form in place : the kernel behind
+		 *        row_echelon(), rref() and rank().
+		 * @param a The matrix to reduce.
+		 * @param tol The magnitude at or under which an entry is zero.
+		 * @param pivoting The pivot search, in the pivot column (Partial) or the trailing block (Complete).
+		 * @param row_perm Receives the row permutation : row i of the result comes from row row_perm[i], a.rows() entries.
+		 * @param col_perm Receives the column permutation : column j of the result is column col_perm[j], a.cols() entries.
+		 * @param pivots Receives the pivot column of each nonzero row, min(a.rows(), a.cols()) entries.
+		 * @param factors Scratch for the row multipliers of a sweep, a.rows() elements.
+		 * @return size_t The rank, the number of pivots.
+		 * @note Time complexity : O(m*n*min(m, n)) matrix rows * matrix cols * min(matrix rows, matrix cols)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : fma
+		 */
+		static size_t echelon(const MatrixView<T>& a, TO_REAL<T> tol, Pivoting pivoting, size_t* row_perm, size_t* col_perm, size_t* pivots, T* factors) {
+			const size_t rows = a.rows(), cols = a.cols();
+			size_t r = 0; // Next pivot row, and rank so far
+
+			for (size_t i = 0; i < rows; i++) row_perm[i] = i;
+			for (size_t k = 0; k < cols; k++) col_perm[k] = k;
+
+			for (size_t lead = 0; lead < cols && r < rows; lead++) {
+				// Pivot search : largest magnitude of the column, or of the trailing block
+				size_t p = r, q = lead;
+				auto   best = magnitude(a[lead][r]);
+				for (size_t k = lead; k < (pivoting == Pivoting::Complete ? cols : lead + 1); k++) {
+					const T* col = a[k].data();
+					for (size_t i = r; i < rows; i++)
+						if (magnitude(col[i]) > best) {
+							best = magnitude(col[i]);
+							p = i;
+							q = k;
+						}
+				}
+
+				if (best <= tol) { // Negligible : zero it exactly, there is no pivot in this column (or any left)
+					for (size_t k = lead; k < (pivoting == Pivoting::Complete ? cols : lead + 1); k++)
+						std::fill(a[k].data() + r, a[k].data() + rows, T(0));
+					if (pivoting == Pivoting::Complete)
+						break;
+					continue;
+				}
+
+				if (q != lead) {
+					std::swap_ranges(a[q].data(), a[q].data() + rows, a[lead].data());
+					std::swap(col_perm[q], col_perm[lead]);
 				}
+				if (p != r) {
+					for (size_t k = lead; k < cols; k++) // Columns before lead are zero in both rows
+						std::swap(a[k][r], a[k][p]);
+					std::swap(row_perm[r], row_perm[p]);
+				}
+
+				// Normalize the pivot row, then eliminate the column from every other row in one sweep
+				T* pc = a[lead].data();
+				const T pivot = pc[r];
+				for (size_t k = lead + 1; k < cols; k++)
+					a[k][r] /= pivot;
+
+				for (size_t j = 0; j < rows; j++)
+					factors[j] = (j == r) ? T(0) : pc[j];
+
+				parallel_for(lead + 1, cols, 2 * rows, [&](size_t lo, size_t hi) {
+					for (size_t k = lo; k < hi; k++) {
+						T*      col = a[k].data();
+						const T x   = col[r];
+
+						for (size_t j = 0; j < rows; j++) {
+							if constexpr (IS_ARITHMETIC(T))
+								col[j] = std::fma(-factors[j], x, col[j]);
+							else
+								col[j] -= factors[j] * x;
+						}
+					}
+				});
+
+				std::fill(pc, pc + rows, T(0));
+				pc[r] = T(1);
+				pivots[r++] = lead;
 			}
 
-			return result;
+			return r;
 		}
 
 		/**
 		 * @brief Computes the determinant of the matrix.
+		 * @details Sizes up to 4 use closed-form cofactor expansions, triangular matrices the product of their diagonal.
+		 *          Other sizes go through an LU factorization with partial pivoting (see LU<T>), run on a copy
+		 *          taken from the workspace : nothing is allocated once the workspace is large enough.
+		 *          Build an LU<T> directly to also solve systems or invert without factorizing again.
+		 * @param ws The workspace the temporaries are taken from, the calling thread's by default.
 		 * @return T The determinant of the matrix.
 		 * @throw std::invalid_argument If the matrix is not square.
-		 * @note Time complexity : O(n^3) using Gaussian elimination
-		 * @note Space complexity : O(n^2) matrix rows * matrix cols
+		 * @note Time complexity : O(n^3) using LU decomposition
+		 * @note Space complexity : O(n^2) matrix rows * matrix cols, from the workspace
 		 * @note Allowed math functions : None
 		 */
-		T determinant() const {
+		T determinant(Workspace& ws = Workspace::local()) const {
+			PROFILE_OP("Matrix::determinant", rows(), cols(), FLOPS_FMA<T> * double(rows()) * rows() * rows() / 3, sizeof(T) * double(rows()) * cols());
+
 			if (!is_square())
 				throw std::invalid_argument("Determinant can only be computed on square matrix");
 
-			if (rows() == 1) return data[0][0];
-   			if (rows() == 2) return data[0][0]*data[1][1] - data[1][0]*data[0][1];
+			switch (rows()) { // Closed-form cofactor expansions (see Small.hpp)
+				case 1: return small_determinant<1>(ptr(), 1, ld());
+				case 2: return small_determinant<2>(ptr(), 1, ld());
+				case 3: return small_determinant<3>(ptr(), 1, ld());
+				case 4: return small_determinant<4>(ptr(), 1, ld());
+				default: break;
+			}
 
-			Matrix<T> tmp = *this;
-			int swaps = 0;
-			
-			// Basic Gaussian elimination
-			for (size_t i = 0; i < rows(); ++i) {
-				if (tmp.data[i][i] == T(0)) {
-					// find row to swap
-					for (size_t j = i+1; j < rows(); ++j) {
-						if (tmp.data[j][i] != T(0)) {
-							std::swap(tmp.data[i], tmp.data[j]);
-							swaps++;
-							break;
-						}
-					}
-				}
-				// eliminate below
-				for (size_t j = i+1; j < rows(); ++j) {
-					T factor = tmp.data[j][i] / tmp.data[i][i];
-					for (size_t k = i; k < rows(); ++k)
-						if constexpr (IS_ARITHMETIC(T))
-							tmp.data[j][k] = std::fma(-factor, tmp.data[i][k], tmp.data[j][k]);
-						else
-							tmp.data[j][k] -= factor * tmp.data[i][k];
-				}
+			if (is_triangular()) {
+				T result = T(1);
+				for (size_t i = 0; i < rows(); i++)
+					result *= (*this)[i][i];
+				return result;
 			}
 
-			T det = (swaps % 2 == 0) ? 1 : -1;
-			for (size_t i = 0; i < rows(); ++i)
-				det *= tmp.data[i][i];
+			Workspace::Scope scope(ws);
+			MatrixView<T> lu = ws.copy<T>(view());
+			bool odd_swaps;
 
-			return det;
+			if (!LU<T>::factor(lu, ws.alloc<size_t>(rows()), odd_swaps))
+				return T(0);
+
+			T result = odd_swaps ? T(-1) : T(1);
+			for (size_t i = 0; i < rows(); i++)
+				result *= lu[i][i];
+			return result;
 		}
 
 		/**
 		 * @brief Computes the inverse of the matrix.
-		 * @details The inverse matrix is compute using the Gauss-Jordan elimination method.
+		 * @details Sizes up to 4 use closed forms (see inverse(Matrix<T>&, Workspace&)). Above, the matrix is factorized
+		 *          once (see LU<T>) : a zero pivot reports the singularity, otherwise the inverse is solved column by column
+		 *          from the same factors.
+		 *          The factors live in the workspace, so only the result is allocated.
+		 * @param ws The workspace the temporaries are taken from, the calling thread's by default.
 		 * @throw std::invalid_argument If the matrix is not square.
 		 * @throw std::logic_error If the matrix is singular and cannot be inverted.
 		 * @return Matrix<T> The inverse of the matrix.
@@ -339,88 +859,140 @@ class Matrix {
 		 * @note Space complexity : O(n^2) matrix rows * matrix cols
 		 * @note Allowed math functions : None
 		 */
-		Matrix<T> inverse() const {
+		Matrix<T> inverse(Workspace& ws = Workspace::local()) const {
+			Matrix<T> result;
+			inverse(result, ws);
+			return result;
+		}
+
+		/**
+		 * @brief Computes the inverse of the matrix into a preallocated result.
+		 * @details Sizes up to 4 use the closed-form adjugate / determinant, with a cheaper path for 4x4 affine transforms
+		 *          (last row or last column (0, 0, 0, 1)).
+		 *          Same as inverse(), but reuses the storage of result when it already has the shape of the inverse :
+		 *          with a warm workspace, inverting thousands of small matrices allocates nothing.
+		 *          result may be the matrix itself.
+		 * @param result Receives the inverse. Left unchanged if an exception is thrown.
+		 * @param ws The workspace the temporaries are taken from, the calling thread's by default.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @throw std::logic_error If the matrix is singular and cannot be inverted.
+		 * @note Time complexity : O(n^3)
+		 * @note Space complexity : O(n^2) from the workspace
+		 * @note Allowed math functions : None
+		 */
+		void inverse(Matrix<T>& result, Workspace& ws = Workspace::local()) const {
+			PROFILE_OP("Matrix::inverse", rows(), cols(), FLOPS_FMA<T> * double(rows()) * rows() * rows() * 4 / 3, 2. * sizeof(T) * double(rows()) * cols());
+
 			if (!is_square())
 				throw std::invalid_argument("Inverse can only be computed on square matrix.");
 
-			if (determinant() == T(0))
+			const size_t n = rows();
+
+			if (n >= 1 && n <= 4) { // Closed-form adjugate / determinant, affine transforms on their own path (see Small.hpp)
+				std::array<T, 16> inv = {};
+				const bool regular = (n == 1) ? small_inverse<1>(ptr(), 1, ld(), inv.data(), 1, n)
+				                   : (n == 2) ? small_inverse<2>(ptr(), 1, ld(), inv.data(), 1, n)
+				                   : (n == 3) ? small_inverse<3>(ptr(), 1, ld(), inv.data(), 1, n)
+				                   :            small_inverse<4>(ptr(), 1, ld(), inv.data(), 1, n);
+				if (!regular)
+					throw std::logic_error("Matrix is singular and cannot be inverted.");
+
+				if (result.shape() != shape())
+					result = Matrix<T>(n, n);
+				for (size_t c = 0; c < n; c++)
+					std::copy(inv.begin() + c * n, inv.begin() + (c + 1) * n, result.col_ptr(c));
+				return;
+			}
+
+			Workspace::Scope scope(ws);
+			MatrixView<T> lu   = ws.copy<T>(view());
+			size_t*       perm = ws.alloc<size_t>(n);
+			bool          odd_swaps;
+
+			if (!LU<T>::factor(lu, perm, odd_swaps))
 				throw std::logic_error("Matrix is singular and cannot be inverted.");
 
-			size_t n = rows();
-
-			// Augment A with identity matrix [A | I]
-			Matrix<T> identity(n, n);
-			for (size_t i = 0; i < n; ++i)
-				identity[i][i] = T(1);
-
-			Matrix<T> augmented = *this | identity;
-
-			// Perform Gauss–Jordan elimination
-			for (size_t i = 0; i < n; ++i) {
-				// Find pivot
-				size_t pivot_row = i;
-				for (size_t j = i; j < n; ++j)
-					if (this->abs(augmented[i][j]) > this->abs(augmented[i][pivot_row]))
-						pivot_row = j;
-
-				if (pivot_row != i)
-					for (size_t c = 0; c < augmented.cols(); ++c)
-						std::swap(augmented[c][i], augmented[c][pivot_row]);
-
-				// Normalize pivot row
-				T pivot = augmented[i][i];
-				if (pivot == T(0))
-					throw std::logic_error("Matrix is singular during elimination.");
-
-				for (size_t c = 0; c < augmented.cols(); ++c)
-					augmented[c][i] /= pivot;
-
-				// Eliminate all other rows
-				for (size_t r = 0; r < n; ++r) {
-					if (r == i) continue;
-					T factor = augmented[i][r];
-					for (size_t c = 0; c < augmented.cols(); ++c)
-						augmented[c][r] -= factor * augmented[c][i];
-				}
-			}
+			if (result.shape() != shape() || result.ld() != n)
+				result = Matrix<T>(n, n);
+			LU<T>::invert(lu, perm, result.view());
+		}
 
-			// Extract inverse (right half)
-			Matrix<T> inverse(n, n);
-			for (size_t c = 0; c < n; ++c)
-				for (size_t r = 0; r < n; ++r)
-					inverse[c][r] = augmented[c + n][r];
+		/**
+		 * @brief Replaces the matrix by its inverse.
+		 * @details The factors come from the workspace and the inverse is written over the matrix storage.
+		 * @param ws The workspace the temporaries are taken from, the calling thread's by default.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @throw std::logic_error If the matrix is singular, in which case it is left unchanged.
+		 * @note Time complexity : O(n^3)
+		 * @note Space complexity : O(n^2) from the workspace
+		 * @note Allowed math functions : None
+		 */
+		void inverse_inplace(Workspace& ws = Workspace::local()) {
+			inverse(*this, ws);
+		}
 
-			return inverse;
+		/**
+		 * @brief Solves the linear system A.mul_vec(x) == b without forming the inverse.
+		 * @details Diagonal and triangular matrices are solved by substitution directly, Hermitian positive-definite
+		 *          ones through a Cholesky factorization, the others through LU (see Solver<T>).
+		 *          This is the result of inverse().mul_vec(b), in about a third of the flops and with a smaller error.
+		 * @param b The right-hand side.
+		 * @param rcond If not null, receives an estimate of the reciprocal condition number of the matrix in the 1-norm.
+		 * @return Vector<T> The solution x.
+		 * @throw std::invalid_argument If the matrix is not square or b does not match its size.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n^3) in general, O(n^2) for triangular matrices
+		 * @note Space complexity : O(n^2) matrix rows * matrix cols
+		 * @note Allowed math functions : fma, pow
+		 */
+		Vector<T> solve(const Vector<T>& b, TO_REAL<T>* rcond = nullptr) const {
+			PROFILE_OP("Matrix::solve", rows(), cols(), FLOPS_FMA<T> * (double(rows()) * rows() * rows() / 3 + double(rows()) * cols()), sizeof(T) * (double(rows()) * cols() + 2. * rows()));
+
+			return Solver<T>::solve(*this, b, rcond);
+		}
+
+		/**
+		 * @brief Solves the linear systems A.mul_mat(X) == B, one per column of B, with a single factorization.
+		 * @details Same dispatch as solve(const Vector<T>&), the columns of B are then solved in parallel.
+		 * @param b The right-hand sides, one per column.
+		 * @param rcond If not null, receives an estimate of the reciprocal condition number of the matrix in the 1-norm.
+		 * @return Matrix<T> The solutions, one per column.
+		 * @throw std::invalid_argument If the matrix is not square or B rows do not match its size.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n^3 + n^2 * k) with k the number of columns of B
+		 * @note Space complexity : O(n^2 + n * k)
+		 * @note Allowed math functions : fma, pow
+		 */
+		Matrix<T> solve(const Matrix<T>& b, TO_REAL<T>* rcond = nullptr) const {
+			PROFILE_OP("Matrix::solve", rows(), cols(), FLOPS_FMA<T> * (double(rows()) * rows() * rows() / 3 + double(rows()) * cols() * b.cols()), sizeof(T) * (double(rows()) * cols() + 2. * b.rows() * b.cols()));
+
+			return Solver<T>::solve(*this, b, rcond);
 		}
 
 		/**
 		 * @brief Computes the rank of the matrix.
 		 * @details The rank is defined as the maximum number of linearly independent row or column vectors in the matrix.
-		 *          It is computed by transforming the matrix to its Row Echelon Form (REF) and counting the number of non-zero rows.
+		 *          It is the number of pivots of the elimination (see rref()), run on a workspace copy of the matrix with
+		 *          complete pivoting : entries at most the tolerance count as zero, so rounding noise does not add to the rank.
+		 * @param tolerance The magnitude under which an entry is zero, negative for the default of rref().
+		 * @param ws The workspace the temporaries are taken from, the calling thread's by default.
 		 * @return size_t The rank of the matrix.
 		 * @note Time complexity : O(m*n*min(m, n)) matrix rows * matrix cols * min(matrix rows, matrix cols)
-		 * @note Space complexity : O(m*n) matrix rows * matrix cols
+		 * @note Space complexity : O(m*n) matrix rows * matrix cols, from the workspace
 		 * @note Allowed math functions : None
 		 * 
 		 * @see https://en.wikipedia.org/wiki/Rank_(linear_algebra)
 		 */
-		size_t rank() const {
-			Matrix<T> ref = row_echelon();
-			size_t result = 0;
-
-			for (size_t r = 0; r < ref.rows(); ++r) {
-				bool non_zero_row = false;
+		size_t rank(TO_REAL<T> tolerance = -1, Workspace& ws = Workspace::local()) const {
+			PROFILE_OP("Matrix::rank", rows(), cols(), FLOPS_FMA<T> * double(rows()) * cols() * std::min(rows(), cols()), sizeof(T) * double(rows()) * cols());
 
-				for (size_t c = 0; c < ref.cols(); ++c) {
-					if (ref[c][r] != T(0)) {
-						non_zero_row = true;
-						break;
-					}
-				}
+			Workspace::Scope scope(ws);
+			MatrixView<T> ref = ws.copy<T>(view());
 
-				if (non_zero_row) result++;
-			}
-			return result;
+			if (tolerance < TO_REAL<T>(0))
+				tolerance = echelon_tolerance(view());
+			return echelon(ref, tolerance, Pivoting::Complete,
+			               ws.alloc<size_t>(rows()), ws.alloc<size_t>(cols()), ws.alloc<size_t>(std::min(rows(), cols())), ws.alloc<T>(rows()));
 		}
 
 		# pragma region Utils
@@ -429,13 +1001,13 @@ class Matrix {
 		 * @brief Returns the number of rows in the matrix.
 		 * @return size_t The number of rows.
 		 */
-		inline size_t rows() const { return data.empty() ? 0 : data[0].size(); }
+		inline size_t rows() const { return n_rows; }
 
 		/**
 		 * @brief Returns the number of columns in the matrix.
 		 * @return size_t The number of columns.
 		 */
-		inline size_t cols() const { return data.size(); }
+		inline size_t cols() const { return n_cols; }
 
 		/**
 		 * @brief Returns the shape of the matrix as a pair (rows, cols).
@@ -448,12 +1020,13 @@ class Matrix {
 		 * @return Vector<T> The flattened vector.
 		 */
 		Vector<T> flatten() const {
-			std::vector<T> vec;
-			vec.reserve(rows() * cols());
+			if (stride == rows())
+				return Vector<T>(data);
 
-			for (const Vector<T>& col : data)
-				for (size_t j = 0; j < col.size(); ++j)
-					vec.push_back(col[j]);
+			std::vector<T> vec(rows() * cols());
+
+			for (size_t c = 0; c < cols(); ++c)
+				std::copy(col_ptr(c), col_ptr(c) + rows(), vec.begin() + c * rows());
 
 			return Vector<T>(vec);
 		}
@@ -464,8 +1037,86 @@ class Matrix {
 		 */
 		inline bool is_square() const { return rows() == cols(); }
 
-		Vector<T>& operator[](size_t index) { return data[index]; }
-		const Vector<T>& operator[](size_t index) const { return data[index]; }
+		/**
+		 * @brief Checks if the matrix is square and lower or upper triangular (diagonal matrices are both).
+		 * @details Stops at the first nonzero found on each side of the diagonal, so a general matrix is rejected
+		 *          after reading a few elements.
+		 * @return true If every element above, or every element below, the diagonal is zero.
+		 * @note Time complexity : O(n^2) at worst
+		 * @note Space complexity : O(1)
+		 */
+		bool is_triangular() const {
+			if (!is_square())
+				return false;
+
+			bool lower = true, upper = true;
+			for (size_t c = 0; c < cols() && (lower || upper); c++) {
+				const T* col = col_ptr(c);
+				for (size_t r = 0; r < c && lower; r++)
+					lower = col[r] == T(0);
+				for (size_t r = c + 1; r < rows() && upper; r++)
+					upper = col[r] == T(0);
+			}
+			return lower || upper;
+		}
+
+		/**
+		 * @brief Returns the leading dimension of the buffer (distance between two columns, in elements).
+		 * @return size_t The leading dimension.
+		 */
+		inline size_t ld() const { return stride; }
+
+		/**
+		 * @brief Returns the raw column-major buffer, e.g. to hand it to BLAS or GPU code without copying.
+		 * @return T* The pointer to the first element.
+		 */
+		inline T* ptr() { return data.data(); }
+		inline const T* ptr() const { return data.data(); }
+
+		/**
+		 * @brief Returns the pointer to the first element of a column.
+		 * @param c The column index.
+		 * @return T* The pointer to the column.
+		 */
+		inline T* col_ptr(size_t c) { return data.data() + c * stride; }
+		inline const T* col_ptr(size_t c) const { return data.data() + c * stride; }
+
+		VectorView<T> operator[](size_t index) { return VectorView<T>(col_ptr(index), rows()); }
+		VectorView<const T> operator[](size_t index) const { return VectorView<const T>(col_ptr(index), rows()); }
+
+		/**
+		 * @brief Views a row of the matrix, without copying it.
+		 * @param r The row index.
+		 * @return VectorView<T> The row, with a stride of ld().
+		 */
+		VectorView<T> row(size_t r) { return view().row(r); }
+		VectorView<const T> row(size_t r) const { return view().row(r); }
+
+		/**
+		 * @brief Views the whole matrix, to pass it where a MatrixView is expected.
+		 * @return MatrixView<T> The view.
+		 */
+		MatrixView<T> view() { return MatrixView<T>(*this); }
+		MatrixView<const T> view() const { return MatrixView<const T>(*this); }
+
+		/**
+		 * @brief Views a sub-block of the matrix, without copying it.
+		 * @param row The first row of the block.
+		 * @param col The first column of the block.
+		 * @param rows The number of rows of the block.
+		 * @param cols The number of columns of the block.
+		 * @return MatrixView<T> The block.
+		 * @throw std::out_of_range If the block does not fit in the matrix.
+		 */
+		MatrixView<T> block(size_t row, size_t col, size_t rows, size_t cols) { return view().block(row, col, rows, cols); }
+		MatrixView<const T> block(size_t row, size_t col, size_t rows, size_t cols) const { return view().block(row, col, rows, cols); }
+
+		/**
+		 * @brief Views the transpose of the matrix, in O(1) and without copying (see transpose() for an owning result).
+		 * @return MatrixView<T> The transposed view.
+		 */
+		MatrixView<T> transpose_view() { return view().transpose(); }
+		MatrixView<const T> transpose_view() const { return view().transpose(); }
 
 		bool operator==(const Matrix<T>& other) const {
 			if (rows() != other.rows() || cols() != other.cols())
@@ -476,7 +1127,7 @@ class Matrix {
 			
 			for (size_t c = 0; c < cols(); ++c)
 				for (size_t r = 0; r < rows(); ++r)
-					if (this->abs(data[c][r] - other[c][r]) > eps)
+					if (magnitude((*this)[c][r] - other[c][r]) > eps)
 						return false;
 
 			return true;
@@ -496,14 +1147,8 @@ class Matrix {
 				throw std::invalid_argument("Matrices must have the same number of rows for horizontal concatenation.");
 
 			Matrix<T> result(cols() + other.cols(), rows());
-
-			for (size_t c = 0; c < cols(); ++c)
-				for (size_t r = 0; r < rows(); ++r)
-					result[c][r] = data[c][r];
-
-			for (size_t c = 0; c < other.cols(); ++c)
-				for (size_t r = 0; r < other.rows(); ++r)
-					result[c + cols()][r] = other[c][r];
+			result.block(0, 0, rows(), cols()).assign(view());
+			result.block(0, cols(), rows(), other.cols()).assign(other.view());
 
 			return result;
 		}
@@ -513,6 +1158,38 @@ class Matrix {
 
 template<typename T>
 std::ostream& operator<<(std::ostream& os, const Matrix<T>& mat) {
+	if constexpr (std::is_floating_point_v<TO_REAL<T>>) {
+		char       buffer[4096];
+		const int  prec = int(os.precision());
+		const auto need = format_room<T>(prec) + 8; // One element and its separators
+
+		// Same output as the loop below, formatted with to_chars in a local buffer : huge precisions take the stream
+		if (formats_like_stream(os) && need <= sizeof(buffer)) {
+			char*       out  = buffer;
+			const auto  put  = [&](const char* s, size_t n) { std::copy(s, s + n, out); out += n; };
+			const auto  room = [&] { // Flushes unless one more element and its separators fit
+				if (out + need > buffer + sizeof(buffer)) {
+					os.write(buffer, out - buffer);
+					out = buffer;
+				}
+			};
+
+			put("{", 1);
+			for (size_t r = 0; r < mat.rows(); ++r) {
+				room();
+				put(r ? ", [" : "[", r ? 3 : 1);
+				for (size_t c = 0; c < mat.cols(); ++c) {
+					room();
+					if (c) put(", ", 2);
+					out = format_value(out, buffer + sizeof(buffer), mat[c][r], prec);
+				}
+				put("]", 1);
+			}
+			put("}", 1);
+			return os.write(buffer, out - buffer);
+		}
+	}
+
 	os << "{";
 	for (size_t r = 0; r < mat.rows(); ++r) {
 		if (r) os << ", ";
@@ -526,3 +1203,6 @@ std::ostream& operator<<(std::ostream& os, const Matrix<T>& mat) {
 	os << "}";
 	return os;
 }
+
+# include "LU.hpp"
+# include "Solve.hpp"
@@ -0,0 +1,241 @@
+#pragma once
+
+# include <cstdint>
+# include <vector>
+
+# include "Vector.hpp"
+# include "Matrix.hpp"
+# include "LU.hpp"
+
+/**
+ * Mixed precision : storage in a narrow type, arithmetic in a wider one.
+ * - convert<U>() : element-wise type conversions between matrices / vectors (f16 / bf16 <-> f32 <-> double) ;
+ * - Int8Matrix : int8 storage with one f32 scale per column, 4x less memory traffic than f32 ;
+ * - solve_refined() : LU factorization in low precision, residuals and corrections in high precision.
+ */
+
+# pragma region Utils
+
+/**
+ * @brief Converts every element of a matrix to another type.
+ * @details f32 <-> f16 / bf16 conversions go through the F16C block converters of Half.hpp, others through U(v).
+ * @tparam U The target element type.
+ * @param m The matrix to convert.
+ * @return Matrix<U> The converted matrix, same shape.
+ * @note Time complexity : O(n*m)
+ * @note Space complexity : O(n*m)
+ */
+template<typename U, typename T>
+Matrix<U> convert(const Matrix<T>& m) {
+	Matrix<U> result(m.cols(), m.rows());
+
+	for (size_t c = 0; c < m.cols(); c++) {
+		if constexpr (IS_REDUCED(T) && std::is_same_v<U, float>)
+			to_f32(m[c].data(), result[c].data(), m.rows());
+		else if constexpr (std::is_same_v<T, float> && IS_REDUCED(U))
+			from_f32(m[c].data(), result[c].data(), m.rows());
+		else
+			for (size_t r = 0; r < m.rows(); r++)
+				result[c][r] = U(m[c][r]);
+	}
+	return result;
+}
+
+/**
+ * @brief Converts every element of a vector to another type.
+ * @tparam U The target element type.
+ * @param v The vector to convert.
+ * @return Vector<U> The converted vector.
+ * @note Time complexity : O(n)
+ * @note Space complexity : O(n)
+ */
+template<typename U, typename T>
+Vector<U> convert(const Vector<T>& v) {
+	Vector<U> result(v.size());
+
+	if constexpr (IS_REDUCED(T) && std::is_same_v<U, float>)
+		to_f32(v.ptr(), result.ptr(), v.size());
+	else if constexpr (std::is_same_v<T, float> && IS_REDUCED(U))
+		from_f32(v.ptr(), result.ptr(), v.size());
+	else
+		for (size_t i = 0; i < v.size(); i++)
+			result[i] = U(v[i]);
+	return result;
+}
+
+# pragma endregion
+
+/**
+ * @brief f32 matrix quantized to int8, one symmetric scale per column.
+ * @details Column c is stored as q = round(A(:, c) / s_c) in [-127, 127] with s_c = max |A(:, c)| / 127,
+ *          so each element is off by at most s_c / 2. A column scale factors out of mul_vec's per-column
+ *          dot products : result[c] = s_c * sum_r q(r, c) * v[r], accumulated in f32.
+ */
+class Int8Matrix {
+	protected:
+		std::vector<int8_t> q;         // Column-major, leading dimension n_rows
+		std::vector<float>  scale;     // One per column
+		size_t              n_rows = 0;
+		size_t              n_cols = 0;
+
+	public:
+		Int8Matrix() = default;
+
+		/**
+		 * @brief Quantizes an f32 matrix.
+		 * @param m The matrix to quantize.
+		 * @note Time complexity : O(n*m)
+		 * @note Space complexity : O(n*m) bytes
+		 * @note Allowed math functions : round
+		 */
+		explicit Int8Matrix(const Matrix<f32>& m) : q(m.rows() * m.cols()), scale(m.cols()), n_rows(m.rows()), n_cols(m.cols()) {
+			for (size_t c = 0; c < n_cols; c++) {
+				const f32* col = m[c].data();
+				f32        amax = 0;
+
+				for (size_t r = 0; r < n_rows; r++)
+					amax = std::max(amax, col[r] < 0 ? -col[r] : col[r]);
+
+				scale[c] = amax / 127.f;
+				const f32 inv = amax > 0 ? 127.f / amax : 0.f;
+				int8_t*   dst = q.data() + c * n_rows;
+
+				for (size_t r = 0; r < n_rows; r++)
+					dst[r] = int8_t(std::round(col[r] * inv));
+			}
+		}
+
+		inline size_t rows() const { return n_rows; }
+		inline size_t cols() const { return n_cols; }
+		inline const std::vector<int8_t>& values() const { return q; }
+		inline const std::vector<float>&  scales() const { return scale; }
+
+		/**
+		 * @brief Returns the dequantized element (r, c).
+		 * @throw std::out_of_range If (r, c) is outside the matrix.
+		 */
+		f32 at(size_t r, size_t c) const {
+			if (r >= n_rows || c >= n_cols)
+				throw std::out_of_range("Index out of range");
+			return scale[c] * q[c * n_rows + r];
+		}
+
+		/**
+		 * @brief Dequantizes the whole matrix.
+		 * @return Matrix<f32> The f32 matrix the quantized values stand for.
+		 * @note Time complexity : O(n*m)
+		 * @note Space complexity : O(n*m)
+		 */
+		Matrix<f32> dense() const {
+			Matrix<f32> result(n_cols, n_rows);
+
+			for (size_t c = 0; c < n_cols; c++)
+				for (size_t r = 0; r < n_rows; r++)
+					result[c][r] = scale[c] * q[c * n_rows + r];
+			return result;
+		}
+
+		/**
+		 * @brief Multiplies the matrix by an f32 vector, same convention as Matrix<T>::mul_vec.
+		 * @details Blocks of each column are widened to f32 on the stack and reduced by the f32 SIMD kernel,
+		 *          then scaled once by the column scale.
+		 * @param v The vector to multiply.
+		 * @return Vector<f32> The resulting vector.
+		 * @throw std::invalid_argument If the matrix rows do not match the vector size.
+		 * @note Time complexity : O(n*m)
+		 * @note Space complexity : O(m)
+		 */
+		Vector<f32> mul_vec(const Vector<f32>& v) const {
+			if (n_rows != v.size())
+				throw std::invalid_argument("Matrix rows must match vector size");
+
+			Vector<f32> result(n_cols);
+			const auto& k = simd<float>();
+
+			parallel_for(0, n_cols, 2 * n_rows, [&](size_t lo, size_t hi) {
+				f32 block[REDUCED_BLOCK];
+
+				for (size_t c = lo; c < hi; c++) {
+					const int8_t* col = q.data() + c * n_rows;
+					f32           acc = 0;
+
+					for (size_t i = 0; i < n_rows; i += REDUCED_BLOCK) {
+						const size_t m = std::min(REDUCED_BLOCK, n_rows - i);
+						for (size_t r = 0; r < m; r++)
+							block[r] = col[i + r];
+						acc += k.dot(block, v.ptr() + i, m);
+					}
+					result[c] = scale[c] * acc;
+				}
+			});
+
+			return result;
+		}
+
+		friend std::ostream& operator<<(std::ostream& os, const Int8Matrix& m) { return os << m.dense(); }
+};
+
+/**
+ * @brief Solves A.mul_vec(x) == b by mixed-precision iterative refinement.
+ * @details A is factored once in the Low type (half the memory traffic of High, faster kernels), then each step
+ *          computes the residual r = b - A x in High, solves the correction with the Low factors and adds it in High.
+ *          For cond(A) well below 1 / eps(Low) the result reaches High accuracy in a few O(n^2) steps instead of an
+ *          O(n^3) High factorization. When the corrections stop shrinking (too ill-conditioned for Low), it falls
+ *          back to a High precision solve, as LAPACK's dsgesv does.
+ * @tparam Low The factorization type, f32 by default.
+ * @tparam High The type of the system, double for instance.
+ * @param a The square matrix.
+ * @param b The right-hand side.
+ * @param max_iterations The maximum number of refinement steps.
+ * @param steps If not null, set to the number of refinement steps applied, 0 when falling back to the High solve.
+ * @return Vector<High> The solution x.
+ * @throw std::invalid_argument If the matrix is not square or b does not match its size.
+ * @throw std::logic_error If the matrix is singular.
+ * @note Time complexity : O(n^3) in Low + O(n^2) per step in High
+ * @note Space complexity : O(n^2)
+ * @note Allowed math functions : None
+ *
+ * @see https://doi.org/10.1145/1377596.1377597
+ */
+template<typename Low = f32, typename High>
+Vector<High> solve_refined(const Matrix<High>& a, const Vector<High>& b, size_t max_iterations = 10, size_t* steps = nullptr) {
+	using R = TO_REAL<High>;
+
+	if (a.rows() != a.cols())
+		throw std::invalid_argument("Matrix must be square");
+	if (a.rows() != b.size())
+		throw std::invalid_argument("Right-hand side size must match the matrix size.");
+
+	if (steps)
+		*steps = 0;
+
+	const LU<Low> lu(convert<Low>(a));
+	if (lu.is_singular())
+		return a.solve(b); // Singular in Low only if it is (almost) singular in High : let the High solve decide
+
+	Vector<High> x   = convert<High>(lu.solve(convert<Low>(b)));
+	const R      eps = std::numeric_limits<R>::epsilon() * R(a.rows());
+	R            last = std::numeric_limits<R>::infinity();
+
+	for (size_t it = 0; it < max_iterations; it++) {
+		Vector<High> r(b);
+		r.sub(a.mul_vec(x));
+
+		const Vector<High> d    = convert<High>(lu.solve(convert<Low>(r)));
+		const R            step = d.norm_inf();
+		if (step >= last / 2) { // Not contracting : Low is too coarse for this matrix
+			if (steps)
+				*steps = 0;
+			return a.solve(b);
+		}
+
+		x.add(d);
+		if (steps)
+			*steps = it + 1;
+		if (step <= eps * x.norm_inf())
+			return x;
+		last = step;
+	}
+
+	return x;
+}
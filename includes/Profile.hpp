@@ -0,0 +1,296 @@
+#pragma once
+
+# include <atomic>
+# include <chrono>
+# include <cstdint>
+# include <map>
+# include <memory>
+# include <mutex>
+# include <ostream>
+# include <string>
+# include <string_view>
+# include <tuple>
+# include <vector>
+
+/**
+ * Per-operation profiling counters.
+ * The public Vector / Matrix operations open a ProfileScope through the PROFILE_OP macro of config.hpp, which only
+ * expands to something when MATRIX_PROFILE is defined (make PROFILE=1) : a default build pays nothing.
+ * Each thread aggregates its own calls per (operation, shape) and keeps a bounded trace of them, the Profiler
+ * merges and dumps them on demand, as JSON or in the Chrome trace event format (chrome://tracing, Perfetto).
+ */
+
+/**
+ * @brief Aggregated counters of one operation on one shape.
+ * @details Times, allocations and bytes include the nested operations (inverse calls mul_mat...), except self_ns
+ *          which is the time spent in the operation itself : the column to sort by to find where to optimize.
+ */
+struct ProfileStat {
+	std::string op;
+	size_t      rows = 0;        // Shape of the object the operation was called on, a vector is n x 1
+	size_t      cols = 0;
+	size_t      thread = 0;      // Index of the thread in Profiler::threads() order, 0 once merged
+	uint64_t    calls = 0;
+	double      flops = 0;       // Estimated, same conventions as srcs/bench.cpp
+	double      bytes = 0;       // Minimal memory traffic : operands read once, result written once
+	uint64_t    allocations = 0; // Vector / Matrix buffers allocated and workspace growths
+	uint64_t    allocated = 0;   // Bytes of those allocations
+	uint64_t    total_ns = 0;
+	uint64_t    self_ns = 0;
+	uint64_t    min_ns = UINT64_MAX;
+	uint64_t    max_ns = 0;
+};
+
+// One call, in the per-thread trace
+struct ProfileEvent {
+	const char* op;
+	size_t      rows, cols;
+	uint64_t    start_ns, duration_ns;
+	double      flops, bytes;
+};
+
+class ProfileScope;
+
+/**
+ * @brief Counters of one thread. Only its own thread writes them, the lock is there for the dumps.
+ */
+struct ProfileThread {
+	using Key = std::tuple<std::string_view, size_t, size_t>;
+
+	mutable std::mutex         lock;
+	size_t                     index = 0;
+	std::map<Key, ProfileStat> stats;
+	std::vector<ProfileEvent>  events;
+	uint64_t                   allocations = 0; // Running totals, read by the scopes at both ends
+	uint64_t                   allocated = 0;
+	ProfileScope*              current = nullptr;
+};
+
+/**
+ * @brief Registry of the per-thread counters.
+ */
+class Profiler {
+	protected:
+		mutable std::mutex                          lock;
+		std::vector<std::shared_ptr<ProfileThread>> list; // Kept after their thread exits, until reset()
+		std::chrono::steady_clock::time_point       epoch = std::chrono::steady_clock::now();
+
+		static void write_json_string(std::ostream& os, std::string_view s) {
+			os << '"';
+			for (char c : s)
+				os << ((c == '"' || c == '\\') ? "\\" : "") << c;
+			os << '"';
+		}
+
+	public:
+		std::atomic<bool>   enabled{true};       // Scopes opened while false record nothing
+		std::atomic<size_t> trace_capacity{1 << 16}; // Events kept per thread, later calls are only aggregated
+
+		/**
+		 * @brief Returns the process-wide profiler.
+		 */
+		static Profiler& global() {
+			static Profiler instance;
+			return instance;
+		}
+
+		/**
+		 * @brief Returns the counters of the calling thread, registering them on first use.
+		 */
+		ProfileThread& thread() {
+			thread_local std::shared_ptr<ProfileThread> local = [this] {
+				auto t = std::make_shared<ProfileThread>();
+				std::lock_guard<std::mutex> guard(lock);
+				t->index = list.size();
+				list.push_back(t);
+				return t;
+			}();
+			return *local;
+		}
+
+		// Nanoseconds since the profiler was created, the time base of the trace
+		uint64_t now() const {
+			return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+		}
+
+		/**
+		 * @brief Clears every counter and trace. Must not run while operations are being profiled.
+		 */
+		void reset() {
+			std::lock_guard<std::mutex> guard(lock);
+			for (auto& t : list) {
+				std::lock_guard<std::mutex> tguard(t->lock);
+				t->stats.clear();
+				t->events.clear();
+			}
+		}
+
+		/**
+		 * @brief Returns the counters, one entry per (thread, operation, shape) or merged across threads.
+		 * @param per_thread Whether to keep the threads apart.
+		 * @return std::vector<ProfileStat> The entries, by decreasing self time.
+		 * @note Time complexity : O(e log e) e entries
+		 */
+		std::vector<ProfileStat> stats(bool per_thread = false) const {
+			std::map<std::tuple<size_t, std::string, size_t, size_t>, ProfileStat> merged;
+
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				for (const auto& t : list) {
+					std::lock_guard<std::mutex> tguard(t->lock);
+					for (const auto& [key, s] : t->stats) {
+						ProfileStat& m = merged[{ per_thread ? t->index : 0, s.op, s.rows, s.cols }];
+						if (!m.calls) {
+							m = s;
+							m.thread = per_thread ? t->index : 0;
+							continue;
+						}
+						m.calls       += s.calls;
+						m.flops       += s.flops;
+						m.bytes       += s.bytes;
+						m.allocations += s.allocations;
+						m.allocated   += s.allocated;
+						m.total_ns    += s.total_ns;
+						m.self_ns     += s.self_ns;
+						m.min_ns       = std::min(m.min_ns, s.min_ns);
+						m.max_ns       = std::max(m.max_ns, s.max_ns);
+					}
+				}
+			}
+
+			std::vector<ProfileStat> result;
+			for (auto& [key, s] : merged)
+				result.push_back(std::move(s));
+			std::stable_sort(result.begin(), result.end(), [](const ProfileStat& a, const ProfileStat& b) { return a.self_ns > b.self_ns; });
+			return result;
+		}
+
+		/**
+		 * @brief Writes the per-thread counters as JSON : {"ops": [{"op", "rows", "cols", "thread", "calls", ...}]}.
+		 * @param os The stream to write to.
+		 */
+		void write_json(std::ostream& os) const {
+			os << "{\"ops\": [";
+			bool first = true;
+			for (const ProfileStat& s : stats(true)) {
+				os << (first ? "\n" : ",\n") << "\t{\"op\": ";
+				write_json_string(os, s.op);
+				os << ", \"rows\": " << s.rows << ", \"cols\": " << s.cols << ", \"thread\": " << s.thread
+				   << ", \"calls\": " << s.calls << ", \"flops\": " << s.flops << ", \"bytes\": " << s.bytes
+				   << ", \"allocations\": " << s.allocations << ", \"allocated\": " << s.allocated
+				   << ", \"total_ns\": " << s.total_ns << ", \"self_ns\": " << s.self_ns
+				   << ", \"min_ns\": " << s.min_ns << ", \"max_ns\": " << s.max_ns << "}";
+				first = false;
+			}
+			os << "\n]}\n";
+		}
+
+		/**
+		 * @brief Writes the recorded calls in the Chrome trace event format, one complete ("X") event per call.
+		 * @param os The stream to write to.
+		 *
+		 * @see https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+		 */
+		void write_trace(std::ostream& os) const {
+			std::lock_guard<std::mutex> guard(lock);
+
+			os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+			bool first = true;
+			for (const auto& t : list) {
+				std::lock_guard<std::mutex> tguard(t->lock);
+				for (const ProfileEvent& e : t->events) {
+					os << (first ? "\n" : ",\n") << "\t{\"name\": ";
+					write_json_string(os, e.op);
+					os << ", \"cat\": \"matrix\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << t->index
+					   << ", \"ts\": " << double(e.start_ns) * 1e-3 << ", \"dur\": " << double(e.duration_ns) * 1e-3
+					   << ", \"args\": {\"rows\": " << e.rows << ", \"cols\": " << e.cols
+					   << ", \"flops\": " << e.flops << ", \"bytes\": " << e.bytes << "}}";
+					first = false;
+				}
+			}
+			os << "\n]}\n";
+		}
+};
+
+/**
+ * @brief Times one call of an operation and adds it to the calling thread's counters when it ends.
+ * @details Scopes nest : the duration of a scope is subtracted from the self time of the one it runs in.
+ */
+class ProfileScope {
+	protected:
+		ProfileThread* t = nullptr;
+		ProfileScope*  parent = nullptr;
+		const char*    op;
+		size_t         rows, cols;
+		double         flops, bytes;
+		uint64_t       start = 0, allocations = 0, allocated = 0, children = 0;
+
+	public:
+		/**
+		 * @param op The operation name, a string literal : it is kept by pointer.
+		 * @param rows, cols The shape of the object called on.
+		 * @param flops, bytes The estimated work and memory traffic of the call.
+		 */
+		ProfileScope(const char* op, size_t rows, size_t cols, double flops, double bytes)
+			: op(op), rows(rows), cols(cols), flops(flops), bytes(bytes) {
+			Profiler& p = Profiler::global();
+			if (!p.enabled.load(std::memory_order_relaxed))
+				return;
+
+			t           = &p.thread();
+			parent      = t->current;
+			t->current  = this;
+			allocations = t->allocations;
+			allocated   = t->allocated;
+			start       = p.now();
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+		~ProfileScope() {
+			if (!t)
+				return;
+
+			Profiler&      p = Profiler::global();
+			const uint64_t duration = p.now() - start;
+
+			if (parent)
+				parent->children += duration;
+			t->current = parent;
+
+			std::lock_guard<std::mutex> guard(t->lock);
+			ProfileStat& s = t->stats[{ std::string_view(op), rows, cols }];
+			if (!s.calls) {
+				s.op   = op;
+				s.rows = rows;
+				s.cols = cols;
+			}
+			s.calls++;
+			s.flops       += flops;
+			s.bytes       += bytes;
+			s.allocations += t->allocations - allocations;
+			s.allocated   += t->allocated - allocated;
+			s.total_ns    += duration;
+			s.self_ns     += duration - std::min(duration, children);
+			s.min_ns       = std::min(s.min_ns, duration);
+			s.max_ns       = std::max(s.max_ns, duration);
+
+			if (t->events.size() < p.trace_capacity.load(std::memory_order_relaxed))
+				t->events.push_back({ op, rows, cols, start, duration, flops, bytes });
+		}
+};
+
+/**
+ * @brief Counts one heap allocation of the calling thread, for the scopes open on it.
+ * @param bytes The size of the allocation.
+ */
+inline void profile_allocation(size_t bytes) {
+	Profiler& p = Profiler::global();
+	if (!p.enabled.load(std::memory_order_relaxed))
+		return;
+
+	ProfileThread& t = p.thread();
+	t.allocations++;
+	t.allocated += bytes;
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+# include <array>
+# include "config.hpp"
+
+/**
+ * Closed-form determinant and inverse of 1x1 to 4x4 matrices, shared by Matrix<T> (dispatched on the run-time size)
+ * and Matrix<T, N, N> (at compile time).
+ *
+ * The matrix is first loaded into a packed column-major std::array, element (r, c) at index c * N + r, through
+ * arbitrary strides : (1, ld) for a Matrix<T>, (ld, 1) for its transpose. The cofactor / adjugate formulas are then
+ * straight-line code on that array, with no branch nor loop for the compiler to keep, so they vectorize freely.
+ */
+
+template<size_t N, typename T>
+using SmallMatrix = std::array<T, N * N>;
+
+# pragma region Kernels
+
+/**
+ * @brief Loads the N x N matrix with element (r, c) at m[r * rs + c * cs].
+ */
+template<size_t N, typename T>
+constexpr SmallMatrix<N, T> small_load(const T* m, size_t rs, size_t cs) {
+	SmallMatrix<N, T> a = {};
+	for (size_t c = 0; c < N; c++)
+		for (size_t r = 0; r < N; r++)
+			a[c * N + r] = m[r * rs + c * cs];
+	return a;
+}
+
+template<size_t N, typename T>
+constexpr void small_store(const SmallMatrix<N, T>& a, T* m, size_t rs, size_t cs) {
+	for (size_t c = 0; c < N; c++)
+		for (size_t r = 0; r < N; r++)
+			m[r * rs + c * cs] = a[c * N + r];
+}
+
+/**
+ * @brief 2x2 minors of the two left columns (s) and of the two right columns (c) of a 4x4 matrix, from which both
+ *        its determinant and its adjugate are built (Laplace expansion along pairs of columns).
+ */
+template<typename T>
+struct Minors4 {
+	T s0, s1, s2, s3, s4, s5;
+	T c0, c1, c2, c3, c4, c5;
+
+	constexpr Minors4(const SmallMatrix<4, T>& m)
+		: s0(m[0] * m[5]  - m[1] * m[4]),   s1(m[0] * m[6]  - m[2] * m[4]),   s2(m[0] * m[7]  - m[3] * m[4]),
+		  s3(m[1] * m[6]  - m[2] * m[5]),   s4(m[1] * m[7]  - m[3] * m[5]),   s5(m[2] * m[7]  - m[3] * m[6]),
+		  c0(m[8] * m[13] - m[9] * m[12]),  c1(m[8] * m[14] - m[10] * m[12]), c2(m[8] * m[15] - m[11] * m[12]),
+		  c3(m[9] * m[14] - m[10] * m[13]), c4(m[9] * m[15] - m[11] * m[13]), c5(m[10] * m[15] - m[11] * m[14]) {}
+
+	constexpr T det() const { return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0; }
+};
+
+/**
+ * @brief Determinant by cofactor expansion.
+ * @note Time complexity : O(1)
+ * @note Space complexity : O(1)
+ */
+template<size_t N, typename T>
+constexpr T small_determinant(const SmallMatrix<N, T>& m) {
+	static_assert(N >= 1 && N <= 4, "Closed forms are only provided up to 4x4.");
+
+	if constexpr (N == 1)
+		return m[0];
+	else if constexpr (N == 2)
+		return m[0] * m[3] - m[2] * m[1];
+	else if constexpr (N == 3)
+		return m[0] * (m[4] * m[8] - m[7] * m[5])
+		     - m[3] * (m[1] * m[8] - m[7] * m[2])
+		     + m[6] * (m[1] * m[5] - m[4] * m[2]);
+	else
+		return Minors4<T>(m).det();
+}
+
+/**
+ * @brief Adjugate (transposed cofactor matrix) and determinant : the inverse is adj / det.
+ * @note Time complexity : O(1)
+ * @note Space complexity : O(1)
+ */
+template<size_t N, typename T>
+constexpr SmallMatrix<N, T> small_adjugate(const SmallMatrix<N, T>& m, T& det) {
+	static_assert(N >= 1 && N <= 4, "Closed forms are only provided up to 4x4.");
+
+	if constexpr (N == 1) {
+		det = m[0];
+		return { T(1) };
+	}
+	else if constexpr (N == 2) {
+		det = small_determinant<2>(m);
+		return { m[3], -m[1], -m[2], m[0] };
+	}
+	else if constexpr (N == 3) {
+		const SmallMatrix<3, T> adj = {
+			m[4] * m[8] - m[7] * m[5], m[7] * m[2] - m[1] * m[8], m[1] * m[5] - m[4] * m[2],
+			m[6] * m[5] - m[3] * m[8], m[0] * m[8] - m[6] * m[2], m[3] * m[2] - m[0] * m[5],
+			m[3] * m[7] - m[6] * m[4], m[6] * m[1] - m[0] * m[7], m[0] * m[4] - m[3] * m[1]
+		};
+		det = m[0] * adj[0] + m[3] * adj[1] + m[6] * adj[2]; // First row of m times first column of adj
+		return adj;
+	}
+	else {
+		const Minors4<T> k(m);
+		det = k.det();
+		return {
+			 m[5] * k.c5 - m[6] * k.c4 + m[7] * k.c3,    -m[1] * k.c5 + m[2] * k.c4 - m[3] * k.c3,
+			 m[13] * k.s5 - m[14] * k.s4 + m[15] * k.s3, -m[9] * k.s5 + m[10] * k.s4 - m[11] * k.s3,
+			-m[4] * k.c5 + m[6] * k.c2 - m[7] * k.c1,     m[0] * k.c5 - m[2] * k.c2 + m[3] * k.c1,
+			-m[12] * k.s5 + m[14] * k.s2 - m[15] * k.s1,  m[8] * k.s5 - m[10] * k.s2 + m[11] * k.s1,
+			 m[4] * k.c4 - m[5] * k.c2 + m[7] * k.c0,    -m[0] * k.c4 + m[1] * k.c2 - m[3] * k.c0,
+			 m[12] * k.s4 - m[13] * k.s2 + m[15] * k.s0, -m[8] * k.s4 + m[9] * k.s2 - m[11] * k.s0,
+			-m[4] * k.c3 + m[5] * k.c1 - m[6] * k.c0,     m[0] * k.c3 - m[1] * k.c1 + m[2] * k.c0,
+			-m[12] * k.s3 + m[13] * k.s1 - m[14] * k.s0,  m[8] * k.s3 - m[9] * k.s1 + m[10] * k.s0
+		};
+	}
+}
+
+/**
+ * @brief Checks whether a 4x4 matrix is an affine transform : last row (0, 0, 0, 1).
+ */
+template<typename T>
+constexpr bool is_affine(const SmallMatrix<4, T>& m) {
+	return m[3] == T(0) && m[7] == T(0) && m[11] == T(0) && m[15] == T(1);
+}
+
+/**
+ * @brief Inverts an affine transform [L t ; 0 1] as [L^-1  -L^-1 t ; 0 1], with a 3x3 adjugate instead of a 4x4 one.
+ * @param m The transform, with is_affine(m).
+ * @param det Receives det(L), which is also the determinant of m.
+ * @note Time complexity : O(1)
+ * @note Space complexity : O(1)
+ */
+template<typename T>
+constexpr SmallMatrix<4, T> affine_inverse(const SmallMatrix<4, T>& m, T& det) {
+	const SmallMatrix<3, T> l = { m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10] };
+	const SmallMatrix<3, T> adj = small_adjugate<3>(l, det);
+	const T inv_det = (det == T(0)) ? T(0) : T(1) / det;
+
+	SmallMatrix<4, T> inv = {};
+	for (size_t c = 0; c < 3; c++)
+		for (size_t r = 0; r < 3; r++)
+			inv[c * 4 + r] = adj[c * 3 + r] * inv_det;
+	for (size_t r = 0; r < 3; r++)
+		inv[12 + r] = -(inv[r] * m[12] + inv[4 + r] * m[13] + inv[8 + r] * m[14]);
+	inv[15] = T(1);
+	return inv;
+}
+
+# pragma endregion
+
+/**
+ * @brief Determinant of the N x N matrix with element (r, c) at m[r * rs + c * cs].
+ * @note Time complexity : O(1)
+ * @note Space complexity : O(1)
+ * @note Allowed math functions : None
+ */
+template<size_t N, typename T>
+constexpr T small_determinant(const T* m, size_t rs, size_t cs) {
+	return small_determinant<N>(small_load<N>(m, rs, cs));
+}
+
+/**
+ * @brief Inverse of the N x N matrix with element (r, c) at m[r * rs + c * cs], by adjugate / determinant.
+ * @details 4x4 affine transforms, with a last row (0, 0, 0, 1) or a last column (0, 0, 0, 1) for the row-vector
+ *          convention, take the cheaper affine_inverse path. The input is fully loaded before the output is
+ *          written, so both may be the same storage.
+ * @param m The matrix.
+ * @param out The inverse, element (r, c) written at out[r * ors + c * ocs].
+ * @return bool false if the matrix is singular (zero determinant), in which case out is not written.
+ * @note Time complexity : O(1)
+ * @note Space complexity : O(1)
+ * @note Allowed math functions : None
+ */
+template<size_t N, typename T>
+constexpr bool small_inverse(const T* m, size_t rs, size_t cs, T* out, size_t ors, size_t ocs) {
+	SmallMatrix<N, T> a = small_load<N>(m, rs, cs);
+	SmallMatrix<N, T> inv = {};
+	T det = T(0);
+
+	if constexpr (N == 4) {
+		if (is_affine<T>(a)) {
+			inv = affine_inverse<T>(a, det);
+			if (det == T(0))
+				return false;
+			small_store<4>(inv, out, ors, ocs);
+			return true;
+		}
+		if (a[12] == T(0) && a[13] == T(0) && a[14] == T(0) && a[15] == T(1)) { // Transposed affine : inv(A^T) = inv(A)^T
+			a   = small_load<4>(m, cs, rs);
+			inv = affine_inverse<T>(a, det);
+			if (det == T(0))
+				return false;
+			small_store<4>(inv, out, ocs, ors);
+			return true;
+		}
+	}
+
+	inv = small_adjugate<N>(a, det);
+	if (det == T(0))
+		return false;
+
+	const T inv_det = T(1) / det;
+	for (T& v : inv)
+		v *= inv_det;
+	small_store<N>(inv, out, ors, ocs);
+	return true;
+}
@@ -0,0 +1,497 @@
+#pragma once
+
+# include "Vector.hpp"
+# include "Matrix.hpp"
+# include "LU.hpp"
+
+/**
+ * @brief Cholesky factorization (A = L * L^H) of a Hermitian (symmetric, for real types) positive-definite matrix.
+ * @details Half the flops of LU and no pivoting. Only the lower triangle of A is read. A non-positive pivot does not
+ *          throw : the matrix is flagged as not positive-definite and solving throws, so callers can fall back to LU.
+ * @tparam T The type of the elements in the matrix.
+ *
+ * @see https://en.wikipedia.org/wiki/Cholesky_decomposition
+ */
+template<typename T>
+class Cholesky {
+	protected:
+		Matrix<T>  l;              // Lower factor, zeros above the diagonal
+		TO_REAL<T> anorm = 0;      // 1-norm of A, for rcond()
+		bool       positive = true;
+
+		static inline T conj(const T& v) {
+			if constexpr (IS_COMPLEX(T))
+				return T(v.real(), -v.imag());
+			else
+				return v;
+		}
+
+		void check_solvable(size_t rhs_size) const {
+			if (rhs_size != size())
+				throw std::invalid_argument("Right-hand side size must match the matrix size.");
+			if (!positive)
+				throw std::logic_error("Matrix is not positive-definite.");
+		}
+
+		/**
+		 * @brief Solves L * L^H * x = b in place, column-oriented.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(1)
+		 */
+		void substitute(T* x) const {
+			const size_t n = size();
+
+			for (size_t k = 0; k < n; k++) { // L y = b
+				const T* c = l.col_ptr(k);
+				x[k] /= c[k];
+				for (size_t i = k + 1; i < n; i++)
+					x[i] -= c[i] * x[k];
+			}
+			for (size_t k = n; k-- > 0;) {   // L^H x = y, column k of L is row k of L^H
+				const T* c = l.col_ptr(k);
+				T acc = x[k];
+				for (size_t i = k + 1; i < n; i++)
+					acc -= conj(c[i]) * x[i];
+				x[k] = acc / conj(c[k]);
+			}
+		}
+
+	public:
+		/**
+		 * @brief Factorizes a square matrix, assumed Hermitian.
+		 * @param a The matrix to factorize, moved in to factorize in its storage (Cholesky(std::move(m))).
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @note Time complexity : O(n^3 / 3)
+		 * @note Space complexity : O(n^2), O(1) when the matrix is moved in
+		 * @note Allowed math functions : pow
+		 */
+		Cholesky(Matrix<T> a) : l(std::move(a)) {
+			using R = TO_REAL<T>;
+
+			if (!l.is_square())
+				throw std::invalid_argument("Cholesky factorization can only be computed on square matrix.");
+
+			const size_t n = size();
+
+			for (size_t c = 0; c < n; c++) {
+				R sum = 0;
+				for (size_t r = 0; r < n; r++)
+					sum += magnitude(l[c][r]);
+				anorm = std::max(anorm, sum);
+			}
+
+			// Left-looking : column j receives the updates of the columns before it, split over its rows
+			for (size_t j = 0; j < n; j++) {
+				T* col = l.col_ptr(j);
+
+				parallel_for(j, n, 2 * j, [&](size_t lo, size_t hi) {
+					for (size_t k = 0; k < j; k++) {
+						const T* prev = l.col_ptr(k);
+						const T  ljk = conj(prev[j]);
+
+						for (size_t i = lo; i < hi; i++) {
+							if constexpr (IS_ARITHMETIC(T))
+								col[i] = std::fma(-prev[i], ljk, col[i]);
+							else
+								col[i] -= prev[i] * ljk;
+						}
+					}
+				});
+
+				R d;
+				if constexpr (IS_COMPLEX(T))
+					d = col[j].real();
+				else
+					d = col[j];
+
+				if (!(d > R(0))) {
+					positive = false;
+					return;
+				}
+
+				const T ljj = T(std::pow(d, R(0.5)));
+				col[j] = ljj;
+				for (size_t i = j + 1; i < n; i++)
+					col[i] /= ljj;
+				for (size_t i = 0; i < j; i++)
+					col[i] = T(0);
+			}
+		}
+
+		/**
+		 * @brief Returns the size of the factorized matrix.
+		 * @return size_t The number of rows (and columns).
+		 */
+		inline size_t size() const { return l.rows(); }
+
+		/**
+		 * @brief Checks whether every pivot was positive.
+		 * @return true If the matrix is positive-definite, and the factor usable.
+		 */
+		inline bool is_positive_definite() const { return positive; }
+
+		/**
+		 * @brief Returns the lower factor L.
+		 * @return const Matrix<T>& The factor.
+		 */
+		inline const Matrix<T>& factor() const { return l; }
+
+		/**
+		 * @brief Computes the determinant from the factor.
+		 * @return T The determinant, the squared product of the diagonal of L.
+		 * @throw std::logic_error If the matrix is not positive-definite.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(1)
+		 */
+		T det() const {
+			check_solvable(size());
+
+			T result = T(1);
+			for (size_t i = 0; i < size(); i++)
+				result *= l[i][i] * l[i][i];
+
+			return result;
+		}
+
+		/**
+		 * @brief Solves the system for one right-hand side.
+		 * @details Same convention as Matrix<T>::mul_vec : returns x such that A.mul_vec(x) == b. As A^T = conj(A),
+		 *          this is conj(A^-1 * conj(b)), which is A^-1 * b for real types.
+		 * @param b The right-hand side.
+		 * @return Vector<T> The solution x.
+		 * @throw std::invalid_argument If b does not match the matrix size.
+		 * @throw std::logic_error If the matrix is not positive-definite.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : None
+		 */
+		Vector<T> solve(const Vector<T>& b) const {
+			check_solvable(b.size());
+
+			Vector<T> x(b.size());
+			for (size_t i = 0; i < x.size(); i++)
+				x[i] = conj(b[i]);
+
+			substitute(x.ptr());
+
+			for (size_t i = 0; i < x.size(); i++)
+				x[i] = conj(x[i]);
+
+			return x;
+		}
+
+		/**
+		 * @brief Solves the system for several right-hand sides.
+		 * @details Same convention as Matrix<T>::mul_mat : returns X such that A.mul_mat(X) == B.
+		 *          Columns of B are solved in parallel.
+		 * @param b The right-hand sides, one per column.
+		 * @return Matrix<T> The solutions, one per column.
+		 * @throw std::invalid_argument If B rows do not match the matrix size.
+		 * @throw std::logic_error If the matrix is not positive-definite.
+		 * @note Time complexity : O(n^2 * k) with k the number of columns of B
+		 * @note Space complexity : O(n * k)
+		 * @note Allowed math functions : None
+		 */
+		Matrix<T> solve(const Matrix<T>& b) const {
+			check_solvable(b.rows());
+
+			Matrix<T> x = b;
+			parallel_for(0, x.cols(), 2 * size() * size(), [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++)
+					substitute(x.col_ptr(c));
+			});
+
+			return x;
+		}
+
+		/**
+		 * @brief Estimates the reciprocal condition number of the matrix in the 1-norm (see LU<T>::rcond).
+		 * @return TO_REAL<T> The estimate, 0 if the matrix is not positive-definite.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : fma, pow
+		 */
+		TO_REAL<T> rcond() const {
+			using R = TO_REAL<T>;
+
+			if (!positive || anorm == R(0))
+				return R(0);
+
+			// A is Hermitian : A^-T x = conj(A^-1 conj(x))
+			auto solve_a = [&](Vector<T>& x) { substitute(x.ptr()); };
+			auto solve_t = [&](Vector<T>& x) {
+				for (size_t i = 0; i < x.size(); i++)
+					x[i] = conj(x[i]);
+				substitute(x.ptr());
+				for (size_t i = 0; i < x.size(); i++)
+					x[i] = conj(x[i]);
+			};
+
+			return R(1) / (anorm * inverse_norm1<T>(size(), solve_a, solve_t));
+		}
+};
+
+/**
+ * @brief Linear system solver behind Matrix<T>::solve.
+ * @details The matrix is scanned once (O(n^2), negligible next to a factorization) and the cheapest exact method
+ *          for its structure is used :
+ *          - diagonal : one division per element, O(n) per right-hand side ;
+ *          - triangular : forward or back substitution, O(n^2) per right-hand side, no factorization ;
+ *          - Hermitian with a positive diagonal : Cholesky, falling back to LU if it meets a non-positive pivot ;
+ *          - otherwise : LU with partial pivoting.
+ * @tparam T The type of the elements in the matrix.
+ */
+template<typename T>
+class Solver {
+	public:
+		using R = TO_REAL<T>;
+
+		enum class Structure { Diagonal, Lower, Upper, Hermitian, General };
+
+	protected:
+
+		static inline T conj(const T& v) {
+			if constexpr (IS_COMPLEX(T))
+				return T(v.real(), -v.imag());
+			else
+				return v;
+		}
+
+		static void check(const Matrix<T>& a, size_t rhs_size) {
+			if (!a.is_square())
+				throw std::invalid_argument("A system can only be solved with a square matrix.");
+			if (rhs_size != a.rows())
+				throw std::invalid_argument("Right-hand side size must match the matrix size.");
+		}
+
+		static void check_diagonal(const Matrix<T>& a) {
+			for (size_t i = 0; i < a.rows(); i++)
+				if (a[i][i] == T(0))
+					throw std::logic_error("Matrix is singular and the system cannot be solved.");
+		}
+
+		/**
+		 * @brief Solves op(A) * x = b in place for a triangular A, op being the identity or the transposition.
+		 * @details Every variant walks the columns of A, so the inner loops are contiguous.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(1)
+		 */
+		static void triangular(const Matrix<T>& a, bool lower, bool transposed, T* x) {
+			const size_t n = a.rows();
+
+			if (lower != transposed) { // Lower system : forward substitution
+				for (size_t k = 0; k < n; k++) {
+					const T* c = a.col_ptr(k);
+					if (transposed) {  // Row k of A^T is column k of A
+						T acc = x[k];
+						for (size_t i = 0; i < k; i++)
+							acc -= c[i] * x[i];
+						x[k] = acc / c[k];
+					}
+					else {
+						x[k] /= c[k];
+						for (size_t i = k + 1; i < n; i++)
+							x[i] -= c[i] * x[k];
+					}
+				}
+			}
+			else {                     // Upper system : back substitution
+				for (size_t k = n; k-- > 0;) {
+					const T* c = a.col_ptr(k);
+					if (transposed) {
+						T acc = x[k];
+						for (size_t i = k + 1; i < n; i++)
+							acc -= c[i] * x[i];
+						x[k] = acc / c[k];
+					}
+					else {
+						x[k] /= c[k];
+						for (size_t i = 0; i < k; i++)
+							x[i] -= c[i] * x[k];
+					}
+				}
+			}
+		}
+
+		static R norm1(const Matrix<T>& a) {
+			R result = 0;
+			for (size_t c = 0; c < a.cols(); c++) {
+				R sum = 0;
+				for (size_t r = 0; r < a.rows(); r++)
+					sum += magnitude(a[c][r]);
+				result = std::max(result, sum);
+			}
+			return result;
+		}
+
+		static R triangular_rcond(const Matrix<T>& a, bool lower) {
+			const R anorm = norm1(a);
+			if (anorm == R(0))
+				return R(0);
+
+			const R inv = inverse_norm1<T>(a.rows(),
+				[&](Vector<T>& x) { triangular(a, lower, false, x.ptr()); },
+				[&](Vector<T>& x) { triangular(a, lower, true, x.ptr()); });
+
+			return R(1) / (anorm * inv);
+		}
+
+		static R diagonal_rcond(const Matrix<T>& a) {
+			R lo = magnitude(a[0][0]), hi = lo;
+			for (size_t i = 1; i < a.rows(); i++) {
+				lo = std::min(lo, magnitude(a[i][i]));
+				hi = std::max(hi, magnitude(a[i][i]));
+			}
+			return hi == R(0) ? R(0) : lo / hi;
+		}
+
+	public:
+		/**
+		 * @brief Detects the structure of a square matrix.
+		 * @param a The matrix.
+		 * @return Structure The most specific structure, Diagonal before Lower / Upper before Hermitian.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(1)
+		 */
+		static Structure structure(const Matrix<T>& a) {
+			const size_t n = a.rows();
+			bool lower = true, upper = true, hermitian = true;
+
+			for (size_t c = 0; c < n; c++) {
+				for (size_t r = 0; r < n; r++) {
+					if (r < c && a[c][r] != T(0)) lower = false;
+					if (r > c && a[c][r] != T(0)) upper = false;
+					if (r > c && a[c][r] != conj(a[r][c])) hermitian = false;
+				}
+				const T d = a[c][c];
+				if constexpr (IS_COMPLEX(T))
+					hermitian = hermitian && d.imag() == R(0) && d.real() > R(0);
+				else
+					hermitian = hermitian && d > T(0);
+			}
+
+			if (lower && upper) return Structure::Diagonal;
+			if (lower)          return Structure::Lower;
+			if (upper)          return Structure::Upper;
+			if (hermitian)      return Structure::Hermitian;
+			return Structure::General;
+		}
+
+		/**
+		 * @brief Solves A.mul_vec(x) == b (see Matrix<T>::solve).
+		 * @param a The matrix.
+		 * @param b The right-hand side.
+		 * @param rcond If not null, receives the reciprocal condition number estimate in the 1-norm.
+		 * @return Vector<T> The solution x.
+		 * @throw std::invalid_argument If the matrix is not square or b does not match its size.
+		 * @throw std::logic_error If the matrix is singular.
+		 */
+		static Vector<T> solve(const Matrix<T>& a, const Vector<T>& b, R* rcond = nullptr) {
+			check(a, b.size());
+			if (!a.rows())
+				return b;
+
+			const Structure kind = structure(a);
+
+			switch (kind) {
+				case Structure::Diagonal: {
+					check_diagonal(a);
+					if (rcond) *rcond = diagonal_rcond(a);
+
+					Vector<T> x(b);
+					for (size_t i = 0; i < x.size(); i++)
+						x[i] /= a[i][i];
+					return x;
+				}
+				case Structure::Lower:
+				case Structure::Upper: {
+					check_diagonal(a);
+					const bool lower = kind == Structure::Lower;
+					if (rcond) *rcond = triangular_rcond(a, lower);
+
+					Vector<T> x(b);
+					triangular(a, lower, true, x.ptr()); // mul_vec applies A^T
+					return x;
+				}
+				case Structure::Hermitian: {
+					Cholesky<T> chol(a);
+					if (chol.is_positive_definite()) {
+						if (rcond) *rcond = chol.rcond();
+						return chol.solve(b);
+					}
+					break;
+				}
+				case Structure::General:
+					break;
+			}
+
+			LU<T> lu(a);
+			if (rcond) *rcond = lu.rcond();
+			if (lu.is_singular())
+				throw std::logic_error("Matrix is singular and the system cannot be solved.");
+			return lu.solve(b);
+		}
+
+		/**
+		 * @brief Solves A.mul_mat(X) == B (see Matrix<T>::solve).
+		 * @param a The matrix.
+		 * @param b The right-hand sides, one per column.
+		 * @param rcond If not null, receives the reciprocal condition number estimate in the 1-norm.
+		 * @return Matrix<T> The solutions, one per column.
+		 * @throw std::invalid_argument If the matrix is not square or B rows do not match its size.
+		 * @throw std::logic_error If the matrix is singular.
+		 */
+		static Matrix<T> solve(const Matrix<T>& a, const Matrix<T>& b, R* rcond = nullptr) {
+			check(a, b.rows());
+			if (!a.rows())
+				return b;
+
+			const size_t n = a.rows();
+
+			const Structure kind = structure(a);
+
+			switch (kind) {
+				case Structure::Diagonal: {
+					check_diagonal(a);
+					if (rcond) *rcond = diagonal_rcond(a);
+
+					Matrix<T> x = b;
+					parallel_for(0, x.cols(), n, [&](size_t lo, size_t hi) {
+						for (size_t c = lo; c < hi; c++)
+							for (size_t r = 0; r < n; r++)
+								x[c][r] /= a[r][r];
+					});
+					return x;
+				}
+				case Structure::Lower:
+				case Structure::Upper: {
+					check_diagonal(a);
+					const bool lower = kind == Structure::Lower;
+					if (rcond) *rcond = triangular_rcond(a, lower);
+
+					Matrix<T> x = b;
+					parallel_for(0, x.cols(), n * n, [&](size_t lo, size_t hi) {
+						for (size_t c = lo; c < hi; c++)
+							triangular(a, lower, false, x.col_ptr(c));
+					});
+					return x;
+				}
+				case Structure::Hermitian: {
+					Cholesky<T> chol(a);
+					if (chol.is_positive_definite()) {
+						if (rcond) *rcond = chol.rcond();
+						return chol.solve(b);
+					}
+					break;
+				}
+				case Structure::General:
+					break;
+			}
+
+			LU<T> lu(a);
+			if (rcond) *rcond = lu.rcond();
+			if (lu.is_singular())
+				throw std::logic_error("Matrix is singular and the system cannot be solved.");
+			return lu.solve(b);
+		}
+};
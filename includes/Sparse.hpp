@@ -0,0 +1,495 @@
+#pragma once
+
+# include <limits>
+# include "Vector.hpp"
+# include "Matrix.hpp"
+
+/**
+ * @brief Represents a sparse m x n matrix in Compressed Sparse Column (CSC) form.
+ * @details Only the nonzero elements are stored, column after column as for Matrix<T> : the elements of column c are
+ *          values()[offsets()[c] .. offsets()[c + 1]), at rows indices()[...] in increasing order. Memory and the cost
+ *          of mul_vec, add and scl scale with the number of nonzeros instead of m * n.
+ *          The storage is kept canonical : sorted rows, no duplicates and no stored zeros.
+ * @tparam T The type of the elements in the matrix.
+ *
+ * @see https://en.wikipedia.org/wiki/Sparse_matrix#Compressed_sparse_column_(CSC_or_CCS)
+ */
+template<typename T>
+class SparseMatrix {
+	protected:
+		std::vector<size_t> offset = { 0 }; // Start of each column in idx / val, cols + 1 entries
+		std::vector<size_t> idx;            // Row of each stored element
+		std::vector<T>      val;            // Stored elements
+		size_t n_rows = 0;
+		size_t n_cols = 0;
+
+		// Sparse row of the eliminations : sorted columns and their values
+		struct Row {
+			std::vector<size_t> cols;
+			std::vector<T>      vals;
+
+			T at(size_t c) const {
+				auto it = std::lower_bound(cols.begin(), cols.end(), c);
+				return (it != cols.end() && *it == c) ? vals[size_t(it - cols.begin())] : T(0);
+			}
+		};
+
+		/**
+		 * @brief row += factor * pivot, dropping the results whose magnitude is at most tol.
+		 * @note Time complexity : O(nnz(row) + nnz(pivot))
+		 */
+		static void axpy(Row& row, const T& factor, const Row& pivot, TO_REAL<T> tol, Row& scratch) {
+			scratch.cols.clear();
+			scratch.vals.clear();
+
+			size_t i = 0, j = 0;
+			while (i < row.cols.size() || j < pivot.cols.size()) {
+				size_t c;
+				T      v;
+
+				if (j == pivot.cols.size() || (i < row.cols.size() && row.cols[i] < pivot.cols[j]))
+					c = row.cols[i], v = row.vals[i++];
+				else if (i == row.cols.size() || pivot.cols[j] < row.cols[i])
+					c = pivot.cols[j], v = factor * pivot.vals[j++];
+				else
+					c = row.cols[i], v = row.vals[i++] + factor * pivot.vals[j++];
+
+				if (magnitude(v) > tol) {
+					scratch.cols.push_back(c);
+					scratch.vals.push_back(v);
+				}
+			}
+			std::swap(row, scratch);
+		}
+
+		/**
+		 * @brief Gauss elimination on sparse rows, with partial pivoting and a drop tolerance.
+		 * @details The rows that are not pivots yet are bucketed by their leading column : the pivot of column lead is
+		 *          searched, and eliminated, only among the rows starting at lead, which then move to the bucket of their
+		 *          new leading column. For the RREF, holders[c] lists the pivot rows that may store column c (some entries
+		 *          are stale after a cancellation, and checked), so the rows above a pivot are found without a scan either.
+		 * @param rows The matrix rows, reduced in place and reordered : the first (returned) rank rows hold the pivots.
+		 * @param reduced Whether to also eliminate above the pivots and normalize them (RREF), or only below (REF).
+		 * @param tol The magnitude at or under which an entry is zero.
+		 * @return size_t The rank.
+		 * @note Time complexity : O(m + n + the work of the row updates), O(nnz + m + n) without fill-in (e.g. diagonal or triangular)
+		 */
+		size_t eliminate(std::vector<Row>& rows, bool reduced, TO_REAL<T> tol) const {
+			std::vector<std::vector<size_t>> starting(n_cols); // Non-pivot rows by leading column
+			std::vector<std::vector<size_t>> holders(reduced ? n_cols : 0);
+			std::vector<size_t>              pivots;
+			Row                              scratch;
+
+			for (size_t i = 0; i < n_rows; i++)
+				if (!rows[i].cols.empty())
+					starting[rows[i].cols[0]].push_back(i);
+
+			const auto drop_lead = [](Row& row) {
+				row.cols.erase(row.cols.begin());
+				row.vals.erase(row.vals.begin());
+			};
+
+			for (size_t lead = 0; lead < n_cols; lead++) {
+				std::vector<size_t> candidates = std::move(starting[lead]);
+				if (candidates.empty())
+					continue;
+
+				size_t p = 0;
+				for (size_t k = 1; k < candidates.size(); k++)
+					if (magnitude(rows[candidates[k]].vals[0]) > magnitude(rows[candidates[p]].vals[0]))
+						p = k;
+				const size_t pr = candidates[p];
+				Row&         pivot = rows[pr];
+
+				if (reduced) {
+					const T inv = T(1) / pivot.vals[0];
+					for (T& v : pivot.vals)
+						v *= inv;
+					pivot.vals[0] = T(1);
+				}
+
+				for (size_t i : candidates) { // Below : the other rows starting at lead
+					if (i == pr)
+						continue;
+					axpy(rows[i], -rows[i].vals[0] / pivot.vals[0], pivot, tol, scratch);
+					if (!rows[i].cols.empty() && rows[i].cols[0] == lead) // Drop the cancelled pivot entry exactly
+						drop_lead(rows[i]);
+					if (!rows[i].cols.empty())
+						starting[rows[i].cols[0]].push_back(i);
+				}
+
+				if (reduced) { // Above : the previous pivot rows storing column lead
+					for (size_t i : std::exchange(holders[lead], {})) {
+						const T x = rows[i].at(lead);
+						if (x == T(0))
+							continue;
+						axpy(rows[i], -x, pivot, tol, scratch); // Cancels column lead exactly, the pivot being 1
+						for (size_t k = 1; k < pivot.cols.size(); k++) // The fill-in can only be in the pivot columns
+							holders[pivot.cols[k]].push_back(i);
+					}
+					for (size_t k = 1; k < pivot.cols.size(); k++)
+						holders[pivot.cols[k]].push_back(pr);
+				}
+				pivots.push_back(pr);
+			}
+
+			// Pivots first, in order, then the rows left empty
+			std::vector<Row>  ordered;
+			std::vector<bool> is_pivot(n_rows, false);
+			ordered.reserve(n_rows);
+			for (size_t i : pivots) {
+				ordered.push_back(std::move(rows[i]));
+				is_pivot[i] = true;
+			}
+			for (size_t i = 0; i < n_rows; i++)
+				if (!is_pivot[i])
+					ordered.push_back(std::move(rows[i]));
+			rows = std::move(ordered);
+
+			return pivots.size();
+		}
+
+		/**
+		 * @brief Returns the rows of the matrix as sparse rows, entries at most tol dropped.
+		 * @note Time complexity : O(nnz)
+		 */
+		std::vector<Row> to_rows(TO_REAL<T> tol) const {
+			std::vector<Row> rows(n_rows);
+
+			for (size_t c = 0; c < n_cols; c++)
+				for (size_t k = offset[c]; k < offset[c + 1]; k++)
+					if (magnitude(val[k]) > tol) {
+						rows[idx[k]].cols.push_back(c);
+						rows[idx[k]].vals.push_back(val[k]);
+					}
+			return rows;
+		}
+
+		// Default drop tolerance, as for Matrix<T> : max(m, n) * epsilon * ||A||_inf
+		TO_REAL<T> default_tolerance() const {
+			using R = TO_REAL<T>;
+
+			std::vector<R> sums(n_rows, R(0));
+			for (size_t k = 0; k < idx.size(); k++)
+				sums[idx[k]] += magnitude(val[k]);
+
+			const R norm = sums.empty() ? R(0) : *std::max_element(sums.begin(), sums.end());
+			return R(std::max(n_rows, n_cols)) * std::numeric_limits<R>::epsilon() * norm;
+		}
+
+	public:
+		// One element of a matrix given by coordinates, see the triplets constructor
+		struct Entry {
+			size_t row;
+			size_t col;
+			T      value;
+		};
+
+		SparseMatrix() = default;
+
+		/**
+		 * @brief Creates an all-zero sparse matrix, with the same cols-first order as Matrix<T>(cols, rows).
+		 * @param cols The number of columns.
+		 * @param rows The number of rows.
+		 */
+		SparseMatrix(const size_t& cols, const size_t& rows) : offset(cols + 1, 0), n_rows(rows), n_cols(cols) {}
+
+		/**
+		 * @brief Creates a sparse matrix from its nonzero elements, in any order.
+		 * @details Duplicated coordinates are summed, and the elements that end up zero are not stored.
+		 * @param cols The number of columns.
+		 * @param rows The number of rows.
+		 * @param entries The elements.
+		 * @throw std::out_of_range If an element is outside of the matrix.
+		 * @note Time complexity : O(nnz log(nnz per column) + cols)
+		 * @note Space complexity : O(nnz + cols)
+		 */
+		SparseMatrix(const size_t& cols, const size_t& rows, std::vector<Entry> entries) : SparseMatrix(cols, rows) {
+			for (const Entry& e : entries)
+				if (e.row >= rows || e.col >= cols)
+					throw std::out_of_range("Sparse matrix element is out of the matrix bounds.");
+
+			std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+				return a.col != b.col ? a.col < b.col : a.row < b.row;
+			});
+
+			for (size_t i = 0; i < entries.size();) {
+				const Entry& e = entries[i];
+				T sum = T(0);
+				for (; i < entries.size() && entries[i].col == e.col && entries[i].row == e.row; i++)
+					sum += entries[i].value;
+
+				if (sum != T(0)) {
+					idx.push_back(e.row);
+					val.push_back(sum);
+					offset[e.col + 1]++;
+				}
+			}
+			for (size_t c = 0; c < cols; c++)
+				offset[c + 1] += offset[c];
+		}
+
+		/**
+		 * @brief Compresses a dense matrix.
+		 * @param m The dense matrix.
+		 * @param drop Elements whose magnitude is at most drop are not stored, only exact zeros by default.
+		 * @note Time complexity : O(m*n) matrix rows * matrix cols
+		 * @note Space complexity : O(nnz)
+		 */
+		explicit SparseMatrix(const Matrix<T>& m, TO_REAL<T> drop = 0) : SparseMatrix(m.cols(), m.rows()) {
+			for (size_t c = 0; c < n_cols; c++) {
+				const T* col = m.col_ptr(c);
+				for (size_t r = 0; r < n_rows; r++)
+					if (col[r] != T(0) && magnitude(col[r]) > drop) {
+						idx.push_back(r);
+						val.push_back(col[r]);
+					}
+				offset[c + 1] = idx.size();
+			}
+		}
+
+		/**
+		 * @brief Expands the matrix to a dense one.
+		 * @return Matrix<T> The dense matrix.
+		 * @note Time complexity : O(m*n + nnz)
+		 * @note Space complexity : O(m*n)
+		 */
+		Matrix<T> dense() const {
+			Matrix<T> result(n_cols, n_rows);
+
+			for (size_t c = 0; c < n_cols; c++) {
+				T* col = result.col_ptr(c);
+				for (size_t k = offset[c]; k < offset[c + 1]; k++)
+					col[idx[k]] = val[k];
+			}
+			return result;
+		}
+
+		/**
+		 * @brief Adds two sparse matrices, merging their columns.
+		 * @param other The other matrix to add.
+		 * @throw std::invalid_argument If the matrices are not of the same shape.
+		 * @note Time complexity : O(nnz(A) + nnz(B))
+		 * @note Space complexity : O(nnz(A) + nnz(B))
+		 * @note Allowed math functions : None
+		 */
+		void add(const SparseMatrix<T>& other) { merge(other, T(1)); }
+
+		/**
+		 * @brief Subtracts a sparse matrix from this one, merging their columns.
+		 * @see add
+		 */
+		void sub(const SparseMatrix<T>& other) { merge(other, T(-1)); }
+
+		/**
+		 * @brief Sets this matrix to this + factor * other, dropping the elements that cancel out.
+		 * @param other The other matrix.
+		 * @param factor The scale of the other matrix.
+		 * @throw std::invalid_argument If the matrices are not of the same shape.
+		 */
+		void merge(const SparseMatrix<T>& other, const T& factor) {
+			if (shape() != other.shape())
+				throw std::invalid_argument("Matrices must have the same shape.");
+
+			std::vector<size_t> new_offset(n_cols + 1, 0), new_idx;
+			std::vector<T>      new_val;
+			new_idx.reserve(idx.size() + other.idx.size());
+			new_val.reserve(idx.size() + other.idx.size());
+
+			for (size_t c = 0; c < n_cols; c++) {
+				size_t i = offset[c], j = other.offset[c];
+				const size_t i_end = offset[c + 1], j_end = other.offset[c + 1];
+
+				while (i < i_end || j < j_end) {
+					size_t r;
+					T      v;
+
+					if (j == j_end || (i < i_end && idx[i] < other.idx[j]))
+						r = idx[i], v = val[i++];
+					else if (i == i_end || other.idx[j] < idx[i])
+						r = other.idx[j], v = factor * other.val[j++];
+					else
+						r = idx[i], v = val[i++] + factor * other.val[j++];
+
+					if (v != T(0)) {
+						new_idx.push_back(r);
+						new_val.push_back(v);
+					}
+				}
+				new_offset[c + 1] = new_idx.size();
+			}
+
+			offset = std::move(new_offset);
+			idx    = std::move(new_idx);
+			val    = std::move(new_val);
+		}
+
+		/**
+		 * @brief Scale the matrix by a scalar.
+		 * @param scalar The scalar to scale the matrix by. Scaling by zero empties the storage.
+		 * @note Time complexity : O(nnz)
+		 * @note Space complexity : O(1)
+		 * @note Allowed math functions : None
+		 */
+		void scl(const T& scalar) {
+			if (scalar == T(0)) {
+				*this = SparseMatrix<T>(n_cols, n_rows);
+				return;
+			}
+			for (T& v : val)
+				v *= scalar;
+		}
+
+		/**
+		 * @brief Multiplies the matrix by a vector (SpMV), with the Matrix<T>::mul_vec convention.
+		 * @details result[c] = sum over the stored elements m(r, c) of m(r, c) * v[r] : each result element is a sparse
+		 *          dot product over one contiguous column, and the columns are spread over the thread pool.
+		 * @param other The vector to multiply, of rows() elements.
+		 * @return Vector<T> The resulting vector, of cols() elements.
+		 * @throw std::invalid_argument If the matrix rows do not match the vector size.
+		 * @note Time complexity : O(nnz + n)
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : fma
+		 */
+		Vector<T> mul_vec(const Vector<T>& other) const {
+			if (n_rows != other.size())
+				throw std::invalid_argument("Matrix rows must match vector size");
+
+			Vector<T> result(n_cols);
+			const T*  v = other.ptr();
+
+			parallel_for(0, n_cols, 2 * (idx.size() / std::max<size_t>(n_cols, 1)) + 1, [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++) {
+					T acc = T(0);
+
+					for (size_t k = offset[c]; k < offset[c + 1]; k++) {
+						if constexpr (IS_ARITHMETIC(T))
+							acc = std::fma(val[k], v[idx[k]], acc);
+						else
+							acc += val[k] * v[idx[k]];
+					}
+					result[c] = acc;
+				}
+			});
+
+			return result;
+		}
+
+		/**
+		 * @brief Transposes the matrix, by a counting sort of the elements on their rows.
+		 * @return SparseMatrix<T> The transposed matrix, canonical as well.
+		 * @note Time complexity : O(nnz + m + n)
+		 * @note Space complexity : O(nnz + m)
+		 */
+		SparseMatrix<T> transpose() const {
+			SparseMatrix<T> result(n_rows, n_cols);
+			result.idx.resize(idx.size());
+			result.val.resize(val.size());
+
+			for (size_t r : idx)
+				result.offset[r + 1]++;
+			for (size_t r = 0; r < n_rows; r++)
+				result.offset[r + 1] += result.offset[r];
+
+			std::vector<size_t> next(result.offset.begin(), result.offset.end() - 1);
+			for (size_t c = 0; c < n_cols; c++) // Columns in order, so every new column gets increasing rows
+				for (size_t k = offset[c]; k < offset[c + 1]; k++) {
+					const size_t dst = next[idx[k]]++;
+					result.idx[dst] = c;
+					result.val[dst] = val[k];
+				}
+
+			return result;
+		}
+
+		/**
+		 * @brief Converts the matrix to its Reduced Row Echelon Form, keeping it sparse.
+		 * @details Same form as Matrix<T>::row_echelon(), by Gauss-Jordan elimination on sparse rows : only the stored
+		 *          elements are touched, and the fill-in whose magnitude is at most the tolerance is dropped.
+		 * @param tolerance The magnitude under which an entry is zero, or negative for max(m, n) * epsilon * ||A||_inf.
+		 * @return SparseMatrix<T> The Row Echelon Form of the matrix.
+		 * @note Time complexity : O(rank * m * nnz per row) at worst, O(nnz log(nnz) + m + n) without fill-in
+		 * @note Space complexity : O(nnz of the result)
+		 * @note Allowed math functions : None
+		 */
+		SparseMatrix<T> row_echelon(TO_REAL<T> tolerance = -1) const {
+			const TO_REAL<T> tol = (tolerance < TO_REAL<T>(0)) ? default_tolerance() : tolerance;
+			std::vector<Row> rows = to_rows(tol);
+			const size_t     rank = eliminate(rows, true, tol);
+
+			std::vector<Entry> entries;
+			for (size_t r = 0; r < rank; r++)
+				for (size_t k = 0; k < rows[r].cols.size(); k++)
+					entries.push_back({ r, rows[r].cols[k], rows[r].vals[k] });
+
+			return SparseMatrix<T>(n_cols, n_rows, std::move(entries));
+		}
+
+		/**
+		 * @brief Computes the rank of the matrix.
+		 * @details Gauss elimination on sparse rows, below the pivots only, counting the pivots.
+		 * @param tolerance The magnitude under which an entry is zero, or negative for the default of row_echelon().
+		 * @return size_t The rank of the matrix.
+		 * @note Time complexity : O(rank * m * nnz per row) at worst, O(nnz + m + n) without fill-in
+		 * @note Space complexity : O(nnz with fill-in)
+		 * @note Allowed math functions : None
+		 */
+		size_t rank(TO_REAL<T> tolerance = -1) const {
+			const TO_REAL<T> tol = (tolerance < TO_REAL<T>(0)) ? default_tolerance() : tolerance;
+			std::vector<Row> rows = to_rows(tol);
+			return eliminate(rows, false, tol);
+		}
+
+		# pragma region Utils
+
+		inline size_t rows() const { return n_rows; }
+		inline size_t cols() const { return n_cols; }
+		inline std::pair<size_t, size_t> shape() const { return { n_rows, n_cols }; }
+		inline bool is_square() const { return n_rows == n_cols; }
+
+		/**
+		 * @brief Returns the number of stored (nonzero) elements.
+		 * @return size_t The number of nonzeros.
+		 */
+		inline size_t nnz() const { return idx.size(); }
+
+		inline const std::vector<size_t>& offsets() const { return offset; }
+		inline const std::vector<size_t>& indices() const { return idx; }
+		inline const std::vector<T>& values() const { return val; }
+
+		/**
+		 * @brief Returns element (r, c), zero when it is not stored.
+		 * @note Time complexity : O(log(nnz of column c))
+		 */
+		T at(size_t r, size_t c) const {
+			auto first = idx.begin() + std::ptrdiff_t(offset[c]), last = idx.begin() + std::ptrdiff_t(offset[c + 1]);
+			auto it = std::lower_bound(first, last, r);
+			return (it != last && *it == r) ? val[size_t(it - idx.begin())] : T(0);
+		}
+
+		bool operator==(const SparseMatrix<T>& other) const {
+			if (shape() != other.shape())
+				return false;
+
+			SparseMatrix<T> diff = *this;
+			diff.sub(other);
+
+			const TO_REAL<T> eps = TO_REAL<T>(1e-5); // Same tolerance as Matrix<T>
+			for (const T& v : diff.val)
+				if (magnitude(v) > eps)
+					return false;
+			return true;
+		}
+
+		# pragma endregion
+};
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const SparseMatrix<T>& mat) {
+	os << "{";
+	for (size_t c = 0, first = 1; c < mat.cols(); c++)
+		for (size_t k = mat.offsets()[c]; k < mat.offsets()[c + 1]; k++, first = 0)
+			os << (first ? "" : ", ") << "(" << mat.indices()[k] << ", " << c << "): " << mat.values()[k];
+	os << "}";
+	return os;
+}
@@ -0,0 +1,963 @@
+#pragma once
+
+# include <utility>
+# include "Vector.hpp"
+# include "Matrix.hpp"
+# include "Solve.hpp"
+
+/**
+ * Square matrices with a known structure, storing only the elements the structure allows :
+ * - DiagonalMatrix<T>   : the n diagonal elements ;
+ * - TriangularMatrix<T> : the n(n+1)/2 elements of the lower or upper triangle, packed column after column ;
+ * - SymmetricMatrix<T>  : the n(n+1)/2 elements of the lower triangle, A(r, c) == A(c, r) ;
+ * - BandedMatrix<T>     : the kl subdiagonals, the diagonal and the ku superdiagonals, LAPACK band storage.
+ *
+ * They follow the Matrix<T> conventions, so they can replace a dense matrix in an expression :
+ * mul_vec(v)[c] = sum over r of A(r, c) * v[r], mul_mat(B) = A * B, solve(b) returns x such that mul_vec(x) == b
+ * and solve(B) returns X such that mul_mat(X) == B. Each operation uses the cheapest kernel for its structure.
+ * Elements are read with at(r, c) (zero outside the structure) and written with (r, c), which throws
+ * std::out_of_range outside of it. dense() expands to a Matrix<T>, and the explicit constructors from a Matrix<T>
+ * keep the elements the structure stores, ignoring the others.
+ */
+
+enum class Triangle { Lower, Upper };
+
+# pragma region Utils
+
+template<typename T>
+inline void structured_fma(T& acc, const T& a, const T& b) {
+	if constexpr (IS_ARITHMETIC(T))
+		acc = std::fma(a, b, acc);
+	else
+		acc += a * b;
+}
+
+inline void check_square_shape(const std::pair<size_t, size_t>& shape) {
+	if (shape.first != shape.second)
+		throw std::invalid_argument("Structured matrices can only be built from a square matrix.");
+}
+
+inline void check_structured_size(size_t n, size_t size, const char* what) {
+	if (n != size)
+		throw std::invalid_argument(what);
+}
+
+[[noreturn]] inline void throw_singular() {
+	throw std::logic_error("Matrix is singular and the system cannot be solved.");
+}
+
+# pragma endregion
+
+/**
+ * @brief Diagonal matrix, storing its n diagonal elements.
+ * @tparam T The type of the elements in the matrix.
+ */
+template<typename T>
+class DiagonalMatrix {
+	protected:
+		std::vector<T> diag;
+
+	public:
+		DiagonalMatrix() = default;
+		explicit DiagonalMatrix(size_t n) : diag(n, T(0)) {}
+		explicit DiagonalMatrix(const Vector<T>& d) : diag(d.ptr(), d.ptr() + d.size()) {}
+
+		/**
+		 * @brief Keeps the diagonal of a square matrix.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 */
+		explicit DiagonalMatrix(const Matrix<T>& m) : diag(m.rows()) {
+			check_square_shape(m.shape());
+			for (size_t i = 0; i < size(); i++)
+				diag[i] = m[i][i];
+		}
+
+		/**
+		 * @brief Multiplies the matrix by a vector : one product per element.
+		 * @throw std::invalid_argument If the vector size does not match the matrix size.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : None
+		 */
+		Vector<T> mul_vec(const Vector<T>& v) const {
+			check_structured_size(size(), v.size(), "Matrix rows must match vector size");
+
+			Vector<T> result(size());
+			for (size_t i = 0; i < size(); i++)
+				result[i] = diag[i] * v[i];
+			return result;
+		}
+
+		/**
+		 * @brief Computes D * B, scaling each row of B.
+		 * @throw std::invalid_argument If the matrix size does not match B rows.
+		 * @note Time complexity : O(n*p) instead of the O(n^2*p) of a dense product
+		 * @note Space complexity : O(n*p)
+		 * @note Allowed math functions : None
+		 */
+		Matrix<T> mul_mat(const Matrix<T>& b) const {
+			check_structured_size(size(), b.rows(), "Matrix columns must match the other matrix rows");
+
+			Matrix<T> result = b;
+			parallel_for(0, b.cols(), b.rows(), [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++) {
+					T* col = result.col_ptr(c);
+					for (size_t r = 0; r < size(); r++)
+						col[r] *= diag[r];
+				}
+			});
+			return result;
+		}
+
+		/**
+		 * @brief Solves the system : one division per element.
+		 * @throw std::invalid_argument If b does not match the matrix size.
+		 * @throw std::logic_error If a diagonal element is zero.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(n)
+		 */
+		Vector<T> solve(const Vector<T>& b) const {
+			check_structured_size(size(), b.size(), "Right-hand side size must match the matrix size.");
+
+			Vector<T> x(b);
+			for (size_t i = 0; i < size(); i++) {
+				if (diag[i] == T(0))
+					throw_singular();
+				x[i] /= diag[i];
+			}
+			return x;
+		}
+
+		Matrix<T> solve(const Matrix<T>& b) const { return inverse().mul_mat(b); }
+
+		/**
+		 * @brief Inverts each diagonal element.
+		 * @throw std::logic_error If a diagonal element is zero.
+		 * @note Time complexity : O(n)
+		 */
+		DiagonalMatrix<T> inverse() const {
+			DiagonalMatrix<T> result(size());
+			for (size_t i = 0; i < size(); i++) {
+				if (diag[i] == T(0))
+					throw std::logic_error("Matrix is singular and cannot be inverted.");
+				result.diag[i] = T(1) / diag[i];
+			}
+			return result;
+		}
+
+		/**
+		 * @brief Computes the determinant, the product of the diagonal.
+		 * @note Time complexity : O(n)
+		 */
+		T determinant() const {
+			T result = T(1);
+			for (const T& d : diag)
+				result *= d;
+			return result;
+		}
+
+		T trace() const {
+			T result = T(0);
+			for (const T& d : diag)
+				result += d;
+			return result;
+		}
+
+		DiagonalMatrix<T> transpose() const { return *this; }
+
+		Matrix<T> dense() const {
+			Matrix<T> result(size(), size());
+			for (size_t i = 0; i < size(); i++)
+				result[i][i] = diag[i];
+			return result;
+		}
+
+		# pragma region Utils
+
+		inline size_t size() const { return diag.size(); }
+		inline size_t rows() const { return size(); }
+		inline size_t cols() const { return size(); }
+		inline std::pair<size_t, size_t> shape() const { return { size(), size() }; }
+		inline const std::vector<T>& diagonal() const { return diag; }
+
+		inline T at(size_t r, size_t c) const { return r == c ? diag.at(r) : T(0); }
+
+		T& operator()(size_t r, size_t c) {
+			if (r != c || r >= size())
+				throw std::out_of_range("Element is not stored by the diagonal matrix.");
+			return diag[r];
+		}
+
+		# pragma endregion
+};
+
+/**
+ * @brief Lower or upper triangular matrix, packed column-major : only the n(n+1)/2 elements of its triangle are stored.
+ * @details Column c holds rows c..n-1 (lower) or 0..c (upper), contiguously, as the BLAS / LAPACK packed format.
+ * @tparam T The type of the elements in the matrix.
+ */
+template<typename T>
+class TriangularMatrix {
+	protected:
+		std::vector<T> data;
+		size_t         n = 0;
+		Triangle       uplo = Triangle::Lower;
+
+		static constexpr size_t PANEL = 64; // Columns unpacked at once by mul_mat
+
+		inline bool lower() const { return uplo == Triangle::Lower; }
+
+		// Range of the stored rows of column c : [first(c), last(c))
+		inline size_t first(size_t c) const { return lower() ? c : 0; }
+		inline size_t last(size_t c) const { return lower() ? n : c + 1; }
+
+		// Column c indexed by row : col(c)[r] for r in [first(c), last(c))
+		inline const T* col(size_t c) const {
+			return data.data() + (lower() ? c * n - c * (c - 1) / 2 - c : c * (c + 1) / 2);
+		}
+		inline T* col(size_t c) { return const_cast<T*>(std::as_const(*this).col(c)); }
+
+		void check_diagonal() const {
+			for (size_t i = 0; i < n; i++)
+				if (col(i)[i] == T(0))
+					throw_singular();
+		}
+
+		/**
+		 * @brief Solves A * x = b in place by substitution, walking the stored columns.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(1)
+		 */
+		void substitute(T* x) const {
+			if (lower()) {
+				for (size_t k = 0; k < n; k++) {
+					const T* c = col(k);
+					x[k] /= c[k];
+					for (size_t i = k + 1; i < n; i++)
+						x[i] -= c[i] * x[k];
+				}
+			}
+			else {
+				for (size_t k = n; k-- > 0;) {
+					const T* c = col(k);
+					x[k] /= c[k];
+					for (size_t i = 0; i < k; i++)
+						x[i] -= c[i] * x[k];
+				}
+			}
+		}
+
+		/**
+		 * @brief Solves A^T * x = b in place : row k of A^T is the stored column k, so each step is a dot product.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(1)
+		 */
+		void substitute_t(T* x) const {
+			auto step = [&](size_t k) {
+				const T* c = col(k);
+				T acc = x[k];
+				for (size_t i = first(k); i < last(k); i++)
+					if (i != k)
+						acc -= c[i] * x[i];
+				x[k] = acc / c[k];
+			};
+
+			if (lower())
+				for (size_t k = n; k-- > 0;)
+					step(k);
+			else
+				for (size_t k = 0; k < n; k++)
+					step(k);
+		}
+
+	public:
+		TriangularMatrix() = default;
+
+		/**
+		 * @brief Creates an all-zero triangular matrix.
+		 * @param n The size of the matrix.
+		 * @param uplo Which triangle is stored.
+		 */
+		TriangularMatrix(size_t n, Triangle uplo) : data(n * (n + 1) / 2, T(0)), n(n), uplo(uplo) {}
+
+		/**
+		 * @brief Keeps one triangle of a square matrix, diagonal included.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @note Time complexity : O(n^2)
+		 */
+		TriangularMatrix(const Matrix<T>& m, Triangle uplo) : TriangularMatrix(m.rows(), uplo) {
+			check_square_shape(m.shape());
+			for (size_t c = 0; c < n; c++)
+				std::copy(m.col_ptr(c) + first(c), m.col_ptr(c) + last(c), col(c) + first(c));
+		}
+
+		/**
+		 * @brief Multiplies the matrix by a vector, one dot product per stored column.
+		 * @throw std::invalid_argument If the vector size does not match the matrix size.
+		 * @note Time complexity : O(n^2 / 2)
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : fma
+		 */
+		Vector<T> mul_vec(const Vector<T>& v) const {
+			check_structured_size(n, v.size(), "Matrix rows must match vector size");
+
+			Vector<T> result(n);
+			parallel_for(0, n, n, [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++) {
+					const T* a = col(c);
+					T acc = T(0);
+					for (size_t r = first(c); r < last(c); r++)
+						structured_fma(acc, a[r], v[r]);
+					result[c] = acc;
+				}
+			});
+			return result;
+		}
+
+		/**
+		 * @brief Computes A * B, skipping the zero triangle.
+		 * @details Large f32, double and c32 products (every size at least tuning.gemm_threshold) unpack A by panels
+		 *          of PANEL columns into the workspace, each zero-padded only within its diagonal block, and multiply
+		 *          them with the blocked GEMM kernel. Smaller ones run column-oriented loops over the packed storage.
+		 * @throw std::invalid_argument If the matrix size does not match B rows.
+		 * @note Time complexity : O(n^2 * p / 2)
+		 * @note Space complexity : O(n*p), plus O(n * PANEL) from the workspace
+		 * @note Allowed math functions : fma
+		 */
+		Matrix<T> mul_mat(const Matrix<T>& b, Workspace& ws = Workspace::local()) const {
+			check_structured_size(n, b.rows(), "Matrix columns must match the other matrix rows");
+
+			Matrix<T> result(b.cols(), n);
+			const size_t p = b.cols();
+
+			if constexpr (gemm_traits<T>::enabled) {
+				ensure_tuning_loaded();
+				if (n >= tuning.gemm_threshold && p >= tuning.gemm_threshold) {
+					Workspace::Scope scope(ws);
+					T* panel = ws.alloc<T>(n * PANEL);
+
+					for (size_t k0 = 0; k0 < n; k0 += PANEL) {
+						const size_t k1 = std::min(n, k0 + PANEL), kb = k1 - k0;
+						const size_t r0 = lower() ? k0 : 0, r1 = lower() ? n : k1, m = r1 - r0; // Nonzero rows of the panel
+
+						for (size_t k = k0; k < k1; k++) {
+							T* dst = panel + (k - k0) * m;
+							std::fill(dst, dst + m, T(0));
+							std::copy(col(k) + first(k), col(k) + last(k), dst + first(k) - r0);
+						}
+						parallel_for(0, p, 2 * m * kb, [&](size_t lo, size_t hi) {
+							gemm(m, hi - lo, kb, panel, m, b.col_ptr(lo) + k0, b.ld(), result.col_ptr(lo) + r0, result.ld());
+						});
+					}
+					return result;
+				}
+			}
+
+			parallel_for(0, p, n * n, [&](size_t lo, size_t hi) {
+				for (size_t j = lo; j < hi; j++) {
+					T*       dst = result.col_ptr(j);
+					const T* src = b.col_ptr(j);
+
+					for (size_t k = 0; k < n; k++) {
+						const T* a = col(k);
+						const T  x = src[k];
+						for (size_t r = first(k), end = last(k); r < end; r++)
+							structured_fma(dst[r], a[r], x);
+					}
+				}
+			});
+			return result;
+		}
+
+		/**
+		 * @brief Solves the system by substitution, no factorization.
+		 * @throw std::invalid_argument If b does not match the matrix size.
+		 * @throw std::logic_error If a diagonal element is zero.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : None
+		 */
+		Vector<T> solve(const Vector<T>& b) const {
+			check_structured_size(n, b.size(), "Right-hand side size must match the matrix size.");
+			check_diagonal();
+
+			Vector<T> x(b);
+			substitute_t(x.ptr()); // mul_vec applies A^T
+			return x;
+		}
+
+		/**
+		 * @brief Solves the system for several right-hand sides, in parallel over the columns of B.
+		 * @note Time complexity : O(n^2 * p)
+		 * @note Space complexity : O(n*p)
+		 */
+		Matrix<T> solve(const Matrix<T>& b) const {
+			check_structured_size(n, b.rows(), "Right-hand side size must match the matrix size.");
+			check_diagonal();
+
+			Matrix<T> x = b;
+			parallel_for(0, x.cols(), n * n, [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++)
+					substitute(x.col_ptr(c));
+			});
+			return x;
+		}
+
+		/**
+		 * @brief Computes the determinant, the product of the diagonal.
+		 * @note Time complexity : O(n)
+		 */
+		T determinant() const {
+			T result = T(1);
+			for (size_t i = 0; i < n; i++)
+				result *= col(i)[i];
+			return result;
+		}
+
+		T trace() const {
+			T result = T(0);
+			for (size_t i = 0; i < n; i++)
+				result += col(i)[i];
+			return result;
+		}
+
+		/**
+		 * @brief Transposes the matrix : a lower matrix becomes upper and conversely.
+		 * @note Time complexity : O(n^2)
+		 */
+		TriangularMatrix<T> transpose() const {
+			TriangularMatrix<T> result(n, lower() ? Triangle::Upper : Triangle::Lower);
+			for (size_t c = 0; c < n; c++)
+				for (size_t r = first(c); r < last(c); r++)
+					result.col(r)[c] = col(c)[r];
+			return result;
+		}
+
+		Matrix<T> dense() const {
+			Matrix<T> result(n, n);
+			for (size_t c = 0; c < n; c++)
+				std::copy(col(c) + first(c), col(c) + last(c), result.col_ptr(c) + first(c));
+			return result;
+		}
+
+		# pragma region Utils
+
+		inline size_t size() const { return n; }
+		inline size_t rows() const { return n; }
+		inline size_t cols() const { return n; }
+		inline std::pair<size_t, size_t> shape() const { return { n, n }; }
+		inline Triangle triangle() const { return uplo; }
+		inline const std::vector<T>& packed() const { return data; }
+
+		inline bool stores(size_t r, size_t c) const { return r < n && c < n && (lower() ? r >= c : r <= c); }
+		inline T at(size_t r, size_t c) const { return stores(r, c) ? col(c)[r] : T(0); }
+
+		T& operator()(size_t r, size_t c) {
+			if (!stores(r, c))
+				throw std::out_of_range("Element is not stored by the triangular matrix.");
+			return col(c)[r];
+		}
+
+		# pragma endregion
+};
+
+/**
+ * @brief Symmetric matrix, A(r, c) == A(c, r), storing only its lower triangle packed column-major.
+ * @details Half the memory of a dense matrix. Real systems are solved with a packed Cholesky factorization when the
+ *          matrix is positive-definite, the other ones with LU on the expanded matrix.
+ * @tparam T The type of the elements in the matrix.
+ */
+template<typename T>
+class SymmetricMatrix {
+	protected:
+		std::vector<T> data;
+		size_t         n = 0;
+
+		inline size_t index(size_t r, size_t c) const {
+			if (r < c)
+				std::swap(r, c);
+			return c * n - c * (c - 1) / 2 + r - c;
+		}
+
+		/**
+		 * @brief Factorizes the matrix as L * L^T in packed storage, left-looking.
+		 * @param l Receives the packed lower factor.
+		 * @return true If every pivot was positive.
+		 * @note Time complexity : O(n^3 / 3)
+		 * @note Space complexity : O(n^2 / 2)
+		 * @note Allowed math functions : pow
+		 */
+		bool cholesky(std::vector<T>& l) const {
+			l = data;
+			for (size_t j = 0; j < n; j++) {
+				T* cj = l.data() + index(j, j);
+				for (size_t k = 0; k < j; k++) {
+					const T* ck = l.data() + index(j, k); // L(j.., k)
+					const T  ljk = ck[0];
+					for (size_t i = 0; i < n - j; i++)
+						cj[i] -= ck[i] * ljk;
+				}
+				if (!(cj[0] > T(0)))
+					return false;
+
+				const T ljj = std::pow(cj[0], T(0.5));
+				cj[0] = ljj;
+				for (size_t i = 1; i < n - j; i++)
+					cj[i] /= ljj;
+			}
+			return true;
+		}
+
+		// Solves L * L^T * x = b in place, with l from cholesky()
+		void cholesky_substitute(const std::vector<T>& l, T* x) const {
+			for (size_t k = 0; k < n; k++) {
+				const T* c = l.data() + index(k, k);
+				x[k] /= c[0];
+				for (size_t i = 1; i < n - k; i++)
+					x[k + i] -= c[i] * x[k];
+			}
+			for (size_t k = n; k-- > 0;) {
+				const T* c = l.data() + index(k, k);
+				T acc = x[k];
+				for (size_t i = 1; i < n - k; i++)
+					acc -= c[i] * x[k + i];
+				x[k] = acc / c[0];
+			}
+		}
+
+	public:
+		SymmetricMatrix() = default;
+		explicit SymmetricMatrix(size_t n) : data(n * (n + 1) / 2, T(0)), n(n) {}
+
+		/**
+		 * @brief Keeps the lower triangle of a square matrix, the upper one is assumed to mirror it.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @note Time complexity : O(n^2)
+		 */
+		explicit SymmetricMatrix(const Matrix<T>& m) : SymmetricMatrix(m.rows()) {
+			check_square_shape(m.shape());
+			for (size_t c = 0; c < n; c++)
+				std::copy(m.col_ptr(c) + c, m.col_ptr(c) + n, data.begin() + std::ptrdiff_t(index(c, c)));
+		}
+
+		/**
+		 * @brief Multiplies the matrix by a vector, reading each stored element once.
+		 * @details Stored column c contributes a dot product to result[c] (lower part of A) and an axpy to result[c+1..]
+		 *          (the mirrored upper part).
+		 * @throw std::invalid_argument If the vector size does not match the matrix size.
+		 * @note Time complexity : O(n^2), over n^2 / 2 elements
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : fma
+		 */
+		Vector<T> mul_vec(const Vector<T>& v) const {
+			check_structured_size(n, v.size(), "Matrix rows must match vector size");
+
+			Vector<T> result(n);
+			for (size_t c = 0; c < n; c++) {
+				const T* a = data.data() + index(c, c);
+				T acc = a[0] * v[c];
+				for (size_t i = 1; i < n - c; i++) {
+					structured_fma(acc, a[i], v[c + i]);
+					structured_fma(result[c + i], a[i], v[c]);
+				}
+				result[c] += acc;
+			}
+			return result;
+		}
+
+		/**
+		 * @brief Computes A * B, one symmetric mul_vec per column of B, in parallel.
+		 * @throw std::invalid_argument If the matrix size does not match B rows.
+		 * @note Time complexity : O(n^2 * p)
+		 * @note Space complexity : O(n*p)
+		 */
+		Matrix<T> mul_mat(const Matrix<T>& b) const {
+			check_structured_size(n, b.rows(), "Matrix columns must match the other matrix rows");
+
+			Matrix<T> result(b.cols(), n);
+			parallel_for(0, b.cols(), 2 * n * n, [&](size_t lo, size_t hi) {
+				for (size_t j = lo; j < hi; j++) {
+					Vector<T> y = mul_vec(Vector<T>(b[j]));
+					std::copy(y.ptr(), y.ptr() + n, result.col_ptr(j));
+				}
+			});
+			return result;
+		}
+
+		/**
+		 * @brief Solves the system, with a packed Cholesky factorization for floating positive-definite matrices.
+		 * @details A^T = A, so both conventions solve A * x = b. Other matrices fall back to Matrix<T>::solve.
+		 * @throw std::invalid_argument If b does not match the matrix size.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n^3 / 3) positive-definite, O(n^3) otherwise
+		 * @note Space complexity : O(n^2 / 2) positive-definite, O(n^2) otherwise
+		 */
+		Vector<T> solve(const Vector<T>& b) const {
+			check_structured_size(n, b.size(), "Right-hand side size must match the matrix size.");
+
+			if constexpr (std::is_floating_point_v<T>) {
+				std::vector<T> l;
+				if (cholesky(l)) {
+					Vector<T> x(b);
+					cholesky_substitute(l, x.ptr());
+					return x;
+				}
+			}
+			return dense().solve(b);
+		}
+
+		Matrix<T> solve(const Matrix<T>& b) const {
+			check_structured_size(n, b.rows(), "Right-hand side size must match the matrix size.");
+
+			if constexpr (std::is_floating_point_v<T>) {
+				std::vector<T> l;
+				if (cholesky(l)) {
+					Matrix<T> x = b;
+					parallel_for(0, x.cols(), 2 * n * n, [&](size_t lo, size_t hi) {
+						for (size_t c = lo; c < hi; c++)
+							cholesky_substitute(l, x.col_ptr(c));
+					});
+					return x;
+				}
+			}
+			return dense().solve(b);
+		}
+
+		/**
+		 * @brief Computes the determinant, from the Cholesky factor when it exists, by LU otherwise.
+		 * @note Time complexity : O(n^3 / 3) positive-definite, O(n^3) otherwise
+		 */
+		T determinant() const {
+			if constexpr (std::is_floating_point_v<T>) {
+				std::vector<T> l;
+				if (cholesky(l)) {
+					T result = T(1);
+					for (size_t i = 0; i < n; i++)
+						result *= l[index(i, i)] * l[index(i, i)];
+					return result;
+				}
+			}
+			return dense().determinant();
+		}
+
+		T trace() const {
+			T result = T(0);
+			for (size_t i = 0; i < n; i++)
+				result += data[index(i, i)];
+			return result;
+		}
+
+		SymmetricMatrix<T> transpose() const { return *this; }
+
+		Matrix<T> dense() const {
+			Matrix<T> result(n, n);
+			for (size_t c = 0; c < n; c++)
+				for (size_t r = 0; r < n; r++)
+					result[c][r] = data[index(r, c)];
+			return result;
+		}
+
+		# pragma region Utils
+
+		inline size_t size() const { return n; }
+		inline size_t rows() const { return n; }
+		inline size_t cols() const { return n; }
+		inline std::pair<size_t, size_t> shape() const { return { n, n }; }
+		inline const std::vector<T>& packed() const { return data; }
+
+		inline T at(size_t r, size_t c) const { return (r < n && c < n) ? data[index(r, c)] : T(0); }
+
+		// Element (r, c), which is also element (c, r)
+		T& operator()(size_t r, size_t c) {
+			if (r >= n || c >= n)
+				throw std::out_of_range("Element is out of the matrix bounds.");
+			return data[index(r, c)];
+		}
+
+		# pragma endregion
+};
+
+/**
+ * @brief Banded matrix, with kl subdiagonals and ku superdiagonals, in LAPACK band storage.
+ * @details Column c stores rows c-ku..c+kl contiguously : element (r, c) is at c * (kl + ku + 1) + ku + r - c.
+ *          mul_vec and mul_mat cost O(n * (kl + ku + 1)) per vector, and systems are solved by a banded LU with
+ *          partial pivoting in O(n * kl * (kl + ku)), instead of O(n^3).
+ * @tparam T The type of the elements in the matrix.
+ *
+ * @see https://www.netlib.org/lapack/lug/node124.html
+ */
+template<typename T>
+class BandedMatrix {
+	protected:
+		std::vector<T> data;
+		size_t         n = 0;
+		size_t         kl = 0; // Subdiagonals
+		size_t         ku = 0; // Superdiagonals
+
+		inline size_t ldab() const { return kl + ku + 1; }
+		inline size_t first(size_t c) const { return c > ku ? c - ku : 0; }
+		inline size_t last(size_t c) const { return std::min(n, c + kl + 1); }
+
+		// Column c indexed by row : col(c)[r] for r in [first(c), last(c))
+		inline const T* col(size_t c) const { return data.data() + c * ldab() + ku - c; }
+		inline T* col(size_t c) { return const_cast<T*>(std::as_const(*this).col(c)); }
+
+		// Banded LU factors of A or A^T, with room for the fill-in of the row swaps (LAPACK gbtrf layout)
+		struct Factor {
+			std::vector<T>      w;
+			std::vector<size_t> piv;
+			size_t              l = 0, u = 0; // Sub- and superdiagonals of the factorized matrix
+			bool                odd_swaps = false;
+			bool                singular = false;
+
+			inline size_t ld() const { return 2 * l + u + 1; }
+			inline T& at(size_t r, size_t c) { return w[c * ld() + l + u + r - c]; }
+			inline const T& at(size_t r, size_t c) const { return w[c * ld() + l + u + r - c]; }
+		};
+
+		/**
+		 * @brief Factorizes A (or A^T) as P * L * U, with partial pivoting restricted to the band.
+		 * @details U gets up to l + u superdiagonals from the row swaps, L keeps l subdiagonals.
+		 * @note Time complexity : O(n * l * (l + u))
+		 * @note Space complexity : O(n * (2l + u + 1))
+		 */
+		Factor factor(bool transposed) const {
+			Factor f;
+			f.l = transposed ? ku : kl;
+			f.u = transposed ? kl : ku;
+			f.w.assign(n * f.ld(), T(0));
+			f.piv.resize(n);
+
+			for (size_t c = 0; c < n; c++)
+				for (size_t r = first(c); r < last(c); r++)
+					(transposed ? f.at(c, r) : f.at(r, c)) = col(c)[r];
+
+			const size_t kv = f.l + f.u;
+			for (size_t j = 0; j < n; j++) {
+				const size_t km = std::min(f.l, n - 1 - j);
+				const size_t ju = std::min(n - 1, j + kv);
+
+				size_t p = j;
+				for (size_t i = j + 1; i <= j + km; i++)
+					if (magnitude(f.at(i, j)) > magnitude(f.at(p, j)))
+						p = i;
+				f.piv[j] = p;
+
+				if (f.at(p, j) == T(0)) {
+					f.singular = true;
+					continue;
+				}
+				if (p != j) {
+					for (size_t c = j; c <= ju; c++)
+						std::swap(f.at(j, c), f.at(p, c));
+					f.odd_swaps = !f.odd_swaps;
+				}
+
+				const T inv = T(1) / f.at(j, j);
+				for (size_t i = j + 1; i <= j + km; i++)
+					f.at(i, j) *= inv;
+
+				for (size_t c = j + 1; c <= ju; c++) {
+					const T x = f.at(j, c);
+					if (x == T(0))
+						continue;
+					for (size_t i = j + 1; i <= j + km; i++)
+						f.at(i, c) -= f.at(i, j) * x;
+				}
+			}
+			return f;
+		}
+
+		// Solves P * L * U * x = b in place
+		void substitute(const Factor& f, T* x) const {
+			const size_t kv = f.l + f.u;
+
+			for (size_t j = 0; j < n; j++) {
+				std::swap(x[j], x[f.piv[j]]);
+				for (size_t i = j + 1; i <= std::min(n - 1, j + f.l); i++)
+					x[i] -= f.at(i, j) * x[j];
+			}
+			for (size_t j = n; j-- > 0;) {
+				x[j] /= f.at(j, j);
+				for (size_t i = j > kv ? j - kv : 0; i < j; i++)
+					x[i] -= f.at(i, j) * x[j];
+			}
+		}
+
+	public:
+		BandedMatrix() = default;
+
+		/**
+		 * @brief Creates an all-zero banded matrix.
+		 * @param n The size of the matrix.
+		 * @param kl The number of subdiagonals.
+		 * @param ku The number of superdiagonals.
+		 */
+		BandedMatrix(size_t n, size_t kl, size_t ku) : data(n * (kl + ku + 1), T(0)), n(n), kl(kl), ku(ku) {}
+
+		/**
+		 * @brief Keeps the band of a square matrix.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @note Time complexity : O(n * (kl + ku + 1))
+		 */
+		BandedMatrix(const Matrix<T>& m, size_t kl, size_t ku) : BandedMatrix(m.rows(), kl, ku) {
+			check_square_shape(m.shape());
+			for (size_t c = 0; c < n; c++)
+				std::copy(m.col_ptr(c) + first(c), m.col_ptr(c) + last(c), col(c) + first(c));
+		}
+
+		/**
+		 * @brief Multiplies the matrix by a vector, one dot product over the band of each column.
+		 * @throw std::invalid_argument If the vector size does not match the matrix size.
+		 * @note Time complexity : O(n * (kl + ku + 1))
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : fma
+		 */
+		Vector<T> mul_vec(const Vector<T>& v) const {
+			check_structured_size(n, v.size(), "Matrix rows must match vector size");
+
+			Vector<T> result(n);
+			parallel_for(0, n, 2 * ldab(), [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++) {
+					const T* a = col(c);
+					T acc = T(0);
+					for (size_t r = first(c); r < last(c); r++)
+						structured_fma(acc, a[r], v[r]);
+					result[c] = acc;
+				}
+			});
+			return result;
+		}
+
+		/**
+		 * @brief Computes A * B, one axpy over the band of each column of A per element of B.
+		 * @throw std::invalid_argument If the matrix size does not match B rows.
+		 * @note Time complexity : O(n * (kl + ku + 1) * p)
+		 * @note Space complexity : O(n*p)
+		 * @note Allowed math functions : fma
+		 */
+		Matrix<T> mul_mat(const Matrix<T>& b) const {
+			check_structured_size(n, b.rows(), "Matrix columns must match the other matrix rows");
+
+			Matrix<T> result(b.cols(), n);
+			parallel_for(0, b.cols(), 2 * n * ldab(), [&](size_t lo, size_t hi) {
+				for (size_t j = lo; j < hi; j++) {
+					T*       dst = result.col_ptr(j);
+					const T* src = b.col_ptr(j);
+					for (size_t k = 0; k < n; k++) {
+						const T* a = col(k);
+						const T  x = src[k];
+						for (size_t r = first(k), end = last(k); r < end; r++)
+							structured_fma(dst[r], a[r], x);
+					}
+				}
+			});
+			return result;
+		}
+
+		/**
+		 * @brief Solves the system with a banded LU factorization (of A^T, as mul_vec applies A^T).
+		 * @throw std::invalid_argument If b does not match the matrix size.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n * kl * (kl + ku))
+		 * @note Space complexity : O(n * (2kl + ku + 1))
+		 * @note Allowed math functions : pow
+		 */
+		Vector<T> solve(const Vector<T>& b) const {
+			check_structured_size(n, b.size(), "Right-hand side size must match the matrix size.");
+
+			const Factor f = factor(true);
+			if (f.singular)
+				throw_singular();
+
+			Vector<T> x(b);
+			substitute(f, x.ptr());
+			return x;
+		}
+
+		Matrix<T> solve(const Matrix<T>& b) const {
+			check_structured_size(n, b.rows(), "Right-hand side size must match the matrix size.");
+
+			const Factor f = factor(false);
+			if (f.singular)
+				throw_singular();
+
+			Matrix<T> x = b;
+			parallel_for(0, x.cols(), 2 * n * f.ld(), [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++)
+					substitute(f, x.col_ptr(c));
+			});
+			return x;
+		}
+
+		/**
+		 * @brief Computes the determinant from the banded LU factors.
+		 * @note Time complexity : O(n * kl * (kl + ku)), O(n) for kl == 0 (upper triangular band)
+		 */
+		T determinant() const {
+			T result = T(1);
+			if (kl == 0 || ku == 0) { // Triangular band
+				for (size_t i = 0; i < n; i++)
+					result *= col(i)[i];
+				return result;
+			}
+
+			const Factor f = factor(false);
+			if (f.singular)
+				return T(0);
+			for (size_t i = 0; i < n; i++)
+				result *= f.at(i, i);
+			return f.odd_swaps ? -result : result;
+		}
+
+		T trace() const {
+			T result = T(0);
+			for (size_t i = 0; i < n; i++)
+				result += col(i)[i];
+			return result;
+		}
+
+		BandedMatrix<T> transpose() const {
+			BandedMatrix<T> result(n, ku, kl);
+			for (size_t c = 0; c < n; c++)
+				for (size_t r = first(c); r < last(c); r++)
+					result.col(r)[c] = col(c)[r];
+			return result;
+		}
+
+		Matrix<T> dense() const {
+			Matrix<T> result(n, n);
+			for (size_t c = 0; c < n; c++)
+				std::copy(col(c) + first(c), col(c) + last(c), result.col_ptr(c) + first(c));
+			return result;
+		}
+
+		# pragma region Utils
+
+		inline size_t size() const { return n; }
+		inline size_t rows() const { return n; }
+		inline size_t cols() const { return n; }
+		inline std::pair<size_t, size_t> shape() const { return { n, n }; }
+		inline size_t lower_bandwidth() const { return kl; }
+		inline size_t upper_bandwidth() const { return ku; }
+
+		inline bool stores(size_t r, size_t c) const { return r < n && c < n && r + ku >= c && r <= c + kl; }
+		inline T at(size_t r, size_t c) const { return stores(r, c) ? col(c)[r] : T(0); }
+
+		T& operator()(size_t r, size_t c) {
+			if (!stores(r, c))
+				throw std::out_of_range("Element is not stored by the banded matrix.");
+			return col(c)[r];
+		}
+
+		# pragma endregion
+};
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const DiagonalMatrix<T>& m) { return os << m.dense(); }
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const TriangularMatrix<T>& m) { return os << m.dense(); }
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const SymmetricMatrix<T>& m) { return os << m.dense(); }
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const BandedMatrix<T>& m) { return os << m.dense(); }
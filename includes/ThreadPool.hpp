@@ -0,0 +1,232 @@
+#pragma once
+
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+# include <deque>
+# include <functional>
+# include <atomic>
+# include <memory>
+# include "config.hpp"
+# include "TuningFile.hpp"
+
+/**
+ * @brief Work-stealing thread pool backing the parallel Matrix operations.
+ * @details Each worker owns a task deque : it pops its own tasks from the back (most recent, cache-hot) and,
+ *          when it runs dry, steals from the front of the other workers' deques. Threads waiting on a parallel
+ *          region help executing pending tasks instead of blocking, so nested parallel regions cannot deadlock.
+ */
+class ThreadPool {
+	public:
+		using Task = std::function<void()>;
+
+	protected:
+		struct Queue {
+			std::mutex       mutex;
+			std::deque<Task> tasks;
+		};
+
+		std::vector<std::unique_ptr<Queue>> queues; // One per worker
+		std::vector<std::thread>            threads;
+		std::mutex                          sleep_mutex;
+		std::condition_variable             wake;
+		std::atomic<size_t>                 pending{0};  // Tasks pushed but not started yet
+		std::atomic<size_t>                 next{0};     // Round-robin target for pushes from outside the pool
+		bool                                stopping = false;
+
+		static inline thread_local size_t current = size_t(-1); // Index of the worker running on this thread
+
+		/**
+		 * @brief Takes a task, from the back of queue `self` first, then from the front of the others.
+		 * @param self The queue to look into first.
+		 * @param out The task taken.
+		 * @return true If a task was found.
+		 */
+		bool take(size_t self, Task& out) {
+			for (size_t i = 0; i < queues.size(); i++) {
+				Queue& q = *queues[(self + i) % queues.size()];
+				std::lock_guard<std::mutex> lock(q.mutex);
+
+				if (q.tasks.empty())
+					continue;
+
+				if (i == 0) {
+					out = std::move(q.tasks.back());
+					q.tasks.pop_back();
+				}
+				else {
+					out = std::move(q.tasks.front()); // Steal the oldest task, usually the largest remaining tile
+					q.tasks.pop_front();
+				}
+				pending--;
+				return true;
+			}
+			return false;
+		}
+
+		void worker_loop(size_t self) {
+			current = self;
+
+			while (true) {
+				Task task;
+				if (take(self, task)) {
+					task();
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(sleep_mutex);
+				wake.wait(lock, [this] { return stopping || pending > 0; });
+				if (stopping && pending == 0)
+					return;
+			}
+		}
+
+		void start(size_t count) {
+			stopping = false;
+			for (size_t i = 0; i < count; i++)
+				queues.push_back(std::make_unique<Queue>());
+			for (size_t i = 0; i < count; i++)
+				threads.emplace_back(&ThreadPool::worker_loop, this, i);
+		}
+
+		void stop() {
+			{
+				std::lock_guard<std::mutex> lock(sleep_mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+
+			for (std::thread& t : threads)
+				t.join();
+
+			threads.clear();
+			queues.clear();
+		}
+
+	public:
+		/**
+		 * @brief Starts a pool of workers.
+		 * @param count The number of workers, 0 meaning one per hardware thread.
+		 */
+		explicit ThreadPool(size_t count = 0) { start(count ? count : std::max(1u, std::thread::hardware_concurrency())); }
+		~ThreadPool() { stop(); }
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/**
+		 * @brief Returns the pool shared by the library, created on first use with tuning.threads workers.
+		 * @return ThreadPool& The global pool.
+		 */
+		static ThreadPool& global() {
+			static ThreadPool pool((ensure_tuning_loaded(), tuning.threads));
+			return pool;
+		}
+
+		/**
+		 * @brief Changes the number of workers.
+		 * @details Pending tasks are drained first. Must not be called while a parallel region is running.
+		 * @param count The new number of workers, 0 meaning one per hardware thread.
+		 */
+		void resize(size_t count) {
+			stop();
+			start(count ? count : std::max(1u, std::thread::hardware_concurrency()));
+		}
+
+		/**
+		 * @brief Returns the number of workers.
+		 * @return size_t The number of workers.
+		 */
+		inline size_t size() const { return threads.size(); }
+
+		/**
+		 * @brief Queues a task.
+		 * @details Tasks pushed from a worker go to its own deque, others are spread round-robin.
+		 * @param task The task to run.
+		 */
+		void push(Task task) {
+			const size_t target = (current < queues.size()) ? current : next++ % queues.size();
+			pending++; // Before publishing : a worker taking the task right away must not decrement it below zero
+			{
+				std::lock_guard<std::mutex> lock(queues[target]->mutex);
+				queues[target]->tasks.push_back(std::move(task));
+			}
+
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			wake.notify_one();
+		}
+
+		/**
+		 * @brief Runs one pending task on the calling thread, if any.
+		 * @return true If a task was run.
+		 */
+		bool run_one() {
+			Task task;
+			if (!take(current < queues.size() ? current : 0, task))
+				return false;
+
+			task();
+			return true;
+		}
+};
+
+/**
+ * @brief Runs fn(lo, hi) over tiles covering [begin, end), in parallel when the work is large enough.
+ * @details The range is split into about 4 tiles per worker. The calling thread runs the first tile itself,
+ *          then helps with the pending tasks until every tile is done. The first exception thrown by a tile
+ *          is rethrown on the calling thread.
+ * @param begin The first index.
+ * @param end The index past the last one.
+ * @param cost The estimated work per index (e.g. flops), compared against tuning.parallel_threshold.
+ * @param fn The function to apply on each tile.
+ */
+template<typename F>
+void parallel_for(size_t begin, size_t end, size_t cost, const F& fn) {
+	if (begin >= end)
+		return;
+
+	ensure_tuning_loaded();
+	const size_t n = end - begin;
+	const bool   parallel = tuning.execution == Execution::Parallel
+	                     || (tuning.execution == Execution::Auto && n * cost >= tuning.parallel_threshold);
+
+	ThreadPool* pool = parallel ? &ThreadPool::global() : nullptr;
+
+	if (!pool || pool->size() <= 1 || n == 1) {
+		fn(begin, end);
+		return;
+	}
+
+	const size_t tiles = std::min(n, pool->size() * 4);
+	const size_t step  = (n + tiles - 1) / tiles;
+
+	std::atomic<size_t> remaining{0};
+	std::exception_ptr  error;
+	std::mutex          error_mutex;
+
+	auto run = [&](size_t lo, size_t hi) {
+		try {
+			fn(lo, hi);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(error_mutex);
+			if (!error)
+				error = std::current_exception();
+		}
+		remaining--;
+	};
+
+	for (size_t lo = begin + step; lo < end; lo += step) {
+		remaining++;
+		pool->push([&run, lo, hi = std::min(end, lo + step)] { run(lo, hi); });
+	}
+	remaining++;
+	run(begin, std::min(end, begin + step));
+
+	while (remaining > 0)
+		if (!pool->run_one())
+			std::this_thread::yield();
+
+	if (error)
+		std::rethrow_exception(error);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+# include <chrono>
+# include <limits>
+# include "Vector.hpp"
+# include "Matrix.hpp"
+# include "functions.hpp"
+# include "ThreadPool.hpp"
+
+/**
+ * Auto-calibration of the Tuning knobs (see config.hpp) for the host CPU.
+ * calibrate_tuning() times the operations each knob drives under a few candidate values and keeps the fastest,
+ * then save_tuning() writes them to a config file, applied on first use by every program through MATRIX_TUNING :
+ *
+ *     make calibrate                       # Writes matrix_tuning.cfg
+ *     MATRIX_TUNING=matrix_tuning.cfg ./program
+ *
+ * Calibration runs on f32, the type of the exercises, single-threaded for everything but the parallel threshold.
+ * The closed forms of matrices up to 4x4 (see Small.hpp) are always faster than the general paths and have no knob :
+ * the small-matrix cutoff of mul_mat is gemm_threshold, under which the plain loops run.
+ */
+
+# pragma region Utils
+
+// Best wall time over a few runs of fn, in seconds : the minimum filters out the noise of other processes
+template<typename F>
+double calibration_time(F&& fn, size_t runs = 5) {
+	double best = std::numeric_limits<double>::infinity();
+
+	fn(); // Warm up caches and packing buffers
+	for (size_t i = 0; i < runs; i++) {
+		const auto start = std::chrono::steady_clock::now();
+		fn();
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+	return best;
+}
+
+// Deterministic n x n matrix with entries in [-1, 1)
+inline Matrix<f32> calibration_matrix(size_t n, uint32_t seed) {
+	Matrix<f32> m(n, n);
+	for (size_t c = 0; c < n; c++)
+		for (size_t r = 0; r < n; r++) {
+			seed = seed * 1664525u + 1013904223u;
+			m[c][r] = f32(seed >> 8) / f32(1u << 23) - 1.f;
+		}
+	return m;
+}
+
+// Sets knob to the candidate giving the lowest measure(), returns it
+template<typename F>
+size_t calibrate_knob(size_t& knob, std::initializer_list<size_t> candidates, F&& measure) {
+	size_t best = knob;
+	double fastest = std::numeric_limits<double>::infinity();
+
+	for (size_t candidate : candidates) {
+		knob = candidate;
+		const double t = measure();
+		if (t < fastest) {
+			fastest = t;
+			best = candidate;
+		}
+	}
+	return knob = best;
+}
+
+# pragma endregion
+
+/**
+ * @brief Measures the tuning knobs for the host CPU.
+ * @details Each knob is calibrated in turn, the others at their current value (or already calibrated) :
+ *          - gemm_threshold : the smallest size from which the blocked GEMM kernel is never slower than the plain loops ;
+ *          - gemm_kc, gemm_mc, gemm_nc : the fastest block sizes for a size x size mul_mat, one pass of coordinate descent ;
+ *          - combine_chunk : the fastest chunk for a linear combination of 16 vectors of size^2 elements ;
+ *          - parallel_threshold : the work from which a parallel mul_vec beats a serial one, when the pool has several workers.
+ *          The global tuning is restored before returning : assign the result to apply it.
+ * @param size The size of the large operations timed, the production size of the block sizes.
+ * @return Tuning The calibrated knobs. execution and threads are copied from the current tuning.
+ * @note Time complexity : O(size^3), a few seconds for size 512
+ */
+inline Tuning calibrate_tuning(size_t size = 512) {
+	const Tuning saved = tuning;
+	tuning.execution = Execution::Serial;
+
+	// Small sizes : blocked kernel against the plain loops
+	size_t threshold = std::numeric_limits<size_t>::max();
+	for (size_t n : {128, 96, 64, 48, 32, 24, 16, 8}) {
+		const Matrix<f32> a = calibration_matrix(n, 1), b = calibration_matrix(n, 2);
+		const auto        measure = [&](size_t t) {
+			tuning.gemm_threshold = t;
+			return calibration_time([&] { a.mul_mat(b); }, 20);
+		};
+
+		if (measure(n) > measure(std::numeric_limits<size_t>::max()))
+			break;
+		threshold = n;
+	}
+	tuning.gemm_threshold = std::min(threshold, size_t(256));
+
+	// Block sizes, at the production size
+	{
+		const Matrix<f32> a = calibration_matrix(size, 3), b = calibration_matrix(size, 4);
+		const auto        measure = [&] { return calibration_time([&] { a.mul_mat(b); }); };
+
+		calibrate_knob(tuning.gemm_kc, {128, 192, 256, 384, 512}, measure);
+		calibrate_knob(tuning.gemm_mc, {48, 96, 128, 192, 256, 384}, measure);
+		calibrate_knob(tuning.gemm_nc, {512, 1024, 2048, 4096}, measure);
+	}
+
+	// Linear combination chunk
+	{
+		std::vector<Vector<f32>> vectors;
+		std::vector<f32>         scalars(16, 0.5f);
+		for (size_t i = 0; i < 16; i++) {
+			vectors.emplace_back(size * size);
+			for (size_t j = 0; j < size * size; j++)
+				vectors.back()[j] = f32((i + j) % 7) - 3.f;
+		}
+
+		calibrate_knob(tuning.combine_chunk, {512, 1024, 2048, 4096, 8192}, [&] {
+			return calibration_time([&] { linear_combination(vectors.begin(), vectors.end(), scalars.begin()); });
+		});
+	}
+
+	// Parallel threshold : the smallest mul_vec worth splitting
+	if (ThreadPool::global().size() > 1) {
+		size_t parallel = size_t(1) << 30;
+		for (size_t n = 2048; n >= 32; n /= 2) {
+			const Matrix<f32> a = calibration_matrix(n, 21);
+			const Vector<f32> v(n);
+			const auto        measure = [&](Execution e) {
+				tuning.execution = e;
+				return calibration_time([&] { a.mul_vec(v); }, 10);
+			};
+
+			if (measure(Execution::Parallel) >= measure(Execution::Serial))
+				break;
+			parallel = 2 * n * n;
+		}
+		tuning.parallel_threshold = parallel;
+	}
+
+	Tuning result    = tuning;
+	result.execution = saved.execution;
+	result.threads   = saved.threads;
+	tuning           = saved;
+	return result;
+}
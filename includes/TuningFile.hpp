@@ -0,0 +1,155 @@
+#pragma once
+
+# include <cstdio>
+# include <cstdlib>
+# include <memory>
+# include <stdexcept>
+# include <string>
+# include "config.hpp"
+
+/**
+ * Tuning config files (see Tuning in config.hpp), as written by make calibrate :
+ *
+ *     # comment
+ *     gemm_mc = 96
+ *     execution = auto
+ *
+ * One "key = value" per line, blank lines and lines starting with '#' are ignored.
+ * The file named by the MATRIX_TUNING environment variable is applied once, when the library first reads a knob
+ * (see ensure_tuning_loaded()) : tuning itself stays constant-initialized, so static initializers of other
+ * translation units always see the defaults, never a zeroed or half-loaded Tuning.
+ * Uses <cstdio> rather than <fstream> : this header is included by every operation.
+ */
+
+# pragma region Utils
+
+// Numeric knobs, in file order
+inline constexpr const char* TUNING_KEYS[] = {"gemm_threshold", "gemm_mc", "gemm_kc", "gemm_nc", "combine_chunk", "threads", "parallel_threshold"};
+inline constexpr const char* TUNING_EXECUTIONS[] = {"auto", "serial", "parallel"};
+
+// Address of the numeric knob named key in t (const or not), nullptr if there is none
+template<typename Self>
+auto tuning_knob(Self& t, const std::string& key) -> decltype(&t.gemm_mc) {
+	decltype(&t.gemm_mc) knobs[] = {&t.gemm_threshold, &t.gemm_mc, &t.gemm_kc, &t.gemm_nc, &t.combine_chunk, &t.threads, &t.parallel_threshold};
+	for (size_t i = 0; i < std::size(knobs); i++)
+		if (key == TUNING_KEYS[i])
+			return knobs[i];
+	return nullptr;
+}
+
+using TuningFileHandle = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+inline std::string tuning_trim(const std::string& s) {
+	const size_t first = s.find_first_not_of(" \t\r\n");
+	const size_t last  = s.find_last_not_of(" \t\r\n");
+	return first == std::string::npos ? std::string() : s.substr(first, last - first + 1);
+}
+
+# pragma endregion
+
+/**
+ * @brief Reads a tuning config file.
+ * @param path The path of the file.
+ * @param base The knobs missing from the file keep these values.
+ * @return Tuning The knobs of the file.
+ * @throw std::runtime_error If the file cannot be read.
+ * @throw std::invalid_argument If a line is not a known key with a valid value.
+ * @note Time complexity : O(file size)
+ */
+inline Tuning load_tuning(const std::string& path, Tuning base = Tuning()) {
+	TuningFileHandle file(std::fopen(path.c_str(), "r"), &std::fclose);
+	if (!file)
+		throw std::runtime_error("Cannot open tuning file " + path);
+
+	std::string line;
+	size_t      number = 0;
+	for (int ch = 0; ch != EOF;) {
+		line.clear();
+		while ((ch = std::fgetc(file.get())) != EOF && ch != '\n')
+			line += char(ch);
+		number++;
+
+		const std::string entry = tuning_trim(line);
+		if (entry.empty() || entry[0] == '#')
+			continue;
+
+		const size_t      equal = entry.find('=');
+		const std::string key   = tuning_trim(entry.substr(0, equal));
+		const std::string value = equal == std::string::npos ? std::string() : tuning_trim(entry.substr(equal + 1));
+		const std::string where = path + ":" + std::to_string(number);
+		if (equal == std::string::npos || value.empty())
+			throw std::invalid_argument("Expected key = value at " + where);
+
+		if (key == "execution") {
+			size_t e = 0;
+			while (e < std::size(TUNING_EXECUTIONS) && value != TUNING_EXECUTIONS[e])
+				e++;
+			if (e == std::size(TUNING_EXECUTIONS))
+				throw std::invalid_argument("Unknown execution " + value + " at " + where);
+			base.execution = static_cast<Execution>(e);
+			continue;
+		}
+
+		size_t* target = tuning_knob(base, key);
+		if (!target)
+			throw std::invalid_argument("Unknown tuning key " + key + " at " + where);
+		if (value.find_first_not_of("0123456789") != std::string::npos || value.size() > 18)
+			throw std::invalid_argument("Invalid value " + value + " at " + where);
+		*target = std::stoull(value);
+	}
+	return base;
+}
+
+/**
+ * @brief Writes every knob to a config file that load_tuning() reads back.
+ * @param path The path of the file, overwritten.
+ * @param t The knobs.
+ * @throw std::runtime_error If the file cannot be written.
+ */
+inline void save_tuning(const std::string& path, const Tuning& t) {
+	TuningFileHandle file(std::fopen(path.c_str(), "w"), &std::fclose);
+	if (!file)
+		throw std::runtime_error("Cannot open tuning file " + path);
+
+	bool ok = std::fputs("# Matrix tuning knobs, applied on first use from the file named by MATRIX_TUNING\n", file.get()) >= 0;
+	for (const char* key : TUNING_KEYS)
+		ok = ok && std::fprintf(file.get(), "%s = %zu\n", key, *tuning_knob(t, key)) > 0;
+	ok = ok && std::fprintf(file.get(), "execution = %s\n", TUNING_EXECUTIONS[static_cast<int>(t.execution)]) > 0;
+	if (!ok || std::fflush(file.get()) != 0)
+		throw std::runtime_error("Cannot write tuning file " + path);
+}
+
+/**
+ * @brief Applies the file named by MATRIX_TUNING to the knobs that still have their default value.
+ * @details Knobs the program set itself before the first operation are kept. A file that cannot be read or is
+ *          malformed is reported on std::cerr and changes nothing : a stale config must not stop programs.
+ */
+inline void apply_tuning_file() {
+	const char* path = std::getenv("MATRIX_TUNING");
+	if (!path || !*path)
+		return;
+
+	Tuning loaded;
+	try {
+		loaded = load_tuning(path);
+	} catch (const std::exception& e) {
+		std::cerr << "Matrix : ignoring tuning file : " << e.what() << std::endl;
+		return;
+	}
+
+	const Tuning defaults;
+	for (const char* key : TUNING_KEYS)
+		if (*tuning_knob(tuning, key) == *tuning_knob(defaults, key))
+			*tuning_knob(tuning, key) = *tuning_knob(loaded, key);
+	if (tuning.execution == defaults.execution)
+		tuning.execution = loaded.execution;
+}
+
+/**
+ * @brief Applies the MATRIX_TUNING file on the first call, from any thread. Called by the library before reading a knob.
+ * @note Time complexity : O(1) after the first call
+ */
+inline void ensure_tuning_loaded() {
+	static const bool loaded = (apply_tuning_file(), true);
+	(void)loaded;
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+# include "Vector.hpp"
+# include "Matrix.hpp"
+# include "LU.hpp"
+
+/**
+ * @brief Keeps the inverse and the determinant of a matrix up to date through low-rank updates.
+ * @details A rank-1 update A += u v^T (element (r, c) gains u[r] * v[c]) costs O(n^2) with the Sherman-Morrison
+ *          formula instead of the O(n^3) of a new inverse(), a rank-k update A += U V^T costs O(n^2 k) with Woodbury's.
+ *          The determinant follows from the matrix determinant lemma : det(A + U V^T) = det(I + V^T A^-1 U) det(A).
+ *          Rounding errors accumulate with the updates, so the inverse is rebuilt from the tracked matrix every
+ *          refactor_every updates (n by default : the O(n^3) refactorization then costs O(n^2) per update, the
+ *          same order as the update itself), and whenever an update is close to making the matrix singular.
+ * @tparam T The type of the elements, floating-point or complex.
+ *
+ * @see https://en.wikipedia.org/wiki/Sherman%E2%80%93Morrison_formula
+ * @see https://en.wikipedia.org/wiki/Woodbury_matrix_identity
+ * @see https://en.wikipedia.org/wiki/Matrix_determinant_lemma
+ */
+template<typename T>
+class InverseTracker {
+	protected:
+		using R = TO_REAL<T>;
+
+		Matrix<T> a;                // The tracked matrix
+		Matrix<T> inv;              // Its inverse
+		T         det = T(1);
+		size_t    updates = 0;      // Since the last factorization
+		size_t    refactor_every;
+
+		void check_size(size_t size) const {
+			if (size != a.rows())
+				throw std::invalid_argument("Update vectors must match the matrix size.");
+		}
+
+		// Factorizes m, and only then replaces the state with it : a singular m leaves the tracker unchanged
+		void reset(Matrix<T> m) {
+			const LU<T> lu(m); // Copies m, kept until the factorization succeeded
+			if (lu.is_singular())
+				throw std::logic_error("Matrix is singular and cannot be inverted.");
+
+			inv     = lu.inverse();
+			det     = lu.det();
+			a       = std::move(m);
+			updates = 0;
+		}
+
+		// Threshold under which an update is rebuilt from the matrix : half of the digits are lost
+		static R tolerance() { return std::sqrt(std::numeric_limits<R>::epsilon()); }
+
+		// Counts one update, refactorizing when the budget is spent (keeping the updated inverse if that fails)
+		void count_update() {
+			if (refactor_every && ++updates >= refactor_every) {
+				try {
+					reset(a);
+				} catch (const std::logic_error&) {
+					updates = 0;
+				}
+			}
+		}
+
+	public:
+		/**
+		 * @brief Starts tracking a square matrix.
+		 * @param m The matrix, factorized once.
+		 * @param refactor_every The number of updates between refactorizations, 0 for the default n,
+		 *        std::numeric_limits<size_t>::max() to never refactorize.
+		 * @throw std::invalid_argument If the matrix is not square.
+		 * @throw std::logic_error If the matrix is singular.
+		 * @note Time complexity : O(n^3)
+		 * @note Space complexity : O(n^2)
+		 */
+		explicit InverseTracker(Matrix<T> m, size_t refactor_every = 0) : refactor_every(refactor_every ? refactor_every : m.rows()) {
+			if (!m.is_square())
+				throw std::invalid_argument("Inverse can only be computed on square matrix.");
+			reset(std::move(m));
+		}
+
+		/**
+		 * @brief Applies the rank-1 update A += u v^T.
+		 * @details With x = A^-1 u and y^T = v^T A^-1 : A^-1 -= x y^T / (1 + v^T x), det(A) *= 1 + v^T x.
+		 *          When 1 + v^T x has lost half of its digits to cancellation the inverse is rebuilt from the updated matrix instead.
+		 * @param u, v The factors of the update, of the matrix size.
+		 * @throw std::invalid_argument If u or v does not match the matrix size.
+		 * @throw std::logic_error If the updated matrix is singular, in which case the tracker is left unchanged.
+		 * @note Time complexity : O(n^2)
+		 * @note Space complexity : O(n)
+		 * @note Allowed math functions : None
+		 */
+		void update(const Vector<T>& u, const Vector<T>& v) {
+			check_size(u.size());
+			check_size(v.size());
+
+			const size_t n = size();
+			Vector<T>    x(n), y = inv.mul_vec(v); // y = A^-T v
+
+			for (size_t c = 0; c < n; c++) { // x = A^-1 u, a sum of columns
+				const T* col = inv[c].data();
+				for (size_t r = 0; r < n; r++)
+					x[r] += col[r] * u[c];
+			}
+
+			T d     = T(1);
+			R scale = R(0);
+			for (size_t r = 0; r < n; r++) {
+				d     += v[r] * x[r];
+				scale += magnitude(v[r] * x[r]);
+			}
+
+			if (magnitude(d) <= tolerance() * std::max(R(1), scale)) { // 1 + v^T x lost to cancellation
+				Matrix<T> m = a;
+				for (size_t c = 0; c < n; c++)
+					for (size_t r = 0; r < n; r++)
+						m[c][r] += u[r] * v[c];
+				reset(std::move(m));
+				return;
+			}
+
+			const T inv_d = T(1) / d;
+			parallel_for(0, n, 4 * n, [&](size_t lo, size_t hi) {
+				for (size_t c = lo; c < hi; c++) {
+					T*      ic = inv[c].data();
+					T*      ac = a[c].data();
+					const T yc = y[c] * inv_d, vc = v[c];
+
+					for (size_t r = 0; r < n; r++) {
+						ic[r] -= x[r] * yc;
+						ac[r] += u[r] * vc;
+					}
+				}
+			});
+			det *= d;
+			count_update();
+		}
+
+		/**
+		 * @brief Applies the rank-k update A += U V^T.
+		 * @details Woodbury : A^-1 -= (A^-1 U) C^-1 (V^T A^-1) with the k x k capacitance matrix C = I + V^T A^-1 U,
+		 *          and det(A) *= det(C). Cheaper than k rank-1 updates once k is more than a few, through mul_mat.
+		 * @param u, v n x k matrices.
+		 * @throw std::invalid_argument If U and V do not have n rows and the same number of columns.
+		 * @throw std::logic_error If the updated matrix is singular, in which case the tracker is left unchanged.
+		 * @note Time complexity : O(n^2 k + k^3)
+		 * @note Space complexity : O(n k)
+		 */
+		void update(const Matrix<T>& u, const Matrix<T>& v) {
+			check_size(u.rows());
+			check_size(v.rows());
+			if (u.cols() != v.cols())
+				throw std::invalid_argument("Update factors must have the same number of columns.");
+
+			const size_t k = u.cols();
+			if (!k)
+				return;
+
+			const Matrix<T> vt = v.transpose();
+			const Matrix<T> x  = inv.mul_mat(u);  // A^-1 U, n x k
+			const Matrix<T> y  = vt.mul_mat(inv); // V^T A^-1, k x n
+			Matrix<T>       c  = vt.mul_mat(x);   // C = I + V^T A^-1 U
+			for (size_t i = 0; i < k; i++)
+				c[i][i] += T(1);
+
+			const LU<T> lu(c);
+			if (lu.is_singular() || lu.rcond() <= tolerance()) { // C nearly singular : A + U V^T may be too
+				Matrix<T> m = a;
+				m.add(u.mul_mat(vt));
+				reset(std::move(m));
+				return;
+			}
+
+			inv.sub(x.mul_mat(lu.solve(y)));
+			a.add(u.mul_mat(vt));
+			det *= lu.det();
+			count_update();
+		}
+
+		/**
+		 * @brief Rebuilds the inverse and the determinant from the tracked matrix.
+		 * @note Time complexity : O(n^3)
+		 */
+		void refactor() { reset(a); }
+
+		inline size_t size() const { return a.rows(); }
+		inline const Matrix<T>& matrix() const { return a; }
+		inline const Matrix<T>& inverse() const { return inv; }
+		inline T determinant() const { return det; }
+		inline size_t refactor_interval() const { return refactor_every; }
+		inline size_t updates_since_refactor() const { return updates; }
+
+		/**
+		 * @brief Solves A.mul_vec(x) == b with the tracked inverse.
+		 * @param b The right-hand side.
+		 * @return Vector<T> The solution x.
+		 * @throw std::invalid_argument If b does not match the matrix size.
+		 * @note Time complexity : O(n^2)
+		 */
+		Vector<T> solve(const Vector<T>& b) const {
+			if (b.size() != size())
+				throw std::invalid_argument("Right-hand side size must match the matrix size.");
+			return inv.mul_vec(b);
+		}
+};
@@ -1,45 +1,71 @@
 #pragma once
 
 # include "config.hpp"
+# include "simd.hpp"
+# include "Expr.hpp"
 
 /**
  * @brief Represents a mathematical vector of n dimensions.
  * @tparam T The type of the elements in the vector.
+ * @note This is the run-time sized vector, see Fixed.hpp for Vector<T, N>.
  */
 template<typename T>
-class Vector {
+class Vector<T, DYNAMIC> {
 	protected:
 		std::vector<T> data;
 
+		// Number of reals per element : complex elements are stored as interleaved (re, im) pairs
+		static constexpr size_t lanes = IS_COMPLEX(T) ? 2 : 1;
+
 		/**
-		 * @brief Computes the absolute value of a number.
-		 * @details Works for both real and complex numbers.
-		 * @param v The value to compute the absolute value for.
-		 * @return The absolute value of v, as a real number.
-		 * @throw std::invalid_argument If the type T is neither arithmetic nor complex.
-		 * @note Time complexity : O(1)
-		 * @note Space complexity : O(1)
-		 * @note Allowed math functions : fma, pow
+		 * @brief Views the elements as a buffer of reals, for the SIMD kernels.
+		 * @return The pointer to size() * lanes reals.
 		 */
-		inline auto abs(const T& v) const {
-			using R = TO_REAL<T>;
-			
-			if constexpr (IS_ARITHMETIC(T))
-				return (v < R(0)) ? -v : v;
-			else if constexpr (IS_COMPLEX(T))
-				return std::pow(std::fma(v.real(), v.real(), v.imag() * v.imag()), R(0.5)); // sqrt(real² + imag²)
-			else
-				throw std::invalid_argument("Cannot compute abs with the given type.");
-		}
+		inline TO_REAL<T>* reals() { return reinterpret_cast<TO_REAL<T>*>(data.data()); }
+		inline const TO_REAL<T>* reals() const { return reinterpret_cast<const TO_REAL<T>*>(data.data()); }
 
 	public:
 		Vector() = default;
-		Vector(const size_t& size) : data(size) {}
+		Vector(const size_t& size) : data(size) { PROFILE_ALLOC(size * sizeof(T)); }
 		Vector(std::initializer_list<T> list) : data(list) {}
 		Vector(const std::vector<T>& other) : data(other) {}
 
+		/**
+		 * @brief Evaluates an element-wise expression (see Expr.hpp) in a single loop.
+		 * @param expr The expression to evaluate, e.g. a * x + b * y - z.
+		 * @note Time complexity : O(n)
+		 * @note Space complexity : O(n)
+		 */
+		template<typename E>
+		Vector(const Expr<E>& expr) : data(expr.self().size()) {
+			static_assert(!E::is_matrix, "Cannot assign a matrix expression to a vector.");
+
+			const E& e = expr.self();
+			for (size_t i = 0; i < size(); ++i)
+				data[i] = T(e[i]);
+		}
+
+		/**
+		 * @brief Evaluates an element-wise expression (see Expr.hpp) into this vector.
+		 * @details The vector may appear in the expression itself (x = x + y) : each element only reads its own index.
+		 * @param expr The expression to evaluate.
+		 * @return Vector<T>& This vector.
+		 */
+		template<typename E>
+		Vector<T>& operator=(const Expr<E>& expr) {
+			static_assert(!E::is_matrix, "Cannot assign a matrix expression to a vector.");
+
+			const E& e = expr.self();
+			data.resize(e.size());
+			for (size_t i = 0; i < size(); ++i)
+				data[i] = T(e[i]);
+
+			return *this;
+		}
+
 		/**
 		 * @brief Adds two vectors.
+		 * @details Float, double and complex vectors go through the SIMD kernels.
 		 * @param other The other vector to add.
 		 * @throw std::invalid_argument If the vectors are not of the same size.
 		 * @note Time complexity : O(n)
@@ -47,15 +73,21 @@ class Vector {
 		 * @note Allowed math functions : None
 		 */
 		void add(const Vector<T>& other) {
+			PROFILE_OP("Vector::add", size(), 1, FLOPS_ADD<T> * size(), 3. * sizeof(T) * size());
+
 			if (size() != other.size())
 				throw std::invalid_argument("Vectors must have the same size");
 
-			for (size_t i = 0; i < size(); ++i)
-				data[i] += other.data[i];
+			if constexpr (IS_SIMD(T))
+				simd<TO_REAL<T>>().add(reals(), other.reals(), size() * lanes);
+			else
+				for (size_t i = 0; i < size(); ++i)
+					data[i] += other.data[i];
 		}
 
 		/**
 		 * @brief Substract two vectors.
+		 * @details Float, double and complex vectors go through the SIMD kernels.
 		 * @param other The other vector to subtract.
 		 * @throw std::invalid_argument If the vectors are not of the same size.
 		 * @note Time complexity : O(n)
@@ -63,27 +95,39 @@ class Vector {
 		 * @note Allowed math functions : None
 		 */
 		void sub(const Vector<T>& other) {
+			PROFILE_OP("Vector::sub", size(), 1, FLOPS_ADD<T> * size(), 3. * sizeof(T) * size());
+
 			if (size() != other.size())
 				throw std::invalid_argument("Vectors must have the same size");
 
-			for (size_t i = 0; i < size(); ++i)
-				data[i] -= other.data[i];
+			if constexpr (IS_SIMD(T))
+				simd<TO_REAL<T>>().sub(reals(), other.reals(), size() * lanes);
+			else
+				for (size_t i = 0; i < size(); ++i)
+					data[i] -= other.data[i];
 		}
 
 		/**
 		 * @brief Scale the vector by a scalar.
+		 * @details Float and double vectors go through the SIMD kernels.
 		 * @param scalar The scalar to scale the vector by.
 		 * @note Time complexity : O(n)
 		 * @note Space complexity : O(1)
 		 * @note Allowed math functions : None
 		 */
 		void scl(const T& scalar) {
-			for (T& i : data)
-				i *= scalar;
+			PROFILE_OP("Vector::scl", size(), 1, FLOPS_ADD<T> * size(), 2. * sizeof(T) * size());
+
+			if constexpr (IS_SIMD(T) && IS_ARITHMETIC(T))
+				simd<T>().scl(data.data(), scalar, size());
+			else
+				for (T& i : data)
+					i *= scalar;
 		}
 
 		/**
 		 * @brief Divide the vector by a scalar.
+		 * @details Float and double vectors go through the SIMD kernels.
 		 * @param scalar The scalar to divide the vector by.
 		 * @throw std::logic_error If the scalar is zero.
 		 * @note Time complexity : O(n)
@@ -91,16 +135,24 @@ class Vector {
 		 * @note Allowed math functions : None
 		 */
 		void div(const T& scalar) {
+			PROFILE_OP("Vector::div", size(), 1, FLOPS_ADD<T> * size(), 2. * sizeof(T) * size());
+
 			if (scalar == T(0))
 				throw std::logic_error("Division by zero is not allowed.");
 
-			for (T& i : data)
-				i /= scalar;
+			if constexpr (IS_SIMD(T) && IS_ARITHMETIC(T))
+				simd<T>().div(data.data(), scalar, size());
+			else
+				for (T& i : data)
+					i /= scalar;
 		}
 
 		/**
 		 * @brief Computes the dot product of two vectors.
 		 * @details Work with both real and complex numbers.
+		 *          Float, double and complex vectors go through the SIMD kernels, which split the sum over several
+		 *          accumulators : the rounding may differ from a strictly sequential sum in the last bits.
+		 *          f16 and bf16 vectors are widened by blocks and accumulated in f32, which the result is.
 		 * @param other The other vector to compute the dot product with.
 		 * @return The dot product result.
 		 * @throw std::invalid_argument If the vectors are not of the same size.
@@ -109,10 +161,22 @@ class Vector {
 		 * @note Allowed math functions : fma
 		 */
 		auto dot(const Vector<T>& other) const {
+			PROFILE_OP("Vector::dot", size(), 1, FLOPS_FMA<T> * size(), 2. * sizeof(T) * size());
+
 			if (size() != other.size())
 				throw std::invalid_argument("Vectors must have the same size");
 
-			T result = T(0);
+			if constexpr (IS_REDUCED(T))
+				return reduced_dot(data.data(), other.data.data(), size());
+			else if constexpr (IS_SIMD(T) && IS_ARITHMETIC(T))
+				return simd<T>().dot(data.data(), other.data.data(), size());
+			else if constexpr (IS_SIMD(T)) {
+				// re(a * conj(b)) = ar*br + ai*bi is a plain real dot product over the interleaved buffers
+				const auto& k = simd<TO_REAL<T>>();
+				return T(k.dot(reals(), other.reals(), size() * 2), k.dot_conj_imag(reals(), other.reals(), size() * 2));
+			}
+
+			ACCUMULATE<T> result = ACCUMULATE<T>(0);
 
 			for (size_t i = 0; i < size(); i++) {
 				if constexpr (IS_ARITHMETIC(T)) {
@@ -134,17 +198,26 @@ class Vector {
 		/**
 		 * @brief Compute the Taxicab norm (L1 norm) of the vector.
 		 * @details The L1 norm is the sum of the absolute values of the vector's elements.
+		 *          Float and double vectors go through the SIMD kernels, f16 and bf16 ones too after widening to f32.
 		 * @return The L1 norm of the vector.
 		 * @note Time complexity : O(n)
 		 * @note Space complexity : O(1)
 		 * @note Allowed math functions : fma, pow
 		 */
 		auto norm_1() const {
-			using R = TO_REAL<T>;
+			PROFILE_OP("Vector::norm_1", size(), 1, FLOPS_ADD<T> * size(), 1. * sizeof(T) * size());
+
+			using R = TO_REAL<ACCUMULATE<T>>;
+
+			if constexpr (IS_REDUCED(T))
+				return reduced_abs(data.data(), size(), false);
+			else if constexpr (IS_SIMD(T) && IS_ARITHMETIC(T))
+				return simd<T>().sum_abs(data.data(), size());
+
 			R result = R(0);
 
 			for (const T& i : data)
-				result += this->abs(i);
+				result += magnitude(i);
 	
 			return result;
 		}
@@ -152,17 +225,27 @@ class Vector {
 		/**
 		 * @brief Compute the Euclidean norm (L2 norm) of the vector.
 		 * @details The L2 norm is the square root of the sum of the squares of the vector's elements.
+		 *          Float, double and complex vectors go through the SIMD kernels (|z|² = re² + im², so a complex
+		 *          vector is the real vector of its interleaved parts). f16 and bf16 vectors accumulate in f32.
 		 * @return The L2 norm of the vector.
 		 * @note Time complexity : O(n)
 		 * @note Space complexity : O(1)
 		 * @note Allowed math functions : fma, pow
 		 */
 		auto norm() const {
-			using R = TO_REAL<T>;
+			PROFILE_OP("Vector::norm", size(), 1, FLOPS_FMA<T> * size(), 1. * sizeof(T) * size());
+
+			using R = TO_REAL<ACCUMULATE<T>>;
+
+			if constexpr (IS_REDUCED(T))
+				return std::pow(reduced_dot(data.data(), data.data(), size()), R(0.5)); // = sqrt()
+			else if constexpr (IS_SIMD(T))
+				return std::pow(simd<R>().dot(reals(), reals(), size() * lanes), R(0.5)); // = sqrt()
+
 			R result = R(0);
 
 			for (const T& i : data) {
-				const R a = this->abs(i); // Avoid doing fma with complex numbers
+				const R a = magnitude(i); // Avoid doing fma with complex numbers
 				result = std::fma(a, a, result);
 			}
 
@@ -172,17 +255,26 @@ class Vector {
 		/**
 		 * @brief Compute the Infinity norm (L∞ norm) of the vector.
 		 * @details The L∞ norm is the maximum absolute value of the vector's elements.
+		 *          Float and double vectors go through the SIMD kernels, f16 and bf16 ones too after widening to f32.
 		 * @return The L∞ norm of the vector.
 		 * @note Time complexity : O(n)
 		 * @note Space complexity : O(1)
 		 * @note Allowed math functions : fma, pow
 		 */
 		auto norm_inf() const {
-			using R = TO_REAL<T>;
+			PROFILE_OP("Vector::norm_inf", size(), 1, FLOPS_ADD<T> * size(), 1. * sizeof(T) * size());
+
+			using R = TO_REAL<ACCUMULATE<T>>;
+
+			if constexpr (IS_REDUCED(T))
+				return reduced_abs(data.data(), size(), true);
+			else if constexpr (IS_SIMD(T) && IS_ARITHMETIC(T))
+				return simd<T>().max_abs(data.data(), size());
+
 			R result = R(0);
 
 			for (const T& i : data)
-				result = std::max(result, this->abs(i));
+				result = std::max(result, magnitude(i));
 
 			return result;
 		}
@@ -195,6 +287,13 @@ class Vector {
 		 */
 		inline size_t size() const { return data.size(); }
 
+		/**
+		 * @brief Returns the raw element buffer.
+		 * @return T* The pointer to the first element.
+		 */
+		inline T* ptr() { return data.data(); }
+		inline const T* ptr() const { return data.data(); }
+
 		/**
 		 * @brief Reshapes the vector into a matrix.
 		 * @param rows The number of rows in the resulting matrix.
@@ -202,21 +301,26 @@ class Vector {
 		 * @return Matrix<T> The reshaped matrix.
 		 * @throw std::invalid_argument If the product of rows and cols does not equal the size of the vector.
 		 */
-		Matrix<T> reshape(size_t rows, size_t cols) const {
+		Matrix<T> reshape(size_t rows, size_t cols) const & {
 			if (rows * cols != size())
 				throw std::invalid_argument("Reshape dimensions do not match vector size.");
 
-			std::vector<Vector<T>> mat;
-			for (size_t i = 0; i < rows; ++i) {
-				Vector<T> row;
-
-				for (size_t j = 0; j < cols; ++j)
-					row.data.push_back(data[i * cols + j]);
+			// Element (i, j) lands in column i, row j : the vector already is the column-major buffer
+			return Matrix<T>(rows, cols, data);
+		}
 
-				mat.push_back(row);
-			}
+		/**
+		 * @brief Reshapes a temporary vector, handing its buffer over to the matrix (e.g. std::move(v).reshape(2, 3)).
+		 * @param rows The number of rows in the reshaped matrix.
+		 * @param cols The number of columns in the reshaped matrix.
+		 * @return Matrix<T> The reshaped matrix, the vector is left empty.
+		 * @throw std::invalid_argument If the product of rows and cols does not equal the size of the vector.
+		 */
+		Matrix<T> reshape(size_t rows, size_t cols) && {
+			if (rows * cols != size())
+				throw std::invalid_argument("Reshape dimensions do not match vector size.");
 
-			return Matrix<T>(mat);
+			return Matrix<T>(rows, cols, std::move(data));
 		}
 
 		T& operator[](size_t index) { return data[index]; }
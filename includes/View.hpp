@@ -0,0 +1,269 @@
+#pragma once
+
+# include <iterator>
+# include "config.hpp"
+
+/**
+ * @brief Random-access iterator over elements spaced by a fixed stride.
+ * @tparam T The type of the elements (may be const-qualified).
+ */
+template<typename T>
+class StrideIterator {
+	protected:
+		T*        ptr  = nullptr;
+		ptrdiff_t step = 1;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type        = std::remove_const_t<T>;
+		using difference_type   = ptrdiff_t;
+		using pointer           = T*;
+		using reference         = T&;
+
+		StrideIterator() = default;
+		constexpr StrideIterator(T* ptr, ptrdiff_t step) : ptr(ptr), step(step) {}
+
+		constexpr T& operator*() const { return *ptr; }
+		constexpr T* operator->() const { return ptr; }
+		constexpr T& operator[](ptrdiff_t i) const { return ptr[i * step]; }
+
+		constexpr StrideIterator& operator++() { ptr += step; return *this; }
+		constexpr StrideIterator& operator--() { ptr -= step; return *this; }
+		constexpr StrideIterator operator++(int) { StrideIterator it = *this; ptr += step; return it; }
+		constexpr StrideIterator operator--(int) { StrideIterator it = *this; ptr -= step; return it; }
+		constexpr StrideIterator& operator+=(ptrdiff_t i) { ptr += i * step; return *this; }
+		constexpr StrideIterator& operator-=(ptrdiff_t i) { ptr -= i * step; return *this; }
+		constexpr StrideIterator operator+(ptrdiff_t i) const { return StrideIterator(ptr + i * step, step); }
+		constexpr StrideIterator operator-(ptrdiff_t i) const { return StrideIterator(ptr - i * step, step); }
+		constexpr ptrdiff_t operator-(const StrideIterator& other) const { return (ptr - other.ptr) / step; }
+
+		constexpr bool operator==(const StrideIterator& other) const { return ptr == other.ptr; }
+		constexpr bool operator!=(const StrideIterator& other) const { return ptr != other.ptr; }
+		constexpr bool operator<(const StrideIterator& other) const { return (step > 0) ? ptr < other.ptr : ptr > other.ptr; }
+		constexpr bool operator>(const StrideIterator& other) const { return other < *this; }
+		constexpr bool operator<=(const StrideIterator& other) const { return !(other < *this); }
+		constexpr bool operator>=(const StrideIterator& other) const { return !(*this < other); }
+};
+
+/**
+ * @brief Non-owning view over elements spaced by a fixed stride, such as a matrix column (stride 1) or row.
+ * @details Behaves like a Vector for element access, but never allocates : it only stores a pointer, a size
+ *          and a stride. Can wrap externally owned buffers. The viewed storage must outlive the view.
+ * @tparam T The type of the elements (may be const-qualified for read-only views).
+ */
+template<typename T>
+class VectorView {
+	protected:
+		T*     ptr  = nullptr;
+		size_t n    = 0;
+		size_t inc  = 1;   // Distance between two consecutive elements
+
+	public:
+		using value_type = std::remove_const_t<T>;
+		using iterator   = StrideIterator<T>;
+
+		VectorView() = default;
+		constexpr VectorView(T* ptr, size_t size, size_t stride = 1) : ptr(ptr), n(size), inc(stride) {}
+
+		// Allow VectorView<T> -> VectorView<const T>
+		template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+		constexpr VectorView(const VectorView<U>& other) : ptr(other.data()), n(other.size()), inc(other.stride()) {}
+
+		# pragma region Utils
+
+		/**
+		 * @brief Returns the number of elements in the view.
+		 * @return size_t The size of the view.
+		 */
+		constexpr size_t size() const { return n; }
+
+		/**
+		 * @brief Returns the distance between two consecutive viewed elements.
+		 * @return size_t The stride, 1 for a contiguous view.
+		 */
+		constexpr size_t stride() const { return inc; }
+
+		/**
+		 * @brief Returns the pointer to the first viewed element.
+		 * @return T* The underlying pointer.
+		 */
+		constexpr T* data() const { return ptr; }
+
+		constexpr iterator begin() const { return iterator(ptr, ptrdiff_t(inc)); }
+		constexpr iterator end() const { return iterator(ptr + n * inc, ptrdiff_t(inc)); }
+
+		constexpr T& operator[](size_t index) const { return ptr[index * inc]; }
+
+		/**
+		 * @brief Copies the elements of another view of the same size into this one.
+		 * @param other The view to copy from.
+		 * @throw std::invalid_argument If the sizes differ.
+		 */
+		void assign(const VectorView<const value_type>& other) const {
+			if (other.size() != n)
+				throw std::invalid_argument("Views must have the same size.");
+			std::copy(other.begin(), other.end(), begin());
+		}
+
+		/**
+		 * @brief Copies the viewed elements into an owning vector.
+		 * @return Vector<value_type> The materialized vector.
+		 */
+		operator Vector<value_type>() const { return Vector<value_type>(std::vector<value_type>(begin(), end())); }
+
+		bool operator==(const VectorView<const value_type>& other) const {
+			return n == other.size() && std::equal(begin(), end(), other.begin());
+		}
+
+		# pragma endregion
+};
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const VectorView<T>& vec) {
+	os << "[";
+	for (size_t i = 0; i < vec.size(); ++i)
+		os << vec[i] << (i + 1 < vec.size() ? ", " : "");
+	os << "]";
+	return os;
+}
+
+/**
+ * @brief Non-owning view over a matrix stored with arbitrary row and column strides.
+ * @details Element (r, c) is at `ptr[r * row_stride + c * col_stride]`. A Matrix<T> is viewed with strides (1, ld),
+ *          its transpose by swapping them, and any block by offsetting the pointer : none of them copies an element.
+ *          Columns and rows come out as VectorView, with the same m[c][r] indexing as Matrix<T>.
+ *          Can wrap externally owned buffers (e.g. memory-mapped). The viewed storage must outlive the view.
+ *          Matrix<T>(view) materializes a view into an owning matrix.
+ * @tparam T The type of the elements (may be const-qualified for read-only views).
+ */
+template<typename T>
+class MatrixView {
+	protected:
+		T*     ptr    = nullptr;
+		size_t n_rows = 0;
+		size_t n_cols = 0;
+		size_t rs     = 1;   // Distance between two rows of a column
+		size_t cs     = 0;   // Distance between two columns of a row
+
+	public:
+		using value_type = std::remove_const_t<T>;
+
+		MatrixView() = default;
+
+		/**
+		 * @brief Views a column-major buffer.
+		 * @param ptr The first element.
+		 * @param rows The number of rows.
+		 * @param cols The number of columns.
+		 * @param ld The distance between the starts of two columns, rows (packed) by default.
+		 */
+		constexpr MatrixView(T* ptr, size_t rows, size_t cols, size_t ld = 0) : ptr(ptr), n_rows(rows), n_cols(cols), rs(1), cs(ld ? ld : rows) {}
+
+		/**
+		 * @brief Views a buffer with explicit strides, e.g. (cols, 1) for a row-major buffer.
+		 * @param ptr The first element.
+		 * @param rows The number of rows.
+		 * @param cols The number of columns.
+		 * @param row_stride The distance between two rows of a column.
+		 * @param col_stride The distance between two columns of a row.
+		 */
+		constexpr MatrixView(T* ptr, size_t rows, size_t cols, size_t row_stride, size_t col_stride)
+			: ptr(ptr), n_rows(rows), n_cols(cols), rs(row_stride), cs(col_stride) {}
+
+		/**
+		 * @brief Views a whole Matrix<T> or Matrix<T, R, C>.
+		 * @param m The matrix to view.
+		 */
+		template<typename M, typename = decltype(std::declval<M&>().ptr(), std::declval<M&>().ld())>
+		constexpr MatrixView(M& m) : MatrixView(m.ptr(), m.rows(), m.cols(), m.ld()) {}
+
+		// Allow MatrixView<T> -> MatrixView<const T>
+		template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+		constexpr MatrixView(const MatrixView<U>& other)
+			: MatrixView(other.data(), other.rows(), other.cols(), other.row_stride(), other.col_stride()) {}
+
+		/**
+		 * @brief Views a sub-block of the matrix.
+		 * @param row The first row of the block.
+		 * @param col The first column of the block.
+		 * @param rows The number of rows of the block.
+		 * @param cols The number of columns of the block.
+		 * @return MatrixView<T> The block, sharing the storage.
+		 * @throw std::out_of_range If the block does not fit in the matrix.
+		 */
+		MatrixView<T> block(size_t row, size_t col, size_t rows, size_t cols) const {
+			if (row + rows > n_rows || col + cols > n_cols)
+				throw std::out_of_range("Block is out of the matrix bounds.");
+			return MatrixView<T>(ptr + row * rs + col * cs, rows, cols, rs, cs);
+		}
+
+		/**
+		 * @brief Views the transpose of the matrix, by swapping the strides.
+		 * @return MatrixView<T> The transposed view, sharing the storage.
+		 * @note Time complexity : O(1)
+		 */
+		constexpr MatrixView<T> transpose() const { return MatrixView<T>(ptr, n_cols, n_rows, cs, rs); }
+
+		/**
+		 * @brief Views a row of the matrix.
+		 * @param r The row index.
+		 * @return VectorView<T> The row, with a stride of col_stride().
+		 */
+		constexpr VectorView<T> row(size_t r) const { return VectorView<T>(ptr + r * rs, n_cols, cs); }
+
+		/**
+		 * @brief Copies the elements of another view of the same shape into this one.
+		 * @details Used to fill blocks of a preallocated matrix, e.g. the two halves of [A | B].
+		 * @param other The view to copy from. Must not overlap this view.
+		 * @throw std::invalid_argument If the shapes differ.
+		 */
+		void assign(const MatrixView<const value_type>& other) const {
+			if (other.shape() != shape())
+				throw std::invalid_argument("Views must have the same shape.");
+			for (size_t c = 0; c < n_cols; c++)
+				(*this)[c].assign(other[c]);
+		}
+
+		# pragma region Utils
+
+		inline size_t rows() const { return n_rows; }
+		inline size_t cols() const { return n_cols; }
+		inline std::pair<size_t, size_t> shape() const { return { n_rows, n_cols }; }
+		inline bool is_square() const { return n_rows == n_cols; }
+
+		inline size_t row_stride() const { return rs; }
+		inline size_t col_stride() const { return cs; }
+
+		/**
+		 * @brief Checks whether the columns are contiguous, so the view can go through the column-major kernels.
+		 * @return true If the row stride is 1 ; ld() is then the leading dimension.
+		 */
+		inline bool is_column_major() const { return rs == 1; }
+		inline size_t ld() const { return cs; }
+
+		inline T* data() const { return ptr; }
+
+		constexpr VectorView<T> operator[](size_t c) const { return VectorView<T>(ptr + c * cs, n_rows, rs); }
+
+		bool operator==(const MatrixView<const value_type>& other) const {
+			if (other.shape() != shape())
+				return false;
+			for (size_t c = 0; c < n_cols; c++)
+				if (!((*this)[c] == other[c]))
+					return false;
+			return true;
+		}
+
+		# pragma endregion
+};
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const MatrixView<T>& mat) {
+	os << "{";
+	for (size_t r = 0; r < mat.rows(); ++r) {
+		if (r) os << ", ";
+		os << mat.row(r);
+	}
+	os << "}";
+	return os;
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+# include <cstddef>
+# include <cstdint>
+# include <memory>
+# include "config.hpp"
+# include "View.hpp"
+
+/**
+ * @brief Bump-pointer arena for the temporaries of the matrix algorithms.
+ * @details Allocating is a pointer increment, and nothing is freed one by one : a Workspace::Scope rewinds the
+ *          arena to where it was when the scope was opened. Memory is kept across scopes, so once the arena has
+ *          grown to the high-water mark of a workload (or was sized up front with reserve()), the algorithms
+ *          using it do not call malloc at all. When a scope rewinds the arena to empty while it is split over
+ *          several blocks, they are merged into one block of the total size.
+ *
+ *          Workspace::local() is the arena of the calling thread, used by default by determinant(), inverse(),
+ *          rank() and row_echelon(). Pass an explicit Workspace to control its lifetime or size.
+ *
+ *          The memory is uninitialized and only meant for trivially destructible element types.
+ *          A Workspace is not thread-safe : each thread uses its own.
+ */
+class Workspace {
+	protected:
+		struct Block {
+			std::unique_ptr<std::byte[]> data;
+			size_t                       size = 0;
+		};
+
+		std::vector<Block> blocks;
+		size_t             current = 0; // Block being filled
+		size_t             used    = 0; // Bytes used in the current block
+
+		static constexpr size_t MIN_BLOCK = size_t(64) << 10;
+
+		void add_block(size_t bytes) {
+			PROFILE_ALLOC(bytes);
+			blocks.push_back({ std::unique_ptr<std::byte[]>(new std::byte[bytes]), bytes }); // Left uninitialized
+		}
+
+	public:
+		// Alignment of every allocation : a cache line, enough for any SIMD load
+		static constexpr size_t ALIGN = 64;
+
+		// A position in the arena, to rewind to
+		struct Mark {
+			size_t block = 0;
+			size_t used  = 0;
+		};
+
+		/**
+		 * @brief Rewinds a workspace to its state at construction when going out of scope.
+		 */
+		class Scope {
+			protected:
+				Workspace& ws;
+				Mark       mark;
+
+			public:
+				explicit Scope(Workspace& ws) : ws(ws), mark(ws.mark()) {}
+				Scope(const Scope&) = delete;
+				Scope& operator=(const Scope&) = delete;
+				~Scope() { ws.rewind(mark); }
+		};
+
+		Workspace() = default;
+
+		/**
+		 * @brief Creates a workspace with bytes preallocated.
+		 * @param bytes The initial capacity.
+		 */
+		explicit Workspace(size_t bytes) { reserve(bytes); }
+
+		Workspace(const Workspace&) = delete;
+		Workspace& operator=(const Workspace&) = delete;
+		Workspace(Workspace&&) = default;
+		Workspace& operator=(Workspace&&) = default;
+
+		/**
+		 * @brief Returns the workspace of the calling thread.
+		 * @return Workspace& The thread-local workspace, created empty on first use.
+		 */
+		static Workspace& local() {
+			static thread_local Workspace ws;
+			return ws;
+		}
+
+		/**
+		 * @brief Makes sure bytes can be allocated without growing.
+		 * @details Only takes effect while nothing is allocated, e.g. right after construction.
+		 * @param bytes The capacity to provide.
+		 */
+		void reserve(size_t bytes) {
+			if (bytes > capacity() && (blocks.empty() || (current == 0 && used == 0))) {
+				blocks.clear();
+				current = 0;
+				add_block(bytes);
+			}
+		}
+
+		/**
+		 * @brief Allocates bytes, aligned on ALIGN.
+		 * @param bytes The size of the allocation.
+		 * @return void* The uninitialized memory, valid until the enclosing scope rewinds the workspace.
+		 * @note Time complexity : O(1), amortized
+		 */
+		void* allocate(size_t bytes) {
+			while (true) {
+				if (current < blocks.size()) {
+					const uintptr_t base  = reinterpret_cast<uintptr_t>(blocks[current].data.get());
+					const uintptr_t start = (base + used + ALIGN - 1) & ~uintptr_t(ALIGN - 1);
+
+					if (start + bytes <= base + blocks[current].size) {
+						used = size_t(start + bytes - base);
+						return reinterpret_cast<void*>(start);
+					}
+					if (current + 1 < blocks.size()) { // Blocks kept from a previous, deeper use
+						current++;
+						used = 0;
+						continue;
+					}
+				}
+
+				const size_t last = blocks.empty() ? 0 : blocks.back().size;
+				add_block(std::max({ bytes + ALIGN, 2 * last, MIN_BLOCK }));
+				current = blocks.size() - 1;
+				used    = 0;
+			}
+		}
+
+		/**
+		 * @brief Allocates n uninitialized elements.
+		 * @param n The number of elements.
+		 * @return T* The first element.
+		 */
+		template<typename T>
+		T* alloc(size_t n) {
+			static_assert(std::is_trivially_destructible_v<T>, "Workspace memory is never destroyed.");
+			return static_cast<T*>(allocate(n * sizeof(T)));
+		}
+
+		/**
+		 * @brief Allocates an uninitialized packed column-major matrix.
+		 * @param rows The number of rows.
+		 * @param cols The number of columns.
+		 * @return MatrixView<T> The view over the new storage.
+		 */
+		template<typename T>
+		MatrixView<T> matrix(size_t rows, size_t cols) {
+			return MatrixView<T>(alloc<T>(rows * cols), rows, cols);
+		}
+
+		/**
+		 * @brief Allocates a copy of a matrix (or any view of one), packed column-major.
+		 * @param m The matrix to copy.
+		 * @return MatrixView<T> The copy.
+		 */
+		template<typename T>
+		MatrixView<T> copy(const MatrixView<const T>& m) {
+			MatrixView<T> result = matrix<T>(m.rows(), m.cols());
+			result.assign(m);
+			return result;
+		}
+
+		# pragma region Utils
+
+		/**
+		 * @brief Returns the current position, for rewind().
+		 * @return Mark The position.
+		 */
+		inline Mark mark() const { return { current, used }; }
+
+		/**
+		 * @brief Frees everything allocated since mark was taken.
+		 * @param mark A position returned by mark(). Marks are rewound in the reverse order they were taken.
+		 */
+		void rewind(const Mark& mark) {
+			current = mark.block;
+			used    = mark.used;
+
+			if (current == 0 && used == 0 && blocks.size() > 1) { // Empty again : merge, so the next run fits one block
+				const size_t total = capacity();
+				blocks.clear();
+				add_block(total);
+			}
+		}
+
+		/**
+		 * @brief Returns the total size of the blocks owned by the workspace.
+		 * @return size_t The capacity in bytes.
+		 */
+		inline size_t capacity() const {
+			size_t total = 0;
+			for (const Block& b : blocks)
+				total += b.size;
+			return total;
+		}
+
+		# pragma endregion
+};
@@ -1,16 +1,23 @@
 #pragma once
 
-# define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+# ifndef DOCTEST_CONFIG_DISABLE // Programs providing their own main (see srcs/bench.cpp) disable doctest
+#  define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+# endif
 # define GREEN "\033[1;32m"
 # define RED   "\033[1;31m"
 # define RESET "\033[0m"
 
 # include <vector>
+# include <utility>
+# include <algorithm>
 # include <iostream>
 # include <cmath>
 # include <complex>
 # include <type_traits>
+# include <stdexcept>
 # include "doctest.h"
+# include "Half.hpp"
+# include "Profile.hpp"
 
 # define IS_ARITHMETIC(T) (std::is_arithmetic_v<T>)
 # define IS_COMPLEX(T) (std::is_same_v<T, std::complex<float>> || std::is_same_v<T, std::complex<double>> || std::is_same_v<T, std::complex<long double>>)
@@ -23,6 +30,86 @@ template<typename T> using TO_REAL = typename to_real<T>::type;
 using f32 = float;
 using c32 = std::complex<float>;
 
+// 16-bit storage types (see Half.hpp) : computed and accumulated in f32
+# define IS_REDUCED(T) (std::is_same_v<T, f16> || std::is_same_v<T, bf16>)
+
+// Type the reductions (dot, norms, products) accumulate in
+template<typename T> struct accumulator { using type = T; };
+template<> struct accumulator<f16> { using type = f32; };
+template<> struct accumulator<bf16> { using type = f32; };
+template<typename T> using ACCUMULATE = typename accumulator<T>::type;
+
+/**
+ * @brief Computes the absolute value of a number, shared by every container and solver.
+ * @param v The value to compute the absolute value for.
+ * @return The absolute value of v, as a real number (f32 for the 16-bit types).
+ * @throw std::invalid_argument If the type T is neither arithmetic, complex nor reduced.
+ * @note Time complexity : O(1)
+ * @note Space complexity : O(1)
+ * @note Allowed math functions : fma, pow
+ */
+template<typename T>
+inline auto magnitude(const T& v) {
+	if constexpr (IS_ARITHMETIC(T))
+		return (v < T(0)) ? -v : v;
+	else if constexpr (IS_COMPLEX(T))
+		return std::pow(std::fma(v.real(), v.real(), v.imag() * v.imag()), TO_REAL<T>(0.5)); // sqrt(real² + imag²)
+	else if constexpr (IS_REDUCED(T)) {
+		const float f = v;
+		return (f < 0.f) ? -f : f;
+	}
+	else
+		throw std::invalid_argument("Cannot compute abs with the given type.");
+}
+
+// Per-operation profiling (see Profile.hpp), compiled out unless MATRIX_PROFILE is defined (make PROFILE=1)
+# ifdef MATRIX_PROFILE
+#  define PROFILE_OP(op, rows, cols, flops, bytes) ProfileScope profile_scope_(op, rows, cols, flops, bytes)
+#  define PROFILE_ALLOC(bytes) profile_allocation(bytes)
+# else
+#  define PROFILE_OP(op, rows, cols, flops, bytes) ((void)0)
+#  define PROFILE_ALLOC(bytes) ((void)0)
+# endif
+
+// Flops of one add and one fma on T, for the profiling counters (a complex fma is 4 muls and 4 adds)
+template<typename T> inline constexpr double FLOPS_ADD = IS_COMPLEX(T) ? 2 : 1;
+template<typename T> inline constexpr double FLOPS_FMA = IS_COMPLEX(T) ? 8 : 2;
+
+/**
+ * @brief Execution policy of the operations that can run on the thread pool.
+ * @details Auto goes parallel above tuning.parallel_threshold, Serial and Parallel force one or the other.
+ */
+enum class Execution { Auto, Serial, Parallel };
+
+/**
+ * @brief Runtime tuning knobs of the library.
+ * @details Defaults are sensible for a modern x86 core, they can be adjusted at startup for the host CPU,
+ *          or measured by make calibrate into a file named by MATRIX_TUNING (see TuningFile.hpp and Tuning.hpp).
+ */
+struct Tuning {
+	size_t gemm_threshold = 48;   // mul_mat switches to the blocked GEMM kernel when m, n and k are all at least this size
+	size_t gemm_mc        = 128;  // Rows of A packed per L2 block
+	size_t gemm_kc        = 256;  // Depth of the packed panels (L1 block)
+	size_t gemm_nc        = 2048; // Columns of B packed per L3 block
+
+	size_t combine_chunk  = 2048; // Output elements accumulated across all the inputs of linear_combination at once (L1 block)
+
+	Execution execution          = Execution::Auto;
+	size_t    threads            = 0;       // Workers of the global thread pool, 0 = one per hardware thread (read on first use)
+	size_t    parallel_threshold = 1 << 18; // Minimum work (about one unit per flop) for an operation to go parallel
+};
+
+// Constant-initialized : usable from any static initializer. The MATRIX_TUNING file is applied on first use (see TuningFile.hpp)
+inline Tuning tuning;
+
+// Size parameter of the run-time sized Vector / Matrix
+inline constexpr size_t DYNAMIC = 0;
+
 // forward declarations
-template<typename T> class Vector;
-template<typename T> class Matrix;
\ No newline at end of file
+template<typename T, size_t N = DYNAMIC> class Vector;                 // Vector<T> is dynamic, Vector<T, N> is fixed-size
+template<typename T, size_t R = DYNAMIC, size_t C = R> class Matrix;   // Matrix<T> is dynamic, Matrix<T, R, C> is fixed-size
+template<typename T> class VectorView;
+template<typename T> class MatrixView;
+template<typename E> struct Expr;
+template<typename T> class LU;
+template<typename T> class Solver;
\ No newline at end of file
@@ -2,17 +2,80 @@
 
 # include "Vector.hpp"
 # include "Matrix.hpp"
+# include "Fixed.hpp"
+# include "Batch.hpp"
+
+/**
+ * @brief Computes the linear combination of a run-time sized range of vectors and scalars.
+ * @details A GEMV of the stacked vectors : the output is processed in chunks of tuning.combine_chunk elements,
+ *          each one accumulated across all k inputs while it stays in L1, so every input is read once and
+ *          every output element written once. The chunks are split across the thread pool, and the float / double
+ *          accumulation goes through the SIMD combine kernel.
+ * @tparam It A forward iterator over Vector<T>.
+ * @tparam SIt An iterator over at least as many scalars as there are vectors.
+ * @param first, last The vectors to combine.
+ * @param scalars The scalars to multiply each vector by.
+ * @return Vector<T> The resulting vector from the linear combination, empty when the range is.
+ * @throw std::invalid_argument If the vectors are not of the same size.
+ * @note Time complexity : O(n k)
+ * @note Space complexity : O(n + k)
+ * @note Allowed math functions : fma
+ */
+template<typename It, typename SIt>
+auto linear_combination(It first, It last, SIt scalars) {
+	using T = std::decay_t<decltype((*first)[0])>;
+
+	std::vector<const T*> src;
+	std::vector<T>        coefs;
+	const size_t          n = (first != last) ? first->size() : 0;
+
+	for (It it = first; it != last; ++it, ++scalars) {
+		const Vector<T>& v = *it;
+		if (v.size() != n)
+			throw std::invalid_argument("All vectors must be of the same size.");
+		src.push_back(v.ptr());
+		coefs.push_back(*scalars);
+	}
+
+	const size_t k = src.size();
+	PROFILE_OP("linear_combination", n, k, FLOPS_FMA<T> * n * k, sizeof(T) * double(n) * (k + 1));
+
+	Vector<T>    result(n);
+	T*           out = result.ptr();
+	ensure_tuning_loaded();
+	const size_t chunk = std::max<size_t>(1, tuning.combine_chunk);
+
+	parallel_for(0, (n + chunk - 1) / chunk, chunk * std::max<size_t>(1, k), [&](size_t lo, size_t hi) {
+		for (size_t b = lo; b < hi; b++) {
+			const size_t offset = b * chunk, m = std::min(chunk, n - offset);
+
+			if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
+				simd<T>().combine(out + offset, src.data(), coefs.data(), k, offset, m);
+			else {
+				for (size_t i = 0; i < k; i++) {
+					const T* x = src[i] + offset;
+					const T  s = coefs[i];
+					for (size_t j = 0; j < m; j++)
+						out[offset + j] += s * x[j];
+				}
+			}
+		}
+	});
+
+	return result;
+}
 
 /**
  * @brief Computes the linear combination of given vectors and scalars.
  * @details This mean that the function computes the sum of each vector multiplied by its corresponding scalar.
+ *          It goes through the chunked range overload above : every input is read once, every output element written once.
  * @tparam T The type of the elements in the vectors and scalars.
  * @param vectors The vectors to combine.
  * @param scalars The scalars to multiply each vector by.
  * @return Vector<T> The resulting vector from the linear combination.
  * @throw std::invalid_argument If the sizes of the vectors and scalars lists do not match, or if the vectors are not of the same size.
- * @note Time complexity : O(n)
- * @note Space complexity : O(n)
+ * @note Time complexity : O(n k)
+ * @note Space complexity : O(n + k)
  * @note Allowed math functions : fma
  */
 template<typename T>
@@ -20,40 +83,18 @@ Vector<T> linear_combination(std::initializer_list<Vector<T>> vectors, std::init
     if (vectors.size() != scalars.size())
         throw std::invalid_argument("Vectors and scalars lists must be of the same size.");
 
-    if (vectors.size() == 0)
-        return Vector<T>();
-
-    auto vecIt = vectors.begin();
-    auto scaIt = scalars.begin();
-
-    Vector<T> result(vecIt->size());
-
-    while (vecIt != vectors.end() && scaIt != scalars.end()) {
-        if (vecIt->size() != result.size())
-            throw std::invalid_argument("All vectors must be of the same size.");
-
-        for (size_t j = 0; j < result.size(); ++j) {
-			if constexpr (IS_ARITHMETIC(T))
-            	result[j] = std::fma(*scaIt, (*vecIt)[j], result[j]);
-			else
-				result[j] += (*scaIt) * (*vecIt)[j];
-		}
-
-        ++vecIt;
-        ++scaIt;
-    }
-
-    return result;
+    return linear_combination(vectors.begin(), vectors.end(), scalars.begin());
 }
 
 /**
  * @brief Performs linear interpolation between two vectors.
  * @details The function computes a point along the line connecting vectors u and v, based on the interpolation factor t.
  *          When t = 0, the result is u; when t = 1, the result is v; for values between 0 and 1, the result is a blend of u and v.
+ *          It is evaluated as the fused expression u + t * (v - u) (see Expr.hpp).
  * @tparam T The type of the elements in the vectors and the interpolation factor.
  * @param u The first vector.
  * @param v The second vector.
- * @param t The interpolation factor.
+ * @param t The interpolation factor, a real of the precision of T.
  * @return Vector<T> The interpolated vector.
  * @throw std::invalid_argument If the vectors are not of the same size.
  * @note Time complexity : O(n)
@@ -63,20 +104,12 @@ Vector<T> linear_combination(std::initializer_list<Vector<T>> vectors, std::init
  * @see https://en.wikipedia.org/wiki/Linear_interpolation
  */
 template<typename T>
-Vector<T> lerp(const Vector<T>& u, const Vector<T>& v, const f32& t) {
+Vector<T> lerp(const Vector<T>& u, const Vector<T>& v, const TO_REAL<T>& t) {
 	if (u.size() != v.size())
 		throw std::invalid_argument("Both vectors must be of the same size.");
 
-	Vector<T> result(u.size());
-
-	for (size_t i = 0; i < u.size(); i++) {
-		if constexpr (IS_ARITHMETIC(T))
-			result[i] = std::fma(t, v[i] - u[i], u[i]);
-		else
-			result[i] = (v[i] - u[i]) * t + u[i];
-	}
-
-	return result;
+	PROFILE_OP("lerp", u.size(), 1, (FLOPS_ADD<T> + FLOPS_FMA<T>) * u.size(), 3. * sizeof(T) * u.size());
+	return Vector<T>(u + t * (v - u));
 }
 
 /**
@@ -153,19 +186,21 @@ Vector<T> cross_product(const Vector<T>& u, const Vector<T>& v) {
  * @param ratio The aspect ratio of the viewport (width / height).
  * @param near The distance to the near clipping plane.
  * @param far The distance to the far clipping plane.
- * @return Matrix<f32> The resulting perspective projection matrix.
+ * @tparam M The matrix type to build : Matrix<f32> by default, or Matrix<f32, 4, 4> to stay off the heap.
+ * @return M The resulting perspective projection matrix.
  * @note Time complexity : O(1)
  * @note Space complexity : O(1)
  * @note Allowed math functions : tan
  * 
  * @see https://en.wikipedia.org/wiki/Projection_matrix#Perspective_projection
  */
-Matrix<f32> projection(f32 fov, f32 ratio, f32 near, f32 far) {
+template<typename M = Matrix<f32>>
+M projection(f32 fov, f32 ratio, f32 near, f32 far) {
 
 	f32 fov_rad = fov * (3.14159265358979323846f / 180.0f);
 	f32 f = 1.0f / std::tan(fov_rad / 2.0f);
 
-	Matrix<f32> proj({
+	M proj({
 		{ f / ratio, 0, 0, 0 },
 		{ 0, f, 0, 0 },
 		{ 0, 0, (far+near)/(near-far), -1 },
@@ -0,0 +1,164 @@
+#pragma once
+
+# include "config.hpp"
+# include "TuningFile.hpp"
+
+/**
+ * @brief Register tile sizes of the GEMM micro-kernel for a given element type.
+ * @details MR x NR accumulators are kept in registers : MR is a multiple of the SIMD width so the
+ *          innermost loop maps to full vector FMAs, NR is bounded by the number of vector registers.
+ *          Only the types with an entry here go through the blocked kernel.
+ */
+template<typename T> struct gemm_traits { static constexpr bool enabled = false; };
+template<> struct gemm_traits<float>  { static constexpr bool enabled = true; static constexpr size_t MR = 16; static constexpr size_t NR = 6; };
+template<> struct gemm_traits<double> { static constexpr bool enabled = true; static constexpr size_t MR = 8;  static constexpr size_t NR = 6; };
+template<> struct gemm_traits<c32>    { static constexpr bool enabled = true; static constexpr size_t MR = 8;  static constexpr size_t NR = 4; };
+
+/**
+ * @brief Packs a mc x kc block of A into row panels of MR rows.
+ * @details Each panel is stored depth-first (MR consecutive elements per k), zero-padded up to MR rows,
+ *          so the micro-kernel reads it with unit stride. Element (i, p) of A is A[i * rsa + p * csa].
+ * @note Time complexity : O(mc*kc)
+ * @note Space complexity : O(1)
+ */
+template<typename T>
+void gemm_pack_a(size_t mc, size_t kc, const T* A, size_t rsa, size_t csa, T* buffer) {
+	constexpr size_t MR = gemm_traits<T>::MR;
+
+	for (size_t i = 0; i < mc; i += MR) {
+		const size_t mr = std::min(MR, mc - i);
+
+		for (size_t p = 0; p < kc; p++) {
+			const T* src = A + p * csa + i * rsa;
+
+			if (rsa == 1) {
+				for (size_t ii = 0; ii < mr; ii++)
+					*buffer++ = src[ii];
+			}
+			else {
+				for (size_t ii = 0; ii < mr; ii++)
+					*buffer++ = src[ii * rsa];
+			}
+			for (size_t ii = mr; ii < MR; ii++)
+				*buffer++ = T(0);
+		}
+	}
+}
+
+/**
+ * @brief Packs a kc x nc block of B into column panels of NR columns.
+ * @details Each panel is stored depth-first (NR consecutive elements per k), zero-padded up to NR columns.
+ *          Element (p, j) of B is B[p * rsb + j * csb].
+ * @note Time complexity : O(kc*nc)
+ * @note Space complexity : O(1)
+ */
+template<typename T>
+void gemm_pack_b(size_t kc, size_t nc, const T* B, size_t rsb, size_t csb, T* buffer) {
+	constexpr size_t NR = gemm_traits<T>::NR;
+
+	for (size_t j = 0; j < nc; j += NR) {
+		const size_t nr = std::min(NR, nc - j);
+
+		for (size_t p = 0; p < kc; p++) {
+			for (size_t jj = 0; jj < nr; jj++)
+				*buffer++ = B[(j + jj) * csb + p * rsb];
+			for (size_t jj = nr; jj < NR; jj++)
+				*buffer++ = T(0);
+		}
+	}
+}
+
+/**
+ * @brief Computes a MR x NR tile C += A_panel * B_panel.
+ * @details The accumulators live in a local array sized to fit in registers; partial tiles on the
+ *          matrix edges are computed in full and only the valid mr x nr part is written back.
+ * @note Time complexity : O(MR*NR*kc)
+ * @note Space complexity : O(1)
+ */
+template<typename T>
+inline void gemm_micro_kernel(size_t kc, const T* a, const T* b, T* C, size_t ldc, size_t mr, size_t nr) {
+	constexpr size_t MR = gemm_traits<T>::MR;
+	constexpr size_t NR = gemm_traits<T>::NR;
+
+	T acc[NR][MR] = {};
+
+	for (size_t p = 0; p < kc; p++) {
+		# pragma GCC unroll 16
+		for (size_t j = 0; j < NR; j++) {
+			const T bj = b[j];
+
+			# pragma GCC unroll 16
+			for (size_t i = 0; i < MR; i++)
+				acc[j][i] += a[i] * bj;
+		}
+		a += MR;
+		b += NR;
+	}
+
+	for (size_t j = 0; j < nr; j++)
+		for (size_t i = 0; i < mr; i++)
+			C[j * ldc + i] += acc[j][i];
+}
+
+/**
+ * @brief Cache-blocked general matrix multiplication C += A * B on column-major buffers.
+ * @details Goto/BLIS-style loop nest : B is packed by (kc x nc) blocks to stay in L3, A by (mc x kc) blocks
+ *          to stay in L2, and the micro-kernel streams one MR x kc panel of A against one kc x NR panel of B from L1.
+ *          Packing buffers are kept per thread and reused across calls.
+ * @param m The number of rows of A and C.
+ * @param n The number of columns of B and C.
+ * @param k The number of columns of A and rows of B.
+ * @param rsa, csa The row and column strides of A : element (i, p) is A[i * rsa + p * csa].
+ * @param rsb, csb The row and column strides of B, so transposed views are multiplied without a copy.
+ * @note Time complexity : O(m*n*k)
+ * @note Space complexity : O(mc*kc + kc*nc) packing buffers
+ *
+ * @see https://www.cs.utexas.edu/~flame/pubs/GotoTOMS_revision.pdf
+ */
+template<typename T>
+void gemm(size_t m, size_t n, size_t k, const T* A, size_t rsa, size_t csa, const T* B, size_t rsb, size_t csb, T* C, size_t ldc) {
+	constexpr size_t MR = gemm_traits<T>::MR;
+	constexpr size_t NR = gemm_traits<T>::NR;
+
+	ensure_tuning_loaded();
+	const size_t MC = std::max(MR, tuning.gemm_mc / MR * MR);
+	const size_t KC = std::max(size_t(1), tuning.gemm_kc);
+	const size_t NC = std::max(NR, tuning.gemm_nc / NR * NR);
+
+	thread_local std::vector<T> packed_a;
+	thread_local std::vector<T> packed_b;
+	packed_a.resize(MC * KC);
+	packed_b.resize(KC * NC);
+
+	for (size_t jc = 0; jc < n; jc += NC) {
+		const size_t nc = std::min(NC, n - jc);
+
+		for (size_t pc = 0; pc < k; pc += KC) {
+			const size_t kc = std::min(KC, k - pc);
+			gemm_pack_b(kc, nc, B + jc * csb + pc * rsb, rsb, csb, packed_b.data());
+
+			for (size_t ic = 0; ic < m; ic += MC) {
+				const size_t mc = std::min(MC, m - ic);
+				gemm_pack_a(mc, kc, A + pc * csa + ic * rsa, rsa, csa, packed_a.data());
+
+				for (size_t jr = 0; jr < nc; jr += NR) {
+					for (size_t ir = 0; ir < mc; ir += MR) {
+						gemm_micro_kernel(kc,
+							packed_a.data() + ir * kc,
+							packed_b.data() + jr * kc,
+							C + (jc + jr) * ldc + ic + ir, ldc,
+							std::min(MR, mc - ir), std::min(NR, nc - jr));
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief Cache-blocked C += A * B on column-major buffers with unit row strides (see the strided overload).
+ */
+template<typename T>
+inline void gemm(size_t m, size_t n, size_t k, const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc) {
+	gemm(m, n, k, A, size_t(1), lda, B, size_t(1), ldb, C, ldc);
+}
@@ -0,0 +1,462 @@
+#pragma once
+
+# include "config.hpp"
+
+/**
+ * SIMD kernels for the hot Vector loops (add, sub, scl, div, dot, norms).
+ *
+ * The kernels are written once in simd_kernels.hpp against a small "lane" interface, then compiled
+ * once per instruction set : SSE2 / AVX2+FMA / AVX-512F on x86 (selected at run time from the host CPU),
+ * NEON on ARM, and a portable scalar version with the same multi-accumulator structure elsewhere.
+ * Define MATRIX_NO_SIMD to force the scalar version.
+ *
+ * Lane interface : T (element), V (register), W (elements per register), load, store, set1,
+ *                  add, sub, mul, div, fma(a, b, c) = a * b + c, abs, max, swap_pairs (swap each (re, im) pair).
+ */
+
+# if !defined(MATRIX_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#  define MATRIX_SIMD_X86
+#  include <immintrin.h>
+# elif !defined(MATRIX_NO_SIMD) && defined(__ARM_NEON) && defined(__aarch64__)
+#  define MATRIX_SIMD_NEON
+#  include <arm_neon.h>
+# endif
+
+// Compile a region of the header for a given instruction set, without requiring -m flags on the command line
+# define SIMD_PRAGMA(x) _Pragma(#x)
+# if defined(__clang__)
+#  define SIMD_TARGET_PUSH(isa) SIMD_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#  define SIMD_TARGET_POP()     SIMD_PRAGMA(clang attribute pop)
+# else
+#  define SIMD_TARGET_PUSH(isa) SIMD_PRAGMA(GCC push_options) SIMD_PRAGMA(GCC target(isa))
+#  define SIMD_TARGET_POP()     SIMD_PRAGMA(GCC pop_options)
+# endif
+
+/**
+ * @brief Table of kernels selected for the host CPU, for one real element type.
+ * @details Complex vectors go through the same kernels by viewing their storage as 2n interleaved reals.
+ */
+template<typename T>
+struct SimdKernels {
+	void (*add)(T* dst, const T* src, size_t n);
+	void (*sub)(T* dst, const T* src, size_t n);
+	void (*scl)(T* dst, T scalar, size_t n);
+	void (*div)(T* dst, T scalar, size_t n);
+	T    (*dot)(const T* x, const T* y, size_t n);
+	T    (*sum_abs)(const T* x, size_t n);
+	T    (*max_abs)(const T* x, size_t n);
+	T    (*dot_conj_imag)(const T* x, const T* y, size_t n);
+	void (*combine)(T* dst, const T* const* src, const T* scalars, size_t k, size_t offset, size_t n);
+	void (*transpose)(const T* src, size_t lds, T* dst, size_t ldd, size_t rows, size_t cols);
+	const char* isa;
+};
+
+# pragma region Scalar
+
+template<typename E>
+struct SimdScalarLane {
+	using T = E;
+	using V = E;
+	static constexpr size_t W = 1;
+
+	static V load(const T* p) { return *p; }
+	static void store(T* p, V v) { *p = v; }
+	static V set1(T v) { return v; }
+	static V add(V a, V b) { return a + b; }
+	static V sub(V a, V b) { return a - b; }
+	static V mul(V a, V b) { return a * b; }
+	static V div(V a, V b) { return a / b; }
+	static V fma(V a, V b, V c) { return a * b + c; }
+	static V abs(V a) { return (a < 0) ? -a : a; }
+	static V max(V a, V b) { return (a > b) ? a : b; }
+	static V swap_pairs(V a) { return a; }
+
+	// Transposes the TILE x TILE block of columns src (leading dimension lds) into dst (leading dimension ldd)
+	static constexpr size_t TILE = 4;
+	static void transpose_tile(const T* src, size_t lds, T* dst, size_t ldd) {
+		for (size_t i = 0; i < TILE; i++)
+			for (size_t j = 0; j < TILE; j++)
+				dst[j * ldd + i] = src[i * lds + j];
+	}
+};
+
+struct SimdScalarLanes {
+	using F32 = SimdScalarLane<float>;
+	using F64 = SimdScalarLane<double>;
+	static constexpr const char* name = "scalar";
+};
+
+# define SIMD_ISA SimdScalar
+# define SIMD_LANES SimdScalarLanes
+# include "simd_kernels.hpp"
+# undef SIMD_ISA
+# undef SIMD_LANES
+
+# pragma endregion
+
+# ifdef MATRIX_SIMD_X86
+
+# pragma region SSE2
+
+SIMD_TARGET_PUSH("sse2")
+
+struct SimdSSE2Lanes {
+	struct F32 {
+		using T = float;
+		using V = __m128;
+		static constexpr size_t W = 4;
+
+		static V load(const T* p) { return _mm_loadu_ps(p); }
+		static void store(T* p, V v) { _mm_storeu_ps(p, v); }
+		static V set1(T v) { return _mm_set1_ps(v); }
+		static V add(V a, V b) { return _mm_add_ps(a, b); }
+		static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+		static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+		static V div(V a, V b) { return _mm_div_ps(a, b); }
+		static V fma(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+		static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+		static V max(V a, V b) { return _mm_max_ps(a, b); }
+		static V swap_pairs(V a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)); }
+
+		static constexpr size_t TILE = 4;
+		static void transpose_tile(const T* src, size_t lds, T* dst, size_t ldd) {
+			V r0 = load(src), r1 = load(src + lds), r2 = load(src + 2 * lds), r3 = load(src + 3 * lds);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			store(dst, r0);
+			store(dst + ldd, r1);
+			store(dst + 2 * ldd, r2);
+			store(dst + 3 * ldd, r3);
+		}
+	};
+	struct F64 {
+		using T = double;
+		using V = __m128d;
+		static constexpr size_t W = 2;
+
+		static V load(const T* p) { return _mm_loadu_pd(p); }
+		static void store(T* p, V v) { _mm_storeu_pd(p, v); }
+		static V set1(T v) { return _mm_set1_pd(v); }
+		static V add(V a, V b) { return _mm_add_pd(a, b); }
+		static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+		static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+		static V div(V a, V b) { return _mm_div_pd(a, b); }
+		static V fma(V a, V b, V c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+		static V abs(V a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+		static V max(V a, V b) { return _mm_max_pd(a, b); }
+		static V swap_pairs(V a) { return _mm_shuffle_pd(a, a, 1); }
+
+		static constexpr size_t TILE = 2;
+		static void transpose_tile(const T* src, size_t lds, T* dst, size_t ldd) {
+			const V c0 = load(src), c1 = load(src + lds);
+			store(dst, _mm_unpacklo_pd(c0, c1));
+			store(dst + ldd, _mm_unpackhi_pd(c0, c1));
+		}
+	};
+	static constexpr const char* name = "sse2";
+};
+
+# define SIMD_ISA SimdSSE2
+# define SIMD_LANES SimdSSE2Lanes
+# include "simd_kernels.hpp"
+# undef SIMD_ISA
+# undef SIMD_LANES
+
+SIMD_TARGET_POP()
+
+# pragma endregion
+
+# pragma region AVX2
+
+SIMD_TARGET_PUSH("avx2,fma")
+
+struct SimdAVX2Lanes {
+	struct F32 {
+		using T = float;
+		using V = __m256;
+		static constexpr size_t W = 8;
+
+		static V load(const T* p) { return _mm256_loadu_ps(p); }
+		static void store(T* p, V v) { _mm256_storeu_ps(p, v); }
+		static V set1(T v) { return _mm256_set1_ps(v); }
+		static V add(V a, V b) { return _mm256_add_ps(a, b); }
+		static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+		static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+		static V div(V a, V b) { return _mm256_div_ps(a, b); }
+		static V fma(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+		static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+		static V max(V a, V b) { return _mm256_max_ps(a, b); }
+		static V swap_pairs(V a) { return _mm256_permute_ps(a, 0xB1); }
+
+		// 8x8 : interleave pairs of columns, then pairs of pairs, then swap the 128-bit halves
+		static constexpr size_t TILE = 8;
+		static void transpose_tile(const T* src, size_t lds, T* dst, size_t ldd) {
+			V c[8], t[8];
+			for (size_t i = 0; i < 8; i++)
+				c[i] = load(src + i * lds);
+			for (size_t i = 0; i < 8; i += 2) {
+				t[i]     = _mm256_unpacklo_ps(c[i], c[i + 1]);
+				t[i + 1] = _mm256_unpackhi_ps(c[i], c[i + 1]);
+			}
+			for (size_t i = 0; i < 8; i += 4) {
+				c[i]     = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+				c[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+				c[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+				c[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+			}
+			for (size_t i = 0; i < 4; i++) {
+				store(dst + i * ldd, _mm256_permute2f128_ps(c[i], c[i + 4], 0x20));
+				store(dst + (i + 4) * ldd, _mm256_permute2f128_ps(c[i], c[i + 4], 0x31));
+			}
+		}
+	};
+	struct F64 {
+		using T = double;
+		using V = __m256d;
+		static constexpr size_t W = 4;
+
+		static V load(const T* p) { return _mm256_loadu_pd(p); }
+		static void store(T* p, V v) { _mm256_storeu_pd(p, v); }
+		static V set1(T v) { return _mm256_set1_pd(v); }
+		static V add(V a, V b) { return _mm256_add_pd(a, b); }
+		static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+		static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+		static V div(V a, V b) { return _mm256_div_pd(a, b); }
+		static V fma(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+		static V abs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+		static V max(V a, V b) { return _mm256_max_pd(a, b); }
+		static V swap_pairs(V a) { return _mm256_permute_pd(a, 0x5); }
+
+		static constexpr size_t TILE = 4;
+		static void transpose_tile(const T* src, size_t lds, T* dst, size_t ldd) {
+			const V c0 = load(src), c1 = load(src + lds), c2 = load(src + 2 * lds), c3 = load(src + 3 * lds);
+			const V t0 = _mm256_unpacklo_pd(c0, c1), t1 = _mm256_unpackhi_pd(c0, c1);
+			const V t2 = _mm256_unpacklo_pd(c2, c3), t3 = _mm256_unpackhi_pd(c2, c3);
+			store(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+			store(dst + ldd, _mm256_permute2f128_pd(t1, t3, 0x20));
+			store(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+			store(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+		}
+	};
+	static constexpr const char* name = "avx2";
+};
+
+# define SIMD_ISA SimdAVX2
+# define SIMD_LANES SimdAVX2Lanes
+# include "simd_kernels.hpp"
+# undef SIMD_ISA
+# undef SIMD_LANES
+
+SIMD_TARGET_POP()
+
+# pragma endregion
+
+# pragma region AVX-512
+
+SIMD_TARGET_PUSH("avx512f")
+
+// The unmasked max / permute intrinsics pass an undefined source to their masked builtins, which GCC flags with
+// -Wmaybe-uninitialized at -O3 : the all-lanes masked forms with an explicit source compile to the same instructions.
+struct SimdAVX512Lanes {
+	struct F32 {
+		using T = float;
+		using V = __m512;
+		static constexpr size_t W = 16;
+
+		static V load(const T* p) { return _mm512_loadu_ps(p); }
+		static void store(T* p, V v) { _mm512_storeu_ps(p, v); }
+		static V set1(T v) { return _mm512_set1_ps(v); }
+		static V add(V a, V b) { return _mm512_add_ps(a, b); }
+		static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+		static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+		static V div(V a, V b) { return _mm512_div_ps(a, b); }
+		static V fma(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+		static V abs(V a) { return _mm512_abs_ps(a); }
+		static V max(V a, V b) { return _mm512_mask_max_ps(a, __mmask16(0xFFFF), a, b); }
+		static V swap_pairs(V a) { return _mm512_mask_permute_ps(a, __mmask16(0xFFFF), a, 0xB1); }
+
+		// The 256-bit tiles already saturate the memory bandwidth
+		static constexpr size_t TILE = SimdAVX2Lanes::F32::TILE;
+		static void transpose_tile(const T* src, size_t lds, T* dst, size_t ldd) { SimdAVX2Lanes::F32::transpose_tile(src, lds, dst, ldd); }
+	};
+	struct F64 {
+		using T = double;
+		using V = __m512d;
+		static constexpr size_t W = 8;
+
+		static V load(const T* p) { return _mm512_loadu_pd(p); }
+		static void store(T* p, V v) { _mm512_storeu_pd(p, v); }
+		static V set1(T v) { return _mm512_set1_pd(v); }
+		static V add(V a, V b) { return _mm512_add_pd(a, b); }
+		static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+		static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+		static V div(V a, V b) { return _mm512_div_pd(a, b); }
+		static V fma(V a, V b, V c) { return _mm512_fmadd_pd(a, b, c); }
+		static V abs(V a) { return _mm512_abs_pd(a); }
+		static V max(V a, V b) { return _mm512_mask_max_pd(a, __mmask8(0xFF), a, b); }
+		static V swap_pairs(V a) { return _mm512_mask_permute_pd(a, __mmask8(0xFF), a, 0x55); }
+
+		static constexpr size_t TILE = SimdAVX2Lanes::F64::TILE;
+		static void transpose_tile(const T* src, size_t lds, T* dst, size_t ldd) { SimdAVX2Lanes::F64::transpose_tile(src, lds, dst, ldd); }
+	};
+	static constexpr const char* name = "avx512";
+};
+
+# define SIMD_ISA SimdAVX512
+# define SIMD_LANES SimdAVX512Lanes
+# include "simd_kernels.hpp"
+# undef SIMD_ISA
+# undef SIMD_LANES
+
+SIMD_TARGET_POP()
+
+# pragma endregion
+
+# endif // MATRIX_SIMD_X86
+
+# ifdef MATRIX_SIMD_NEON
+
+# pragma region NEON
+
+struct SimdNEONLanes {
+	struct F32 {
+		using T = float;
+		using V = float32x4_t;
+		static constexpr size_t W = 4;
+
+		static V load(const T* p) { return vld1q_f32(p); }
+		static void store(T* p, V v) { vst1q_f32(p, v); }
+		static V set1(T v) { return vdupq_n_f32(v); }
+		static V add(V a, V b) { return vaddq_f32(a, b); }
+		static V sub(V a, V b) { return vsubq_f32(a, b); }
+		static V mul(V a, V b) { return vmulq_f32(a, b); }
+		static V div(V a, V b) { return vdivq_f32(a, b); }
+		static V fma(V a, V b, V c) { return vfmaq_f32(c, a, b); }
+		static V abs(V a) { return vabsq_f32(a); }
+		static V max(V a, V b) { return vmaxq_f32(a, b); }
+		static V swap_pairs(V a) { return vrev64q_f32(a); }
+
+		static constexpr size_t TILE = 4;
+		static void transpose_tile(const T* src, size_t lds, T* dst, size_t ldd) {
+			const float32x4x2_t a = vtrnq_f32(load(src), load(src + lds));
+			const float32x4x2_t b = vtrnq_f32(load(src + 2 * lds), load(src + 3 * lds));
+			store(dst, vcombine_f32(vget_low_f32(a.val[0]), vget_low_f32(b.val[0])));
+			store(dst + ldd, vcombine_f32(vget_low_f32(a.val[1]), vget_low_f32(b.val[1])));
+			store(dst + 2 * ldd, vcombine_f32(vget_high_f32(a.val[0]), vget_high_f32(b.val[0])));
+			store(dst + 3 * ldd, vcombine_f32(vget_high_f32(a.val[1]), vget_high_f32(b.val[1])));
+		}
+	};
+	struct F64 {
+		using T = double;
+		using V = float64x2_t;
+		static constexpr size_t W = 2;
+
+		static V load(const T* p) { return vld1q_f64(p); }
+		static void store(T* p, V v) { vst1q_f64(p, v); }
+		static V set1(T v) { return vdupq_n_f64(v); }
+		static V add(V a, V b) { return vaddq_f64(a, b); }
+		static V sub(V a, V b) { return vsubq_f64(a, b); }
+		static V mul(V a, V b) { return vmulq_f64(a, b); }
+		static V div(V a, V b) { return vdivq_f64(a, b); }
+		static V fma(V a, V b, V c) { return vfmaq_f64(c, a, b); }
+		static V abs(V a) { return vabsq_f64(a); }
+		static V max(V a, V b) { return vmaxq_f64(a, b); }
+		static V swap_pairs(V a) { return vextq_f64(a, a, 1); }
+
+		static constexpr size_t TILE = 2;
+		static void transpose_tile(const T* src, size_t lds, T* dst, size_t ldd) {
+			const V c0 = load(src), c1 = load(src + lds);
+			store(dst, vzip1q_f64(c0, c1));
+			store(dst + ldd, vzip2q_f64(c0, c1));
+		}
+	};
+	static constexpr const char* name = "neon";
+};
+
+# define SIMD_ISA SimdNEON
+# define SIMD_LANES SimdNEONLanes
+# include "simd_kernels.hpp"
+# undef SIMD_ISA
+# undef SIMD_LANES
+
+# pragma endregion
+
+# endif // MATRIX_SIMD_NEON
+
+/**
+ * @brief Returns the kernels of the best instruction set supported by the host CPU.
+ * @details The CPU is probed once, on first use.
+ * @tparam T float or double.
+ * @return const SimdKernels<T>& The kernel table.
+ */
+template<typename T>
+const SimdKernels<T>& simd() {
+	static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "SIMD kernels exist for float and double only.");
+
+	static const SimdKernels<T> kernels = [] {
+# if defined(MATRIX_SIMD_X86)
+		if (__builtin_cpu_supports("avx512f"))
+			return SimdAVX512::table<T>();
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+			return SimdAVX2::table<T>();
+		return SimdSSE2::table<T>();
+# elif defined(MATRIX_SIMD_NEON)
+		return SimdNEON::table<T>();
+# else
+		return SimdScalar::table<T>();
+# endif
+	}();
+
+	return kernels;
+}
+
+// True for the element types whose Vector loops go through the SIMD kernels
+# define IS_SIMD(T) (std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, std::complex<float>> || std::is_same_v<T, std::complex<double>>)
+
+# pragma region Reduced
+
+// Elements widened per block by the reduced-precision reductions : the f32 blocks stay in L1
+inline constexpr size_t REDUCED_BLOCK = 512;
+
+/**
+ * @brief Dot product of reduced-precision elements (see Half.hpp), accumulated in f32.
+ * @details Blocks of both operands are widened to f32 on the stack, then reduced by the f32 SIMD kernel.
+ * @tparam T f16 or bf16.
+ * @tparam U T, or float for an operand already widened.
+ * @note Time complexity : O(n)
+ * @note Space complexity : O(1)
+ */
+template<typename T, typename U>
+float reduced_dot(const T* x, const U* y, size_t n) {
+	const auto& k = simd<float>();
+	float bx[REDUCED_BLOCK], by[REDUCED_BLOCK];
+	float acc = 0;
+
+	for (size_t i = 0; i < n; i += REDUCED_BLOCK) {
+		const size_t m = std::min(REDUCED_BLOCK, n - i);
+		to_f32(x + i, bx, m);
+		if constexpr (std::is_same_v<U, float>)
+			acc += k.dot(bx, y + i, m);
+		else {
+			to_f32(y + i, by, m);
+			acc += k.dot(bx, by, m);
+		}
+	}
+	return acc;
+}
+
+// Sum (max_abs = false) or maximum of the absolute values of reduced-precision elements, in f32
+template<typename T>
+float reduced_abs(const T* x, size_t n, bool max_abs) {
+	const auto& k = simd<float>();
+	float bx[REDUCED_BLOCK];
+	float acc = 0;
+
+	for (size_t i = 0; i < n; i += REDUCED_BLOCK) {
+		const size_t m = std::min(REDUCED_BLOCK, n - i);
+		to_f32(x + i, bx, m);
+		acc = max_abs ? std::max(acc, k.max_abs(bx, m)) : acc + k.sum_abs(bx, m);
+	}
+	return acc;
+}
+
+# pragma endregion
@@ -0,0 +1,228 @@
+// No include guard : this file is included once per instruction set by simd.hpp,
+// inside a region compiled for that instruction set. SIMD_ISA names the generated struct and
+// SIMD_LANES the struct providing its F32 / F64 lane types and its name.
+
+/**
+ * @brief Vector kernels for one instruction set.
+ * @details Every kernel is written once against a lane type L (see simd.hpp) providing W elements per register.
+ *          Reductions keep four independent accumulators to hide the FMA latency, and the scalar tail
+ *          handles the last n % W elements.
+ */
+struct SIMD_ISA : SIMD_LANES {
+	template<typename L>
+	static void add(typename L::T* dst, const typename L::T* src, size_t n) {
+		size_t i = 0;
+		for (; i + L::W <= n; i += L::W)
+			L::store(dst + i, L::add(L::load(dst + i), L::load(src + i)));
+		for (; i < n; i++)
+			dst[i] += src[i];
+	}
+
+	template<typename L>
+	static void sub(typename L::T* dst, const typename L::T* src, size_t n) {
+		size_t i = 0;
+		for (; i + L::W <= n; i += L::W)
+			L::store(dst + i, L::sub(L::load(dst + i), L::load(src + i)));
+		for (; i < n; i++)
+			dst[i] -= src[i];
+	}
+
+	template<typename L>
+	static void scl(typename L::T* dst, typename L::T scalar, size_t n) {
+		const auto s = L::set1(scalar);
+
+		size_t i = 0;
+		for (; i + L::W <= n; i += L::W)
+			L::store(dst + i, L::mul(L::load(dst + i), s));
+		for (; i < n; i++)
+			dst[i] *= scalar;
+	}
+
+	template<typename L>
+	static void div(typename L::T* dst, typename L::T scalar, size_t n) {
+		const auto s = L::set1(scalar);
+
+		size_t i = 0;
+		for (; i + L::W <= n; i += L::W)
+			L::store(dst + i, L::div(L::load(dst + i), s));
+		for (; i < n; i++)
+			dst[i] /= scalar;
+	}
+
+	template<typename L>
+	static typename L::T reduce_add(typename L::V v) {
+		alignas(64) typename L::T lanes[L::W];
+		L::store(lanes, v);
+
+		typename L::T result = lanes[0];
+		for (size_t i = 1; i < L::W; i++)
+			result += lanes[i];
+		return result;
+	}
+
+	template<typename L>
+	static typename L::T dot(const typename L::T* x, const typename L::T* y, size_t n) {
+		auto a0 = L::set1(0), a1 = L::set1(0), a2 = L::set1(0), a3 = L::set1(0);
+
+		size_t i = 0;
+		for (; i + 4 * L::W <= n; i += 4 * L::W) {
+			a0 = L::fma(L::load(x + i),              L::load(y + i),              a0);
+			a1 = L::fma(L::load(x + i + L::W),       L::load(y + i + L::W),       a1);
+			a2 = L::fma(L::load(x + i + 2 * L::W),   L::load(y + i + 2 * L::W),   a2);
+			a3 = L::fma(L::load(x + i + 3 * L::W),   L::load(y + i + 3 * L::W),   a3);
+		}
+		for (; i + L::W <= n; i += L::W)
+			a0 = L::fma(L::load(x + i), L::load(y + i), a0);
+
+		typename L::T result = reduce_add<L>(L::add(L::add(a0, a1), L::add(a2, a3)));
+		for (; i < n; i++)
+			result += x[i] * y[i];
+		return result;
+	}
+
+	template<typename L>
+	static typename L::T sum_abs(const typename L::T* x, size_t n) {
+		auto a0 = L::set1(0), a1 = L::set1(0), a2 = L::set1(0), a3 = L::set1(0);
+
+		size_t i = 0;
+		for (; i + 4 * L::W <= n; i += 4 * L::W) {
+			a0 = L::add(L::abs(L::load(x + i)),            a0);
+			a1 = L::add(L::abs(L::load(x + i + L::W)),     a1);
+			a2 = L::add(L::abs(L::load(x + i + 2 * L::W)), a2);
+			a3 = L::add(L::abs(L::load(x + i + 3 * L::W)), a3);
+		}
+		for (; i + L::W <= n; i += L::W)
+			a0 = L::add(L::abs(L::load(x + i)), a0);
+
+		typename L::T result = reduce_add<L>(L::add(L::add(a0, a1), L::add(a2, a3)));
+		for (; i < n; i++)
+			result += (x[i] < 0) ? -x[i] : x[i];
+		return result;
+	}
+
+	template<typename L>
+	static typename L::T max_abs(const typename L::T* x, size_t n) {
+		auto m = L::set1(0);
+
+		size_t i = 0;
+		for (; i + L::W <= n; i += L::W)
+			m = L::max(L::abs(L::load(x + i)), m);
+
+		alignas(64) typename L::T lanes[L::W];
+		L::store(lanes, m);
+
+		typename L::T result = 0;
+		for (size_t j = 0; j < L::W; j++)
+			result = std::max(result, lanes[j]);
+		for (; i < n; i++)
+			result = std::max(result, (x[i] < 0) ? -x[i] : x[i]);
+		return result;
+	}
+
+	/**
+	 * @brief Imaginary part of sum(x[k] * conj(y[k])) over interleaved complex buffers of n reals.
+	 * @details Multiplying x by y with swapped (re, im) pairs gives (xr*yi, xi*yr) in each pair,
+	 *          the imaginary part is then the sum of the odd lanes minus the sum of the even lanes.
+	 */
+	template<typename L>
+	static typename L::T dot_conj_imag(const typename L::T* x, const typename L::T* y, size_t n) {
+		using T = typename L::T;
+		T result = 0;
+		size_t i = 0;
+
+		if constexpr (L::W >= 2) {
+			alignas(64) T signs[L::W];
+			for (size_t j = 0; j < L::W; j++)
+				signs[j] = (j % 2) ? T(1) : T(-1);
+
+			const auto s = L::load(signs);
+			auto a0 = L::set1(0), a1 = L::set1(0);
+
+			for (; i + 2 * L::W <= n; i += 2 * L::W) {
+				a0 = L::fma(L::load(x + i),        L::swap_pairs(L::load(y + i)),        a0);
+				a1 = L::fma(L::load(x + i + L::W), L::swap_pairs(L::load(y + i + L::W)), a1);
+			}
+			for (; i + L::W <= n; i += L::W)
+				a0 = L::fma(L::load(x + i), L::swap_pairs(L::load(y + i)), a0);
+
+			result = reduce_add<L>(L::mul(L::add(a0, a1), s));
+		}
+
+		for (; i + 1 < n; i += 2)
+			result += x[i + 1] * y[i] - x[i] * y[i + 1];
+		return result;
+	}
+
+	/**
+	 * @brief Accumulates dst[j] += sum(scalars[i] * src[i][offset + j]) over the k sources.
+	 * @details The sources are taken four at a time, so dst is loaded and stored once per four FMAs.
+	 *          The caller keeps n small enough (see linear_combination()) for dst to stay in L1 across the k sources.
+	 */
+	template<typename L>
+	static void combine(typename L::T* dst, const typename L::T* const* src, const typename L::T* scalars, size_t k, size_t offset, size_t n) {
+		using T = typename L::T;
+
+		size_t i = 0;
+		for (; i + 4 <= k; i += 4) {
+			const T* x0 = src[i] + offset;
+			const T* x1 = src[i + 1] + offset;
+			const T* x2 = src[i + 2] + offset;
+			const T* x3 = src[i + 3] + offset;
+			const auto s0 = L::set1(scalars[i]), s1 = L::set1(scalars[i + 1]), s2 = L::set1(scalars[i + 2]), s3 = L::set1(scalars[i + 3]);
+
+			size_t j = 0;
+			for (; j + L::W <= n; j += L::W) {
+				auto acc = L::load(dst + j);
+				acc = L::fma(s0, L::load(x0 + j), acc);
+				acc = L::fma(s1, L::load(x1 + j), acc);
+				acc = L::fma(s2, L::load(x2 + j), acc);
+				acc = L::fma(s3, L::load(x3 + j), acc);
+				L::store(dst + j, acc);
+			}
+			for (; j < n; j++)
+				dst[j] += scalars[i] * x0[j] + scalars[i + 1] * x1[j] + scalars[i + 2] * x2[j] + scalars[i + 3] * x3[j];
+		}
+		for (; i < k; i++) {
+			const T* x = src[i] + offset;
+			const auto s = L::set1(scalars[i]);
+
+			size_t j = 0;
+			for (; j + L::W <= n; j += L::W)
+				L::store(dst + j, L::fma(s, L::load(x + j), L::load(dst + j)));
+			for (; j < n; j++)
+				dst[j] += scalars[i] * x[j];
+		}
+	}
+
+	/**
+	 * @brief Transposes the column-major rows x cols block src into the cols x rows block dst.
+	 * @details Whole L::TILE x L::TILE tiles are transposed in registers, the ragged edges element by element.
+	 *          The caller keeps the block small enough (see Matrix<T>::transpose()) for both sides to stay in cache.
+	 */
+	template<typename L>
+	static void transpose(const typename L::T* src, size_t lds, typename L::T* dst, size_t ldd, size_t rows, size_t cols) {
+		constexpr size_t B = L::TILE;
+
+		size_t c = 0;
+		for (; c + B <= cols; c += B) {
+			size_t r = 0;
+			for (; r + B <= rows; r += B)
+				L::transpose_tile(src + c * lds + r, lds, dst + r * ldd + c, ldd);
+			for (; r < rows; r++)
+				for (size_t k = c; k < c + B; k++)
+					dst[r * ldd + k] = src[k * lds + r];
+		}
+		const size_t         tail = cols - c; // Ragged columns, counted from 0 : GCC misreads the bounds of a loop resuming at c
+		const typename L::T* s    = src + c * lds;
+		typename L::T*       d    = dst + c;
+		for (size_t j = 0; j < tail; j++)
+			for (size_t r = 0; r < rows; r++)
+				d[r * ldd + j] = s[j * lds + r];
+	}
+
+	template<typename T>
+	static SimdKernels<T> table() {
+		using L = std::conditional_t<std::is_same_v<T, float>, F32, F64>;
+		return { &add<L>, &sub<L>, &scl<L>, &div<L>, &dot<L>, &sum_abs<L>, &max_abs<L>, &dot_conj_imag<L>, &combine<L>, &transpose<L>, name };
+	}
+};
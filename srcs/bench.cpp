@@ -0,0 +1,347 @@
+#define DOCTEST_CONFIG_DISABLE // No test runner here, this file provides its own main
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "functions.hpp"
+#include "IO.hpp"
+#include "Sparse.hpp"
+#include "Structured.hpp"
+#include "Precision.hpp"
+#include "Update.hpp"
+
+using namespace std;
+
+// Benchmark harness, in the spirit of Google Benchmark : every case is run in batches of doubling size
+// until it has run for at least --min-time seconds, then reports the time per call, GFLOP/s and bytes/op.
+//
+// Flops follow the usual conventions : a real add or mul is 1 flop, a real fma 2, a complex add 2 and a complex fma 8.
+// Bytes/op is the minimal memory traffic of one call (operands read once, result written once).
+//
+// Usage : ./Matrix_bench [--filter=<substring>] [--min-size=N] [--max-size=N] [--min-time=seconds] [--max-gflop=G]
+
+struct Options {
+	string filter;
+	size_t min_size = 4;
+	size_t max_size = 4096;
+	double min_time = 0.1;
+	double max_gflop = 150;  // Cases needing more work per call are skipped : 4096^3 cubic ops on real types fit
+};
+
+struct Case {
+	string                name;
+	size_t                size;
+	double                flops;  // Per call
+	double                bytes;  // Per call
+	function<void()>      run;
+	function<void(Case&)> setup = nullptr; // Counts that depend on the inputs, filled in for the selected cases only
+};
+
+static Options options;
+
+// Input of the cases, built on first use : the setup of the cases that --filter drops is never run
+template<typename X>
+class Lazy {
+	struct State {
+		function<X()> make;
+		optional<X>   value;
+	};
+	shared_ptr<State> state;
+
+	public:
+		explicit Lazy(function<X()> make) : state(make_shared<State>(State{ std::move(make), nullopt })) {}
+
+		X& operator*() const {
+			if (!state->value)
+				state->value.emplace(state->make());
+			return *state->value;
+		}
+		X* operator->() const { return &**this; }
+};
+
+template<typename F>
+auto lazy(F make) { return Lazy<invoke_result_t<F>>(std::move(make)); }
+
+template<typename X>
+inline void keep(const X& x) { asm volatile("" : : "g"(&x) : "memory"); } // Keeps the optimizer from dropping results
+
+template<typename T> const char* type_name();
+template<> const char* type_name<f32>()    { return "f32"; }
+template<> const char* type_name<double>() { return "double"; }
+template<> const char* type_name<c32>()    { return "c32"; }
+
+// Flop weights of one add and one fma on T
+template<typename T> constexpr double ADD = IS_COMPLEX(T) ? 2 : 1;
+template<typename T> constexpr double FMA = IS_COMPLEX(T) ? 8 : 2;
+
+template<typename T>
+T random_value(uint64_t& state) {
+	auto next = [&] {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL; // PCG multiplier, deterministic across runs
+		return double(state >> 11) / double(1ULL << 53) * 2.0 - 1.0;
+	};
+
+	if constexpr (IS_COMPLEX(T))
+		return T(TO_REAL<T>(next()), TO_REAL<T>(next()));
+	else
+		return T(next());
+}
+
+template<typename T>
+Vector<T> random_vector(size_t n, uint64_t seed) {
+	Vector<T> v(n);
+	for (size_t i = 0; i < n; i++)
+		v[i] = random_value<T>(seed);
+	return v;
+}
+
+template<typename T>
+Matrix<T> random_matrix(size_t n, uint64_t seed) {
+	Matrix<T> m(n, n);
+	for (size_t c = 0; c < n; c++)
+		for (size_t r = 0; r < n; r++)
+			m[c][r] = random_value<T>(seed) + (r == c ? T(TO_REAL<T>(n)) : T(0)); // Diagonally dominant, well conditioned
+	return m;
+}
+
+#pragma region Cases
+
+template<typename T>
+void vector_cases(vector<Case>& cases, size_t n) {
+	const double s = sizeof(T);
+	const string t = type_name<T>();
+
+	auto x = lazy([=] { return random_vector<T>(n, 1); });
+	auto y = lazy([=] { return random_vector<T>(n, 2); });
+	auto z = lazy([=] { return random_vector<T>(n, 3); });
+	auto w = lazy([=] { return random_vector<T>(n, 4); });
+
+	cases.push_back({ "Vector<" + t + ">::add", n, ADD<T> * n, 3 * s * n, [=] { x->add(*y); keep(*x); } });
+	cases.push_back({ "Vector<" + t + ">::scl", n, ADD<T> * n, 2 * s * n, [=] { x->scl(T(1)); keep(*x); } });
+	cases.push_back({ "Vector<" + t + ">::dot", n, FMA<T> * n, 2 * s * n, [=] { keep(x->dot(*y)); } });
+	cases.push_back({ "Vector<" + t + ">::norm_1", n, ADD<T> * n, s * n, [=] { keep(x->norm_1()); } });
+	cases.push_back({ "Vector<" + t + ">::norm", n, FMA<T> * n, s * n, [=] { keep(x->norm()); } });
+	cases.push_back({ "Vector<" + t + ">::norm_inf", n, ADD<T> * n, s * n, [=] { keep(x->norm_inf()); } });
+	cases.push_back({ "linear_combination<" + t + ">", n, 4 * FMA<T> * n, 5 * s * n, [=] {
+		keep(linear_combination<T>({ *x, *y, *z, *w }, { T(1), T(2), T(3), T(4) }));
+	} });
+	cases.push_back({ "lerp<" + t + ">", n, (ADD<T> + FMA<T>) * n, 3 * s * n, [=] { keep(lerp(*x, *y, 0.25f)); } });
+	{ // k vectors from a run-time sized range, k shrinking with n to bound the memory at 64 MB
+		const size_t k = std::max<size_t>(4, std::min<size_t>(256, (size_t(64) << 20) / (s * n)));
+		auto many = lazy([=] { return std::vector<Vector<T>>(k, *x); });
+		auto coef = lazy([=] { return std::vector<T>(k, T(0.5)); });
+
+		cases.push_back({ "linear_combination<" + t + ">/k=" + std::to_string(k), n, k * FMA<T> * n, (k + 1) * s * n, [=] {
+			keep(linear_combination(many->begin(), many->end(), coef->begin()));
+		} });
+	}
+
+	auto m4  = lazy([=] { return random_matrix<T>(4, 10); });
+	auto soa = lazy([=] { return Matrix<T>(4, n); }); // n vectors of 4 components, as a structure of arrays
+	auto res = lazy([=] { return Matrix<T>(4, n); });
+	cases.push_back({ "transform<" + t + ", 4x4>", n, 16 * FMA<T> * n, 8 * s * n, [=] { transform(*m4, *soa, SoAView<T>(*res)); keep(*res); } });
+
+	// n keyframe pairs of 4 components, against n calls of lerp<T> on 4-vectors
+	auto factors = lazy([=] { return std::vector<TO_REAL<T>>(n, TO_REAL<T>(0.25)); });
+	cases.push_back({ "lerp<" + t + ">/batch of 4", n, 4 * (ADD<T> + FMA<T>) * n, 12 * s * n, [=] { lerp<T>(*soa, *res, factors->data(), SoAView<T>(*res)); keep(*res); } });
+	if constexpr (!IS_COMPLEX(T))
+		cases.push_back({ "slerp<" + t + ">/batch of 4", n, 12 * FMA<T> * n, 12 * s * n, [=] { slerp<T>(*soa, *res, factors->data(), SoAView<T>(*res)); keep(*res); } });
+}
+
+template<typename T>
+void matrix_cases(vector<Case>& cases, size_t n) {
+	const double s = sizeof(T);
+	const double n2 = double(n) * n, n3 = n2 * n;
+	const string t = type_name<T>();
+
+	auto a = lazy([=] { return random_matrix<T>(n, 5); });
+	auto b = lazy([=] { return random_matrix<T>(n, 6); });
+	auto v = lazy([=] { return random_vector<T>(n, 7); });
+
+	cases.push_back({ "Matrix<" + t + ">::mul_vec", n, FMA<T> * n2, s * (n2 + 2 * n), [=] { keep(a->mul_vec(*v)); } });
+	cases.push_back({ "Matrix<" + t + ">::mul_mat", n, FMA<T> * n3, 3 * s * n2, [=] { keep(a->mul_mat(*b)); } });
+	cases.push_back({ "Matrix<" + t + ">::transpose", n, 0, 2 * s * n2, [=] { keep(a->transpose()); } });
+	cases.push_back({ "Matrix<" + t + ">::transpose_into", n, 0, 2 * s * n2, [=, out = make_shared<Matrix<T>>()] { a->transpose(*out); keep(*out); } });
+	cases.push_back({ "Matrix<" + t + ">::transpose_inplace", n, 0, 2 * s * n2, [=] { b->transpose_inplace(); keep(*b); } });
+	cases.push_back({ "Matrix<" + t + ">::row_echelon", n, FMA<T> * n3, 2 * s * n2, [=] { keep(a->row_echelon()); } });
+	cases.push_back({ "Matrix<" + t + ">::determinant", n, FMA<T> * n3 / 3, s * n2, [=] { keep(a->determinant()); } });
+	cases.push_back({ "Matrix<" + t + ">::inverse", n, FMA<T> * n3 * 4 / 3, 2 * s * n2, [=] { keep(a->inverse()); } });
+	cases.push_back({ "Matrix<" + t + ">::rank", n, FMA<T> * n3, s * n2, [=] { keep(a->rank()); } });
+
+	{ // 1% of the elements stored, the dense SpMV is the Matrix::mul_vec case above
+		auto sp = lazy([=] {
+			Matrix<T> d(n, n);
+			for (size_t k = 0; k < n * n; k += 97)
+				d[k / n][k % n] = (*a)[k / n][k % n];
+			return SparseMatrix<T>(d);
+		});
+
+		cases.push_back({ "SparseMatrix<" + t + ">::mul_vec", n, 0, 0, [=] { keep(sp->mul_vec(*v)); }, [=](Case& c) {
+			const double nnz = double(sp->nnz());
+			c.flops = FMA<T> * nnz;
+			c.bytes = (s + sizeof(size_t)) * nnz + 2 * s * n;
+		} });
+	}
+
+	{ // Structured storage of a, against the dense cases above
+		auto tri  = lazy([=] { return TriangularMatrix<T>(*a, Triangle::Lower); });
+		auto band = lazy([=] { return BandedMatrix<T>(*a, 1, 1); });
+
+		cases.push_back({ "TriangularMatrix<" + t + ">::mul_mat", n, FMA<T> * n3 / 2, s * (n2 / 2 + 2 * n2), [=] { keep(tri->mul_mat(*b)); } });
+		cases.push_back({ "BandedMatrix<" + t + ">::solve", n, FMA<T> * 5 * n, s * (3 * n + 2 * n), [=] { keep(band->solve(*v)); } });
+	}
+
+	if constexpr (std::is_same_v<T, f32>) { // Narrow storage of a, against the f32 cases above
+		auto ha = lazy([=] { return Matrix<f16>(convert<f16>(*a)); });
+		auto hb = lazy([=] { return Matrix<f16>(convert<f16>(*b)); });
+		auto hv = lazy([=] { return Vector<f16>(convert<f16>(*v)); });
+		auto qa = lazy([=] { return Int8Matrix(*a); });
+
+		cases.push_back({ "Matrix<f16>::mul_vec", n, FMA<T> * n2, 2 * (n2 + 2 * n), [=] { keep(ha->mul_vec(*hv)); } });
+		cases.push_back({ "Matrix<f16>::mul_mat", n, FMA<T> * n3, 3 * 2 * n2, [=] { keep(ha->mul_mat(*hb)); } });
+		cases.push_back({ "Int8Matrix::mul_vec", n, FMA<T> * n2, n2 + 2 * s * n, [=] { keep(qa->mul_vec(*v)); } });
+	}
+
+	if constexpr (std::is_same_v<T, double>) // f32 LU + a few O(n^2) double steps, against Matrix<double>::inverse above
+		cases.push_back({ "solve_refined<f32, double>", n, FMA<T> * n3 * 2 / 3, s * n2, [=] { keep(solve_refined(*a, *v)); } });
+
+	if constexpr (std::is_same_v<T, double>) { // O(n^2) per rank-1 update, against Matrix<double>::inverse above
+		auto tracker = lazy([=] { return InverseTracker<T>(*a, std::numeric_limits<size_t>::max()); });
+		auto sign    = make_shared<T>(T(1));
+
+		cases.push_back({ "InverseTracker<" + t + ">::update", n, FMA<T> * 3 * n2, 4 * s * n2, [=] { // Alternating +u v^T and -u v^T
+			*sign = -*sign;
+			Vector<T> u = *v;
+			u.scl(*sign * T(1e-3));
+			tracker->update(u, *v);
+			keep(tracker->inverse());
+		} });
+	}
+
+	if constexpr (!IS_COMPLEX(T)) {
+		if (n <= 1024) { // Bytes/op is the size of the text
+			auto text = lazy([=] {
+				std::ostringstream os;
+				write_text(os, *a);
+				return os.str();
+			});
+			auto size = [=](Case& c) { c.bytes = double(text->size()); };
+
+			cases.push_back({ "write_text<" + t + ">", n, 0, 0, [=] { std::ostringstream out; write_text(out, *a); keep(out); }, size });
+			cases.push_back({ "parse_text<" + t + ">", n, 0, 0, [=] { keep(parse_text<T>(*text)); }, size });
+		}
+	}
+}
+
+template<typename T>
+void fixed_cases(vector<Case>& cases) {
+	const double s = sizeof(T);
+	const string t = type_name<T>();
+
+	auto u = lazy([=] { return random_vector<T>(3, 8); });
+	auto v = lazy([=] { return random_vector<T>(3, 9); });
+
+	cases.push_back({ "cross_product<" + t + ">", 3, 3 * (FMA<T> + ADD<T>), 9 * s, [=] { keep(cross_product(*u, *v)); } });
+	if constexpr (std::is_same_v<T, f32>)
+		cases.push_back({ "projection<Matrix<f32>>", 4, 8, 16 * s, [] { keep(projection(90.0f, 16.0f / 9.0f, 0.1f, 100.0f)); } });
+}
+
+#pragma endregion
+
+/**
+ * @brief Runs a case in doubling batches until it has run for at least options.min_time.
+ * @return pair<double, size_t> The seconds per call and the number of calls.
+ */
+pair<double, size_t> measure(const Case& c) {
+	using clock = chrono::steady_clock;
+
+	c.run(); // Warm up : caches, thread pool, SIMD dispatch
+
+	for (size_t iterations = 1;; iterations *= 2) {
+		const auto start = clock::now();
+		for (size_t i = 0; i < iterations; i++)
+			c.run();
+		const double elapsed = chrono::duration<double>(clock::now() - start).count();
+
+		if (elapsed >= options.min_time || iterations >= (size_t(1) << 30))
+			return { elapsed / double(iterations), iterations };
+	}
+}
+
+void report(const Case& c) {
+	const string label = c.name + "/" + to_string(c.size);
+
+	if (c.flops > options.max_gflop * 1e9) {
+		cout << left << setw(40) << label << right << setw(14) << "skipped" << "  (over --max-gflop)" << endl;
+		return;
+	}
+
+	const auto [seconds, iterations] = measure(c);
+
+	cout << left << setw(40) << label << right << fixed
+	     << setw(14) << setprecision(1) << seconds * 1e9
+	     << setw(12) << iterations
+	     << setw(10) << setprecision(2);
+	if (c.flops > 0)
+		cout << c.flops / seconds * 1e-9;
+	else
+		cout << "-";
+	cout << setw(14) << setprecision(0) << c.bytes
+	     << setw(10) << setprecision(2) << c.bytes / seconds * 1e-9 << endl;
+}
+
+template<typename T>
+void run_type() {
+	vector<Case> cases;
+
+	for (size_t n = options.min_size; n <= options.max_size; n *= 4) {
+		vector_cases<T>(cases, n);
+		matrix_cases<T>(cases, n);
+	}
+	fixed_cases<T>(cases);
+
+	for (Case& c : cases)
+		if (c.name.find(options.filter) != string::npos) {
+			if (c.setup)
+				c.setup(c);
+			report(c);
+		}
+}
+
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; i++) {
+		const string arg = argv[i];
+		auto value = [&](const char* key) { return arg.rfind(key, 0) == 0 ? arg.substr(strlen(key)) : string(); };
+
+		if (arg.rfind("--filter=", 0) == 0)         options.filter = value("--filter=");
+		else if (arg.rfind("--min-size=", 0) == 0)  options.min_size = stoul(value("--min-size="));
+		else if (arg.rfind("--max-size=", 0) == 0)  options.max_size = stoul(value("--max-size="));
+		else if (arg.rfind("--min-time=", 0) == 0)  options.min_time = stod(value("--min-time="));
+		else if (arg.rfind("--max-gflop=", 0) == 0) options.max_gflop = stod(value("--max-gflop="));
+		else {
+			cerr << RED << "Unknown option : " << arg << RESET << endl;
+			cerr << "Usage : " << argv[0] << " [--filter=<substring>] [--min-size=N] [--max-size=N] [--min-time=seconds] [--max-gflop=G]" << endl;
+			return 1;
+		}
+	}
+	if (!options.min_size)
+		options.min_size = 1;
+
+	cout << "Threads : " << ThreadPool::global().size() << ", SIMD : " << simd<f32>().isa << endl;
+	cout << left << setw(40) << "Benchmark" << right
+	     << setw(14) << "Time (ns)" << setw(12) << "Iterations" << setw(10) << "GFLOP/s"
+	     << setw(14) << "Bytes/op" << setw(10) << "GB/s" << endl;
+	cout << string(100, '-') << endl;
+
+	run_type<f32>();
+	run_type<double>();
+	run_type<c32>();
+
+	return 0;
+}
@@ -1,6 +1,17 @@
 #include "Matrix.hpp"
 #include "Vector.hpp"
 #include "functions.hpp"
+#include "IO.hpp"
+#include "Sparse.hpp"
+#include "Structured.hpp"
+#include "Device.hpp"
+#include "Precision.hpp"
+#include "Update.hpp"
+#include "Cached.hpp"
+#include "Async.hpp"
+#include "Distributed.hpp"
+#include "Tuning.hpp"
+#include <iomanip>
 
 using namespace std;
 
@@ -433,4 +444,1973 @@ TEST_CASE("Bonus Ex14 projection") {
 			file << mat[c][r] << (c + 1 == mat.cols() ? "\n" : ", ");
 		}
 	}
-}
\ No newline at end of file
+}
+TEST_CASE("Contiguous storage") {
+	Matrix<f32> mat = {{1, 4}, {2, 5}, {3, 6}};
+
+	// Columns are laid out one after the other in a single buffer
+	CHECK(mat.ld() == mat.rows());
+	CHECK(mat[1].data() == mat.ptr() + mat.ld());
+	CHECK(mat.flatten() == Vector<f32>({1, 2, 3, 4, 5, 6}));
+	CHECK(Vector<f32>({1, 2, 3, 4, 5, 6}).reshape(2, 3) == Matrix<f32>({{1, 4}, {2, 5}, {3, 6}}));
+
+	// Column views write through to the matrix
+	VectorView<f32> col = mat[0];
+	col[2] = 42;
+	CHECK(mat[0][2] == 42);
+	CHECK(Vector<f32>(mat[1]) == Vector<f32>({4, 5, 6}));
+
+	// Non-square products (3x2 * 2x4 = 3x4)
+	Matrix<f32> wide = {{1, 0, 2, 0}, {0, 1, 0, 2}};
+	CHECK(mat.mul_mat(wide).shape() == std::pair<size_t, size_t>(3, 4));
+	CHECK(Matrix<f32>({{1, 4}, {2, 5}, {3, 6}}).mul_mat(wide) == Matrix<f32>({{1, 4, 2, 8}, {2, 5, 4, 10}, {3, 6, 6, 12}}));
+}
+
+TEST_CASE("Blocked GEMM") {
+	const Tuning saved = tuning;
+
+	// Odd sizes and tiny blocks, so every edge case of the packing and of the micro-kernel is reached
+	tuning.gemm_mc = 32;
+	tuning.gemm_kc = 16;
+	tuning.gemm_nc = 12;
+
+	auto check = [](auto zero) {
+		using T = decltype(zero);
+		Matrix<T> a(53, 70), b(65, 53);
+
+		for (size_t c = 0; c < a.cols(); c++)
+			for (size_t r = 0; r < a.rows(); r++)
+				a[c][r] = T(f32((c * 7 + r * 3) % 11) - 5.0f);
+		for (size_t c = 0; c < b.cols(); c++)
+			for (size_t r = 0; r < b.rows(); r++)
+				b[c][r] = T(f32((c * 5 + r) % 13) / 4.0f);
+
+		tuning.gemm_threshold = size_t(-1);
+		Matrix<T> naive = a.mul_mat(b);
+		tuning.gemm_threshold = 1;
+		Matrix<T> blocked = a.mul_mat(b);
+
+		CHECK(blocked.shape() == naive.shape());
+		CHECK(blocked == naive);
+	};
+
+	check(f32());
+	check(double());
+	check(c32());
+
+	tuning = saved;
+}
+
+TEST_CASE("Fixed-size matrices") {
+	constexpr Matrix<f32, 4, 4> identity(1.0f);
+	static_assert(identity.trace() == 4.0f);   // Built and evaluated at compile time
+	static_assert(sizeof(Matrix<f32, 4, 4>) == 16 * sizeof(f32)); // No heap storage
+
+	Matrix<f32, 3, 3> mat = {{8, 5, -2}, {4, 7, 20}, {7, 6, 1}};
+	Matrix<f32> dyn = {{8, 5, -2}, {4, 7, 20}, {7, 6, 1}};
+	Vector<f32, 3> vec = {7, 8, 9};
+
+	// Same results as the dynamic types
+	CHECK(Matrix<f32>(mat) == dyn);
+	CHECK(Vector<f32>(mat.mul_vec(vec)) == dyn.mul_vec(Vector<f32>({7, 8, 9})));
+	CHECK(Matrix<f32>(mat.mul_mat(mat)) == dyn.mul_mat(dyn));
+	CHECK(Matrix<f32>(mat.transpose()) == dyn.transpose());
+	CHECK(doctest::Approx(mat.determinant()) == -174.0f);
+	CHECK(Matrix<f32>(mat.inverse()) == dyn.inverse());
+	CHECK(Matrix<f32, 3, 3>(dyn) == mat);
+	CHECK_THROWS(Matrix<f32, 2, 2>(dyn)); // Mismatched shapes
+
+	// Rectangular
+	Matrix<f32, 3, 2> rect = {{1, 4}, {2, 5}, {3, 6}};
+	CHECK(rect.transpose() == Matrix<f32, 2, 3>({{1, 2, 3}, {4, 5, 6}}));
+	CHECK(rect.mul_vec({7, 8, 9}) == Vector<f32, 2>({50, 122}));
+
+	// 4x4 closed forms against the dynamic Gauss-Jordan
+	Matrix<f32, 4, 4> mat4 = {{8, 5, -2, 4}, {4, 2.5, 20, 4}, {8, 5, 1, 4}, {28, -4, 17, 1}};
+	CHECK(doctest::Approx(mat4.determinant()) == 1032.0f);
+	CHECK(Matrix<f32>(mat4.inverse()) == Matrix<f32>(mat4).inverse());
+	CHECK(mat4.inverse().mul_mat(mat4) == identity);
+	CHECK_THROWS(Matrix<f32, 2, 2>({{1, 2}, {2, 4}}).inverse()); // Singular
+
+	// Generic elimination above 4x4
+	Matrix<double, 5, 5> big(2.0);
+	big[4][0] = 1.0;
+	CHECK(big.determinant() == 32.0);
+	CHECK(big.inverse().mul_mat(big) == Matrix<double, 5, 5>(1.0));
+
+	// Complex
+	Matrix<c32, 2, 2> cmat = {{{1,1}, {2,0}}, {{0,1}, {1,2}}};
+	CHECK(cmat.determinant() == c32(-1, 1));
+	CHECK(Matrix<c32>(cmat.inverse()) == Matrix<c32>(cmat).inverse());
+
+	// Graphics path
+	Matrix<f32, 4, 4> proj = projection<Matrix<f32, 4, 4>>(90.0f, 1.0f, 0.1f, 100.0f);
+	CHECK(Matrix<f32>(proj) == projection(90.0f, 1.0f, 0.1f, 100.0f));
+}
+
+TEST_CASE("SIMD kernels") {
+	// Every instruction set available on the host must agree with the scalar kernels
+	auto check = [](const auto& kernels, auto zero) {
+		using T = decltype(zero);
+		const SimdKernels<T> ref = SimdScalar::table<T>();
+		const size_t n = 1037; // Not a multiple of any register width
+
+		std::vector<T> x(n), y(n);
+		for (size_t i = 0; i < n; i++) {
+			x[i] = T((i * 7) % 23) - T(11);
+			y[i] = T((i * 3) % 17) / T(4);
+		}
+
+		CHECK(kernels.dot(x.data(), y.data(), n) == doctest::Approx(ref.dot(x.data(), y.data(), n)));
+		CHECK(kernels.sum_abs(x.data(), n) == doctest::Approx(ref.sum_abs(x.data(), n)));
+		CHECK(kernels.max_abs(x.data(), n) == ref.max_abs(x.data(), n));
+		CHECK(kernels.dot_conj_imag(x.data(), y.data(), n - 1) == doctest::Approx(ref.dot_conj_imag(x.data(), y.data(), n - 1)));
+
+		std::vector<T> a = x, b = x;
+		kernels.add(a.data(), y.data(), n); ref.add(b.data(), y.data(), n);
+		CHECK(a == b);
+		kernels.sub(a.data(), y.data(), n); ref.sub(b.data(), y.data(), n);
+		CHECK(a == b);
+		kernels.scl(a.data(), T(3), n); ref.scl(b.data(), T(3), n);
+		CHECK(a == b);
+		kernels.div(a.data(), T(7), n); ref.div(b.data(), T(7), n);
+		CHECK(a == b);
+
+		// 37 x 28 block of columns 40 apart, so both edges are ragged for every tile size
+		std::vector<T> ta(37 * 40, T(-1)), tb(37 * 40, T(-1));
+		kernels.transpose(x.data(), 37, ta.data(), 40, 37, 28); ref.transpose(x.data(), 37, tb.data(), 40, 37, 28);
+		CHECK(ta == tb);
+		CHECK(ta[5 * 40 + 3] == x[3 * 37 + 5]);
+		CHECK(ta[28] == T(-1));
+
+		// 6 sources, so both the groups of four and the single-source tail run
+		std::vector<const T*> src = { x.data(), y.data(), x.data() + 1, y.data() + 2, x.data() + 3, y.data() + 5 };
+		std::vector<T>        coefs = { T(1), T(-2), T(0.5), T(3), T(-1), T(0.25) };
+		std::vector<T>        ca(n - 8, T(1)), cb(n - 8, T(1));
+		kernels.combine(ca.data(), src.data(), coefs.data(), 6, 2, n - 8); ref.combine(cb.data(), src.data(), coefs.data(), 6, 2, n - 8);
+		T worst = 0;
+		for (size_t i = 0; i < n - 8; i++)
+			worst = std::max(worst, std::abs(ca[i] - cb[i]));
+		CHECK(worst < T(1e-4));
+	};
+
+	check(simd<f32>(), f32());
+	check(simd<double>(), double());
+# ifdef MATRIX_SIMD_X86
+	check(SimdSSE2::table<f32>(), f32());
+	check(SimdSSE2::table<double>(), double());
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		check(SimdAVX2::table<f32>(), f32());
+		check(SimdAVX2::table<double>(), double());
+	}
+# endif
+
+	// Complex vectors go through the same kernels
+	Vector<c32> cvec1(100), cvec2(100);
+	c32 dot = 0;
+	for (size_t i = 0; i < 100; i++) {
+		cvec1[i] = c32(f32(i % 5), f32(i % 3) - 1);
+		cvec2[i] = c32(f32(i % 7) - 3, f32(i % 4));
+		dot += cvec1[i] * std::conj(cvec2[i]);
+	}
+	CHECK(cvec1.dot(cvec2) == dot);
+	CHECK(cvec1.norm() == doctest::Approx(std::sqrt(std::real(cvec1.dot(cvec1)))));
+}
+
+TEST_CASE("Expression templates") {
+	Vector<f32> x = {1, 2, 3};
+	Vector<f32> y = {4, 5, 6};
+	Vector<f32> z = {1, 1, 1};
+
+	// Nothing is evaluated before the assignment
+	auto expr = 2.0f * x + y * 0.5f - z;
+	CHECK(expr.size() == 3);
+	CHECK(Vector<f32>(expr) == Vector<f32>({3, 5.5f, 8}));
+
+	x = x + y; // Aliasing is fine, each element only reads its own index
+	CHECK(x == Vector<f32>({5, 7, 9}));
+	CHECK_THROWS(Vector<f32>(x + Vector<f32>({1, 2}))); // Mismatched sizes
+
+	Matrix<f32> a = {{1, 2}, {3, 4}};
+	Matrix<f32> b = {{1, 0}, {0, 1}};
+	CHECK(Matrix<f32>(2.0f * a - b) == Matrix<f32>({{1, 4}, {6, 7}}));
+	CHECK_THROWS(Matrix<f32>(a + Matrix<f32>({{1, 2, 3}}))); // Mismatched shapes
+
+	// Matrix leaves index through ld() : a 2x3 block of a buffer padded to 4 rows per column
+	const f32 padded[] = {1, 2, -1, -1, 3, 4, -1, -1, 5, 6, -1, -1};
+	ExprLeaf<f32, true> view(padded, 2, 3, 4);
+	Matrix<f32> c = {{1, 1, 1}, {1, 1, 1}};
+	c = 2.0f * view + c;
+	CHECK(c == Matrix<f32>({{3, 7, 11}, {5, 9, 13}}));
+
+	Vector<c32> cx = {{1, 1}, {2, 0}};
+	Vector<c32> cy = {{0, 1}, {1, 1}};
+	CHECK(Vector<c32>(c32(0, 1) * cx + cy) == Vector<c32>({{-1, 2}, {1, 3}}));
+}
+
+TEST_CASE("Parallel execution") {
+	const Tuning saved = tuning;
+	ThreadPool::global().resize(4);
+
+	Matrix<double> a(40, 40), b(40, 40);
+	for (size_t c = 0; c < 40; c++)
+		for (size_t r = 0; r < 40; r++) {
+			a[c][r] = double((c * 7 + r * 13) % 19) - 9.0 + (c == r ? 50.0 : 0.0);
+			b[c][r] = double((c + 2 * r) % 5);
+		}
+	Vector<double> v(40);
+	for (size_t i = 0; i < 40; i++)
+		v[i] = double(i % 3);
+
+	auto run = [&] {
+		Matrix<double> sum = a;
+		sum.add(b);
+		sum.scl(0.5);
+		return std::make_tuple(a.mul_mat(b), a.mul_vec(v), a.transpose(), sum, b.row_echelon(), a.determinant(), a.inverse());
+	};
+
+	tuning.execution = Execution::Serial;
+	auto serial = run();
+	tuning.execution = Execution::Parallel;
+	auto parallel = run();
+
+	// Tiles never share an output element, results are bitwise identical
+	CHECK(std::get<0>(parallel) == std::get<0>(serial));
+	CHECK(std::get<1>(parallel) == std::get<1>(serial));
+	CHECK(std::get<2>(parallel) == std::get<2>(serial));
+	CHECK(std::get<3>(parallel) == std::get<3>(serial));
+	CHECK(std::get<4>(parallel) == std::get<4>(serial));
+	CHECK(std::get<5>(parallel) == std::get<5>(serial));
+	CHECK(std::get<6>(parallel) == std::get<6>(serial));
+
+	// Exceptions thrown in a tile reach the caller
+	CHECK_THROWS(parallel_for(0, 100, 1, [](size_t lo, size_t) {
+		if (lo > 0)
+			throw std::runtime_error("tile failure");
+	}));
+
+	tuning = saved;
+	ThreadPool::global().resize(tuning.threads);
+}
+
+TEST_CASE("LU decomposition") {
+	Matrix<f32> a({{2, 1, 1}, {4, -6, 0}, {-2, 7, 2}});
+	LU<f32> lu(a);
+
+	// P * A == L * U
+	const Matrix<f32>& f = lu.factors();
+	Matrix<f32> l(3, 3), u(3, 3), pa(3, 3);
+	for (size_t r = 0; r < 3; r++)
+		for (size_t c = 0; c < 3; c++) {
+			l[c][r] = (r == c) ? 1.0f : (r > c ? f[c][r] : 0.0f);
+			u[c][r] = (r <= c) ? f[c][r] : 0.0f;
+			pa[c][r] = a[c][lu.permutation()[r]];
+		}
+	CHECK(l.mul_mat(u) == pa);
+
+	CHECK(!lu.is_singular());
+	CHECK(lu.det() == doctest::Approx(a.determinant()));
+	CHECK(lu.det() == doctest::Approx(-16.0f));
+	CHECK(lu.inverse() == a.inverse());
+	CHECK(a.mul_mat(lu.inverse()) == Matrix<f32>({{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}));
+
+	// Solutions follow the mul_vec / mul_mat conventions
+	Vector<f32> b({5, -2, 9});
+	CHECK(a.mul_vec(lu.solve(b)) == b);
+	CHECK(lu.solve(b) == a.inverse().mul_vec(b));
+
+	Matrix<f32> rhs({{5, 1}, {-2, 0}, {9, 3}});
+	CHECK(a.mul_mat(lu.solve(rhs)) == rhs);
+	CHECK_THROWS_AS(lu.solve(Vector<f32>({1, 2})), std::invalid_argument);
+
+	// A zero pivot flags the matrix as singular
+	LU<f32> singular(Matrix<f32>({{1, 2, 3}, {2, 4, 6}, {1, 0, 1}}));
+	CHECK(singular.is_singular());
+	CHECK(singular.det() == 0.0f);
+	CHECK_THROWS_AS(singular.inverse(), std::logic_error);
+	CHECK_THROWS_AS(singular.solve(b), std::logic_error);
+	CHECK_THROWS_AS(LU<f32>(Matrix<f32>({{1, 2, 3}, {4, 5, 6}})), std::invalid_argument);
+
+	Matrix<c32> ca({{{1, 1}, {2, 0}, {0, 1}}, {{0, 2}, {1, 0}, {3, 0}}, {{1, 0}, {0, -1}, {2, 2}}});
+	Vector<c32> cb({{1, 0}, {0, 1}, {2, -1}});
+	Vector<c32> cx = ca.mul_vec(LU<c32>(ca).solve(cb));
+	for (size_t i = 0; i < 3; i++) {
+		CHECK(cx[i].real() == doctest::Approx(cb[i].real()));
+		CHECK(cx[i].imag() == doctest::Approx(cb[i].imag()));
+	}
+	CHECK(ca.determinant().real() == doctest::Approx(LU<c32>(ca).det().real()));
+	CHECK(ca.determinant().imag() == doctest::Approx(LU<c32>(ca).det().imag()).epsilon(1e-5));
+}
+
+TEST_CASE("Linear system solver") {
+	// General matrix : LU
+	Matrix<f32> a({{2, 1, 1}, {4, -6, 0}, {-2, 7, 2}});
+	Vector<f32> b({5, -2, 9});
+	f32 rcond = -1;
+	CHECK(a.mul_vec(a.solve(b, &rcond)) == b);
+	CHECK(a.solve(b) == a.inverse().mul_vec(b));
+	CHECK(rcond > 0.0f);
+	CHECK(rcond <= 1.0f);
+
+	Matrix<f32> rhs({{5, 1}, {-2, 0}, {9, 3}});
+	CHECK(a.mul_mat(a.solve(rhs)) == rhs);
+
+	// Diagonal : exact condition number
+	Matrix<f32> d({{2, 0, 0}, {0, 4, 0}, {0, 0, -8}});
+	CHECK(Solver<f32>::structure(d) == Solver<f32>::Structure::Diagonal);
+	CHECK(d.solve(Vector<f32>({2, 4, 8}), &rcond) == Vector<f32>({1, 1, -1}));
+	CHECK(rcond == 0.25f);
+
+	// Triangular : substitution, in both conventions
+	Matrix<f32> lo({{2, 0, 0}, {1, 1, 0}, {3, -1, 4}});
+	Matrix<f32> up = lo.transpose();
+	CHECK(Solver<f32>::structure(lo) == Solver<f32>::Structure::Lower);
+	CHECK(Solver<f32>::structure(up) == Solver<f32>::Structure::Upper);
+	CHECK(lo.mul_vec(lo.solve(b)) == b);
+	CHECK(up.mul_vec(up.solve(b)) == b);
+	CHECK(lo.mul_mat(lo.solve(rhs, &rcond)) == rhs);
+	CHECK(up.mul_mat(up.solve(rhs)) == rhs);
+	CHECK(rcond > 0.0f);
+
+	// Symmetric positive-definite : Cholesky
+	Matrix<double> spd({{4, 12, -16}, {12, 37, -43}, {-16, -43, 98}});
+	CHECK(Solver<double>::structure(spd) == Solver<double>::Structure::Hermitian);
+	Cholesky<double> chol(spd);
+	CHECK(chol.is_positive_definite());
+	CHECK(chol.factor() == Matrix<double>({{2, 0, 0}, {6, 1, 0}, {-8, 5, 3}}));
+	CHECK(chol.det() == doctest::Approx(spd.determinant()));
+	double drcond = 0;
+	Vector<double> db({1, 2, 3});
+	Vector<double> residual = spd.mul_vec(spd.solve(db, &drcond));
+	residual.sub(db);
+	CHECK(residual.norm() < 1e-12);
+	CHECK(drcond == doctest::Approx(LU<double>(spd).rcond()));
+
+	// Symmetric but indefinite : falls back to LU
+	Matrix<f32> indef({{1, 2}, {2, 1}});
+	CHECK(!Cholesky<f32>(indef).is_positive_definite());
+	CHECK(indef.mul_vec(indef.solve(Vector<f32>({3, 3}))) == Vector<f32>({3, 3}));
+
+	// Hermitian positive-definite complex
+	Matrix<c32> h({{{2, 0}, {0, 1}}, {{0, -1}, {3, 0}}});
+	Vector<c32> hb({{1, 0}, {0, 2}});
+	CHECK(Solver<c32>::structure(h) == Solver<c32>::Structure::Hermitian);
+	Vector<c32> hx = h.mul_vec(h.solve(hb));
+	CHECK(hx[0].real() == doctest::Approx(1.0f));
+	CHECK(hx[1].imag() == doctest::Approx(2.0f));
+
+	// Ill-conditioned matrices are reported
+	Matrix<double> hilbert(6, 6);
+	for (size_t c = 0; c < 6; c++)
+		for (size_t r = 0; r < 6; r++)
+			hilbert[c][r] = 1.0 / double(r + c + 1);
+	hilbert.solve(Vector<double>(6), &drcond);
+	CHECK(drcond < 1e-6);
+	CHECK(drcond > 1e-9); // cond_1 of the 6x6 Hilbert matrix is about 2.9e7
+
+	CHECK_THROWS_AS(a.solve(Vector<f32>({1, 2})), std::invalid_argument);
+	CHECK_THROWS_AS(Matrix<f32>({{1, 2, 3}, {4, 5, 6}}).solve(Vector<f32>({1, 2})), std::invalid_argument);
+	CHECK_THROWS_AS(Matrix<f32>({{1, 2}, {2, 4}}).solve(Vector<f32>({1, 2})), std::logic_error);
+	CHECK_THROWS_AS(Matrix<f32>({{1, 0}, {3, 0}}).solve(Vector<f32>({1, 2})), std::logic_error);
+}
+
+TEST_CASE("Move semantics") {
+	// Moved-from matrices are empty, not stale
+	Matrix<f32> a({{1, 2, 3}, {4, 5, 6}, {7, 8, 10}});
+	Matrix<f32> b(std::move(a));
+	CHECK(a.shape() == std::make_pair<size_t, size_t>(0, 0));
+	CHECK(b.shape() == std::make_pair<size_t, size_t>(3, 3));
+	a = std::move(b);
+	CHECK(b.shape() == std::make_pair<size_t, size_t>(0, 0));
+
+	// Rvalue overloads reuse the storage
+	Matrix<f32> expected = a.transpose();
+	Matrix<f32> tmp = a;
+	const f32* buffer = tmp.ptr();
+	Matrix<f32> t = std::move(tmp).transpose();
+	CHECK(t == expected);
+	CHECK(t.ptr() == buffer);
+
+	Matrix<f32> ref = a.row_echelon();
+	tmp = a;
+	buffer = tmp.ptr();
+	Matrix<f32> moved_ref = std::move(tmp).row_echelon();
+	CHECK(moved_ref == ref);
+	CHECK(moved_ref.ptr() == buffer);
+
+	Vector<f32> v({1, 2, 3, 4, 5, 6});
+	const f32* vbuffer = v.ptr();
+	Matrix<f32> reshaped = std::move(v).reshape(2, 3);
+	CHECK(reshaped.ptr() == vbuffer);
+	CHECK(reshaped == Vector<f32>({1, 2, 3, 4, 5, 6}).reshape(2, 3));
+	CHECK(v.size() == 0);
+
+	// In-place variants
+	Matrix<f32> rect({{1, 2, 3}, {4, 5, 6}});
+	rect.transpose_inplace();
+	CHECK(rect == Matrix<f32>({{1, 4}, {2, 5}, {3, 6}}));
+
+	Matrix<f32> sq = a;
+	sq.transpose_inplace();
+	CHECK(sq == expected);
+
+	Matrix<f32> inv = a;
+	inv.inverse_inplace();
+	CHECK(inv == a.inverse());
+
+	Matrix<f32> singular({{1, 2}, {2, 4}});
+	CHECK_THROWS_AS(singular.inverse_inplace(), std::logic_error);
+	CHECK_THROWS_AS(rect.inverse_inplace(), std::invalid_argument);
+	CHECK(rect.shape() == std::make_pair<size_t, size_t>(3, 2));
+
+	// mul_mat and transpose work on const matrices
+	const Matrix<f32>& ca = a;
+	CHECK(ca.mul_mat(ca.inverse()) == Matrix<f32>({{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}));
+	CHECK(ca.transpose() == expected);
+}
+
+TEST_CASE("Batched transforms") {
+	const size_t n = 1000; // Not a multiple of the block size
+
+	// Vertices as a structure of arrays : x[0..n), y[0..n), z[0..n), w[0..n)
+	std::vector<f32> in(4 * n), out(4 * n);
+	for (size_t i = 0; i < n; i++) {
+		in[i]         = f32(i % 17) - 8;
+		in[n + i]     = f32(i % 5);
+		in[2 * n + i] = f32(i % 11) * 0.5f;
+		in[3 * n + i] = 1;
+	}
+
+	Matrix<f32> m({{1, 2, 0, 3}, {0, 1, 4, -1}, {2, 0, 1, 5}, {0, 0, 0, 1}});
+	transform(m, SoAView<const f32>(in.data(), n, 4), SoAView<f32>(out.data(), n, 4));
+
+	bool same = true;
+	for (size_t i = 0; i < n; i++) {
+		Vector<f32> v = m.mul_vec(Vector<f32>({in[i], in[n + i], in[2 * n + i], in[3 * n + i]}));
+		for (size_t k = 0; k < 4; k++)
+			same = same && out[k * n + i] == v[k];
+	}
+	CHECK(same);
+
+	// Fixed-size matrix, and a wider input stride
+	std::vector<f32> strided(4 * (n + 24));
+	for (size_t k = 0; k < 4; k++)
+		std::copy(in.begin() + k * n, in.begin() + (k + 1) * n, strided.begin() + k * (n + 24));
+	std::vector<f32> out2(4 * n);
+	transform(Matrix<f32, 4, 4>(m), SoAView<const f32>(strided.data(), n, 4, n + 24), SoAView<f32>(out2.data(), n, 4));
+	CHECK(out2 == out);
+
+	// Non-square matrix, from and to Matrix storage : 3 components in, 2 out
+	Matrix<double> p({{1, 2}, {3, 4}, {5, 6}});
+	Matrix<double> batch_in({{1, 0, 2}, {0, 1, -1}, {1, 1, 1}}), batch_out(2, 3);
+	transform(p, batch_in, SoAView<double>(batch_out));
+	CHECK(batch_out == Matrix<double>({{1 + 10, 2 + 12}, {3 - 5, 4 - 6}, {9, 12}}));
+
+	// One matrix per vector
+	std::vector<f32> mats(16 * n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t e = 0; e < 16; e++)
+			mats[e * n + i] = m.ptr()[e] * f32(i % 3);
+	std::vector<f32> out3(4 * n);
+	transform_each(SoAView<const f32>(mats.data(), n, 16), SoAView<const f32>(in.data(), n, 4), SoAView<f32>(out3.data(), n, 4));
+	same = true;
+	for (size_t i = 0; i < n; i++)
+		for (size_t k = 0; k < 4; k++)
+			same = same && out3[k * n + i] == out[k * n + i] * f32(i % 3);
+	CHECK(same);
+
+	CHECK_THROWS_AS(transform(m, SoAView<const f32>(in.data(), n, 3), SoAView<f32>(out.data(), n, 4)), std::invalid_argument);
+	CHECK_THROWS_AS(transform(m, SoAView<const f32>(in.data(), n, 4), SoAView<f32>(out.data(), n - 1, 4)), std::invalid_argument);
+	CHECK_THROWS_AS(transform(m, SoAView<const f32>(in.data(), n, 4), SoAView<f32>(in.data(), n, 4)), std::invalid_argument);
+	CHECK_THROWS_AS(SoAView<f32>(in.data(), n, 4, n - 1), std::invalid_argument);
+}
+
+TEST_CASE("Matrix and vector views") {
+	Matrix<f32> m({{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}});
+
+	// Rows are strided views, columns contiguous ones
+	VectorView<f32> row = m.row(1);
+	CHECK(row.stride() == m.ld());
+	CHECK(Vector<f32>(row) == Vector<f32>({5, 6, 7, 8}));
+	row[2] = 70;
+	CHECK(m[2][1] == 70);
+	CHECK(std::vector<f32>(m.row(0).begin(), m.row(0).end()) == std::vector<f32>({1, 2, 3, 4}));
+	m[2][1] = 7;
+
+	// Blocks and transposed views share the storage
+	MatrixView<f32> b = m.block(1, 1, 2, 3);
+	CHECK(b.shape() == std::make_pair<size_t, size_t>(2, 3));
+	CHECK(Matrix<f32>(b) == Matrix<f32>({{6, 7, 8}, {10, 11, 12}}));
+	CHECK(b.data() == &m[1][1]);
+	CHECK(Matrix<f32>(m.transpose_view()) == m.transpose());
+	CHECK(Matrix<f32>(m.transpose_view().block(0, 1, 2, 2)) == Matrix<f32>({{5, 9}, {6, 10}}));
+	CHECK_THROWS_AS(m.block(2, 2, 2, 2), std::out_of_range);
+
+	// Operations accept views : no intermediate matrix
+	Matrix<f32> sq({{1, 2}, {3, 4}});
+	sq.add(m.block(0, 0, 2, 2));
+	CHECK(sq == Matrix<f32>({{2, 4}, {8, 10}}));
+	sq.sub(m.block(0, 0, 2, 2).transpose());
+	CHECK(sq == Matrix<f32>({{1, -1}, {6, 4}}));
+	CHECK(m.mul_vec(Vector<f32>({1, 0, 1})) == Vector<f32>({10, 12, 14, 16}));
+	CHECK(m.mul_vec(m[0]) == Vector<f32>({107, 122, 137, 152}));
+	CHECK(m.transpose().mul_vec(m.row(2)) == Vector<f32>({1 * 9 + 2 * 10 + 3 * 11 + 4 * 12, 5 * 9 + 6 * 10 + 7 * 11 + 8 * 12, 9 * 9 + 10 * 10 + 11 * 11 + 12 * 12}));
+	CHECK(m.mul_mat(m.transpose_view()) == m.mul_mat(m.transpose()));
+
+	// Large enough for the GEMM kernel, on transposed and block operands
+	const Tuning saved = tuning;
+	tuning.gemm_threshold = 4;
+	Matrix<double> a(24, 20), c(30, 24);
+	for (size_t j = 0; j < 24; j++)
+		for (size_t i = 0; i < 20; i++)
+			a[j][i] = double((i * 3 + j * 7) % 11) - 5;
+	for (size_t j = 0; j < 30; j++)
+		for (size_t i = 0; i < 24; i++)
+			c[j][i] = double((i + j * 2) % 7) - 3;
+	CHECK(a.mul_mat(c.transpose_view().transpose()) == a.mul_mat(c));
+	CHECK(a.transpose().mul_mat(a.block(0, 0, 20, 8)) == a.transpose().mul_mat(Matrix<double>(a.block(0, 0, 20, 8))));
+	tuning = saved;
+
+	// Wrapping an external row-major buffer
+	f32 external[6] = {1, 2, 3, 4, 5, 6};
+	MatrixView<f32> rm(external, 2, 3, 3, 1);
+	CHECK(Matrix<f32>(rm) == Matrix<f32>({{1, 2, 3}, {4, 5, 6}}));
+	rm[0][1] = 40;
+	CHECK(external[3] == 40);
+
+	// Assigning blocks builds [A | B] without operator|
+	Matrix<f32> left({{1, 2}, {3, 4}}), right({{5}, {6}}), joined(3, 2);
+	joined.block(0, 0, 2, 2).assign(left.view());
+	joined.block(0, 2, 2, 1).assign(right.view());
+	CHECK(joined == (left | right));
+}
+
+TEST_CASE("Binary matrix files") {
+	const std::string path = "/tmp/matrix_tests_" + std::to_string(getpid()) + ".bin";
+	Matrix<f32> m({{1, 2, 3}, {4, 5, 6}});
+
+	// Save / load round trip, of matrices and views
+	save(path, m);
+	CHECK(load<f32>(path) == m);
+	save(path, m.transpose_view());
+	CHECK(load<f32>(path) == m.transpose());
+	CHECK_THROWS_AS(load<double>(path), std::invalid_argument);
+	CHECK_THROWS_AS(load<f32>("/nonexistent/matrix.bin"), std::runtime_error);
+
+	// Mapping : the view points into the file, aligned, no copy
+	save(path, m);
+	{
+		MappedMatrix<const f32> mapped(path);
+		CHECK(mapped.shape() == m.shape());
+		CHECK(reinterpret_cast<uintptr_t>(mapped.view().data()) % MATRIX_FILE_ALIGN == 0);
+		CHECK(Matrix<f32>(mapped.view()) == m);
+		CHECK(Matrix<f32>(mapped.view().block(0, 1, 2, 2)) == Matrix<f32>({{2, 3}, {5, 6}}));
+
+		MappedMatrix<const f32> moved(std::move(mapped));
+		CHECK_FALSE(mapped.is_open());
+		CHECK(moved.view()[2][1] == 6);
+	}
+	{
+		MappedMatrix<f32> writable(path);
+		writable.view()[0][0] = 10;
+	}
+	CHECK(load<f32>(path)[0][0] == 10);
+
+	// Streaming writer : columns appended one by one or by blocks, shape fixed on close
+	Matrix<double> big(50, 40);
+	for (size_t c = 0; c < 50; c++)
+		for (size_t r = 0; r < 40; r++)
+			big[c][r] = double(r * 50 + c);
+	{
+		MatrixWriter<double> writer(path, 40);
+		writer.append(big[0]);
+		writer.append(big.block(0, 1, 40, 30));
+		writer.append(big.block(0, 31, 40, 19));
+		CHECK_THROWS_AS(writer.append(big.block(0, 0, 3, 1)), std::invalid_argument);
+		CHECK(writer.cols() == 50);
+		writer.close();
+		CHECK_THROWS_AS(writer.append(big[0]), std::logic_error);
+	}
+	CHECK(load<double>(path) == big);
+	save(path, big.transpose_view()); // Strided columns
+	CHECK(MappedMatrix<const double>(path).view() == big.transpose_view());
+
+	// Files that are not matrix files
+	std::FILE* f = std::fopen(path.c_str(), "wb");
+	std::fputs("1, 0\n0, 1\n", f);
+	std::fclose(f);
+	CHECK_THROWS_AS(MappedMatrix<const f32>{ path }, std::invalid_argument);
+	std::remove(path.c_str());
+}
+
+TEST_CASE("Text matrix files") {
+	const std::string path = "/tmp/matrix_tests_" + std::to_string(getpid()) + ".txt";
+
+	// The display `proj` layout, with blank lines, CRLF and extra spaces
+	Matrix<f32> proj = parse_text<f32>("1.0, 0.0, 0.0, 0.0\n0, 1, 0, 0\r\n\n  0.0,0.0, -1.002 ,-1\n0 0 -0.2002 +0\n\n");
+	CHECK(proj == Matrix<f32>({{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, -1.002f, -1}, {0, 0, -0.2002f, 0}}));
+	CHECK(parse_text<f32>("") == Matrix<f32>());
+	CHECK(parse_text<int>("1, 2\n3, 4") == Matrix<int>({{1, 2}, {3, 4}}));
+	CHECK(parse_text<c32>("(1,2), 3\n0, (0,-1)") == Matrix<c32>({{c32(1, 2), 3}, {0, c32(0, -1)}}));
+	CHECK_THROWS_AS(parse_text<f32>("1, 2\n3\n"), std::invalid_argument);       // Ragged rows
+	CHECK_THROWS_AS(parse_text<f32>("1, 2\n3, 4, 5\n"), std::invalid_argument);
+	CHECK_THROWS_AS(parse_text<f32>("1, x\n"), std::invalid_argument);
+	CHECK_THROWS_AS(parse_text<f32>("1, 2.5.1\n"), std::invalid_argument);
+
+	// Same output as the Ex14 loop, shortest round trip by default
+	Matrix<f32> p = projection(90.0f, 1.0f, 0.1f, 100.0f);
+	std::ostringstream expected, text;
+	for (size_t r = 0; r < p.rows(); ++r)
+		for (size_t c = 0; c < p.cols(); ++c)
+			expected << p[c][r] << (c + 1 == p.cols() ? "\n" : ", ");
+	write_text(text, p, 6);
+	CHECK(text.str() == expected.str());
+
+	Matrix<double> m(30, 700);
+	for (size_t c = 0; c < 30; c++)
+		for (size_t r = 0; r < 700; r++)
+			m[c][r] = std::sin(double(r * 30 + c)) * 1e3;
+	save_text(path, m);
+	Matrix<double> back = load_text<double>(path);
+	CHECK(back.shape() == m.shape());
+	CHECK(std::equal(back.ptr(), back.ptr() + 30 * 700, m.ptr())); // Bit exact
+
+	const Tuning saved = tuning;
+	tuning.execution = Execution::Parallel;
+	back = load_text<double>(path);
+	CHECK(std::equal(back.ptr(), back.ptr() + 30 * 700, m.ptr()));
+	tuning = saved;
+	std::remove(path.c_str());
+	CHECK_THROWS_AS(load_text<f32>(path), std::runtime_error);
+
+	// operator<< goes through to_chars but prints the same as the stream would
+	std::ostringstream os, ref;
+	os << Matrix<f32>({{1.5f, -2}, {1.0f / 3, 1e-7f}});
+	CHECK(os.str() == "{[1.5, -2], [0.333333, 1e-07]}");
+	ref << std::fixed << Matrix<f32>({{1.5f}});
+	CHECK(ref.str() == "{[1.500000]}");
+
+	// High precisions reserve their room per element instead of overrunning the buffers
+	Matrix<double> wide(400, 1);
+	for (size_t c = 0; c < 400; c++)
+		wide[c][0] = std::sin(double(c)) * 1e-3;
+	const auto stream_text = [&](int precision, const char* separator, const char* end, size_t cols = 400) {
+		std::ostringstream out;
+		out << std::setprecision(precision);
+		for (size_t c = 0; c < cols; c++)
+			out << wide[c][0] << (c + 1 == cols ? end : separator);
+		return out.str();
+	};
+	std::ostringstream high, textual, huge;
+	high << std::setprecision(130) << wide;
+	CHECK(high.str() == "{[" + stream_text(130, ", ", "]}"));
+	write_text(textual, wide, 170);
+	CHECK(textual.str() == stream_text(170, ", ", "\n"));
+	write_text(huge, wide.block(0, 0, 1, 3), 70000); // More than the stack buffer per element
+	CHECK(huge.str() == stream_text(70000, ", ", "\n", 3));
+
+	char small[4];
+	CHECK_THROWS_AS(format_value(small, small + sizeof(small), 1.0 / 3), std::length_error);
+	CHECK_THROWS_AS(format_value(small, small + sizeof(small), c32(1, 2)), std::length_error);
+}
+
+TEST_CASE("Workspace") {
+	Workspace ws;
+	CHECK(ws.capacity() == 0);
+
+	// Aligned bump allocations, rewound by scopes
+	{
+		Workspace::Scope scope(ws);
+		f32*    a = ws.alloc<f32>(3);
+		double* b = ws.alloc<double>(5);
+		CHECK(reinterpret_cast<uintptr_t>(a) % Workspace::ALIGN == 0);
+		CHECK(reinterpret_cast<uintptr_t>(b) % Workspace::ALIGN == 0);
+		CHECK(reinterpret_cast<char*>(b) - reinterpret_cast<char*>(a) == Workspace::ALIGN);
+		{
+			Workspace::Scope inner(ws);
+			CHECK(reinterpret_cast<char*>(ws.alloc<f32>(1)) - reinterpret_cast<char*>(b) == Workspace::ALIGN);
+		}
+		CHECK(reinterpret_cast<char*>(ws.alloc<f32>(1)) - reinterpret_cast<char*>(b) == Workspace::ALIGN); // Reused
+	}
+
+	// Growing over several blocks, merged once empty
+	{
+		Workspace::Scope scope(ws);
+		ws.alloc<double>(100000);
+		ws.alloc<double>(100000);
+	}
+	const size_t merged = ws.capacity();
+	CHECK(merged >= 2 * 100000 * sizeof(double));
+	{
+		Workspace::Scope scope(ws);
+		MatrixView<double> m = ws.matrix<double>(200, 500);
+		ws.alloc<double>(100000);
+		CHECK(m.shape() == std::make_pair<size_t, size_t>(200, 500));
+	}
+	CHECK(ws.capacity() == merged);
+
+	Workspace preallocated(1 << 20);
+	CHECK(preallocated.capacity() == (1 << 20));
+
+	// Algorithms draw their temporaries from it and leave it empty
+	Matrix<double> a({{2, 0, 2, 0.6}, {3, 3, 4, -2}, {5, 5, 4, 2}, {-1, -2, 3.4, -1}});
+	Matrix<double> inv;
+	a.inverse(inv, ws);
+	CHECK(inv == a.inverse());
+	const double* storage = inv.ptr();
+	const size_t  capacity = ws.capacity();
+	for (int i = 0; i < 100; i++) {
+		a.inverse(inv, ws);
+		CHECK(a.determinant(ws) == doctest::Approx(a.determinant()));
+		CHECK(a.rank(-1, ws) == 4);
+	}
+	CHECK(inv.ptr() == storage); // Result storage reused
+	CHECK(ws.capacity() == capacity);
+	CHECK(ws.mark().block == 0);
+	CHECK(ws.mark().used == 0);
+
+	// In place, and left unchanged when singular
+	Matrix<double> b = a;
+	b.inverse(b, ws);
+	CHECK(b == inv);
+	Matrix<f32> singular({{1, 2}, {2, 4}});
+	CHECK_THROWS_AS(singular.inverse_inplace(ws), std::logic_error);
+	CHECK(singular == Matrix<f32>({{1, 2}, {2, 4}}));
+	CHECK(ws.mark().used == 0);
+	CHECK(std::move(b).row_echelon(ws) == Matrix<double>({{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}));
+}
+
+TEST_CASE("Pivoted row echelon") {
+	// The pivot row is two rows down : it must be swapped with the current row, not the one above it
+	Matrix<f32> a({{0, 1, 2}, {0, 0, 3}, {4, 5, 6}});
+	CHECK(a.row_echelon() == Matrix<f32>({{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}));
+	CHECK(a.rank() == 3);
+
+	// Pivots, rank and permutation in one pass
+	Matrix<double> b({{1, 2, 3}, {2, 4, 6}, {1, 0, 1}});
+	Echelon<double> e = b.rref();
+	CHECK(e.rank == 2);
+	CHECK(e.pivots == std::vector<size_t>({0, 1}));
+	CHECK(e.rows[0] == 1); // Largest magnitude of the first column
+	CHECK(e.cols == std::vector<size_t>({0, 1, 2}));
+	CHECK(e.reduced == Matrix<double>({{1, 0, 1}, {0, 1, 1}, {0, 0, 0}}));
+	CHECK(e.reduced[2][2] == 0.0); // Zeroed exactly, not rounding noise
+
+	// Complete pivoting starts from the largest entry and reduces A * Q
+	Echelon<double> c = b.rref(-1, Pivoting::Complete);
+	CHECK(c.rank == 2);
+	CHECK(c.cols[0] == 2);
+	CHECK(c.pivots == std::vector<size_t>({0, 1}));
+	Matrix<double> aq(3, 3);
+	for (size_t j = 0; j < 3; j++)
+		aq[j].assign(b[c.cols[j]]);
+	CHECK(c.reduced == aq.row_echelon());
+
+	// Rounding noise of float data does not count in the rank, and the tolerance can be set
+	Matrix<f32> noisy(3, 3);
+	for (size_t col = 0; col < 3; col++) {
+		noisy[col][0] = 0.1f * f32(col + 1);
+		noisy[col][1] = 0.7f / f32(col + 3);
+		noisy[col][2] = noisy[col][0] * 0.3f + noisy[col][1] * 1.7f; // Dependent row
+	}
+	CHECK(noisy.rank() == 2);
+	Echelon<f32> n = noisy.rref();
+	CHECK(Vector<f32>(n.reduced.row(2)) == Vector<f32>({0, 0, 0}));
+	Matrix<double> small({{1, 0}, {0, 1e-3}});
+	CHECK(small.rank() == 2);
+	CHECK(small.rank(1e-2) == 1);
+	CHECK(small.rref(1e-2).pivots == std::vector<size_t>({0}));
+	CHECK(Matrix<f32>().rref().rank == 0);
+}
+
+TEST_CASE("Closed-form small inverses") {
+	Matrix<double> a3({{2, -1, 0}, {-1, 2, -1}, {0, -1, 2}});
+	Matrix<double> a4({{2, 0, 2, 0.6}, {3, 3, 4, -2}, {5, 5, 4, 2}, {-1, -2, 3.4, -1}});
+	Matrix<double> i3(3, 3), i4(4, 4);
+	for (size_t i = 0; i < 4; i++) {
+		if (i < 3) i3[i][i] = 1;
+		i4[i][i] = 1;
+	}
+
+	// Same results as the LU path
+	CHECK(a3.determinant() == doctest::Approx(LU<double>(a3).det()));
+	CHECK(a4.determinant() == doctest::Approx(LU<double>(a4).det()));
+	CHECK(a3.inverse() == LU<double>(a3).inverse());
+	CHECK(a4.inverse() == LU<double>(a4).inverse());
+	CHECK(a4.mul_mat(a4.inverse()) == i4);
+	CHECK(Matrix<double>(Matrix<double, 4, 4>(a4).inverse()) == a4.inverse());
+	CHECK(Matrix<double, 3, 3>(a3).determinant() == doctest::Approx(a3.determinant()));
+
+	// Affine transforms : rotation + scale + translation, in both conventions
+	Matrix<double> affine({{0, -2, 0, 5}, {1, 0, 0, -3}, {0, 0, 0.5, 7}, {0, 0, 0, 1}});
+	CHECK(affine.inverse() == LU<double>(affine).inverse());
+	CHECK(affine.mul_mat(affine.inverse()) == i4);
+	CHECK(affine.transpose().inverse() == LU<double>(affine.transpose()).inverse());
+	CHECK(Matrix<double>(Matrix<double, 4, 4>(affine).inverse()) == affine.inverse());
+	CHECK(affine.determinant() == doctest::Approx(1.0));
+
+	// Camera unprojection
+	Matrix<f32> proj = projection(90.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+	Matrix<f32> unproj = proj.inverse();
+	Matrix<f32> id(4, 4);
+	for (size_t i = 0; i < 4; i++)
+		id[i][i] = 1;
+	CHECK(proj.mul_mat(unproj) == id);
+
+	// Singular matrices, and inverting in place
+	CHECK_THROWS_AS(Matrix<double>({{1, 2, 3}, {2, 4, 6}, {1, 0, 1}}).inverse(), std::logic_error);
+	CHECK_THROWS_AS(Matrix<double>({{1, 0, 0, 1}, {0, 0, 0, 2}, {0, 0, 1, 3}, {0, 0, 0, 1}}).inverse(), std::logic_error);
+	CHECK_THROWS_AS((Matrix<double, 3, 3>({{1, 2, 3}, {2, 4, 6}, {1, 0, 1}}).inverse()), std::logic_error);
+	CHECK(Matrix<double>({{1, 2, 3}, {2, 4, 6}, {1, 0, 1}}).determinant() == 0.0);
+	Matrix<double> b = a4;
+	b.inverse(b);
+	CHECK(b == LU<double>(a4).inverse());
+}
+
+TEST_CASE("Sparse matrices") {
+	Matrix<double> d({{4, 0, 0, 1}, {0, 0, 2, 0}, {0, 3, 0, 0}, {1, 0, 0, 5}, {0, 0, 0, 0}});
+	SparseMatrix<double> s(d);
+	CHECK(s.shape() == d.shape());
+	CHECK(s.nnz() == 6);
+	CHECK(s.dense() == d);
+	CHECK(s.at(3, 3) == 5);
+	CHECK(s.at(4, 1) == 0);
+	CHECK(s.offsets() == std::vector<size_t>({0, 2, 3, 4, 6}));
+
+	// Triplets in any order, duplicates summed and cancellations dropped
+	SparseMatrix<double> t(4, 5, {{3, 3, 5}, {0, 0, 4}, {1, 2, 2}, {0, 3, 1}, {2, 1, 3}, {3, 0, 1}, {4, 3, 1}, {4, 3, -1}});
+	CHECK(t == s);
+	CHECK(t.nnz() == 6);
+	CHECK_THROWS_AS((SparseMatrix<double>(2, 2, {{2, 0, 1}})), std::out_of_range);
+
+	Vector<double> v({1, -2, 3, 0.5, 7});
+	CHECK(s.mul_vec(v) == d.mul_vec(v));
+	CHECK_THROWS_AS(s.mul_vec(Vector<double>({1, 2})), std::invalid_argument);
+
+	CHECK(s.transpose().dense() == d.transpose());
+	CHECK(s.transpose().transpose() == s);
+
+	SparseMatrix<double> sum = s;
+	sum.add(t);
+	Matrix<double> dsum = d;
+	dsum.add(d);
+	CHECK(sum.dense() == dsum);
+	sum.sub(s);
+	sum.sub(t);
+	CHECK(sum.nnz() == 0);
+	SparseMatrix<double> scaled = s;
+	scaled.scl(-2);
+	Matrix<double> dscaled = d;
+	dscaled.scl(-2);
+	CHECK(scaled.dense() == dscaled);
+	scaled.scl(0);
+	CHECK(scaled.nnz() == 0);
+
+	// Elimination matches the dense results
+	Matrix<double> r({{1, 2, 0, 0}, {2, 4, 0, 1}, {0, 0, 3, 0}, {1, 2, 3, 1}});
+	SparseMatrix<double> sr(r);
+	CHECK(sr.rank() == r.rank());
+	CHECK(sr.rank() == 3);
+	CHECK(sr.row_echelon().dense() == r.row_echelon());
+	CHECK(s.rank() == d.rank());
+	CHECK(s.row_echelon().dense() == d.row_echelon());
+	CHECK(SparseMatrix<double>(3, 3).rank() == 0);
+
+	// Rank-deficient pattern with fill-in, against the dense elimination
+	Matrix<double> f(24, 20);
+	for (size_t k = 0, seed = 7; k < 24 * 20; k++) {
+		seed = seed * 1103515245 + 12345;
+		if ((seed >> 16) % 5 == 0)
+			f[k / 20][k % 20] = double((seed >> 8) % 19) - 9;
+	}
+	for (size_t r = 0; r < 20; r++) // Column 5 repeats column 2
+		f[5][r] = f[2][r];
+	SparseMatrix<double> sf(f);
+	CHECK(sf.rank() == f.rank());
+	CHECK(sf.row_echelon().dense() == f.row_echelon());
+
+	// Large diagonal and tridiagonal matrices : the elimination only touches the rows starting at each pivot column
+	const size_t big = 50000;
+	std::vector<SparseMatrix<double>::Entry> diagonal, tridiagonal;
+	for (size_t i = 0; i < big; i++) {
+		diagonal.push_back({ i, i, double(i % 7) + 1 });
+		tridiagonal.push_back({ i, i, 4 });
+		if (i + 1 < big) {
+			tridiagonal.push_back({ i + 1, i, 1 });
+			tridiagonal.push_back({ i, i + 1, 1 });
+		}
+	}
+	SparseMatrix<double> sd(big, big, std::move(diagonal)), st(big, big, std::move(tridiagonal));
+	CHECK(sd.rank() == big);
+	CHECK(st.rank() == big);
+	const SparseMatrix<double> ed = sd.row_echelon(), et = st.row_echelon();
+	CHECK(ed.nnz() == big);
+	CHECK(et.nnz() == big);
+	CHECK(et.at(big - 1, big - 1) == doctest::Approx(1));
+
+	Matrix<std::complex<float>> c({{{1, 1}, {0, 0}}, {{0, 0}, {0, 2}}, {{2, 2}, {0, 0}}});
+	SparseMatrix<std::complex<float>> sc(c);
+	CHECK(sc.rank() == 2);
+	CHECK(sc.mul_vec(Vector<std::complex<float>>({{1, 0}, {0, 1}, {1, 1}})) == c.mul_vec(Vector<std::complex<float>>({{1, 0}, {0, 1}, {1, 1}})));
+}
+
+TEST_CASE("Structured matrices") {
+	Vector<double> v({1, -2, 0.5, 3, -1});
+	Matrix<double> b({{1, 2}, {0, -1}, {3, 0.5}, {-2, 1}, {0.25, 4}});
+	auto near = [](Vector<double> x, const Vector<double>& y) { x.sub(y); return x.norm() < 1e-9; };
+
+	SUBCASE("Diagonal") {
+		DiagonalMatrix<double> d(Vector<double>({2, -1, 4, 0.5, 3}));
+		Matrix<double> dd = d.dense();
+		CHECK(d.mul_vec(v) == dd.mul_vec(v));
+		CHECK(d.mul_mat(b) == dd.mul_mat(b));
+		CHECK(d.determinant() == doctest::Approx(dd.determinant()));
+		CHECK(d.trace() == dd.trace());
+		CHECK(near(d.mul_vec(d.solve(v)), v));
+		CHECK(d.mul_mat(d.solve(b)) == b);
+		d(2, 2) = 0;
+		CHECK_THROWS_AS(d.solve(v), std::logic_error);
+		CHECK_THROWS_AS(d(0, 1), std::out_of_range);
+		CHECK(DiagonalMatrix<double>(dd).diagonal() == std::vector<double>({2, -1, 4, 0.5, 3}));
+	}
+
+	Matrix<double> full({{4, 1, 0, 2, 1}, {1, 5, 1, 0, 0}, {0, 1, 6, 1, 2}, {2, 0, 1, 7, 1}, {1, 0, 2, 1, 8}});
+
+	SUBCASE("Triangular") {
+		for (Triangle t : {Triangle::Lower, Triangle::Upper}) {
+			TriangularMatrix<double> a(full, t);
+			Matrix<double> ad = a.dense();
+			CHECK(a.packed().size() == 15);
+			CHECK(ad.is_triangular());
+			CHECK(a.at(0, 4) == (t == Triangle::Upper ? 1 : 0));
+			CHECK(a.mul_vec(v) == ad.mul_vec(v));
+			CHECK(a.mul_mat(b) == ad.mul_mat(b));
+			CHECK(a.determinant() == doctest::Approx(ad.determinant()));
+			CHECK(a.trace() == ad.trace());
+			CHECK(near(a.mul_vec(a.solve(v)), v));
+			CHECK(a.mul_mat(a.solve(b)) == b);
+			CHECK(a.transpose().dense() == ad.transpose());
+		}
+		// Large enough for the panel GEMM path, with a partial last panel
+		Matrix<f32> big(150, 150), rhs(60, 150);
+		for (size_t c = 0; c < 150; c++)
+			for (size_t r = 0; r < 150; r++)
+				big[c][r] = f32((r * 7 + c * 3) % 11) - 5.f;
+		for (size_t c = 0; c < 60; c++)
+			for (size_t r = 0; r < 150; r++)
+				rhs[c][r] = f32((r + c * 5) % 7) - 3.f;
+		for (Triangle t : {Triangle::Lower, Triangle::Upper}) {
+			TriangularMatrix<f32> a(big, t);
+			CHECK(a.mul_mat(rhs) == a.dense().mul_mat(rhs));
+		}
+
+		TriangularMatrix<double> l(3, Triangle::Lower);
+		l(2, 0) = 1;
+		CHECK_THROWS_AS(l(0, 2), std::out_of_range);
+		CHECK_THROWS_AS(l.solve(Vector<double>({1, 1, 1})), std::logic_error);
+		CHECK(!full.is_triangular());
+		CHECK(Matrix<double>({{1, 0, 0, 0, 0}, {2, 3, 0, 0, 0}, {4, 5, 6, 0, 0}, {7, 8, 9, 1, 0}, {1, 2, 3, 4, 2}}).determinant() == 36);
+	}
+
+	SUBCASE("Symmetric") {
+		SymmetricMatrix<double> s(full);
+		CHECK(s.packed().size() == 15);
+		CHECK(s.dense() == full);
+		CHECK(s.at(0, 3) == 2);
+		CHECK(s.mul_vec(v) == full.mul_vec(v));
+		CHECK(s.mul_mat(b) == full.mul_mat(b));
+		CHECK(s.determinant() == doctest::Approx(full.determinant()));
+		CHECK(s.trace() == full.trace());
+		CHECK(near(s.mul_vec(s.solve(v)), v));
+		CHECK(s.mul_mat(s.solve(b)) == b);
+
+		s(4, 4) = -8; // Indefinite : falls back to LU
+		CHECK(s.determinant() == doctest::Approx(s.dense().determinant()));
+		CHECK(near(s.mul_vec(s.solve(v)), v));
+		s(0, 1) = 3;
+		CHECK(s.at(1, 0) == 3);
+
+		Matrix<std::complex<double>> cm({{{1, 1}, {2, 0}}, {{2, 0}, {0, 3}}});
+		SymmetricMatrix<std::complex<double>> cs(cm);
+		Vector<std::complex<double>> cv({{1, 0}, {0, 1}});
+		CHECK(cs.mul_vec(cs.solve(cv)) == cv);
+	}
+
+	SUBCASE("Banded") {
+		BandedMatrix<double> a(full, 1, 2);
+		Matrix<double> ad = a.dense();
+		CHECK(a.at(3, 0) == 0);
+		CHECK(a.at(0, 2) == 0);
+		CHECK(a.at(2, 0) == 0);
+		CHECK(a.at(0, 1) == 1);
+		CHECK(BandedMatrix<double>(ad, 1, 2).dense() == ad);
+		CHECK(a.mul_vec(v) == ad.mul_vec(v));
+		CHECK(a.mul_mat(b) == ad.mul_mat(b));
+		CHECK(a.determinant() == doctest::Approx(ad.determinant()));
+		CHECK(a.trace() == ad.trace());
+		CHECK(near(a.mul_vec(a.solve(v)), v));
+		CHECK(a.mul_mat(a.solve(b)) == b);
+		CHECK(a.transpose().dense() == ad.transpose());
+
+		// Small pivots force row swaps, and the fill-in they create above the band
+		BandedMatrix<double> p(5, 2, 1);
+		for (size_t i = 0; i < 5; i++) {
+			p(i, i) = 1e-3;
+			if (i + 1 < 5) p(i + 1, i) = 2, p(i, i + 1) = -1;
+			if (i + 2 < 5) p(i + 2, i) = 1;
+		}
+		CHECK(p.determinant() == doctest::Approx(p.dense().determinant()));
+		CHECK(near(p.mul_vec(p.solve(v)), v));
+		CHECK(p.mul_mat(p.solve(b)) == b);
+		CHECK_THROWS_AS(BandedMatrix<double>(3, 1, 1).solve(Vector<double>({1, 2, 3})), std::logic_error);
+		CHECK_THROWS_AS(a(4, 0), std::out_of_range);
+	}
+}
+
+TEST_CASE("Device matrices") {
+	Matrix<f32> a({{1, 2, 3}, {4, 5, 6}});
+	Matrix<f32> b({{1, 0}, {2, 1}, {-1, 3}});
+	Vector<f32> v({1, -1});
+
+	DeviceMatrix<f32> da(a), db(b);
+	DeviceVector<f32> dv(v);
+	CHECK(da.shape() == a.shape());
+
+	// Chained on the device, one download at the end
+	DeviceMatrix<f32> dc = da.mul_mat(db);
+	dc.scl(2);
+	dc.add(dc.transpose());
+	Matrix<f32> c = a.mul_mat(b);
+	c.scl(2);
+	Matrix<f32> ct = c.transpose();
+	c.add(ct);
+	CHECK(dc.to_host() == c);
+
+	CHECK(da.mul_vec(dv).to_host() == a.mul_vec(v));
+	CHECK(da.transpose().to_host() == a.transpose());
+	DeviceVector<f32> dw(Vector<f32>({1, 1, 1}));
+	dw.axpy(2, da.mul_vec(dv));
+	dw.sub(DeviceVector<f32>(3));
+	CHECK(dw.to_host() == Vector<f32>({-5, -5, -5}));
+
+	Matrix<f32> host(1, 1);
+	da.download(host);
+	da.context().synchronize();
+	CHECK(host == a);
+
+	// Batched transform : 3 vectors of 3 components, out[i] = m.mul_vec(in[i])
+	Matrix<f32> m({{1, 2, 0}, {0, 1, 0}, {3, 0, 1}});
+	Matrix<f32> in(3, 3);
+	for (size_t i = 0; i < 3; i++)
+		for (size_t k = 0; k < 3; k++)
+			in[k][i] = f32(i * 3 + k);
+	DeviceMatrix<f32> dout;
+	transform(DeviceMatrix<f32>(m), DeviceMatrix<f32>(in), dout);
+	Matrix<f32> out = dout.to_host();
+	for (size_t i = 0; i < 3; i++)
+		CHECK(Vector<f32>(out.row(i)) == m.mul_vec(Vector<f32>(in.row(i))));
+
+	CHECK_THROWS_AS(da.mul_mat(da), std::invalid_argument);
+	CHECK_THROWS_AS(da.mul_vec(DeviceVector<f32>(3)), std::invalid_argument);
+	CHECK_THROWS_AS(da.mul_mat(db, da), std::invalid_argument);
+	CHECK_THROWS_AS(da.add(db), std::invalid_argument);
+	DeviceContext other;
+	CHECK_THROWS_AS(da.add(DeviceMatrix<f32>(a.cols(), a.rows(), other)), std::invalid_argument);
+#ifndef MATRIX_CUDA
+	CHECK(!DeviceContext::accelerated());
+#endif
+}
+
+TEST_CASE("Reduced precision") {
+	// Encodings : exact values, rounding to nearest even, subnormals, overflow and NaN
+	CHECK(f16(1.f).bits == 0x3c00);
+	CHECK(f16(-2.f).bits == 0xc000);
+	CHECK(f16(65504.f).bits == 0x7bff);
+	CHECK(f16(1e6f).bits == 0x7c00);
+	CHECK(f16(1.f + 1.f / 2048).bits == 0x3c00);              // Tie, rounded to the even mantissa
+	CHECK(f16(1.f + 3.f / 2048).bits == 0x3c02);
+	CHECK(float(f16::from_bits(0x0001)) == std::ldexp(1.f, -24)); // Smallest subnormal
+	CHECK(f16(std::ldexp(1.f, -24)).bits == 0x0001);
+	CHECK(std::isnan(float(f16(std::numeric_limits<float>::quiet_NaN()))));
+	CHECK(bf16(1.f).bits == 0x3f80);
+	CHECK(float(bf16(3.140625f)) == 3.140625f);
+	CHECK(std::isnan(float(bf16(std::numeric_limits<float>::quiet_NaN()))));
+	CHECK(float(std::numeric_limits<f16>::epsilon()) == std::ldexp(1.f, -10));
+	for (uint32_t b = 0; b < 0x7c00; b += 7) // Every 7th finite half survives a round trip through f32
+		CHECK(f16(float(f16::from_bits(uint16_t(b)))).bits == b);
+
+	// Vector reductions accumulate in f32 : 4096 * 1 is not representable in f16 accumulation (it stalls at 2048)
+	const size_t      n = 4096;
+	Vector<f16>       ones(n);
+	std::vector<f32>  wide(n);
+	for (size_t i = 0; i < n; i++) {
+		ones[i] = f16(1.f);
+		wide[i] = float(f16(float(i % 17) / 8 - 1));
+	}
+	Vector<f16> x = convert<f16>(Vector<f32>(wide));
+	CHECK(float(ones.dot(ones)) == f32(n));
+	CHECK(ones.norm_1() == f32(n));
+	CHECK(ones.norm() == doctest::Approx(64.0));
+	CHECK(x.norm_inf() == 1.f);
+	CHECK(float(x.dot(ones)) == doctest::Approx(Vector<f32>(wide).dot(Vector<f32>(std::vector<f32>(n, 1.f)))));
+
+	// mul_vec / mul_mat against f32, below and above the GEMM threshold
+	for (size_t s : {5, 64}) {
+		Matrix<f32> a(s, s + 3), b(s + 1, s);
+		for (size_t c = 0; c < a.cols(); c++)
+			for (size_t r = 0; r < a.rows(); r++)
+				a[c][r] = float(bf16(std::sin(float(r * 7 + c))));
+		for (size_t c = 0; c < b.cols(); c++)
+			for (size_t r = 0; r < b.rows(); r++)
+				b[c][r] = float(bf16(std::cos(float(r + 3 * c))));
+		Vector<f32> v(s + 3);
+		for (size_t i = 0; i < v.size(); i++)
+			v[i] = float(bf16(float(i) / s));
+
+		Matrix<bf16> ha = convert<bf16>(a), hb = convert<bf16>(b);
+		Vector<f32>  y  = convert<f32>(ha.mul_vec(convert<bf16>(v)));
+		Vector<f32>  ref = a.mul_vec(v);
+		for (size_t i = 0; i < y.size(); i++)
+			CHECK(y[i] == doctest::Approx(ref[i]).epsilon(1e-2));
+
+		Matrix<f32> p = convert<f32>(convert<f16>(a).mul_mat(convert<f16>(b)));
+		Matrix<f32> pref = a.mul_mat(b);
+		for (size_t c = 0; c < p.cols(); c++)
+			for (size_t r = 0; r < p.rows(); r++)
+				CHECK(std::abs(p[c][r] - pref[c][r]) < 1e-2f * (1 + std::abs(pref[c][r])));
+	}
+
+	// int8 columns, each element within half a column scale
+	Matrix<f32> q({{1, -0.5, 0}, {0.25, 2, -4}, {-1, 0, 0.125}, {0.75, 1, 1}});
+	Int8Matrix  iq(q);
+	Matrix<f32> dq = iq.dense();
+	for (size_t c = 0; c < q.cols(); c++)
+		for (size_t r = 0; r < q.rows(); r++)
+			CHECK(std::abs(dq[c][r] - q[c][r]) <= iq.scales()[c] / 2 + 1e-6f);
+	Vector<f32> w({1, 2, -1, 0.5});
+	Vector<f32> ww = iq.mul_vec(w), wref = dq.mul_vec(w);
+	for (size_t i = 0; i < ww.size(); i++)
+		CHECK(ww[i] == doctest::Approx(wref[i]));
+	CHECK(iq.at(1, 2) == dq[2][1]);
+	CHECK_THROWS_AS(iq.at(4, 0), std::out_of_range);
+	CHECK_THROWS_AS(iq.mul_vec(Vector<f32>(3)), std::invalid_argument);
+
+	// Mixed-precision refinement reaches double accuracy from an f32 factorization
+	const size_t m = 40;
+	Matrix<double> sys(m, m);
+	Vector<double> xs(m);
+	for (size_t c = 0; c < m; c++) {
+		xs[c] = std::sin(double(c) + 0.5);
+		for (size_t r = 0; r < m; r++)
+			sys[c][r] = (r == c ? m : 0) + std::cos(double(r * m + c));
+	}
+	Vector<double> rhs = sys.mul_vec(xs);
+	size_t         steps = 0;
+	Vector<double> sol = solve_refined(sys, rhs, 10, &steps);
+	sol.sub(xs);
+	CHECK(sol.norm_inf() < 1e-12);
+	CHECK(steps > 0); // Reached by refinement, not by the double fallback
+	Matrix<double> hilbert(12, 12); // cond ~ 1e16, far beyond 1 / eps(f32) : falls back to the double solve
+	Vector<double> unit(12);
+	for (size_t c = 0; c < 12; c++) {
+		unit[c] = 1.0;
+		for (size_t r = 0; r < 12; r++)
+			hilbert[c][r] = 1.0 / double(r + c + 1);
+	}
+	solve_refined(hilbert, unit, 10, &steps);
+	CHECK(steps == 0);
+	Vector<double> plain = convert<double>(convert<f32>(sys).solve(convert<f32>(rhs)));
+	plain.sub(xs);
+	CHECK(plain.norm_inf() > 1e-10);
+	CHECK_THROWS_AS(solve_refined(Matrix<double>(2, 3), Vector<double>(3)), std::invalid_argument);
+	CHECK_THROWS_AS(solve_refined(Matrix<double>(2, 2), Vector<double>(2)), std::logic_error);
+}
+
+TEST_CASE("Profiling") {
+	Profiler& p = Profiler::global();
+	p.reset();
+
+	auto find = [](const std::vector<ProfileStat>& stats, const std::string& op, size_t rows) {
+		for (const ProfileStat& s : stats)
+			if (s.op == op && s.rows == rows)
+				return s;
+		return ProfileStat();
+	};
+
+	{
+		ProfileScope outer("test::outer", 4, 2, 10, 100);
+		profile_allocation(64);
+		{
+			ProfileScope inner("test::inner", 4, 1, 5, 50);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		ProfileScope inner("test::inner", 4, 1, 5, 50);
+	}
+	{ ProfileScope other("test::inner", 8, 1, 1, 1); }
+
+	std::vector<ProfileStat> stats = p.stats();
+	ProfileStat outer = find(stats, "test::outer", 4), inner = find(stats, "test::inner", 4);
+	CHECK(outer.calls == 1);
+	CHECK(outer.cols == 2);
+	CHECK(outer.allocations == 1);
+	CHECK(outer.allocated == 64);
+	CHECK(inner.calls == 2);
+	CHECK(inner.flops == 10);
+	CHECK(inner.bytes == 100);
+	CHECK(inner.allocations == 0);
+	CHECK(inner.total_ns >= 1000000);
+	CHECK(inner.min_ns <= inner.max_ns);
+	CHECK(outer.self_ns + inner.total_ns == outer.total_ns); // The second inner scope ends before outer does
+	CHECK(find(stats, "test::inner", 8).calls == 1);
+	CHECK(stats.front().op == "test::inner");                // Sorted by self time
+
+	// Per-thread aggregation, merged on demand
+	std::thread worker([] { ProfileScope s("test::inner", 4, 1, 5, 50); });
+	worker.join();
+	CHECK(find(p.stats(), "test::inner", 4).calls == 3);
+	size_t entries = 0;
+	for (const ProfileStat& s : p.stats(true))
+		entries += (s.op == "test::inner" && s.rows == 4);
+	CHECK(entries == 2);
+
+	std::ostringstream json, trace;
+	p.write_json(json);
+	p.write_trace(trace);
+	CHECK(json.str().find("{\"op\": \"test::outer\", \"rows\": 4, \"cols\": 2") != std::string::npos);
+	CHECK(json.str().find("\"allocated\": 64") != std::string::npos);
+	CHECK(trace.str().rfind("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", 0) == 0);
+	size_t events = 0;
+	for (size_t at = trace.str().find("\"ph\": \"X\""); at != std::string::npos; at = trace.str().find("\"ph\": \"X\"", at + 1))
+		events++;
+	CHECK(events == 5);
+
+	// Disabled : nothing recorded. No trace room : only aggregated
+	p.enabled = false;
+	{ ProfileScope s("test::disabled", 1, 1, 0, 0); }
+	p.enabled = true;
+	CHECK(find(p.stats(), "test::disabled", 1).calls == 0);
+	p.reset();
+	p.trace_capacity = 0;
+	{ ProfileScope s("test::untraced", 1, 1, 0, 0); }
+	std::ostringstream empty;
+	p.write_trace(empty);
+	CHECK(find(p.stats(), "test::untraced", 1).calls == 1);
+	CHECK(empty.str().find("test::untraced") == std::string::npos);
+	p.trace_capacity = 1 << 16;
+
+#ifdef MATRIX_PROFILE
+	p.reset();
+	Matrix<f32> a({{1, 2}, {3, 4}, {5, 6}});
+	Vector<f32> v({1, 1});
+	Matrix<f32> at = a.transpose();
+	a.mul_mat(at);
+	CHECK(find(p.stats(), "Matrix::mul_mat", 3).calls == 1);
+	CHECK(find(p.stats(), "Matrix::mul_mat", 3).flops == 2 * 3 * 2 * 3);
+	CHECK(find(p.stats(), "Matrix::mul_mat", 3).allocations >= 1);
+	CHECK(find(p.stats(), "Matrix::transpose", 3).calls == 1);
+	CHECK(find(p.stats(), "Vector::dot", 2).calls == 0);
+	v.dot(v);
+	CHECK(find(p.stats(), "Vector::dot", 2).calls == 1);
+#endif
+	p.reset();
+}
+
+TEST_CASE("Blocked transpose") {
+	// Sizes around the block and tile sizes, against the element-wise definition
+	auto check = [](auto zero, size_t rows, size_t cols) {
+		using T = decltype(zero);
+		Matrix<T> m(cols, rows);
+		for (size_t c = 0; c < cols; c++)
+			for (size_t r = 0; r < rows; r++)
+				m[c][r] = T(r * 1000 + c);
+
+		auto transposed = [&](const Matrix<T>& t) {
+			if (t.rows() != cols || t.cols() != rows)
+				return false;
+			for (size_t c = 0; c < rows; c++)
+				for (size_t r = 0; r < cols; r++)
+					if (!(t[c][r] == m[r][c]))
+						return false;
+			return true;
+		};
+
+		CHECK(transposed(m.transpose()));
+		Matrix<T> inplace = m;
+		inplace.transpose_inplace();
+		CHECK(transposed(inplace));
+		CHECK(inplace.ld() == inplace.rows());
+		CHECK(transposed(Matrix<T>(m).transpose()));
+		Matrix<T> into(rows, cols);
+		const T*  storage = into.ptr();
+		m.transpose(into);
+		CHECK(transposed(into));
+		CHECK((into.ptr() == storage || !rows || !cols)); // Right shape already : no reallocation
+		Matrix<T> self = m;
+		self.transpose(self); // Into itself : in place
+		CHECK(transposed(self));
+		inplace.transpose_inplace();
+		CHECK(inplace == m);
+	};
+
+	for (auto [r, c] : std::vector<std::pair<size_t, size_t>>{{1, 1}, {1, 7}, {7, 1}, {9, 9}, {64, 64}, {131, 131}, {37, 53}, {130, 67}, {3, 200}}) {
+		check(f32(), r, c);
+		check(double(), r, c);
+		check(c32(), r, c);
+		check(int(), r, c);
+	}
+	check(f32(), 0, 5);
+	check(f32(), 600, 600); // Above tuning.parallel_threshold
+	check(double(), 520, 610);
+}
+
+TEST_CASE("Inverse tracking") {
+	auto near = [](const Matrix<double>& a, const Matrix<double>& b, double tol) {
+		for (size_t c = 0; c < a.cols(); c++)
+			for (size_t r = 0; r < a.rows(); r++)
+				if (std::abs(a[c][r] - b[c][r]) > tol)
+					return false;
+		return true;
+	};
+
+	const size_t   n = 12;
+	Matrix<double> m(n, n);
+	for (size_t c = 0; c < n; c++)
+		for (size_t r = 0; r < n; r++)
+			m[c][r] = (r == c ? 4.0 : 0.0) + std::sin(double(r * n + c));
+
+	InverseTracker<double> t(m);
+	CHECK(t.refactor_interval() == n);
+	CHECK(near(t.inverse(), m.inverse(), 1e-12));
+	CHECK(t.determinant() == doctest::Approx(m.determinant()));
+
+	// Rank-1 updates : element (r, c) gains u[r] * v[c]
+	for (size_t k = 0; k < 5; k++) {
+		Vector<double> u(n), v(n);
+		for (size_t i = 0; i < n; i++) {
+			u[i] = std::cos(double(i + k));
+			v[i] = 0.3 * std::sin(double(2 * i + k));
+		}
+		t.update(u, v);
+		for (size_t c = 0; c < n; c++)
+			for (size_t r = 0; r < n; r++)
+				m[c][r] += u[r] * v[c];
+	}
+	CHECK(t.updates_since_refactor() == 5);
+	CHECK(near(t.matrix(), m, 1e-12));
+	CHECK(near(t.inverse(), m.inverse(), 1e-10));
+	CHECK(t.determinant() == doctest::Approx(m.determinant()).epsilon(1e-10));
+	Vector<double> b(n);
+	for (size_t i = 0; i < n; i++)
+		b[i] = double(i) - 5;
+	Vector<double> x = t.solve(b), ref = m.solve(b);
+	x.sub(ref);
+	CHECK(x.norm() < 1e-10);
+
+	// Rank-3 Woodbury update
+	Matrix<double> u(3, n), v(3, n);
+	for (size_t c = 0; c < 3; c++)
+		for (size_t r = 0; r < n; r++) {
+			u[c][r] = std::cos(double(r * 3 + c));
+			v[c][r] = 0.2 * std::sin(double(r + 5 * c));
+		}
+	t.update(u, v);
+	m.add(u.mul_mat(v.transpose()));
+	CHECK(near(t.inverse(), m.inverse(), 1e-10));
+	CHECK(t.determinant() == doctest::Approx(m.determinant()).epsilon(1e-10));
+
+	// The budget of updates triggers a refactorization
+	InverseTracker<double> every2(m, 2);
+	Vector<double> e(n), f(n);
+	e[0] = 1;
+	f[1] = 0.5;
+	every2.update(e, f);
+	CHECK(every2.updates_since_refactor() == 1);
+	every2.update(e, f);
+	CHECK(every2.updates_since_refactor() == 0);
+	m[1][0] += 1;
+	CHECK(near(every2.inverse(), m.inverse(), 1e-12));
+
+	// An update making the matrix singular is refused and leaves the tracker unchanged
+	Matrix<double> id(2, 2);
+	id[0][0] = id[1][1] = 1;
+	InverseTracker<double> small(id);
+	CHECK_THROWS_AS(small.update(Vector<double>({-1, 0}), Vector<double>({1, 0})), std::logic_error);
+	CHECK(small.matrix() == id);
+	CHECK(small.determinant() == 1);
+	small.update(Vector<double>({1, 0}), Vector<double>({0, 2})); // [[1, 2], [0, 1]]
+	CHECK(small.inverse() == Matrix<double>({{1, -2}, {0, 1}}));
+	CHECK(small.determinant() == 1);
+
+	CHECK_THROWS_AS(InverseTracker<double>(Matrix<double>(2, 3)), std::invalid_argument);
+	CHECK_THROWS_AS(InverseTracker<double>(Matrix<double>(2, 2)), std::logic_error);
+	CHECK_THROWS_AS(small.update(Vector<double>(3), Vector<double>(2)), std::invalid_argument);
+	CHECK_THROWS_AS(small.update(Matrix<double>(1, 2), Matrix<double>(2, 2)), std::invalid_argument);
+}
+
+TEST_CASE("Linear combination of ranges") {
+	auto check = [](auto zero) {
+		using T = decltype(zero);
+		const size_t k = 37, n = 5003; // Ragged against the chunk, the register width and the groups of four inputs
+
+		std::vector<Vector<T>> vectors;
+		std::vector<T>         scalars;
+		for (size_t i = 0; i < k; i++) {
+			Vector<T> v(n);
+			for (size_t j = 0; j < n; j++)
+				v[j] = T(f32((i * 31 + j * 7) % 19) - 9);
+			vectors.push_back(v);
+			scalars.push_back(T(f32(i % 5) - 2) / T(4));
+		}
+
+		Vector<T> expected(n);
+		for (size_t i = 0; i < k; i++)
+			for (size_t j = 0; j < n; j++)
+				expected[j] += scalars[i] * vectors[i][j];
+
+		const Tuning saved = tuning;
+		for (size_t chunk : { size_t(64), size_t(2048), size_t(1 << 20) })
+			for (Execution execution : { Execution::Serial, Execution::Parallel }) {
+				tuning.combine_chunk = chunk;
+				tuning.execution     = execution;
+				Vector<T> result = linear_combination(vectors.begin(), vectors.end(), scalars.begin());
+				result.sub(expected);
+				CHECK(std::abs(result.norm()) < 1e-4);
+			}
+		tuning = saved;
+
+		// Any forward iterator, here raw pointers over a prefix
+		Vector<T> two = linear_combination(vectors.data(), vectors.data() + 2, scalars.data());
+		CHECK(two[3] == scalars[0] * vectors[0][3] + scalars[1] * vectors[1][3]);
+	};
+
+	check(f32());
+	check(double());
+	check(c32());
+
+	std::vector<Vector<f32>> none;
+	std::vector<f32>         coefs = {1, 2};
+	CHECK(linear_combination(none.begin(), none.end(), coefs.begin()).size() == 0);
+
+	std::vector<Vector<f32>> mismatched = { Vector<f32>{1, 2}, Vector<f32>{1, 2, 3} };
+	CHECK_THROWS_AS(linear_combination(mismatched.begin(), mismatched.end(), coefs.begin()), std::invalid_argument);
+}
+
+TEST_CASE("Batched interpolation") {
+	const size_t n = 1000; // Several blocks, the last one partial
+
+	// 3 components of n vectors each, u[i] = (i, -i, 1), v[i] = (2i, i, 3), t[i] spread over [0, 1]
+	std::vector<f32> u(3 * n), v(3 * n), t(n), out(3 * n);
+	for (size_t i = 0; i < n; i++) {
+		u[i] = f32(i); u[n + i] = -f32(i); u[2 * n + i] = 1;
+		v[i] = f32(2 * i); v[n + i] = f32(i); v[2 * n + i] = 3;
+		t[i] = f32(i % 11) / 10;
+	}
+	lerp(SoAView<const f32>(u.data(), n, 3), SoAView<const f32>(v.data(), n, 3), t.data(), SoAView<f32>(out.data(), n, 3));
+	for (size_t i : { size_t(0), size_t(7), size_t(300), n - 1 }) {
+		Vector<f32> ref = lerp(Vector<f32>{u[i], u[n + i], u[2 * n + i]}, Vector<f32>{v[i], v[n + i], v[2 * n + i]}, t[i]);
+		CHECK(out[i] == doctest::Approx(ref[0]));
+		CHECK(out[n + i] == doctest::Approx(ref[1]));
+		CHECK(out[2 * n + i] == doctest::Approx(ref[2]));
+	}
+
+	// In place into u through mutable views, T deduced from the output ; partial overlaps refused
+	std::vector<f32> w = u;
+	SoAView<f32>     pose(w.data(), n, 3), target(v.data(), n, 3);
+	lerp(pose, target, t.data(), pose);
+	CHECK(w == out);
+	CHECK_THROWS_AS(lerp(SoAView<const f32>(w.data(), n, 3), SoAView<const f32>(v.data(), n, 3), t.data(), SoAView<f32>(w.data() + 1, n, 3)), std::invalid_argument);
+	CHECK_THROWS_AS(lerp(SoAView<const f32>(u.data(), n, 3), SoAView<const f32>(v.data(), n, 2), t.data(), SoAView<f32>(out.data(), n, 3)), std::invalid_argument);
+
+	// slerp of unit vectors of the plane : the angle is interpolated linearly, the norm stays 1
+	std::vector<double> p(2 * n), q(2 * n), s(n), r(2 * n);
+	for (size_t i = 0; i < n; i++) {
+		const double a = 0.001 * double(i), b = a + 1.5 * double(i % 3) + 1e-5; // Every third pair nearly parallel
+		p[i] = std::cos(a); p[n + i] = std::sin(a);
+		q[i] = std::cos(b); q[n + i] = std::sin(b);
+		s[i] = double(i % 7) / 6;
+	}
+	slerp(SoAView<double>(p.data(), n, 2), SoAView<const double>(q.data(), n, 2), s.data(), SoAView<double>(r.data(), n, 2));
+	for (size_t i = 0; i < n; i++) {
+		const double a = 0.001 * double(i), b = a + 1.5 * double(i % 3) + 1e-5, e = a + s[i] * (b - a);
+		if (std::abs(r[i] - std::cos(e)) > 1e-6 || std::abs(r[n + i] - std::sin(e)) > 1e-6) {
+			FAIL_CHECK("slerp mismatch at " << i);
+			break;
+		}
+	}
+
+	// Blend of 4x4 transforms, applied with transform_each
+	const size_t m = 5;
+	std::vector<f32> ta(16 * m, 0), tb(16 * m, 0), tt(m, 0.25f), blended(16 * m), vin(4 * m, 1), vout(4 * m);
+	for (size_t i = 0; i < m; i++)
+		for (size_t d = 0; d < 4; d++) {
+			ta[(d * 4 + d) * m + i] = 1;
+			tb[(d * 4 + d) * m + i] = 1;
+		}
+	for (size_t i = 0; i < m; i++)
+		tb[(0 * 4 + 3) * m + i] = 8; // b translates x by 8 : out[0] gains m(3, 0) * in[3], component 0 * 4 + 3
+	blend(SoAView<f32>(ta.data(), m, 16), SoAView<f32>(tb.data(), m, 16), tt.data(), SoAView<f32>(blended.data(), m, 16));
+	transform_each(SoAView<f32>(blended.data(), m, 16), SoAView<f32>(vin.data(), m, 4), SoAView<f32>(vout.data(), m, 4));
+	CHECK(vout[0] == doctest::Approx(3)); // 1 + 0.25 * 8
+	CHECK(vout[m] == doctest::Approx(1));
+	CHECK_THROWS_AS(blend(SoAView<const f32>(ta.data(), m, 4), SoAView<const f32>(tb.data(), m, 4), tt.data(), SoAView<f32>(blended.data(), m, 4)), std::invalid_argument);
+
+	// The single-vector lerp takes t in the precision of T
+	CHECK(lerp(Vector<double>{0, 1}, Vector<double>{1, 3}, 1.0 / 3)[1] == doctest::Approx(5.0 / 3).epsilon(1e-15));
+}
+
+TEST_CASE("Cached matrix properties") {
+	Matrix<double> a(6, 6);
+	for (size_t c = 0; c < 6; c++)
+		for (size_t r = 0; r < 6; r++)
+			a[c][r] = (r == c ? 5.0 : 0.0) + double((r * 7 + c * 3) % 5) - 2;
+
+	CachedMatrix<double> m(a);
+	CHECK_FALSE(m.has_cached_determinant());
+	CHECK(m.determinant() == a.determinant());
+	CHECK(m.has_cached_determinant());
+	CHECK(m.rank() == a.rank());
+	CHECK(&m.inverse() == &m.inverse()); // Computed once, then the same object
+	CHECK(m.inverse() == a.inverse());
+	CHECK(m.rref().reduced == a.rref().reduced);
+	Vector<double> b = {1, 2, 3, 4, 5, 6};
+	Vector<double> x = m.solve(b), ref = a.solve(b);
+	for (size_t i = 0; i < 6; i++)
+		CHECK(x[i] == doctest::Approx(ref[i]));
+
+	// Const access keeps the cache, every mutation drops it
+	const CachedMatrix<double>& view = m;
+	CHECK(view[2][3] == a[2][3]);
+	CHECK(m.has_cached_inverse());
+
+	m.scl(2);
+	a.scl(2);
+	CHECK_FALSE(m.has_cached_determinant());
+	CHECK_FALSE(m.has_cached_inverse());
+	CHECK(m.determinant() == doctest::Approx(a.determinant()));
+
+	m[0][0] = 100;
+	a[0][0] = 100;
+	CHECK_FALSE(m.has_cached_determinant());
+	CHECK(m.determinant() == doctest::Approx(a.determinant()));
+	CHECK(m.inverse() == a.inverse());
+
+	m.add(a);
+	m.sub(a);
+	CHECK(m.inverse() == a.inverse());
+	CachedMatrix<double> copy = m; // Copies the cache with the matrix
+	CHECK(copy.has_cached_inverse());
+	CHECK(copy.inverse() == a.inverse());
+
+	// A singular matrix throws on every inverse() call, without refactorizing
+	m.assign(Matrix<double>({{1, 2}, {2, 4}}));
+	CHECK(m.determinant() == 0);
+	CHECK(m.rank() == 1);
+	CHECK_THROWS_AS(m.inverse(), std::logic_error);
+	CHECK(m.has_cached_inverse());
+	CHECK_THROWS_AS(m.inverse(), std::logic_error);
+
+	m.modify() = Matrix<double>(2, 3);
+	CHECK_THROWS_AS(m.inverse(), std::invalid_argument);
+	CHECK_FALSE(m.has_cached_inverse());
+	CHECK_THROWS_AS(m.determinant(), std::invalid_argument);
+
+	// set() drops the cache at write time, after any number of queries
+	CachedMatrix<double> s(Matrix<double>({{2, 0}, {0, 2}}));
+	CHECK(s.determinant() == 4);
+	s.set(1, 1, 3);
+	CHECK_FALSE(s.has_cached_determinant());
+	CHECK(s.determinant() == 6);
+
+	// Moving takes the cache along and leaves the source empty
+	CachedMatrix<double> moved = std::move(s);
+	CHECK(moved.has_cached_determinant());
+	CHECK(moved.determinant() == 6);
+	CHECK_FALSE(s.has_cached_determinant());
+	CHECK(s.rows() == 0);
+	s = std::move(moved);
+	CHECK(s.has_cached_determinant());
+	CHECK(s.determinant() == 6);
+	CHECK_FALSE(moved.has_cached_determinant());
+}
+
+TEST_CASE("Asynchronous evaluation") {
+	Matrix<double> a(64, 64), b(64, 64);
+	for (size_t c = 0; c < 64; c++)
+		for (size_t r = 0; r < 64; r++) {
+			a[c][r] = (r == c ? 10.0 : 0.0) + std::sin(double(r + 3 * c));
+			b[c][r] = std::cos(double(2 * r + c));
+		}
+
+	// Diamond : ab and inverse(a) run independently, then join
+	Future<Matrix<double>> ab   = async_mul_mat(a, b);
+	Future<Matrix<double>> ainv = async_inverse(a);
+	Future<Matrix<double>> back = async_mul_mat(ainv, ab); // a^-1 * a * b == b
+	CHECK(back.get() == b);
+	CHECK(ab.ready());
+	CHECK(ab.get() == a.mul_mat(b));
+
+	Vector<double> v(64);
+	for (size_t i = 0; i < 64; i++)
+		v[i] = double(i);
+	Vector<double> x = async_solve(a, v).get(), ref = a.solve(v);
+	x.sub(ref);
+	CHECK(x.norm() < 1e-12);
+
+	// Many independent tasks, waited from the submitting thread ; once ready, any task may read them
+	std::vector<Future<size_t>> squares;
+	for (size_t i = 0; i < 100; i++)
+		squares.push_back(submit([i] { return i * i; }));
+	size_t sum = 0;
+	for (const auto& f : squares)
+		sum += f.get();
+	CHECK(sum == 328350);
+	Future<size_t> total = submit([&squares] {
+		size_t sum = 0;
+		for (const auto& f : squares)
+			sum += f.get();
+		return sum;
+	});
+	CHECK(total.get() == 328350);
+
+	// Errors propagate through the dependents, without running them
+	std::atomic<bool> ran{false};
+	Future<Matrix<double>> singular  = async_inverse(Matrix<double>({{1, 2}, {2, 4}}));
+	Future<Matrix<double>> dependent = submit([&ran](const Matrix<double>& m) { ran = true; return m; }, singular);
+	CHECK_THROWS_AS(dependent.get(), std::logic_error);
+	CHECK_FALSE(ran);
+	CHECK_THROWS_AS(Future<int>().wait(), std::logic_error);
+
+	// Binary I/O in the graph : compute, save, then load back once saved
+	const std::string path = "/tmp/matrix_async_test.bin";
+	Future<void>           saved  = async_save(path, ab);
+	Future<Matrix<double>> loaded = submit([path](const std::monostate&) { return load<double>(path); }, saved);
+	CHECK(loaded.get() == ab.get());
+	std::remove(path.c_str());
+	CHECK_THROWS_AS(async_load<double>("/nonexistent/matrix.bin").get(), std::runtime_error);
+
+	// Blocking inside a task on a future that is not one of its dependencies throws instead of risking a deadlock
+	Future<int> never(std::make_shared<Future<int>::State>());
+	Future<int> nested = submit([never] { return never.get(); });
+	CHECK_THROWS_AS(nested.get(), std::logic_error);
+	CHECK(submit([](const int& x) { return x + 1; }, ready_future(1)).get() == 2); // Dependencies are ready
+}
+
+TEST_CASE("Distributed matrices") {
+	// Runs on every rank : 1 x 1 without MPI, the most square grid under mpirun
+	const ProcessGrid& grid = ProcessGrid::world_grid();
+	const bool         root = grid.rank() == 0;
+	const size_t       n = 70, nb = 8; // Several blocks per rank, the last one partial
+
+	Matrix<double> a(n, n), b(n - 11, n);
+	for (size_t c = 0; c < n; c++)
+		for (size_t r = 0; r < n; r++)
+			a[c][r] = (r == c ? 4.0 : 0.0) + std::sin(double(r * n + c));
+	for (size_t c = 0; c < n - 11; c++)
+		for (size_t r = 0; r < n; r++)
+			b[c][r] = std::cos(double(r + 2 * c));
+
+	auto da = DistributedMatrix<double>::scatter(root ? a : Matrix<double>(), 0, grid, nb);
+	auto db = DistributedMatrix<double>::scatter(root ? b : Matrix<double>(), 0, grid, nb);
+	CHECK(da.rows() == n);
+	CHECK(db.cols() == n - 11);
+	CHECK(da.local_rows() == block_cyclic_count(n, nb, grid.row(), grid.rows()));
+
+	Matrix<double> back = da.gather();
+	Matrix<double> product = da.mul_mat(db).gather();
+	if (root) {
+		CHECK(back == a);
+		CHECK(product == a.mul_mat(b));
+	}
+
+	CHECK(da.determinant() == doctest::Approx(a.determinant()).epsilon(1e-10));
+
+	Vector<double> rhs(n);
+	for (size_t i = 0; i < n; i++)
+		rhs[i] = double(i % 7) - 3;
+	Vector<double> x = da.solve(rhs), ref = a.solve(rhs);
+	x.sub(ref);
+	CHECK(x.norm() < 1e-10);
+
+	// A zero column makes the factors singular, on every rank
+	Matrix<double> s = a;
+	for (size_t r = 0; r < n; r++)
+		s[17][r] = 0;
+	DistributedLU<double> lu = DistributedMatrix<double>::scatter(root ? s : Matrix<double>(), 0, grid, nb).lu();
+	CHECK(lu.is_singular());
+	CHECK(lu.det() == 0);
+	CHECK_THROWS_AS(lu.solve(rhs), std::logic_error);
+
+	CHECK_THROWS_AS(da.mul_mat(DistributedMatrix<double>(3, 3, grid, nb)), std::invalid_argument);
+	CHECK_THROWS_AS(db.lu(), std::invalid_argument);
+	CHECK_THROWS_AS(da.mul_mat(DistributedMatrix<double>(n, 3, grid, nb + 1)), std::invalid_argument);
+
+	// An explicit row count is taken as is : one that does not divide the ranks throws on every rank
+	CHECK_THROWS_AS(ProcessGrid(grid.size() + 1), std::invalid_argument);
+	for (size_t rows = 2; rows < grid.size(); rows++)
+		if (grid.size() % rows) {
+			CHECK_THROWS_AS(ProcessGrid{ rows }, std::invalid_argument);
+			break;
+		}
+	if (grid.size() % 2 == 0)
+		CHECK(ProcessGrid(2).rows() == 2);
+}
+
+TEST_CASE("Tuning files") {
+	const string path = "tests_tuning.cfg";
+
+	Tuning t;
+	t.gemm_mc            = 96;
+	t.gemm_threshold     = 32;
+	t.execution          = Execution::Serial;
+	t.parallel_threshold = 12345;
+	save_tuning(path, t);
+
+	Tuning loaded = load_tuning(path);
+	CHECK(loaded.gemm_mc == 96);
+	CHECK(loaded.gemm_threshold == 32);
+	CHECK(loaded.gemm_kc == Tuning().gemm_kc);
+	CHECK(loaded.execution == Execution::Serial);
+	CHECK(loaded.parallel_threshold == 12345);
+
+	// The MATRIX_TUNING file only changes the knobs the program left at their default
+	const Tuning saved = tuning;
+	tuning         = Tuning();
+	tuning.gemm_mc = 64;
+	setenv("MATRIX_TUNING", path.c_str(), 1);
+	apply_tuning_file();
+	unsetenv("MATRIX_TUNING");
+	CHECK(tuning.gemm_mc == 64);
+	CHECK(tuning.gemm_threshold == 32);
+	CHECK(tuning.parallel_threshold == 12345);
+	CHECK(tuning.execution == Execution::Serial);
+	tuning = saved;
+
+	// Partial files only override their keys, comments and blank lines are skipped
+	{
+		ofstream file(path);
+		file << "# calibrated\n\n  gemm_kc =  384 \n";
+	}
+	loaded = load_tuning(path);
+	CHECK(loaded.gemm_kc == 384);
+	CHECK(loaded.gemm_mc == Tuning().gemm_mc);
+
+	// Malformed files are rejected
+	for (const char* bad : {"gemm_kc 384\n", "gemm_kc = -1\n", "gemm_kc = 1x\n", "unknown = 1\n", "execution = fast\n", "gemm_mc = 64\nnc = 2\n"}) {
+		{
+			ofstream file(path);
+			file << bad;
+		}
+		CHECK_THROWS_AS(load_tuning(path), std::invalid_argument);
+	}
+	std::remove(path.c_str());
+	CHECK_THROWS_AS(load_tuning(path), std::runtime_error);
+}
+
+// Performance regression mode, skipped by default : make perf (optimized build, see the Makefile).
+// Every exercise's operation is timed on f32 at production sizes (median of batches of many calls) and checked against
+// the baseline file MATRIX_PERF_BASELINE (perf_baseline.txt next to this file by default) : a case fails when it is
+// more than MATRIX_PERF_TOLERANCE (1.5 by default) times slower, or when it has no baseline. Calls under a microsecond
+// get twice the tolerance : a few nanoseconds of frequency or timer noise is already a large ratio for them.
+// Timings are stored in units of a reference kernel timed again before each case (a dependent chain of scalar fmas,
+// which only follows the clock speed), so the baselines carry over between hosts of the same kind. A new CPU family,
+// or a change that is meant to move the timings, records them again with MATRIX_PERF_RECORD=1 make perf : the file is
+// only written then.
+
+const size_t PERF_BATCHES = 15;
+
+template<typename F>
+double perf_time(F&& fn) { // Seconds per call, median of PERF_BATCHES batches of at least 10 ms each
+	const auto batch = [&](size_t iterations) {
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < iterations; i++)
+			fn();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	size_t iterations = 1;
+	fn(); // Warm up caches and allocations
+	while (batch(iterations) < 0.01 && iterations < (size_t(1) << 26))
+		iterations *= 2;
+
+	vector<double> times(PERF_BATCHES);
+	for (double& t : times)
+		t = batch(iterations) / double(iterations);
+	nth_element(times.begin(), times.begin() + PERF_BATCHES / 2, times.end());
+	return times[PERF_BATCHES / 2];
+}
+
+struct PerfBaseline {
+	string              path;
+	double              tolerance = getenv("MATRIX_PERF_TOLERANCE") ? atof(getenv("MATRIX_PERF_TOLERANCE")) : 1.5;
+	bool                record    = getenv("MATRIX_PERF_RECORD") && string(getenv("MATRIX_PERF_RECORD")) == "1";
+	map<string, double> units; // Time of each case, in reference units
+
+	PerfBaseline() {
+		const string source = __FILE__;
+		const char*  env    = getenv("MATRIX_PERF_BASELINE");
+		path = (env && *env) ? env : source.substr(0, source.find_last_of('/') + 1) + "perf_baseline.txt";
+
+		ifstream file(path);
+		string   line;
+		while (getline(file, line)) {
+			const size_t tab = line.rfind('\t');
+			if (!line.empty() && line[0] != '#' && tab != string::npos)
+				units[line.substr(0, tab)] = atof(line.c_str() + tab + 1);
+		}
+	}
+
+	// 4096 dependent scalar fmas : no memory traffic and no vectorization, one fma latency per step
+	static void reference_kernel() {
+		static volatile f32 seed = 0.5f;
+		f32                 acc  = seed;
+		for (size_t i = 0; i < 4096; i++)
+			acc = std::fma(acc, 0.999f, 0.001f);
+		seed = acc;
+	}
+
+	void save() const {
+		ofstream file(path);
+		if (!file)
+			throw std::runtime_error("Cannot write the perf baselines to " + path);
+		file << "# Time per call of the perf test cases (make perf), in units of the reference kernel, recorded with MATRIX_PERF_RECORD=1\n";
+		for (const auto& [name, u] : units)
+			file << name << '\t' << u << '\n';
+	}
+
+	static PerfBaseline& get() {
+		static PerfBaseline baseline;
+		return baseline;
+	}
+};
+
+// Times fn and checks it against the baseline of name, or records it with MATRIX_PERF_RECORD=1
+template<typename F>
+void perf_check(const string& name, F&& fn) {
+	PerfBaseline& baseline  = PerfBaseline::get();
+	const double  reference = perf_time(PerfBaseline::reference_kernel); // Right before the case : follows clock changes
+	const double  seconds   = perf_time(fn);
+	const double  units     = seconds / reference;
+	const double  tolerance = baseline.tolerance * (seconds < 1e-6 ? 2 : 1);
+	const auto    found     = baseline.units.find(name);
+
+	if (baseline.record) {
+		MESSAGE(name << " : " << seconds * 1e6 << " us, " << units << " units, recorded");
+		baseline.units[name] = units;
+		baseline.save();
+		return;
+	}
+	if (found == baseline.units.end()) {
+		FAIL_CHECK(name << " has no baseline in " << baseline.path << " : record it with MATRIX_PERF_RECORD=1");
+		return;
+	}
+	MESSAGE(name << " : " << seconds * 1e6 << " us, " << units << " units, baseline " << found->second << " units");
+	CHECK_MESSAGE(units <= found->second * tolerance, name << " regressed : " << units / found->second << "x the baseline");
+}
+
+static Vector<f32> perf_vector(size_t n, uint32_t seed) {
+	Vector<f32> v(n);
+	for (size_t i = 0; i < n; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		v[i] = f32(seed >> 8) / f32(1u << 23) - 1.f;
+	}
+	return v;
+}
+
+// Random matrix with a dominant diagonal, far from singular
+static Matrix<f32> perf_matrix(size_t n, uint32_t seed) {
+	Matrix<f32> m = calibration_matrix(n, seed);
+	for (size_t i = 0; i < n; i++)
+		m[i][i] += f32(n);
+	return m;
+}
+
+TEST_SUITE("perf" * doctest::skip()) {
+	const size_t VECTOR = 1 << 20; // Vector size
+	const size_t SQUARE = 1024;    // Matrix size of the O(n^2) operations
+	const size_t CUBIC  = 256;     // Matrix size of the O(n^3) operations
+
+	TEST_CASE("Perf Ex00 add/sub/scl") {
+		Vector<f32> u = perf_vector(VECTOR, 1), v = perf_vector(VECTOR, 2);
+		Matrix<f32> a = perf_matrix(SQUARE, 3), b = perf_matrix(SQUARE, 4);
+
+		perf_check("Ex00 Vector::add", [&] { u.add(v); });
+		perf_check("Ex00 Vector::scl", [&] { u.scl(-1.f); });
+		perf_check("Ex00 Matrix::add", [&] { a.add(b); });
+		perf_check("Ex00 Matrix::sub", [&] { a.sub(b); });
+	}
+
+	TEST_CASE("Perf Ex01 linear combination") {
+		vector<Vector<f32>> vectors;
+		vector<f32>         scalars;
+		for (uint32_t i = 0; i < 16; i++) {
+			vectors.push_back(perf_vector(VECTOR / 4, 10 + i));
+			scalars.push_back(f32(i) / 16);
+		}
+		perf_check("Ex01 linear_combination/k=16", [&] { linear_combination(vectors.begin(), vectors.end(), scalars.begin()); });
+	}
+
+	TEST_CASE("Perf Ex02-Ex06 vector operations") {
+		const Vector<f32> u = perf_vector(VECTOR, 1), v = perf_vector(VECTOR, 2);
+		volatile f32      sink;
+
+		perf_check("Ex02 lerp", [&] { lerp(u, v, 0.25f); });
+		perf_check("Ex03 dot", [&] { sink = u.dot(v); });
+		perf_check("Ex04 norm", [&] { sink = u.norm(); });
+		perf_check("Ex04 norm_1", [&] { sink = u.norm_1(); });
+		perf_check("Ex04 norm_inf", [&] { sink = u.norm_inf(); });
+		perf_check("Ex05 angle_cos", [&] { sink = angle_cos(u, v); });
+
+		const Vector<f32> x = perf_vector(3, 3), y = perf_vector(3, 4);
+		perf_check("Ex06 cross_product", [&] { sink = cross_product(x, y)[0]; });
+		(void)sink;
+	}
+
+	TEST_CASE("Perf Ex07-Ex09 matrix products and transpose") {
+		const Matrix<f32> a = perf_matrix(SQUARE, 1), b = perf_matrix(CUBIC * 2, 2), c = perf_matrix(CUBIC * 2, 3);
+		const Vector<f32> v = perf_vector(SQUARE, 4);
+		volatile f32      sink;
+
+		perf_check("Ex07 mul_vec/1024", [&] { a.mul_vec(v); });
+		perf_check("Ex07 mul_mat/512", [&] { b.mul_mat(c); });
+		perf_check("Ex08 trace/1024", [&] { sink = a.trace(); });
+		perf_check("Ex09 transpose/1024", [&] { a.transpose(); });
+		(void)sink;
+	}
+
+	TEST_CASE("Perf Ex10-Ex13 eliminations") {
+		const Matrix<f32> a = perf_matrix(CUBIC, 1);
+		volatile f32      sink;
+
+		perf_check("Ex10 row_echelon/256", [&] { a.row_echelon(); });
+		perf_check("Ex11 determinant/256", [&] { sink = a.determinant(); });
+		perf_check("Ex12 inverse/256", [&] { a.inverse(); });
+		perf_check("Ex13 rank/256", [&] { sink = f32(a.rank()); });
+		(void)sink;
+	}
+
+	TEST_CASE("Perf Ex14 projection") {
+		volatile f32 sink;
+
+		perf_check("Ex14 projection", [&] { sink = projection(90.0f, 1.0f, 0.1f, 100.0f)[0][0]; });
+		(void)sink;
+	}
+}
+
+// Tuning calibration, skipped by default : make calibrate writes the knobs measured on this host to MATRIX_TUNING
+// (matrix_tuning.cfg by default), applied on first use by every program started with MATRIX_TUNING set to that file.
+TEST_SUITE("calibrate" * doctest::skip()) {
+	TEST_CASE("Calibrate tuning") {
+		const char* env  = getenv("MATRIX_TUNING");
+		const string path = (env && *env) ? env : "matrix_tuning.cfg";
+		const Tuning calibrated = calibrate_tuning();
+
+		save_tuning(path, calibrated);
+		MESSAGE("gemm_threshold " << calibrated.gemm_threshold << ", gemm_mc " << calibrated.gemm_mc << ", gemm_kc " << calibrated.gemm_kc
+			<< ", gemm_nc " << calibrated.gemm_nc << ", combine_chunk " << calibrated.combine_chunk
+			<< ", parallel_threshold " << calibrated.parallel_threshold << " written to " << path);
+
+		const Tuning loaded = load_tuning(path);
+		CHECK(loaded.gemm_kc == calibrated.gemm_kc);
+		CHECK(loaded.gemm_threshold >= 1);
+	}
+}